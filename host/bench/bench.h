@@ -0,0 +1,112 @@
+#pragma once
+
+/**
+ * @file bench.h
+ * @brief Tiny benchmark harness shared by the nmea_bench sections.
+ *
+ * Each section registers itself with BENCH_SECTION(name) and prints one
+ * result line per measured case.  A section returns non-zero when one of its
+ * self-checks fails, which makes nmea_bench exit with a failure status.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <chrono>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace bench {
+
+// ── Timing ───────────────────────────────────────────────────────────────────
+
+inline uint64_t nowNs() {
+    using namespace std::chrono;
+    return (uint64_t)duration_cast<nanoseconds>(
+        steady_clock::now().time_since_epoch()).count();
+}
+
+/** Cycle counter (TSC on x86, 0 elsewhere — reported as "n/a"). */
+inline uint64_t cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// ── Allocation counting (bench_alloc.cpp) ────────────────────────────────────
+
+uint64_t allocCount();
+uint64_t allocBytes();
+
+// ── Corpus ───────────────────────────────────────────────────────────────────
+
+/** Load a text corpus, one sentence per entry, CR/LF stripped. */
+bool loadLines(const std::string& path, std::vector<std::string>& out);
+
+std::string dataPath(const char* file);
+
+/** Global options parsed from the command line. */
+struct Options {
+    int         iterations;   ///< Replays of each corpus per case
+    std::string filter;       ///< Run only sections whose name contains this
+    std::string mixedCorpus;
+    std::string aisCorpus;
+};
+
+const Options& options();
+
+// ── Results ──────────────────────────────────────────────────────────────────
+
+struct Result {
+    uint64_t items;      ///< Sentences (or calls) processed
+    uint64_t ns;
+    uint64_t cycles;
+    uint64_t allocs;
+    uint64_t bytes;
+};
+
+/** Measure fn() once, capturing wall time, TSC and allocator deltas. */
+template <typename Fn>
+Result measure(uint64_t items, Fn fn) {
+    Result r;
+    uint64_t a0 = allocCount(), b0 = allocBytes();
+    uint64_t c0 = cycles();
+    uint64_t t0 = nowNs();
+    fn();
+    r.ns     = nowNs() - t0;
+    r.cycles = cycles() - c0;
+    r.allocs = allocCount() - a0;
+    r.bytes  = allocBytes() - b0;
+    r.items  = items;
+    return r;
+}
+
+void report(const char* name, const Result& r, const char* unit = "sentence");
+
+/** Print a failed self-check and return 1 (so callers can `fails += check(...)`). */
+int fail(const char* section, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+
+/** Keep the optimizer from discarding a computed value. */
+template <typename T>
+inline void keep(const T& v) { asm volatile("" : : "g"(&v) : "memory"); }
+
+// ── Registry ─────────────────────────────────────────────────────────────────
+
+typedef int (*SectionFn)();
+
+struct Registrar {
+    Registrar(const char* name, SectionFn fn);
+};
+
+#define BENCH_SECTION(name)                                             \
+    static int bench_section_##name();                                  \
+    static ::bench::Registrar bench_registrar_##name(#name,             \
+                                                     bench_section_##name); \
+    static int bench_section_##name()
+
+} // namespace bench
@@ -0,0 +1,253 @@
+/**
+ * @file bench_ais_decode.cpp
+ * @brief Table-driven AIS decoder against the per-bit extractor it replaced.
+ *
+ * Reassembles the AIS corpus into whole payloads, then times unarmouring
+ * plus decoding with aisDecode() (every supported type) and with a copy of
+ * the old decodeAISPayload()/extractBits() path (types 1/2/3/5/18/24A
+ * only).  Self-checks: the two paths agree on the Class A / Class B
+ * position fields, and every type in the corpus reaches BoatState through
+ * NMEAParser.
+ */
+
+#include "bench.h"
+#include "ais_decoder.h"
+#include "nmea_parser.h"
+#include "boat_state.h"
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <map>
+
+using namespace bench;
+
+namespace {
+
+struct Payload {
+    std::string armoured;
+    int         fillBits;
+};
+
+// ── Legacy path (pre-descriptor nmea_parser.cpp) ─────────────────────────────
+
+int legacyUnarmor(const char* payload, int payloadLen, uint8_t* out, int outSize) {
+    memset(out, 0, outSize);
+    for (int i = 0; i < payloadLen; i++) {
+        char c = payload[i];
+        uint8_t value = 0;
+        if (c >= '0' && c <= 'W')      value = c - 48;
+        else if (c >= '`' && c <= 'w') value = c - 56;
+        int bitOffset = i * 6;
+        int byteIndex = bitOffset / 8;
+        int bitShift  = 2 - (bitOffset % 8);
+        if (byteIndex < outSize) {
+            if (bitShift >= 0) {
+                out[byteIndex] |= (value << bitShift);
+            } else {
+                out[byteIndex] |= (value >> (-bitShift));
+                if (byteIndex + 1 < outSize) out[byteIndex + 1] |= (value << (8 + bitShift));
+            }
+        }
+    }
+    return payloadLen * 6;
+}
+
+uint32_t legacyBits(const uint8_t* payload, int start, int length) {
+    uint32_t result = 0;
+    for (int i = 0; i < length; i++) {
+        int bitIndex = start + i;
+        if (payload[bitIndex / 8] & (1 << (7 - (bitIndex % 8)))) result |= (1u << (length - 1 - i));
+    }
+    return result;
+}
+
+char legacyChar(uint8_t v) {
+    if (v == 0)            return '@';
+    if (v >= 1 && v <= 26) return 'A' + v - 1;
+    if (v >= 32)           return (char)v;
+    return ' ';
+}
+
+struct LegacyPos {
+    uint32_t mmsi;
+    float    sog, cog, heading, lat, lon;
+    char     name[21];
+};
+
+/** What the old decodeAISType1/5/18/24 extracted; false for other types. */
+bool legacyDecode(const uint8_t* p, LegacyPos& out) {
+    uint8_t type = (uint8_t)legacyBits(p, 0, 6);
+    memset(&out, 0, sizeof(out));
+    out.mmsi = legacyBits(p, 8, 30);
+
+    int base;
+    switch (type) {
+        case 1: case 2: case 3: base = 0; break;
+        case 18:                base = -4; break;
+        case 5: case 24: {
+            int first = type == 5 ? 112 : 40;
+            if (type == 24 && legacyBits(p, 38, 2) != 0) return true;
+            for (int i = 0; i < 20; i++) out.name[i] = legacyChar((uint8_t)legacyBits(p, first + i * 6, 6));
+            for (int i = 19; i >= 0 && (out.name[i] == ' ' || out.name[i] == '@'); i--) out.name[i] = '\0';
+            return true;
+        }
+        default: return false;
+    }
+
+    uint32_t sog = legacyBits(p, 50 + base, 10);
+    if (sog != 1023) out.sog = sog / 10.0f;
+    int32_t lon = (int32_t)legacyBits(p, 61 + base, 28);
+    if (lon & 0x08000000) lon |= 0xF0000000;
+    if (lon != 0x6791AC0) out.lon = lon / 600000.0f;
+    int32_t lat = (int32_t)legacyBits(p, 89 + base, 27);
+    if (lat & 0x04000000) lat |= 0xF8000000;
+    if (lat != 0x3412140) out.lat = lat / 600000.0f;
+    uint32_t cog = legacyBits(p, 116 + base, 12);
+    if (cog != 3600) out.cog = cog / 10.0f;
+    uint32_t hdg = legacyBits(p, 128 + base, 9);
+    if (hdg != 511) out.heading = hdg;
+    return true;
+}
+
+// ── Corpus ───────────────────────────────────────────────────────────────────
+
+/**
+ * Concatenate multi-sentence payloads keyed by (seqId, channel), so parts
+ * interleaved between channels A and B pair up.  Field indices as in
+ * parseAIVDM(); sentences with a bad checksum are skipped.
+ */
+void collectPayloads(const std::vector<std::string>& lines, std::vector<Payload>& out) {
+    NMEAParser checker;
+    std::map<std::string, std::string> pending;
+    for (size_t i = 0; i < lines.size(); i++) {
+        if (!checker.validateChecksum(lines[i].c_str())) continue;
+        NMEAFields f;
+        if (NMEAParser::tokenize(lines[i].c_str(), f) < 7) continue;
+        int total = atoi(std::string(f[1].ptr, f[1].len).c_str());
+        int num   = atoi(std::string(f[2].ptr, f[2].len).c_str());
+        std::string key = std::string(f[3].ptr, f[3].len) + std::string(f[4].ptr, f[4].len);
+        std::string& part = pending[key];
+        if (num == 1) part.clear();
+        part.append(f[5].ptr, f[5].len);
+        if (num == total) {
+            Payload p;
+            p.armoured = part;
+            p.fillBits = f[6].first() - '0';
+            out.push_back(p);
+            pending.erase(key);
+        }
+    }
+}
+
+bool near(float a, float b, float tol) { return fabsf(a - b) <= tol; }
+
+} // namespace
+
+BENCH_SECTION(ais_decode) {
+    int fails = 0;
+
+    std::vector<std::string> lines;
+    if (!loadLines(options().aisCorpus, lines)) return fail("ais_decode", "corpus missing");
+    std::vector<Payload> payloads;
+    collectPayloads(lines, payloads);
+
+    // ── Cross-check position fields against the legacy extractor ────────────
+    const size_t kBuf = AIS_BITBUF_BYTES(AIS_MAX_PAYLOAD_BITS);
+    uint8_t bits[kBuf];
+    uint8_t legacyBuf[kBuf];
+    uint32_t perType[28] = {0};
+    int compared = 0, mismatches = 0;
+
+    for (size_t i = 0; i < payloads.size(); i++) {
+        const Payload& p = payloads[i];
+        size_t n = aisUnarmor(p.armoured.data(), p.armoured.size(), bits, sizeof(bits));
+        AISMessage msg;
+        if (!aisDecode(bits, n - p.fillBits, msg)) continue;
+        perType[msg.type]++;
+
+        legacyUnarmor(p.armoured.data(), (int)p.armoured.size(), legacyBuf, sizeof(legacyBuf));
+        LegacyPos old;
+        if (!legacyDecode(legacyBuf, old)) continue;
+        compared++;
+
+        bool ok = old.mmsi == msg.mmsi;
+        if (msg.type == 5 || msg.type == 24) {
+            ok = ok && strcmp(old.name, msg.name) == 0;
+        } else {
+            ok = ok && near(old.sog, msg.get(AIS_SOG), 0.05f) && near(old.cog, msg.get(AIS_COG), 0.05f)
+                    && near(old.heading, msg.get(AIS_HEADING), 0.5f)
+                    && near(old.lat, msg.get(AIS_LAT), 1e-5f) && near(old.lon, msg.get(AIS_LON), 1e-5f);
+        }
+        if (!ok && mismatches++ < 3) {
+            fails += fail("ais_decode", "type %u MMSI %u decodes differently from the legacy path",
+                          msg.type, msg.mmsi);
+        }
+    }
+    printf("  %zu payloads, %d cross-checked against the legacy extractor, %d mismatches\n",
+           payloads.size(), compared, mismatches);
+
+    // ── Throughput: unarmour + decode, all payloads ──────────────────────────
+    const int iters = options().iterations * 10;
+    AISMessage msg;
+    Result r = measure((uint64_t)payloads.size() * iters, [&]() {
+        for (int it = 0; it < iters; it++) {
+            for (size_t i = 0; i < payloads.size(); i++) {
+                const Payload& p = payloads[i];
+                size_t n = aisUnarmor(p.armoured.data(), p.armoured.size(), bits, sizeof(bits));
+                aisDecode(bits, n - p.fillBits, msg);
+            }
+        }
+    });
+    keep(msg);
+    report("aisDecode, descriptor table", r, "message");
+
+    LegacyPos old;
+    r = measure((uint64_t)payloads.size() * iters, [&]() {
+        for (int it = 0; it < iters; it++) {
+            for (size_t i = 0; i < payloads.size(); i++) {
+                const Payload& p = payloads[i];
+                legacyUnarmor(p.armoured.data(), (int)p.armoured.size(), legacyBuf, sizeof(legacyBuf));
+                legacyDecode(legacyBuf, old);
+            }
+        }
+    });
+    keep(old);
+    report("legacy per-bit extractBits (subset)", r, "message");
+
+    // ── Coverage through NMEAParser ──────────────────────────────────────────
+    BoatState state;
+    state.init();
+    NMEAParser parser(&state);
+    NMEASentence out;
+    for (size_t i = 0; i < lines.size(); i++) parser.parseLine(lines[i].c_str(), out);
+
+    static const uint8_t kExpected[] = { 1, 3, 4, 5, 9, 14, 18, 19, 21, 24, 27 };
+    printf("  decoded by type:");
+    for (uint8_t t = 0; t < 28; t++) {
+        if (parser.getAISDecoded(t)) printf(" %u:%u", t, parser.getAISDecoded(t));
+    }
+    printf("\n");
+    for (size_t i = 0; i < sizeof(kExpected); i++) {
+        uint8_t t = kExpected[i];
+        if (perType[t] == 0) {
+            fails += fail("ais_decode", "corpus has no type %u message", t);
+        } else if (parser.getAISDecoded(t) != perType[t]) {
+            fails += fail("ais_decode", "parser decoded %u type %u messages, expected %u",
+                          parser.getAISDecoded(t), t, perType[t]);
+        }
+    }
+
+    // Static data from 5 / 24B must land on the target
+    AISTarget targets[AIS_MAX_TARGETS];
+    int n = state.getAISTargets(targets, AIS_MAX_TARGETS);
+    int withCallsign = 0, withType = 0;
+    for (int i = 0; i < n; i++) {
+        withCallsign += targets[i].callsign[0] != '\0';
+        withType     += targets[i].shipType != 0;
+    }
+    if (withCallsign == 0 || withType == 0)
+        fails += fail("ais_decode", "no target carries a call sign / ship type (%d / %d)",
+                      withCallsign, withType);
+
+    return fails;
+}
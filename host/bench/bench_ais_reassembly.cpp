@@ -0,0 +1,145 @@
+/**
+ * @file bench_ais_reassembly.cpp
+ * @brief AISReassembler: interleaving, ordering, timeouts and slot pressure.
+ *
+ * Scripted fragment sequences check that dual-channel interleaving and
+ * out-of-order parts reassemble, that 5-part messages fit, and that
+ * stale, duplicate and malformed fragments land in the right counter.
+ * Then times add() on the AIS corpus' multi-sentence traffic.
+ */
+
+#include "bench.h"
+#include "ais_reassembly.h"
+#include "nmea_parser.h"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+
+using namespace bench;
+
+namespace {
+
+AISFragment frag(char seq, char ch, uint8_t total, uint8_t num, const char* payload) {
+    AISFragment f;
+    f.talker[0] = 'A';
+    f.talker[1] = 'I';
+    f.seqId     = seq;
+    f.channel   = ch;
+    f.total     = total;
+    f.num       = num;
+    f.payload   = payload;
+    f.len       = (uint8_t)strlen(payload);
+    f.fillBits  = num == total ? 2 : 0;
+    return f;
+}
+
+/** add() and, on completion, compare the assembled payload. */
+int expect(AISReassembler& r, const AISFragment& f, unsigned long now, const char* want) {
+    bool done = r.add(f, now);
+    if (!want) {
+        return done ? fail("ais_reassembly", "seq %c ch %c part %u/%u completed unexpectedly",
+                           f.seqId, f.channel, f.num, f.total) : 0;
+    }
+    if (!done) {
+        return fail("ais_reassembly", "seq %c ch %c part %u/%u did not complete",
+                    f.seqId, f.channel, f.num, f.total);
+    }
+    std::string got(r.message(), r.messageLen());
+    if (got != want || r.messageFillBits() != 2)
+        return fail("ais_reassembly", "assembled \"%s\", expected \"%s\"", got.c_str(), want);
+    return 0;
+}
+
+} // namespace
+
+BENCH_SECTION(ais_reassembly) {
+    int fails = 0;
+
+    // ── Dual-channel interleaving, same sequential id on A and B ────────────
+    {
+        AISReassembler r;
+        fails += expect(r, frag('3', 'A', 2, 1, "a1"), 0, nullptr);
+        fails += expect(r, frag('3', 'B', 2, 1, "b1"), 1, nullptr);
+        fails += expect(r, frag('4', 'A', 2, 1, "c1"), 2, nullptr);
+        fails += expect(r, frag('3', 'B', 2, 2, "b2"), 3, "b1b2");
+        fails += expect(r, frag('3', 'A', 2, 2, "a2"), 4, "a1a2");
+        fails += expect(r, frag('4', 'A', 2, 2, "c2"), 5, "c1c2");
+        if (r.completed() != 3 || r.dropped() || r.expired() || r.inFlight())
+            fails += fail("ais_reassembly", "interleaving: %u completed, %u dropped, %u expired",
+                          r.completed(), r.dropped(), r.expired());
+    }
+
+    // ── Five parts, out of order ─────────────────────────────────────────────
+    {
+        AISReassembler r;
+        fails += expect(r, frag('7', 'B', 5, 3, "33"), 0, nullptr);
+        fails += expect(r, frag('7', 'B', 5, 1, "11"), 0, nullptr);
+        fails += expect(r, frag('7', 'B', 5, 5, "55"), 0, nullptr);
+        fails += expect(r, frag('7', 'B', 5, 2, "22"), 0, nullptr);
+        fails += expect(r, frag('7', 'B', 5, 4, "44"), 0, "1122334455");
+    }
+
+    // ── Timeout, id wrap-around, malformed and slot pressure ────────────────
+    {
+        AISReassembler r;
+        fails += expect(r, frag('1', 'A', 2, 1, "x1"), 0, nullptr);
+        fails += expect(r, frag('1', 'A', 2, 2, "x2"), AIS_REASSEMBLY_TIMEOUT_MS + 1, nullptr);
+        if (r.expired() != 1) fails += fail("ais_reassembly", "stale part not expired (%u)", r.expired());
+        r.expire(2 * AIS_REASSEMBLY_TIMEOUT_MS + 2);
+        if (r.expired() != 2 || r.inFlight())
+            fails += fail("ais_reassembly", "orphan last part not expired (%u)", r.expired());
+
+        // Part 1 again before part 2: the first message is lost
+        fails += expect(r, frag('2', 'A', 2, 1, "old"), 10000, nullptr);
+        fails += expect(r, frag('2', 'A', 2, 1, "new"), 10001, nullptr);
+        fails += expect(r, frag('2', 'A', 2, 2, "2"), 10002, "new2");
+        if (r.dropped() != 1) fails += fail("ais_reassembly", "superseded part not dropped (%u)", r.dropped());
+
+        fails += expect(r, frag('5', 'A', 6, 1, "p"), 10003, nullptr);     // > 5 parts
+        fails += expect(r, frag('5', 'A', 2, 3, "p"), 10003, nullptr);     // num > total
+        if (r.dropped() != 3) fails += fail("ais_reassembly", "malformed parts not dropped (%u)", r.dropped());
+
+        // One more message than slots: the oldest gives way
+        for (int i = 0; i <= AIS_REASSEMBLY_SLOTS; i++)
+            fails += expect(r, frag((char)('0' + i), 'B', 2, 1, "s"), 10010 + i, nullptr);
+        if (r.dropped() != 4 || r.inFlight() != AIS_REASSEMBLY_SLOTS)
+            fails += fail("ais_reassembly", "slot pressure: %u dropped, %u in flight",
+                          r.dropped(), r.inFlight());
+    }
+
+    // ── Cost on the corpus' multi-sentence traffic ───────────────────────────
+    std::vector<std::string> lines;
+    if (!loadLines(options().aisCorpus, lines)) return fails + fail("ais_reassembly", "corpus missing");
+
+    std::vector<AISFragment> frags;
+    for (size_t i = 0; i < lines.size(); i++) {
+        NMEAFields f;
+        if (NMEAParser::tokenize(lines[i].c_str(), f) < 7 || f[1].first() == '1') continue;
+        AISFragment a = frag(f[3].first(), f[4].first(), (uint8_t)(f[1].first() - '0'),
+                             (uint8_t)(f[2].first() - '0'), "");
+        a.payload  = f[5].ptr;
+        a.len      = f[5].len;
+        a.fillBits = (uint8_t)(f[6].first() - '0');
+        frags.push_back(a);
+    }
+
+    AISReassembler r;
+    const int iters = options().iterations * 50;
+    size_t bytes = 0;
+    Result res = measure((uint64_t)frags.size() * iters, [&]() {
+        for (int it = 0; it < iters; it++) {
+            for (size_t i = 0; i < frags.size(); i++) {
+                if (r.add(frags[i], (unsigned long)i)) bytes += r.messageLen();
+            }
+        }
+    });
+    keep(bytes);
+    char label[64];
+    snprintf(label, sizeof(label), "add (%zu fragments)", frags.size());
+    report(label, res, "fragment");
+    printf("  %u completed, %u dropped, %u expired\n", r.completed(), r.dropped(), r.expired());
+    if (r.completed() * 2 != r.fragments() - r.dropped() - r.expired() - r.inFlight())
+        fails += fail("ais_reassembly", "corpus fragments unaccounted for");
+
+    return fails;
+}
@@ -0,0 +1,146 @@
+/**
+ * @file bench_ais_table.cpp
+ * @brief AISTargetTable: busy-harbour retention checks and lookup cost.
+ *
+ * Feeds more vessels than the table holds and checks that the closest
+ * ones are the ones kept, that stale targets are purged with the MMSI
+ * index still consistent, then compares hashed updates against the
+ * linear MMSI scan the table replaced.
+ */
+
+#include "bench.h"
+#include "ais_table.h"
+#include <stdio.h>
+#include <vector>
+#include <algorithm>
+
+using namespace bench;
+
+namespace {
+
+// Deterministic LCG so runs are comparable
+uint32_t rng(uint32_t& s) {
+    s = s * 1664525u + 1013904223u;
+    return s >> 8;
+}
+
+AISTarget vessel(uint32_t mmsi, float distance) {
+    AISTarget t;
+    t.mmsi         = mmsi;
+    t.hasProximity = true;
+    t.distance     = distance;
+    t.cpa          = distance;
+    t.timestamp    = millis();
+    return t;
+}
+
+int checkIndex(AISTargetTable& table, const char* when) {
+    for (uint16_t i = 0; i < table.size(); i++) {
+        uint32_t mmsi = table.data()[i].mmsi;
+        if (table.find(mmsi) != &table.data()[i])
+            return fail("ais_table", "%s: MMSI %u not found at its slot", when, mmsi);
+    }
+    return 0;
+}
+
+} // namespace
+
+BENCH_SECTION(ais_table) {
+    int fails = 0;
+
+    // ── Retention: 400 vessels, room for 64 → the 64 closest stay ────────────
+    AISTargetTable table;
+    table.begin(64);
+
+    uint32_t seed = 12345;
+    std::vector<AISTarget> harbour;
+    for (int i = 0; i < 400; i++) {
+        harbour.push_back(vessel(227000000 + rng(seed) % 900000, (rng(seed) % 20000) / 1000.0f));
+    }
+    // Unique MMSIs only, so "closest 64" is well defined
+    std::sort(harbour.begin(), harbour.end(),
+              [](const AISTarget& a, const AISTarget& b) { return a.mmsi < b.mmsi; });
+    harbour.erase(std::unique(harbour.begin(), harbour.end(),
+                              [](const AISTarget& a, const AISTarget& b) { return a.mmsi == b.mmsi; }),
+                  harbour.end());
+    std::random_shuffle(harbour.begin(), harbour.end());
+
+    for (size_t i = 0; i < harbour.size(); i++) table.addOrUpdate(harbour[i]);
+
+    std::vector<float> dist;
+    for (size_t i = 0; i < harbour.size(); i++) dist.push_back(harbour[i].distance);
+    std::sort(dist.begin(), dist.end());
+    float cutoff = dist[63];
+
+    float farthestKept = 0;
+    for (uint16_t i = 0; i < table.size(); i++) farthestKept = std::max(farthestKept, table.data()[i].distance);
+    printf("  %u vessels into 64 slots: %u evicted, %u rejected, farthest kept %.3f nm (64th closest %.3f)\n",
+           (unsigned)harbour.size(), table.evictions(), table.rejected(), farthestKept, cutoff);
+    if (table.size() != 64) fails += fail("ais_table", "table holds %u targets, expected 64", table.size());
+    if (farthestKept > cutoff) fails += fail("ais_table", "kept a target beyond the 64 closest");
+    fails += checkIndex(table, "after eviction");
+
+    // Updates keep the name learnt from static data
+    uint32_t named = table.data()[0].mmsi;
+    table.setStatic(named, "BREIZH", "FBRZ", 36);
+    AISTarget pos = *table.find(named);
+    pos.name[0] = '\0';
+    table.addOrUpdate(pos);
+    if (strcmp(table.find(named)->name, "BREIZH") != 0 || table.find(named)->shipType != 36)
+        fails += fail("ais_table", "position report erased the target static data");
+
+    // ── Stale purge: age half the table, index must stay consistent ──────────
+    for (uint16_t i = 0; i < table.size(); i += 2) {
+        AISTarget* t = table.find(table.data()[i].mmsi);
+        t->timestamp = millis() - 2 * DATA_TIMEOUT_AIS;
+    }
+    std::vector<uint32_t> before;
+    for (uint16_t i = 0; i < table.size(); i++) before.push_back(table.data()[i].mmsi);
+    int removed = table.removeStale();
+    if (removed != 32 || table.size() != 32)
+        fails += fail("ais_table", "removeStale removed %d, %u left", removed, table.size());
+    fails += checkIndex(table, "after removeStale");
+    int missing = 0;
+    for (size_t i = 0; i < before.size(); i++) {
+        AISTarget* t = table.find(before[i]);
+        if (t && millis() - t->timestamp > DATA_TIMEOUT_AIS) missing++;
+    }
+    if (missing) fails += fail("ais_table", "%d stale targets still indexed", missing);
+
+    // ── Update cost: hashed vs linear scan over a full 512-slot table ────────
+    AISTargetTable big;
+    big.begin(512);
+    std::vector<AISTarget> fleet;
+    for (uint32_t i = 0; i < 512; i++) fleet.push_back(vessel(227000000 + i * 7919, 1.0f + i));
+    for (size_t i = 0; i < fleet.size(); i++) big.addOrUpdate(fleet[i]);
+
+    std::vector<uint32_t> order;
+    for (int i = 0; i < 4096; i++) order.push_back(fleet[rng(seed) % fleet.size()].mmsi);
+
+    const int rounds = 20 * options().iterations;
+    AISTarget upd = fleet[0];
+    Result r = measure((uint64_t)rounds * order.size(), [&]() {
+        for (int k = 0; k < rounds; k++) {
+            for (size_t i = 0; i < order.size(); i++) {
+                upd.mmsi = order[i];
+                big.addOrUpdate(upd);
+            }
+        }
+    });
+    report("addOrUpdate hashed (512 targets)", r, "update");
+
+    std::vector<AISTarget> linear(fleet);
+    r = measure((uint64_t)rounds * order.size(), [&]() {
+        for (int k = 0; k < rounds; k++) {
+            for (size_t i = 0; i < order.size(); i++) {
+                for (size_t j = 0; j < linear.size(); j++) {
+                    if (linear[j].mmsi == order[i]) { linear[j].sog += 0.1f; break; }
+                }
+            }
+        }
+    });
+    keep(linear[0].sog);
+    report("linear MMSI scan (512 targets)", r, "update");
+
+    return fails;
+}
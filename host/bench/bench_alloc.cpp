@@ -0,0 +1,41 @@
+/**
+ * @file bench_alloc.cpp
+ * @brief Global operator new/delete replacement counting heap allocations.
+ *
+ * Arduino String, std::string and any explicit new in the core all funnel
+ * through here; malloc() calls (PolarData::loadFromFile) are not counted.
+ */
+
+#include "bench.h"
+#include <stdlib.h>
+#include <new>
+#include <atomic>
+
+static std::atomic<uint64_t> s_allocCount(0);
+static std::atomic<uint64_t> s_allocBytes(0);
+
+namespace bench {
+uint64_t allocCount() { return s_allocCount.load(std::memory_order_relaxed); }
+uint64_t allocBytes() { return s_allocBytes.load(std::memory_order_relaxed); }
+}
+
+static void* countedAlloc(size_t size) {
+    s_allocCount.fetch_add(1, std::memory_order_relaxed);
+    s_allocBytes.fetch_add(size, std::memory_order_relaxed);
+    void* p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new(size_t size)                            { return countedAlloc(size); }
+void* operator new[](size_t size)                          { return countedAlloc(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    s_allocCount.fetch_add(1, std::memory_order_relaxed);
+    s_allocBytes.fetch_add(size, std::memory_order_relaxed);
+    return malloc(size ? size : 1);
+}
+void* operator new[](size_t size, const std::nothrow_t& t) noexcept { return operator new(size, t); }
+void  operator delete(void* p) noexcept                    { free(p); }
+void  operator delete[](void* p) noexcept                  { free(p); }
+void  operator delete(void* p, size_t) noexcept            { free(p); }
+void  operator delete[](void* p, size_t) noexcept          { free(p); }
@@ -0,0 +1,74 @@
+/**
+ * @file bench_cache.cpp
+ * @brief ResponseCache: invalidation, max age, and the cost of a hit.
+ *
+ * An entry must be dropped by an invalidation of any of its sources, and
+ * only of its sources — also one that lands while the body is being built
+ * (the stamp is read first) — and must expire after the max age.  A hit
+ * must not allocate, nor a rebuild that fits the buffer already held.
+ */
+
+#include "bench.h"
+#include "response_cache.h"
+#include <stdio.h>
+#include <string.h>
+
+using namespace bench;
+
+BENCH_SECTION(response_cache) {
+    int fails = 0;
+    ResponseCache cache(10000);
+
+    const uint32_t fsOnly    = CACHE_MASK(CACHE_SOURCE_LITTLEFS);
+    const uint32_t fsPolar   = CACHE_MASK(CACHE_SOURCE_LITTLEFS) | CACHE_MASK(CACHE_SOURCE_POLAR);
+    const char*    files     = "{\"files\":[{\"path\":\"/polar.pol\",\"size\":1843}],\"count\":1}";
+    const char*    polar     = "{\"loaded\":true,\"file_size\":1843,\"file_exists\":true}";
+    uint32_t       now       = 1000;
+
+    if (cache.get(0, now)) fails += fail("response_cache", "empty cache hit");
+
+    cache.put(0, fsOnly, cache.stamp(fsOnly), now, files, strlen(files));
+    cache.put(1, fsPolar, cache.stamp(fsPolar), now, polar, strlen(polar));
+    size_t len = 0;
+    const char* body = cache.get(0, now + 50, &len);
+    if (!body || len != strlen(files) || strcmp(body, files) != 0)
+        fails += fail("response_cache", "stored body not returned as put");
+
+    // Polar reload: only the entry built from it goes
+    cache.invalidate(CACHE_MASK(CACHE_SOURCE_POLAR));
+    if (!cache.get(0, now + 60)) fails += fail("response_cache", "polar invalidation dropped the file list");
+    if (cache.get(1, now + 60))  fails += fail("response_cache", "polar status served after polar invalidation");
+
+    // Invalidated while building: stamp read before, entry stale at once
+    uint32_t stamp = cache.stamp(fsPolar);
+    cache.invalidate(CACHE_MASK(CACHE_SOURCE_LITTLEFS));
+    cache.put(1, fsPolar, stamp, now + 70, polar, strlen(polar));
+    if (cache.get(1, now + 80)) fails += fail("response_cache", "body built across an invalidation was served");
+    if (cache.get(0, now + 80)) fails += fail("response_cache", "file list served after a LittleFS invalidation");
+
+    cache.put(1, fsPolar, cache.stamp(fsPolar), now + 90, polar, strlen(polar));
+    if (!cache.get(1, now + 90 + 9999))  fails += fail("response_cache", "entry expired before the max age");
+    if (cache.get(1, now + 90 + 10000))  fails += fail("response_cache", "entry served past the max age");
+
+    if (cache.put(RESPONSE_CACHE_SLOTS, fsOnly, 0, now, files, 4)) fails += fail("response_cache", "out-of-range key accepted");
+
+    // ── Cost ─────────────────────────────────────────────────────────────────
+    cache.put(0, fsOnly, cache.stamp(fsOnly), now, files, strlen(files));
+    const int n = 200000 * options().iterations;
+    size_t total = 0;
+    Result r = measure(n, [&]() {
+        for (int i = 0; i < n; i++) total += cache.get(0, now + (i & 1023), &len) ? len : 0;
+    });
+    keep(total);
+    report("get (hit)", r, "lookup");
+    if (r.allocs) fails += fail("response_cache", "%llu allocations on hits", (unsigned long long)r.allocs);
+
+    r = measure(n / 10, [&]() {
+        for (int i = 0; i < n / 10; i++) cache.put(0, fsOnly, cache.stamp(fsOnly), now, files, strlen(files) - (i & 7));
+    });
+    report("put (rebuild, same buffer)", r, "put");
+    if (r.allocs) fails += fail("response_cache", "%llu allocations rebuilding into a held buffer", (unsigned long long)r.allocs);
+
+    printf("  %u hits, %u misses, %u invalidations\n", cache.getHits(), cache.getMisses(), cache.getInvalidations());
+    return fails;
+}
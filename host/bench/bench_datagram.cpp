@@ -0,0 +1,152 @@
+/**
+ * @file bench_datagram.cpp
+ * @brief DatagramBatch: UDP output packing as UDPOutput drives it.
+ *
+ * The corpus is replayed at a given sentence rate on a simulated 1 ms
+ * clock: each sentence is add()ed, and poll() runs on the processor
+ * task's wake-ups: on each arrival, and when msUntilDue() runs out.  Concatenated, the datagrams must
+ * be the corpus byte for byte; each must hold whole sentences within the
+ * size bound, and no sentence may wait past the latency bound.  The
+ * number of sends is compared with one datagram per sentence.
+ */
+
+#include "bench.h"
+#include "datagram_batch.h"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace bench;
+
+namespace {
+
+struct Capture {
+    std::string stream;
+    uint32_t    datagrams;
+    size_t      largest;
+    uint32_t    torn;          ///< Datagrams not made of whole CR LF sentences
+    uint32_t    now;
+    uint32_t    oldest;        ///< Arrival of the first sentence in the open datagram
+    uint32_t    maxWaitMs;
+
+    Capture() : datagrams(0), largest(0), torn(0), now(0), oldest(0), maxWaitMs(0) {}
+};
+
+void capture(const char* data, size_t len, void* ctx) {
+    Capture& c = *static_cast<Capture*>(ctx);
+    c.stream.append(data, len);
+    c.datagrams++;
+    if (len > c.largest) c.largest = len;
+    if ((data[0] != '$' && data[0] != '!') || len < 2 || data[len - 2] != '\r' || data[len - 1] != '\n')
+        c.torn++;
+    if (c.now - c.oldest > c.maxWaitMs) c.maxWaitMs = c.now - c.oldest;
+}
+
+/** Replay @p count lines at @p perSecond; @p expected gets what the receivers should see. */
+void run(const std::vector<std::string>& lines, size_t count, uint32_t perSecond,
+         DatagramBatch& batch, Capture& c, std::string& expected) {
+    size_t   next = 0;
+    uint32_t wakeAt = 0;
+    for (c.now = 0; next < count || batch.pending() > 0; c.now++) {
+        bool woken = false;
+        while (next < count && (uint64_t)next * 1000 / perSecond <= c.now) {
+            const std::string& l = lines[next % lines.size()];
+            if (batch.pending() == 0) c.oldest = c.now;
+            size_t before = batch.pending();
+            batch.add(l.data(), l.size(), c.now);
+            if (batch.pending() < before + l.size() + 2) c.oldest = c.now;   // Sent the full one first
+            expected.append(l).append("\r\n");
+            next++;
+            woken = true;
+        }
+        if (woken || c.now >= wakeAt) {
+            batch.poll(c.now);
+            wakeAt = c.now + batch.msUntilDue(c.now);
+        }
+    }
+}
+
+} // namespace
+
+BENCH_SECTION(datagram) {
+    int fails = 0;
+
+    std::vector<std::string> lines;
+    loadLines(options().mixedCorpus, lines);
+    if (lines.empty()) return fails + fail("datagram", "no corpus lines");
+
+    // ── Packing at NMEA rates and datagram sizes ─────────────────────────────
+    struct Case { uint32_t rate; size_t size; uint32_t delayMs; };
+    static const Case kCases[] = {
+        {   50, DATAGRAM_MAX, 50 },
+        {  200, DATAGRAM_MAX, 50 },
+        { 1000, DATAGRAM_MAX, 50 },
+        { 1000, 128,          50 },
+        {  200, DATAGRAM_MAX, 200 },
+    };
+    const size_t count = lines.size() * options().iterations;
+    for (size_t i = 0; i < sizeof(kCases) / sizeof(kCases[0]); i++) {
+        const Case& k = kCases[i];
+        Capture c;
+        DatagramBatch batch(capture, &c);
+        batch.setLimits(k.size, k.delayMs);
+        std::string expected;
+        run(lines, count, k.rate, batch, c, expected);
+
+        printf("  %4u sentences/s, ≤ %4zu B / %3u ms: %.1f sentences per datagram (was 1), largest %zu B, max wait %u ms\n",
+               k.rate, k.size, k.delayMs, (double)batch.sentences() / (c.datagrams ? c.datagrams : 1),
+               c.largest, c.maxWaitMs);
+        if (c.stream != expected)
+            fails += fail("datagram", "%u/s ≤ %zu B: receivers' stream differs from the corpus", k.rate, k.size);
+        if (c.torn)             fails += fail("datagram", "%u datagrams split a sentence", c.torn);
+        if (c.largest > k.size) fails += fail("datagram", "%zu B datagram over the %zu B bound", c.largest, k.size);
+        if (c.maxWaitMs > k.delayMs)
+            fails += fail("datagram", "%u/s: a sentence waited %u ms (bound %u)", k.rate, c.maxWaitMs, k.delayMs);
+        if (c.datagrams != batch.datagrams() || batch.sentences() != count)
+            fails += fail("datagram", "counters: %u datagrams, %u sentences", batch.datagrams(), batch.sentences());
+        if (k.rate >= 200 && k.size == DATAGRAM_MAX && batch.sentences() < 4 * c.datagrams)
+            fails += fail("datagram", "%u/s: only %.1f sentences per datagram", k.rate,
+                          (double)batch.sentences() / c.datagrams);
+    }
+
+    // ── Bounds ───────────────────────────────────────────────────────────────
+    {
+        Capture c;
+        DatagramBatch batch(capture, &c);
+        batch.setLimits(64, 50);
+        std::string longLine(70, 'A');
+        longLine[0] = '$';
+        batch.add(longLine.data(), longLine.size(), 0);
+        if (batch.oversize() != 1 || batch.pending() != 0) fails += fail("datagram", "oversize sentence not dropped");
+        batch.add("$GPXXX,1", 8, 0);
+        if (batch.poll(49)) fails += fail("datagram", "sent before the latency bound");
+        if (!batch.poll(50) || c.datagrams != 1) fails += fail("datagram", "not sent at the latency bound");
+        if (batch.poll(200)) fails += fail("datagram", "empty datagram sent");
+        batch.setLimits(DATAGRAM_MAX + 500, 50);
+        if (batch.maxBytes() != DATAGRAM_MAX) fails += fail("datagram", "limit not clamped to %u", DATAGRAM_MAX);
+    }
+
+    // ── Cost per sentence ────────────────────────────────────────────────────
+    {
+        Capture c;
+        DatagramBatch batch(capture, &c);
+        batch.setLimits(DATAGRAM_MAX, 50);
+        c.stream.reserve(DATAGRAM_MAX);
+        const int iters = options().iterations * 5;
+        const uint64_t items = (uint64_t)lines.size() * iters;
+        Result r = measure(items, [&]() {
+            for (int it = 0; it < iters; it++) {
+                for (size_t i = 0; i < lines.size(); i++) {
+                    batch.add(lines[i].data(), lines[i].size(), (uint32_t)i);
+                    c.stream.clear();
+                }
+            }
+            batch.flush();
+        });
+        keep(c.datagrams);
+        report("add + datagram hand-off", r);
+    }
+
+    return fails;
+}
@@ -0,0 +1,235 @@
+/**
+ * @file bench_filter.cpp
+ * @brief SentenceFilter: $PMAR,FILTER commands, matching, rates and cost.
+ *
+ * Commands are checked for their replies (valid checksums, whole-list
+ * rejection, "?" round trip, a full list of the longest rules echoed
+ * whole in a FILTER_REPLY_MAX buffer).  The mixed corpus is replayed at
+ * a simulated 20 sentences per 100 ms through whitelist and rate-limited
+ * rule sets, and the AIS corpus through a tight VDM rate, where every
+ * multi-part message the client receives must be complete.  Then the
+ * per-broadcast cost of one key parse plus five clients' filters is
+ * measured.
+ */
+
+#include "bench.h"
+#include "sentence_filter.h"
+#include <ctype.h>
+#include <map>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace bench;
+
+namespace {
+
+bool validReply(const char* reply, const char* expectBody) {
+    char check[FILTER_REPLY_MAX + 8];
+    SentenceFilter::formatSentence(check, sizeof(check), expectBody);
+    return strcmp(reply, check) == 0;
+}
+
+int expectReply(SentenceFilter& f, const char* cmd, const char* expectBody) {
+    char reply[FILTER_REPLY_MAX + 8];
+    if (!f.command(cmd, strlen(cmd), reply, sizeof(reply)))
+        return fail("filter", "\"%s\" not taken as a command", cmd);
+    if (!validReply(reply, expectBody))
+        return fail("filter", "\"%s\" replied %s, expected $%s*hh", cmd, reply, expectBody);
+    return 0;
+}
+
+} // namespace
+
+BENCH_SECTION(filter) {
+    int fails = 0;
+
+    // ── Commands ─────────────────────────────────────────────────────────────
+    {
+        SentenceFilter f;
+        fails += expectReply(f, "$PMAR,FILTER,RMC,GPGGA,AI*,MWV/2,VDM/0.2\r\n",
+                             "PMAR,OK,FILTER,RMC,GPGGA,AI*,MWV/2,VDM/0.2");
+        if (f.rules() != 5) fails += fail("filter", "%u rules after a 5-rule command", f.rules());
+        fails += expectReply(f, "$PMAR,FILTER,?", "PMAR,OK,FILTER,RMC,GPGGA,AI*,MWV/2,VDM/0.2");
+        // A bad rule rejects the whole list
+        fails += expectReply(f, "$PMAR,FILTER,RMC,bad-rule", "PMAR,ERR,FILTER,bad rule 2");
+        fails += expectReply(f, "$PMAR,FILTER,RMC/0", "PMAR,ERR,FILTER,bad rule 1");
+        if (f.rules() != 5) fails += fail("filter", "rejected command changed the rules");
+        // Checksums: validated when present, lower-case hex accepted
+        char cmd[64], reply[FILTER_REPLY_MAX];
+        SentenceFilter::formatSentence(cmd, sizeof(cmd), "PMAR,FILTER,*/5");
+        fails += expectReply(f, cmd, "PMAR,OK,FILTER,*/5");
+        char* sum = strrchr(cmd, '*');
+        sum[1] = (char)tolower(sum[1]);
+        sum[2] = (char)tolower(sum[2]);
+        fails += expectReply(f, cmd, "PMAR,OK,FILTER,*/5");
+        fails += expectReply(f, "$PMAR,FILTER,GGA*00", "PMAR,ERR,FILTER,checksum");
+        fails += expectReply(f, "$PMAR,FILTER", "PMAR,OK,FILTER");
+        if (f.active()) fails += fail("filter", "empty command left rules active");
+        if (f.command("$PMARX,1", 8, reply, sizeof(reply)) || f.command("$GPRMC,", 7, reply, sizeof(reply)))
+            fails += fail("filter", "non-filter sentence taken as a command");
+    }
+
+    // ── Longest rule list fits the reply ─────────────────────────────────────
+    {
+        SentenceFilter f;
+        std::string rules;
+        for (int i = 0; i < FILTER_MAX_RULES; i++) {
+            char rule[FILTER_RULE_TEXT_MAX + 1];
+            snprintf(rule, sizeof(rule), ",PGRME%c%c*/99.9", 'A' + i / 10, '0' + i % 10);
+            rules += rule;
+        }
+        std::string cmd  = "$PMAR,FILTER" + rules;
+        std::string body = "PMAR,OK,FILTER" + rules;
+        char reply[FILTER_REPLY_MAX];   // As TCPServer sizes it
+        f.command(cmd.c_str(), cmd.size(), reply, sizeof(reply));
+        // Length first: an unformatted reply and an unformatted check are both ""
+        if (f.rules() != FILTER_MAX_RULES || strlen(reply) != body.size() + 6 || !validReply(reply, body.c_str()))
+            fails += fail("filter", "%u longest rules: reply %s", FILTER_MAX_RULES, reply);
+    }
+
+    std::vector<std::string> lines, ais;
+    loadLines(options().mixedCorpus, lines);
+    loadLines(options().aisCorpus, ais);
+    if (lines.empty() || ais.empty()) return fails + fail("filter", "no corpus lines");
+
+    // ── Whitelist and rates on the mixed corpus ──────────────────────────────
+    {
+        char reply[FILTER_REPLY_MAX];
+        SentenceFilter white, rated;
+        const char* w = "$PMAR,FILTER,RMC,GPGGA";
+        const char* r = "$PMAR,FILTER,RMC,*/1";
+        white.command(w, strlen(w), reply, sizeof(reply));
+        rated.command(r, strlen(r), reply, sizeof(reply));
+
+        std::map<std::string, uint32_t> seen, passWhite, passRated;
+        uint32_t wrong = 0;
+        const uint32_t spanMs = (uint32_t)(lines.size() * 5);   // 200 sentences/s
+        for (size_t i = 0; i < lines.size(); i++) {
+            SentenceKey k;
+            if (!k.parse(lines[i].data(), lines[i].size())) continue;
+            uint32_t now = (uint32_t)(i * 5);
+            std::string a = k.address;
+            seen[a]++;
+            if (white.accept(k, now)) {
+                passWhite[a]++;
+                bool ok = (a.size() == 5 && a.compare(2, 3, "RMC") == 0) || a == "GPGGA";
+                if (!ok) wrong++;
+            }
+            if (rated.accept(k, now)) passRated[a]++;
+        }
+        uint32_t missed = 0, overRate = 0;
+        for (std::map<std::string, uint32_t>::iterator it = seen.begin(); it != seen.end(); ++it) {
+            const std::string& a = it->first;
+            bool listed = (a.size() == 5 && a.compare(2, 3, "RMC") == 0) || a == "GPGGA";
+            if (listed && passWhite[a] != it->second) missed++;
+            bool isRMC = a.size() == 5 && a.compare(2, 3, "RMC") == 0;
+            uint32_t limit = isRMC ? it->second : spanMs / 1000 + 1;
+            // Multi-part AIS follows its first fragment, so allow one per fragment count
+            if (!isRMC && a.compare(2, 3, "VDM") == 0) limit *= 9;
+            if (passRated[a] > limit) overRate++;
+        }
+        printf("  whitelist RMC,GPGGA: %zu of %zu addresses pass; */1 over %.1f s: ",
+               passWhite.size(), seen.size(), spanMs / 1000.0);
+        uint32_t shown = 0;
+        for (std::map<std::string, uint32_t>::iterator it = passRated.begin(); it != passRated.end() && shown < 4; ++it, shown++)
+            printf("%s %u/%u  ", it->first.c_str(), it->second, seen[it->first]);
+        printf("\n");
+        if (wrong)    fails += fail("filter", "%u unlisted sentences passed the whitelist", wrong);
+        if (missed)   fails += fail("filter", "%u listed addresses lost sentences", missed);
+        if (overRate) fails += fail("filter", "%u addresses exceeded 1 Hz", overRate);
+    }
+
+    // ── AIS: rate limits never split a message ───────────────────────────────
+    {
+        char reply[FILTER_REPLY_MAX];
+        SentenceFilter f;
+        const char* cmd = "$PMAR,FILTER,VDM/2";
+        f.command(cmd, strlen(cmd), reply, sizeof(reply));
+
+        uint32_t passed = 0, orphans = 0, incomplete = 0;
+        uint8_t  expectNext = 0;
+        for (size_t i = 0; i < ais.size(); i++) {
+            SentenceKey k;
+            if (!k.parse(ais[i].data(), ais[i].size())) continue;
+            if (!f.accept(k, (uint32_t)(i * 10))) continue;      // 100 sentences/s
+            passed++;
+            if (k.fragments > 1) {
+                if (k.fragment == 1) {
+                    if (expectNext) incomplete++;
+                    expectNext = k.fragments > 1 ? 2 : 0;
+                } else if (k.fragment != expectNext) {
+                    orphans++;
+                } else {
+                    expectNext = k.fragment < k.fragments ? k.fragment + 1 : 0;
+                }
+            } else if (expectNext) {
+                incomplete++;
+                expectNext = 0;
+            }
+        }
+        printf("  VDM/2 over %zu AIS sentences: %u passed, %u orphan fragments, %u incomplete messages\n",
+               ais.size(), passed, orphans, incomplete);
+        if (orphans || incomplete) fails += fail("filter", "rate limit split multi-part AIS messages");
+        if (passed == 0 || passed > ais.size() / 10) fails += fail("filter", "VDM/2 passed %u", passed);
+    }
+
+    // ── AIS: interleaved messages each follow their own first fragment ───────
+    {
+        char reply[FILTER_REPLY_MAX];
+        SentenceFilter f;
+        const char* cmd = "$PMAR,FILTER,VDM/1";
+        f.command(cmd, strlen(cmd), reply, sizeof(reply));
+
+        // Type 5 on channels A and B, parts interleaved: B starts within the second, so all of it is dropped
+        static const char* const kParts[] = {
+            "!AIVDM,2,1,3,A,55?MbV02;H;s<HtKR20EHE:0@T4@Dn2222222216L961O5Gf0NSQEp6ClRp8,0*1C",
+            "!AIVDM,2,1,4,B,55NBjP01mtGIL@CW;SM<D60P5Ld000000000000P0`<3557l0<50@kk@K5h@,0*5B",
+            "!AIVDM,2,2,3,A,88888888880,2*25",
+            "!AIVDM,2,2,4,B,00000000000,2*3B",
+        };
+        static const bool kExpect[] = { true, false, true, false };
+        for (size_t i = 0; i < 4; i++) {
+            SentenceKey k;
+            k.parse(kParts[i], strlen(kParts[i]));
+            if (f.accept(k, 100) != kExpect[i])
+                fails += fail("filter", "interleaved AIS part %zu %s", i + 1, kExpect[i] ? "dropped" : "passed");
+        }
+    }
+
+    // ── Cost per broadcast: one parse, five clients ──────────────────────────
+    {
+        char reply[FILTER_REPLY_MAX];
+        SentenceFilter clients[5];
+        static const char* const kCommands[5] = {
+            "$PMAR,FILTER",                                       // everything
+            "$PMAR,FILTER,RMC,GGA,VTG,HDG,MWV,DPT,VHW,XDR",
+            "$PMAR,FILTER,AI*/5,*",
+            "$PMAR,FILTER,RMC/1,MWV/2,*/10",
+            "$PMAR,FILTER,GPRMC,GPGGA,IIMWV,IIVHW,IIDPT,VDM/1",
+        };
+        for (int c = 0; c < 5; c++) clients[c].command(kCommands[c], strlen(kCommands[c]), reply, sizeof(reply));
+
+        const int iters = options().iterations * 5;
+        const uint64_t items = (uint64_t)lines.size() * iters;
+        uint64_t sent = 0;
+        Result r = measure(items, [&]() {
+            for (int it = 0; it < iters; it++) {
+                for (size_t i = 0; i < lines.size(); i++) {
+                    SentenceKey k;
+                    if (!k.parse(lines[i].data(), lines[i].size())) continue;
+                    uint32_t now = (uint32_t)((it * lines.size() + i) * 5);
+                    for (int c = 0; c < 5; c++) {
+                        if (!clients[c].active() || clients[c].accept(k, now)) sent++;
+                    }
+                }
+            }
+        });
+        keep(sent);
+        report("key parse + 5 client filters", r);
+        printf("  %.1f %% of client copies avoided\n", 100.0 - 100.0 * sent / (5.0 * items));
+    }
+
+    return fails;
+}
@@ -0,0 +1,228 @@
+/**
+ * @file bench_framer.cpp
+ * @brief NMEALineFramer: byte-stream fuzzer and UART ingestion throughput.
+ *
+ * The fuzzer mangles the mixed corpus (noise bytes, lost LFs, bare CRs,
+ * overlong runs, stray start characters) and feeds it in random block
+ * sizes; the sentences and counters must match a byte-at-a-time
+ * reference framer fed the same stream in one go.
+ *
+ * Throughput replays the corpus as the UART driver would deliver it at
+ * 115200 and 460800 baud — one block per '\n' (pattern event) or per RX
+ * FIFO threshold (120 bytes), whichever comes first — and compares with
+ * the old reader, which pulled each byte through a kernel queue.
+ */
+
+#include "bench.h"
+#include "nmea_framer.h"
+#include <freertos/queue.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace bench;
+
+namespace {
+
+// Deterministic LCG so runs are comparable
+uint32_t rng(uint32_t& s) {
+    s = s * 1664525u + 1013904223u;
+    return s >> 8;
+}
+
+struct Collected {
+    std::vector<std::string> lines;
+};
+
+void collect(char* line, size_t len, void* ctx) {
+    static_cast<Collected*>(ctx)->lines.push_back(std::string(line, len));
+}
+
+void count(char* line, size_t len, void* ctx) {
+    *static_cast<size_t*>(ctx) += len;
+}
+
+/** Byte-at-a-time model of the framing rules documented in nmea_framer.h. */
+struct ReferenceFramer {
+    std::vector<std::string> lines;
+    uint32_t overlong, noise;
+    std::string cur;
+    bool inSentence, dirty;
+
+    ReferenceFramer() : overlong(0), noise(0), inSentence(false), dirty(false) {}
+
+    void feed(const std::string& s) {
+        for (size_t i = 0; i < s.size(); i++) {
+            char c = s[i];
+            if (c == '$' || c == '!') {
+                cur.assign(1, c);
+                inSentence = true;
+                dirty = false;
+            } else if (c == '\n') {
+                if (inSentence) {
+                    std::string l = cur;
+                    if (!l.empty() && l[l.size() - 1] == '\r') l.erase(l.size() - 1);
+                    if (l.size() > NMEA_MAX_LENGTH - 1) overlong++;
+                    else lines.push_back(l);
+                } else if (dirty) {
+                    noise++;
+                }
+                cur.clear();
+                inSentence = dirty = false;
+            } else if (inSentence) {
+                cur += c;
+            } else if (c != '\r') {
+                dirty = true;
+            }
+        }
+    }
+};
+
+std::string mangle(const std::vector<std::string>& lines, uint32_t& seed) {
+    static const char kNoise[] = "ABC,*\r01\xff\x00$!";
+    std::string s;
+    for (size_t i = 0; i < lines.size(); i++) {
+        std::string l = lines[i];
+        switch (rng(seed) % 16) {
+            case 0:  l.insert(rng(seed) % (l.size() + 1), 1, kNoise[rng(seed) % (sizeof(kNoise) - 1)]); break;
+            case 1:  s += l; s += "\r"; continue;                          // LF lost
+            case 2:  l = l.substr(rng(seed) % l.size()); break;            // head lost
+            case 3:  l += std::string(40 + rng(seed) % 120, 'X'); break;   // overlong
+            case 4:  s += "garbage"; break;                                // noise before
+            case 5:  s += "\r\n"; break;                                   // blank line
+            default: break;
+        }
+        s += l;
+        s += (rng(seed) & 1) ? "\r\n" : "\n";
+    }
+    return s;
+}
+
+/** Split @p stream as the UART driver would deliver it: at each LF or every @p fifo bytes. */
+void driverBlocks(const std::string& stream, size_t fifo, std::vector<size_t>& cuts) {
+    size_t last = 0;
+    for (size_t i = 0; i < stream.size(); i++) {
+        if (stream[i] == '\n' || i + 1 - last == fifo) {
+            cuts.push_back(i + 1);
+            last = i + 1;
+        }
+    }
+    if (last != stream.size()) cuts.push_back(stream.size());
+}
+
+} // namespace
+
+BENCH_SECTION(framer) {
+    int fails = 0;
+
+    std::vector<std::string> lines;
+    if (!loadLines(options().mixedCorpus, lines)) return fail("framer", "corpus missing");
+
+    // ── Fuzzer: random mangling, random block boundaries ────────────────────
+    uint32_t seed = 4242;
+    const int rounds = 20;
+    uint64_t fuzzLines = 0;
+    for (int round = 0; round < rounds; round++) {
+        std::string stream = mangle(lines, seed);
+
+        ReferenceFramer ref;
+        ref.feed(stream);
+
+        Collected got;
+        NMEALineFramer framer(collect, &got);
+        std::vector<char> buf(stream.begin(), stream.end());
+        size_t pos = 0;
+        while (pos < buf.size()) {
+            size_t n = 1 + rng(seed) % (round < rounds / 2 ? 300 : 8);
+            if (n > buf.size() - pos) n = buf.size() - pos;
+            framer.feed(&buf[pos], n);
+            pos += n;
+        }
+        fuzzLines += got.lines.size();
+
+        if (got.lines != ref.lines || framer.overlong() != ref.overlong || framer.noise() != ref.noise) {
+            size_t k = 0;
+            while (k < got.lines.size() && k < ref.lines.size() && got.lines[k] == ref.lines[k]) k++;
+            fails += fail("framer", "round %d: %zu/%zu lines, overlong %u/%u, noise %u/%u, first diff at %zu: \"%s\"",
+                          round, got.lines.size(), ref.lines.size(), framer.overlong(), ref.overlong,
+                          framer.noise(), ref.noise, k,
+                          k < got.lines.size() ? got.lines[k].c_str() : "(none)");
+            break;
+        }
+        for (size_t k = 0; k < got.lines.size(); k++) {
+            const std::string& l = got.lines[k];
+            // Stray CRs / NULs inside a sentence are left for the checksum to reject
+            if ((l[0] != '$' && l[0] != '!') || l.find('\n') != std::string::npos) {
+                fails += fail("framer", "malformed sentence emitted: \"%s\"", l.c_str());
+                break;
+            }
+        }
+    }
+    printf("  fuzzer: %d mangled streams, %llu sentences, framing identical to the reference\n",
+           rounds, (unsigned long long)fuzzLines);
+
+    // ── Throughput as delivered by the driver ───────────────────────────────
+    std::string stream;
+    for (size_t i = 0; i < lines.size(); i++) stream += lines[i] + "\r\n";
+    std::vector<size_t> cuts;
+    driverBlocks(stream, 120, cuts);
+
+    const int iters = options().iterations * 5;
+    std::vector<char> buf(stream.begin(), stream.end());
+    size_t bytes = 0;
+    NMEALineFramer framer(count, &bytes);
+    Result r = measure((uint64_t)stream.size() * iters, [&]() {
+        for (int it = 0; it < iters; it++) {
+            // Each pass frames in place, overwriting CR/LF: start from a clean copy
+            memcpy(&buf[0], stream.data(), stream.size());
+            size_t from = 0;
+            for (size_t c = 0; c < cuts.size(); c++) {
+                framer.feed(&buf[from], cuts[c] - from);
+                from = cuts[c];
+            }
+        }
+    });
+    keep(bytes);
+    report("framer, driver-sized blocks", r, "byte");
+    double nsPerByte = (double)r.ns / (double)r.items;
+
+    if (framer.lines() != lines.size() * (uint64_t)iters)
+        fails += fail("framer", "framed %u sentences, expected %zu", framer.lines(), lines.size() * iters);
+
+    // Old reader: one queue receive (kernel call) per byte
+    QueueHandle_t q = xQueueCreate(UART_BUFFER_SIZE, 1);
+    const int legacyIters = options().iterations;
+    uint64_t legacyLines = 0;
+    Result lr = measure((uint64_t)stream.size() * legacyIters, [&]() {
+        char line[NMEA_MAX_LENGTH];
+        size_t pos = 0;
+        for (int it = 0; it < legacyIters; it++) {
+            size_t sent = 0;
+            while (sent < stream.size()) {
+                size_t chunk = stream.size() - sent < 128 ? stream.size() - sent : 128;
+                for (size_t k = 0; k < chunk; k++) xQueueSend(q, &stream[sent + k], 0);
+                sent += chunk;
+                uint8_t b;
+                while (xQueueReceive(q, &b, 0) == pdTRUE) {
+                    if (b == '$' || b == '!') pos = 0;
+                    if (pos < sizeof(line) - 1) line[pos++] = (char)b;
+                    if (b == '\n') { legacyLines++; pos = 0; }
+                }
+            }
+        }
+    });
+    vQueueDelete(q);
+    keep(legacyLines);
+    report("byte-at-a-time via kernel queue", lr, "byte");
+
+    static const unsigned kBauds[] = { 115200, 460800 };
+    for (size_t i = 0; i < sizeof(kBauds) / sizeof(kBauds[0]); i++) {
+        double bytesPerSec = kBauds[i] / 10.0;        // 8N1
+        printf("  %6u baud: %8.0f B/s → framer %.4f%% of a core, old reader %.3f%%\n",
+               kBauds[i], bytesPerSec, nsPerByte * bytesPerSec / 1e7,
+               (double)lr.ns / (double)lr.items * bytesPerSec / 1e7);
+    }
+
+    return fails;
+}
@@ -0,0 +1,277 @@
+/**
+ * @file bench_json.cpp
+ * @brief JsonWriter / JsonStream: the streamed /api/boat/state document.
+ *
+ * The state is loaded from both corpora (the AIS one fills the target
+ * table) and the document is streamed in chunks of several sizes, as
+ * AsyncTCP asks for them: every split must give the same bytes, the bytes
+ * must be well-formed JSON, and streaming must not allocate whatever the
+ * number of targets.  Writer escaping and separators are checked on a
+ * small document; a part larger than JSON_STREAM_PART_MAX must stop the
+ * stream rather than emit a cut part.  When targets time out and the table
+ * compacts half-way through the list, every target still present must be
+ * listed exactly once.
+ */
+
+#include "bench.h"
+#include "json_writer.h"
+#include "boat_state.h"
+#include "nmea_parser.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace bench;
+
+namespace {
+
+// ── Minimal validator: enough to catch a missing comma or bracket ─────────────
+
+struct Validator {
+    const char* p;
+    const char* end;
+
+    void ws() { while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) p++; }
+    bool lit(const char* s) {
+        size_t n = strlen(s);
+        if ((size_t)(end - p) < n || memcmp(p, s, n) != 0) return false;
+        p += n;
+        return true;
+    }
+    bool str() {
+        if (p >= end || *p != '"') return false;
+        for (p++; p < end; p++) {
+            if (*p == '\\') { p++; continue; }
+            if (*p == '"') { p++; return true; }
+            if ((unsigned char)*p < 0x20) return false;
+        }
+        return false;
+    }
+    bool num() {
+        const char* s = p;
+        if (p < end && *p == '-') p++;
+        while (p < end && (isdigit((unsigned char)*p) || *p == '.' || *p == 'e' || *p == 'E' || *p == '+' || *p == '-')) p++;
+        return p > s;
+    }
+    bool value() {
+        ws();
+        if (p >= end) return false;
+        bool ok;
+        if (*p == '{') {
+            p++; ws();
+            if (p < end && *p == '}') { p++; return true; }
+            do {
+                ws();
+                if (!str()) return false;
+                ws();
+                if (p >= end || *p++ != ':') return false;
+                if (!value()) return false;
+                ws();
+            } while (p < end && *p == ',' && ++p);
+            ok = p < end && *p++ == '}';
+        } else if (*p == '[') {
+            p++; ws();
+            if (p < end && *p == ']') { p++; return true; }
+            do {
+                if (!value()) return false;
+                ws();
+            } while (p < end && *p == ',' && ++p);
+            ok = p < end && *p++ == ']';
+        } else if (*p == '"') {
+            ok = str();
+        } else if (*p == 't') {
+            ok = lit("true");
+        } else if (*p == 'f') {
+            ok = lit("false");
+        } else if (*p == 'n') {
+            ok = lit("null");
+        } else {
+            ok = num();
+        }
+        return ok;
+    }
+};
+
+bool validJson(const std::string& s) {
+    Validator v = { s.data(), s.data() + s.size() };
+    if (!v.value()) return false;
+    v.ws();
+    return v.p == v.end;
+}
+
+std::string streamAll(JsonProducer fn, void* ctx, size_t chunk, bool* failed = nullptr) {
+    JsonStream stream(fn, ctx);
+    std::string out;
+    std::vector<uint8_t> buf(chunk);
+    size_t n;
+    while ((n = stream.read(buf.data(), chunk)) > 0) out.append((const char*)buf.data(), n);
+    if (failed) *failed = stream.failed();
+    return out;
+}
+
+/** MMSIs of the "mmsi": fields of @p doc, in order. */
+std::vector<uint32_t> listedMMSIs(const std::string& doc) {
+    std::vector<uint32_t> out;
+    for (size_t at = 0; (at = doc.find("\"mmsi\":", at)) != std::string::npos; at += 7) {
+        out.push_back((uint32_t)strtoul(doc.c_str() + at + 7, nullptr, 10));
+    }
+    return out;
+}
+
+bool writeSmall(JsonWriter& w, uint32_t part, void*) {
+    if (part == 0) {
+        w.beginObject();
+        w.add("name", "a \"quoted\"\\name\n");
+        w.add("nan", NAN);
+        w.add("pi", 3.14159265358979);
+        w.add("f", 6.2f);
+        w.add("n", -42);
+        w.addNull("none");
+        w.beginArray("list");
+        return true;
+    }
+    if (part <= 3) {
+        w.value((unsigned)part);
+        return true;
+    }
+    w.endArray();
+    w.beginObject("empty").endObject();
+    w.add("ok", true);
+    w.endObject();
+    return false;
+}
+
+bool writeOversized(JsonWriter& w, uint32_t part, void*) {
+    if (part == 0) {
+        w.beginArray();
+        w.value("first");
+        return true;
+    }
+    std::string big(JSON_STREAM_PART_MAX, 'x');
+    w.value(big.c_str());
+    return true;
+}
+
+} // namespace
+
+BENCH_SECTION(json_stream) {
+    int fails = 0;
+
+    // ── Writer ───────────────────────────────────────────────────────────────
+    {
+        const char* expected =
+            "{\"name\":\"a \\\"quoted\\\"\\\\name\\u000a\",\"nan\":null,\"pi\":3.141592654,\"f\":6.2,"
+            "\"n\":-42,\"none\":null,\"list\":[1,2,3],\"empty\":{},\"ok\":true}";
+        std::string got = streamAll(writeSmall, nullptr, 5);
+        if (got != expected) fails += fail("json_stream", "small document:\n    got      %s\n    expected %s",
+                                           got.c_str(), expected);
+        if (!validJson(got)) fails += fail("json_stream", "small document not valid JSON");
+
+        bool failed = false;
+        got = streamAll(writeOversized, nullptr, 64, &failed);
+        if (!failed) fails += fail("json_stream", "oversized part not reported");
+        if (got != "[\"first\"") fails += fail("json_stream", "oversized part sent: %.40s...", got.c_str());
+    }
+
+    // ── State document ───────────────────────────────────────────────────────
+    BoatState state;
+    state.init();
+    NMEAParser parser(&state);
+    NMEASentence out;
+    std::vector<std::string> lines;
+    loadLines(options().mixedCorpus, lines);
+    loadLines(options().aisCorpus, lines);
+    if (lines.empty()) return fails + fail("json_stream", "no corpus lines");
+    for (size_t i = 0; i < lines.size(); i++) parser.parseLine(lines[i].c_str(), out);
+
+    // Ages are computed from millis() as each part is written
+    hostFreezeMillis(true);
+    bool failed = false;
+    BoatState::JsonContext doc(&state);
+    std::string whole = streamAll(BoatState::writeJSON, &doc, 1 << 20, &failed);
+    printf("  /api/boat/state: %zu bytes, %u AIS targets\n", whole.size(), state.getAISCount());
+    if (failed) fails += fail("json_stream", "a state part overflowed JSON_STREAM_PART_MAX");
+    if (!validJson(whole)) fails += fail("json_stream", "state document not valid JSON: %.200s", whole.c_str());
+    if (state.getAISCount() == 0) fails += fail("json_stream", "no AIS target loaded");
+    if (whole.find("\"targets\":[{\"mmsi\":") == std::string::npos) fails += fail("json_stream", "targets missing");
+
+    const size_t chunks[] = { 1, 7, 64, 536, 1436 };
+    for (size_t c = 0; c < sizeof(chunks) / sizeof(chunks[0]); c++) {
+        BoatState::JsonContext chunked(&state);
+        if (streamAll(BoatState::writeJSON, &chunked, chunks[c]) != whole)
+            fails += fail("json_stream", "%zu-byte chunks give a different document", chunks[c]);
+    }
+    hostFreezeMillis(false);
+
+    // ── Cost: no allocation while streaming, whatever the document size ──────
+    const int n = 50 * options().iterations;
+    uint8_t chunk[1436];
+    size_t total = 0;
+    std::vector<BoatState::JsonContext> docs(n, BoatState::JsonContext(&state));
+    JsonStream* streams = (JsonStream*)malloc(sizeof(JsonStream) * n);
+    for (int k = 0; k < n; k++) new (&streams[k]) JsonStream(BoatState::writeJSON, &docs[k]);
+    Result r = measure((uint64_t)n, [&]() {
+        for (int k = 0; k < n; k++) {
+            size_t got;
+            while ((got = streams[k].read(chunk, sizeof(chunk))) > 0) total += got;
+        }
+    });
+    free(streams);
+    keep(total);
+    report("stream /api/boat/state", r, "document");
+    printf("  %.1f MB/s, JsonStream %zu bytes per response\n",
+           r.ns ? (double)total * 1000.0 / r.ns : 0.0, sizeof(JsonStream));
+    if (r.allocs) fails += fail("json_stream", "%llu allocations streaming %d documents", (unsigned long long)r.allocs, n);
+
+    // ── Targets timing out while the list streams ────────────────────────────
+    hostFreezeMillis(true);
+    {
+        std::vector<uint32_t> before = listedMMSIs(whole);
+        BoatState::JsonContext live(&state);
+        JsonStream stream(BoatState::writeJSON, &live);
+        std::string out;
+        uint8_t buf[256];
+        size_t got;
+        bool mutated = false;
+        std::set<uint32_t> kept;
+        while ((got = stream.read(buf, sizeof(buf))) > 0) {
+            out.append((const char*)buf, got);
+            if (mutated || listedMMSIs(out).size() < 4) continue;
+
+            // Every other target heard again, the rest time out: removals
+            // move the last slots into the holes behind the stream
+            hostAdvanceMillis(DATA_TIMEOUT_AIS + 1000);
+            {
+                BoatState::Writer w(state);
+                for (size_t i = 0; i < before.size(); i += 2) {
+                    AISTarget t;
+                    t.mmsi      = before[i];
+                    t.timestamp = millis();
+                    w.addOrUpdateAISTarget(t);
+                    kept.insert(before[i]);
+                }
+            }
+            state.cleanupStaleData();
+            mutated = true;
+        }
+        std::vector<uint32_t> listed = listedMMSIs(out);
+        std::set<uint32_t> seen(listed.begin(), listed.end());
+        uint32_t missing = 0;
+        for (std::set<uint32_t>::const_iterator it = kept.begin(); it != kept.end(); ++it) {
+            if (!seen.count(*it)) missing++;
+        }
+        printf("  AIS list across a compaction: %zu listed, %zu kept, %u kept ones missing, %zu duplicates\n",
+               listed.size(), kept.size(), missing, listed.size() - seen.size());
+        if (!mutated) fails += fail("json_stream", "table never compacted during the stream");
+        if (seen.size() != listed.size()) fails += fail("json_stream", "a target listed twice");
+        if (missing) fails += fail("json_stream", "%u targets still present were skipped", missing);
+        if (!validJson(out)) fails += fail("json_stream", "document cut by the compaction not valid JSON");
+    }
+    hostFreezeMillis(false);
+
+    return fails;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file bench_main.cpp
+ * @brief nmea_bench entry point: option parsing, corpus loading, reporting.
+ *
+ * Usage:
+ *   nmea_bench [-n iterations] [-f section] [--mixed file] [--ais file]
+ *
+ * Corpora default to host/bench/data/{mixed,ais}.nmea, regenerated with
+ * host/bench/data/gen_corpus.py.
+ */
+
+#include "bench.h"
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+
+#ifndef BENCH_DATA_DIR
+#define BENCH_DATA_DIR "bench/data"
+#endif
+
+namespace bench {
+
+// ── Registry ─────────────────────────────────────────────────────────────────
+
+struct Section {
+    const char* name;
+    SectionFn   fn;
+};
+
+static std::vector<Section>& sections() {
+    static std::vector<Section> s;
+    return s;
+}
+
+Registrar::Registrar(const char* name, SectionFn fn) {
+    Section s = { name, fn };
+    sections().push_back(s);
+}
+
+static Options g_options;
+
+const Options& options() { return g_options; }
+
+// ── Corpus ───────────────────────────────────────────────────────────────────
+
+std::string dataPath(const char* file) {
+    return std::string(BENCH_DATA_DIR) + "/" + file;
+}
+
+bool loadLines(const std::string& path, std::vector<std::string>& out) {
+    std::ifstream in(path.c_str());
+    if (!in) {
+        fprintf(stderr, "[Bench] ❌ Cannot open corpus %s\n", path.c_str());
+        return false;
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        while (!line.empty() && (line.back() == '\r' || line.back() == '\n')) line.pop_back();
+        if (!line.empty()) out.push_back(line);
+    }
+    return true;
+}
+
+// ── Reporting ────────────────────────────────────────────────────────────────
+
+void report(const char* name, const Result& r, const char* unit) {
+    double n = r.items ? (double)r.items : 1.0;
+    double perSec = r.ns ? (double)r.items * 1e9 / (double)r.ns : 0.0;
+    char cyc[32];
+    if (r.cycles) snprintf(cyc, sizeof(cyc), "%8.1f", (double)r.cycles / n);
+    else          snprintf(cyc, sizeof(cyc), "%8s", "n/a");
+
+    printf("  %-40s %12.0f %s/s  %8.1f ns  %s cyc  %6.2f allocs  %7.1f B   /%s\n",
+           name, perSec, unit, (double)r.ns / n, cyc,
+           (double)r.allocs / n, (double)r.bytes / n, unit);
+}
+
+int fail(const char* section, const char* fmt, ...) {
+    printf("  ❌ [%s] ", section);
+    va_list args;
+    va_start(args, fmt);
+    vprintf(fmt, args);
+    va_end(args);
+    printf("\n");
+    return 1;
+}
+
+} // namespace bench
+
+// ── main ─────────────────────────────────────────────────────────────────────
+
+static void usage(const char* argv0) {
+    printf("Usage: %s [-n iterations] [-f section] [--mixed file] [--ais file]\n", argv0);
+}
+
+int main(int argc, char** argv) {
+    using namespace bench;
+
+    g_options.iterations  = 20;
+    g_options.mixedCorpus = dataPath("mixed.nmea");
+    g_options.aisCorpus   = dataPath("ais.nmea");
+
+    for (int i = 1; i < argc; i++) {
+        const char* a = argv[i];
+        bool hasNext = i + 1 < argc;
+        if (!strcmp(a, "-n") && hasNext)           g_options.iterations  = atoi(argv[++i]);
+        else if (!strcmp(a, "-f") && hasNext)      g_options.filter      = argv[++i];
+        else if (!strcmp(a, "--mixed") && hasNext) g_options.mixedCorpus = argv[++i];
+        else if (!strcmp(a, "--ais") && hasNext)   g_options.aisCorpus   = argv[++i];
+        else { usage(argv[0]); return 2; }
+    }
+    if (g_options.iterations < 1) g_options.iterations = 1;
+
+    printf("nmea_bench — %d iteration(s) per case\n", g_options.iterations);
+
+    int failures = 0;
+    for (size_t i = 0; i < sections().size(); i++) {
+        const Section& s = sections()[i];
+        if (!g_options.filter.empty() && !strstr(s.name, g_options.filter.c_str())) continue;
+        printf("\n── %s ──\n", s.name);
+        failures += s.fn();
+    }
+
+    if (failures) {
+        printf("\n❌ %d self-check(s) failed\n", failures);
+        return 1;
+    }
+    printf("\n✓ all self-checks passed\n");
+    return 0;
+}
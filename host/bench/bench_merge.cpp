@@ -0,0 +1,237 @@
+/**
+ * @file bench_merge.cpp
+ * @brief NMEAMerger: arrival-order merge of several input ports.
+ *
+ * A simulated 38400 baud instrument bus and a 4800 baud GPS feed push
+ * time-stamped sentences (starting just before the micros() wrap) while the
+ * merge task drains every few milliseconds; each drain must come out in
+ * arrival order, each port in FIFO order, and nothing may be lost.  A
+ * stalled consumer must only cost the chatty port sentences.  Then two
+ * real producer threads race a consumer thread, and the per-line cost of
+ * push + front + pop is measured.  Every test must hand all pool buffers
+ * back.
+ */
+
+#include "bench.h"
+#include "nmea_merge.h"
+#include "sentence_pool.h"
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+
+using namespace bench;
+
+namespace {
+
+// Sentence text carries its source and sequence number for the checks
+size_t makeLine(char* buf, size_t size, unsigned src, unsigned seq) {
+    return (size_t)snprintf(buf, size, "$IIXDR,P,%u,S,%u*00", src, seq);
+}
+
+bool parseLine(const SentenceBuf& b, unsigned& src, unsigned& seq) {
+    return sscanf(b.raw, "$IIXDR,P,%u,S,%u*", &src, &seq) == 2;
+}
+
+bool push(SentencePool& pool, NMEAMerger& merger, unsigned src, unsigned seq, uint32_t arrivalUs) {
+    char text[NMEA_MAX_LENGTH];
+    size_t n = makeLine(text, sizeof(text), src, seq);
+    return merger.push((uint8_t)src, pool.acquire(text, n, (uint8_t)src, arrivalUs));
+}
+
+int leaked(const SentencePool& pool, const char* test) {
+    if (pool.available() == pool.capacity()) return 0;
+    return fail("merge", "%s: %u pool buffers not returned", test,
+                (unsigned)(pool.capacity() - pool.available()));
+}
+
+struct Port {
+    uint32_t periodUs;   // One ~80 byte sentence at the port's baud rate
+    uint32_t nextUs;
+    unsigned seq;
+};
+
+} // namespace
+
+BENCH_SECTION(merge) {
+    int fails = 0;
+
+    // ── Simulated ports, periodic drain ──────────────────────────────────────
+    {
+        SentencePool pool;
+        pool.begin();
+        NMEAMerger merger(pool);
+        // 80 bytes at 3840 B/s and 480 B/s; start ~2 s before the uint32 wrap
+        const uint32_t start = 0xFFFFFFFFu - 2000000u;
+        Port ports[2] = { { 20833, start, 0 }, { 166666, start + 7, 0 } };
+        unsigned expectSeq[2] = { 0, 0 };
+        unsigned out = 0, orderErrors = 0, fifoErrors = 0, badText = 0;
+
+        uint32_t now = start;
+        for (int step = 0; step < 2000; step++) {
+            now += 5000;   // merge task wakes every 5 ms
+            for (unsigned p = 0; p < 2; p++) {
+                while ((int32_t)(now - ports[p].nextUs) >= 0) {
+                    push(pool, merger, p, ports[p].seq++, ports[p].nextUs);
+                    ports[p].nextUs += ports[p].periodUs;
+                }
+            }
+
+            bool     first = true;
+            uint32_t last  = 0;
+            SentenceRef ref;
+            while ((ref = merger.front()) != SENTENCE_NONE) {
+                const SentenceBuf& l = pool.at(ref);
+                unsigned src, seq;
+                if (!parseLine(l, src, seq) || src != l.source || src > 1) {
+                    badText++;
+                } else {
+                    if (seq != expectSeq[src]) fifoErrors++;
+                    expectSeq[src] = seq + 1;
+                }
+                if (!first && (int32_t)(l.arrivalUs - last) < 0) orderErrors++;
+                last  = l.arrivalUs;
+                first = false;
+                out++;
+                merger.pop();
+            }
+        }
+
+        printf("  %-34s %10u lines  port0 %u / port1 %u, dropped %u / %u\n",
+               "simulated 38400 + 4800 baud", out, merger.merged(0), merger.merged(1),
+               merger.dropped(0), merger.dropped(1));
+
+        if (badText)     fails += fail("merge", "%u lines came out corrupted", badText);
+        if (orderErrors) fails += fail("merge", "%u lines out of arrival order", orderErrors);
+        if (fifoErrors)  fails += fail("merge", "%u per-port FIFO violations", fifoErrors);
+        if (merger.dropped(0) || merger.dropped(1))
+            fails += fail("merge", "lost sentences although the consumer kept up");
+        if (out != ports[0].seq + ports[1].seq)
+            fails += fail("merge", "merged %u of %u sentences", out, ports[0].seq + ports[1].seq);
+        fails += leaked(pool, "simulated ports");
+    }
+
+    // ── Ties alternate between sources ───────────────────────────────────────
+    {
+        SentencePool pool;
+        pool.begin();
+        NMEAMerger merger(pool);
+        for (unsigned i = 0; i < 4; i++) {
+            for (unsigned p = 0; p < 2; p++) {
+                push(pool, merger, p, i, 1000);
+            }
+        }
+        unsigned prev = 2, repeats = 0;
+        SentenceRef ref;
+        while ((ref = merger.front()) != SENTENCE_NONE) {
+            if (pool.at(ref).source == prev) repeats++;
+            prev = pool.at(ref).source;
+            merger.pop();
+        }
+        if (repeats) fails += fail("merge", "equal timestamps not served round-robin (%u repeats)", repeats);
+        fails += leaked(pool, "ties");
+    }
+
+    // ── Stalled consumer: only the chatty port loses sentences ──────────────
+    {
+        SentencePool pool;
+        pool.begin();
+        NMEAMerger merger(pool);
+        uint32_t t = 0;
+        for (unsigned i = 0; i < NMEA_MERGE_DEPTH * 3; i++) {
+            push(pool, merger, 0, i, t += 100);
+            if (i % 8 == 0) push(pool, merger, 1, i / 8, t += 1);
+        }
+        printf("  %-34s dropped port0 %u, port1 %u (depth %u)\n", "stalled consumer",
+               merger.dropped(0), merger.dropped(1), (unsigned)NMEA_MERGE_DEPTH);
+        if (merger.dropped(0) != NMEA_MERGE_DEPTH * 2)
+            fails += fail("merge", "chatty port dropped %u, expected %u",
+                          merger.dropped(0), (unsigned)NMEA_MERGE_DEPTH * 2);
+        if (merger.dropped(1))
+            fails += fail("merge", "quiet port dropped %u sentences", merger.dropped(1));
+        while (merger.front() != SENTENCE_NONE) merger.pop();
+        fails += leaked(pool, "stalled consumer");
+    }
+
+    // ── Threads: two producers, one consumer ─────────────────────────────────
+    {
+        SentencePool pool;
+        pool.begin();
+        NMEAMerger merger(pool);
+        const unsigned perPort = 20000u * options().iterations;
+        std::atomic<int> producing(2);
+        unsigned expectSeq[2] = { 0, 0 };
+        unsigned fifoErrors = 0, badText = 0, out = 0;
+
+        std::vector<std::thread> threads;
+        for (unsigned p = 0; p < 2; p++) {
+            threads.push_back(std::thread([&, p]() {
+                for (unsigned i = 0; i < perPort; i++) {
+                    // Port 1 is the slow GPS: leave gaps so it rarely fills up
+                    if (p == 1 && (i & 3) == 0) std::this_thread::yield();
+                    push(pool, merger, p, i, (uint32_t)(nowNs() / 1000));
+                }
+                producing--;
+            }));
+        }
+
+        for (;;) {
+            bool done = producing.load() == 0;
+            SentenceRef ref;
+            while ((ref = merger.front()) != SENTENCE_NONE) {
+                const SentenceBuf& l = pool.at(ref);
+                unsigned src, seq;
+                if (!parseLine(l, src, seq) || src != l.source || src > 1) {
+                    badText++;
+                } else {
+                    // Dropped sentences leave gaps, never reorderings
+                    if (seq < expectSeq[src]) fifoErrors++;
+                    expectSeq[src] = seq + 1;
+                }
+                out++;
+                merger.pop();
+            }
+            if (done) break;
+            std::this_thread::yield();
+        }
+        for (size_t i = 0; i < threads.size(); i++) threads[i].join();
+
+        printf("  %-34s %10u lines  dropped %u / %u\n", "2 producer threads", out,
+               merger.dropped(0), merger.dropped(1));
+
+        if (badText)    fails += fail("merge", "%u torn lines across threads", badText);
+        if (fifoErrors) fails += fail("merge", "%u per-port reorderings across threads", fifoErrors);
+        unsigned accounted = out + merger.dropped(0) + merger.dropped(1);
+        if (accounted != perPort * 2)
+            fails += fail("merge", "%u of %u sentences unaccounted for", perPort * 2 - accounted, perPort * 2);
+        fails += leaked(pool, "producer threads");
+    }
+
+    // ── Cost per line ────────────────────────────────────────────────────────
+    {
+        SentencePool pool;
+        pool.begin();
+        NMEAMerger merger(pool);
+        char line[NMEA_MAX_LENGTH];
+        size_t len = makeLine(line, sizeof(line), 0, 12345);
+        const uint64_t lines = 400000ull * options().iterations;
+        uint64_t sum = 0;
+        Result r = measure(lines, [&]() {
+            uint32_t t = 0;
+            for (uint64_t i = 0; i < lines; i += 2) {
+                merger.push(0, pool.acquire(line, len, 0, t += 3));
+                merger.push(1, pool.acquire(line, len, 1, t += 5));
+                for (int k = 0; k < 2; k++) {
+                    sum += pool.at(merger.front()).len;
+                    merger.pop();
+                }
+            }
+        });
+        keep(sum);
+        report("acquire + push + front + pop, 2 ports", r, "line");
+        fails += leaked(pool, "cost loop");
+    }
+
+    return fails;
+}
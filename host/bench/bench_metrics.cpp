@@ -0,0 +1,233 @@
+/**
+ * @file bench_metrics.cpp
+ * @brief MetricsRegistry: OpenMetrics output checks and the cost of a scrape.
+ *
+ * The registry is filled the way setup() does it (parser, pool, merger,
+ * pipeline stats) after the corpus has gone through them, then rendered.
+ * The text must be valid OpenMetrics as far as a scraper cares — one TYPE
+ * per family, counters suffixed _total, cumulative histogram buckets whose
+ * +Inf bucket equals _count, "# EOF" last — and rendering it in chunks of
+ * any size the TCP stack may offer must produce the same bytes as a single
+ * render, without touching the heap.
+ */
+
+#include "bench.h"
+#include "metrics.h"
+#include "pipeline_stats.h"
+#include "sentence_pool.h"
+#include "nmea_merge.h"
+#include "nmea_parser.h"
+#include "boat_state.h"
+#include <algorithm>
+#include <map>
+#include <set>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace bench;
+
+namespace {
+
+// Deterministic LCG so runs are comparable
+uint32_t rng(uint32_t& s) {
+    s = s * 1664525u + 1013904223u;
+    return s >> 8;
+}
+
+std::string renderAll(const MetricsRegistry& reg, size_t chunk) {
+    std::vector<char> buf(chunk);
+    std::string out;
+    MetricsCursor cursor;
+    size_t n;
+    int guard = 0;
+    while ((n = reg.render(cursor, buf.data(), chunk)) > 0 && guard++ < 100000) out.append(buf.data(), n);
+    return out;
+}
+
+/** Sample name without labels: `foo_total{a="b"} 3` → `foo_total`. */
+std::string sampleName(const std::string& line) {
+    size_t end = line.find_first_of("{ ");
+    return line.substr(0, end);
+}
+
+/** Number of format errors in an exposition. */
+int checkExposition(const std::string& text) {
+    int errors = 0;
+    std::set<std::string> typed;
+    std::map<std::string, std::string> typeOf;
+    std::string family;
+    std::string lastSeries;
+    long long   lastBucket = -1;
+    std::map<std::string, long long> infBucket;
+
+    size_t pos = 0;
+    std::string line, last;
+    while (pos < text.size()) {
+        size_t nl = text.find('\n', pos);
+        if (nl == std::string::npos) {
+            printf("    unterminated last line\n");
+            return errors + 1;
+        }
+        line = text.substr(pos, nl - pos);
+        pos  = nl + 1;
+        last = line;
+
+        if (line.compare(0, 7, "# TYPE ") == 0) {
+            char name[96], type[16];
+            if (sscanf(line.c_str(), "# TYPE %95s %15s", name, type) != 2) { errors++; continue; }
+            if (!typed.insert(name).second) {
+                printf("    family %s typed twice (not contiguous)\n", name);
+                errors++;
+            }
+            family = name;
+            typeOf[family] = type;
+            continue;
+        }
+        if (line[0] == '#') continue;
+
+        std::string name = sampleName(line);
+        if (family.empty() || name.compare(0, family.size(), family) != 0) {
+            printf("    sample %s outside its family (%s)\n", name.c_str(), family.c_str());
+            errors++;
+            continue;
+        }
+        std::string suffix = name.substr(family.size());
+        const std::string& type = typeOf[family];
+        if (type == "counter" && suffix != "_total") {
+            printf("    counter sample %s lacks _total\n", name.c_str());
+            errors++;
+        }
+        if (type == "gauge" && !suffix.empty()) errors++;
+
+        long long value = atoll(line.c_str() + line.rfind(' ') + 1);
+        if (type == "histogram") {
+            // Series = labels minus le
+            size_t lb = line.find('{'), rb = line.find('}');
+            std::string labels = lb == std::string::npos ? "" : line.substr(lb, rb - lb);
+            size_t le = labels.find("le=\"");
+            if (le != std::string::npos) labels.erase(le > 1 ? le - 1 : le);
+            std::string series = family + labels;
+
+            if (suffix == "_bucket") {
+                if (series != lastSeries) lastBucket = -1;
+                if (value < lastBucket) {
+                    printf("    %s buckets not cumulative\n", series.c_str());
+                    errors++;
+                }
+                lastBucket = value;
+                lastSeries = series;
+                if (line.find("le=\"+Inf\"") != std::string::npos) infBucket[series] = value;
+            } else if (suffix == "_count") {
+                if (!infBucket.count(series) || infBucket[series] != value) {
+                    printf("    %s _count %lld != +Inf bucket\n", series.c_str(), value);
+                    errors++;
+                }
+            } else if (suffix != "_sum") {
+                errors++;
+            }
+        }
+    }
+    if (last != "# EOF") {
+        printf("    exposition does not end with # EOF\n");
+        errors++;
+    }
+    return errors;
+}
+
+volatile uint32_t s_plainA = 7, s_plainB = 11, s_plainC = 13;
+
+} // namespace
+
+BENCH_SECTION(metrics) {
+    int fails = 0;
+
+    // ── Families stay contiguous whatever the registration order ─────────────
+    {
+        MetricsRegistry reg;
+        reg.addCounter("espnav_a", "A", &s_plainA, "port=\"0\"");
+        reg.addGauge("espnav_b", "B", &s_plainB);
+        reg.addCounter("espnav_a", "A", &s_plainC, "port=\"1\"");
+        std::string text = renderAll(reg, 4096);
+        const char* expected =
+            "# TYPE espnav_a counter\n"
+            "# HELP espnav_a A\n"
+            "espnav_a_total{port=\"0\"} 7\n"
+            "espnav_a_total{port=\"1\"} 13\n"
+            "# TYPE espnav_b gauge\n"
+            "# HELP espnav_b B\n"
+            "espnav_b 11\n"
+            "# EOF\n";
+        if (text != expected) fails += fail("metrics", "interleaved families rendered as:\n%s", text.c_str());
+    }
+
+    // ── Gateway registry after a corpus run ──────────────────────────────────
+    std::vector<std::string> lines;
+    loadLines(options().mixedCorpus, lines);
+    if (lines.empty()) return fails + fail("metrics", "no corpus lines");
+
+    BoatState state;
+    state.init();
+    NMEAParser    parser(&state);
+    SentencePool  pool;
+    pool.begin();
+    NMEAMerger    merger(pool);
+    PipelineStats stats;
+
+    uint32_t seed = 5;
+    for (size_t i = 0; i < lines.size(); i++) {
+        uint8_t port = (uint8_t)(i & 1);
+        merger.push(port, pool.acquire(lines[i].data(), lines[i].size(), port, 0));
+        SentenceRef ref = merger.front();
+        if (!parser.parseLine(pool.text(ref))) stats.recordDrop(DROP_CHECKSUM);
+        merger.pop();
+        for (int s = 0; s < STAGE_COUNT; s++) stats.recordLatency((PipelineStage)s, rng(seed) >> (rng(seed) % 24));
+    }
+
+    MetricsRegistry reg;
+    reg.addCounter("espnav_nmea_queue_overflows", "Parsed sentences dropped on a full nmeaQueue", &s_plainA);
+    merger.registerMetrics(reg, 2);
+    pool.registerMetrics(reg);
+    parser.registerMetrics(reg);
+    stats.registerMetrics(reg);
+    printf("  %u metrics registered (max %u)\n", reg.size(), METRICS_MAX);
+
+    std::string whole = renderAll(reg, 1 << 16);
+    int errors = checkExposition(whole);
+    if (errors) fails += fail("metrics", "%d OpenMetrics format errors", errors);
+    if (whole.find("espnav_nmea_sentences_total{result=\"valid\"} " + std::to_string(parser.getValidSentences()) + "\n")
+        == std::string::npos)
+        fails += fail("metrics", "valid sentence counter missing or wrong");
+
+    // ── Chunked render is byte-identical ─────────────────────────────────────
+    static const size_t kChunks[] = { METRICS_LINE_MAX, 257, 536, 1436, 4096 };
+    for (size_t i = 0; i < sizeof(kChunks) / sizeof(kChunks[0]); i++) {
+        if (renderAll(reg, kChunks[i]) != whole)
+            fails += fail("metrics", "render in %zu-byte chunks differs from a single render", kChunks[i]);
+    }
+    // Chunks smaller than a line skip it rather than stall
+    std::string tiny = renderAll(reg, 24);
+    if (tiny.size() < 6 || tiny.compare(tiny.size() - 6, 6, "# EOF\n") != 0)
+        fails += fail("metrics", "render in 24-byte chunks did not terminate with # EOF");
+
+    // ── Cost of a scrape ─────────────────────────────────────────────────────
+    const int iters = options().iterations * 20;
+    char chunk[1436];
+    uint64_t bytes = 0;
+    Result r = measure((uint64_t)iters, [&]() {
+        for (int it = 0; it < iters; it++) {
+            MetricsCursor cursor;
+            size_t n;
+            while ((n = reg.render(cursor, chunk, sizeof(chunk))) > 0) bytes += n;
+        }
+    });
+    keep(bytes);
+    report("scrape, 1436-byte chunks", r, "scrape");
+    printf("  exposition: %zu bytes, %zu lines\n", whole.size(),
+           (size_t)std::count(whole.begin(), whole.end(), '\n'));
+    if (r.allocs) fails += fail("metrics", "render allocated %llu times", (unsigned long long)r.allocs);
+
+    return fails;
+}
@@ -0,0 +1,211 @@
+/**
+ * @file bench_numeric.cpp
+ * @brief nmea_number.h against the C library it replaced.
+ *
+ * Exactness: every numeric field of the mixed corpus plus a seeded random
+ * set is parsed both ways; NMEADecimal::toDouble() must equal strtod()
+ * bit for bit and nmeaParseFloat() must equal strtof().  Coordinates are
+ * checked against a long-double reference and compared with the legacy
+ * atof-to-float conversion.
+ */
+
+#include "bench.h"
+#include "nmea_number.h"
+#include "nmea_parser.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <random>
+
+using namespace bench;
+
+static bool isDecimalField(const NMEAField& f) {
+    if (f.len == 0 || f.len > 15) return false;
+    bool digit = false;
+    for (uint8_t i = 0; i < f.len; i++) {
+        char c = f.ptr[i];
+        if (c >= '0' && c <= '9') digit = true;
+        else if (c != '.' && !(i == 0 && c == '-')) return false;
+    }
+    return digit;
+}
+
+struct Coord {
+    std::string text;
+    char        hemi;
+};
+
+static void collect(std::vector<std::string>& numbers, std::vector<Coord>& coords) {
+    std::vector<std::string> lines;
+    loadLines(options().mixedCorpus, lines);
+
+    for (size_t i = 0; i < lines.size(); i++) {
+        NMEAFields f;
+        NMEAParser::tokenize(lines[i].c_str(), f);
+        for (uint8_t k = 1; k < f.count; k++) {
+            if (isDecimalField(f[k])) numbers.push_back(std::string(f[k].ptr, f[k].len));
+        }
+        // $xxGGA lat=2/3 lon=4/5, $xxRMC 3/4 5/6, $xxGLL 1/2 3/4
+        int latIdx = 0;
+        if (f[0].len == 5 && !memcmp(f[0].ptr + 2, "GGA", 3)) latIdx = 2;
+        if (f[0].len == 5 && !memcmp(f[0].ptr + 2, "RMC", 3)) latIdx = 3;
+        if (f[0].len == 5 && !memcmp(f[0].ptr + 2, "GLL", 3)) latIdx = 1;
+        if (latIdx) {
+            for (int j = 0; j < 2; j++) {
+                Coord c = { std::string(f[latIdx + 2 * j].ptr, f[latIdx + 2 * j].len),
+                            f[latIdx + 2 * j + 1].first() };
+                coords.push_back(c);
+            }
+        }
+    }
+
+    // Seeded random decimals: 1–9 significant digits, 0–7 fraction digits
+    std::mt19937 rng(0x4E4D4541);
+    char buf[32];
+    for (int i = 0; i < 200000; i++) {
+        int digits = 1 + rng() % 9;
+        int frac   = rng() % 8;
+        if (frac > digits) frac = digits;
+        uint32_t m = rng() % 1000000000u;
+        uint32_t lim = 1;
+        for (int d = 0; d < digits; d++) lim *= 10;
+        m %= lim;
+        int n = snprintf(buf, sizeof(buf), "%s%0*u", (rng() & 7) == 0 ? "-" : "", frac + 1, m);
+        if (frac > 0) {
+            memmove(buf + n - frac + 1, buf + n - frac, frac + 1);
+            buf[n - frac] = '.';
+        }
+        numbers.push_back(buf);
+    }
+}
+
+/** Reference coordinate in 1e-7 degrees, computed in long double. */
+static long double referenceE7(const std::string& s, char hemi) {
+    size_t point = s.find('.');
+    long double deg = strtold(s.substr(0, point - 2).c_str(), nullptr);
+    long double min = strtold(s.substr(point - 2).c_str(), nullptr);
+    long double v = (deg + min / 60.0L) * 1e7L;
+    return (hemi == 'S' || hemi == 'W') ? -v : v;
+}
+
+/** The float conversion nmea_parser.cpp used before nmea_number.h. */
+static float legacyCoord(const std::string& s, char hemi) {
+    size_t point = s.find('.');
+    std::string d = s.substr(0, point - 2);
+    float r = atof(d.c_str()) + atof(s.c_str() + point - 2) / 60.0;
+    return (hemi == 'S' || hemi == 'W') ? -r : r;
+}
+
+BENCH_SECTION(numeric) {
+    std::vector<std::string> numbers;
+    std::vector<Coord> coords;
+    collect(numbers, coords);
+    int fails = 0;
+
+    // ── Exactness ──────────────────────────────────────────────────────────
+    size_t badDouble = 0, badFloat = 0;
+    for (size_t i = 0; i < numbers.size(); i++) {
+        const std::string& s = numbers[i];
+        NMEADecimal d;
+        float f;
+        if (!nmeaParseDecimal(s.c_str(), s.size(), d) || !nmeaParseFloat(s.c_str(), s.size(), f)) {
+            fails += fail("numeric", "rejected '%s'", s.c_str());
+            continue;
+        }
+        double ref = strtod(s.c_str(), nullptr);
+        if (d.toDouble() != ref) {
+            if (badDouble++ < 3) fails += fail("numeric", "'%s': %.17g != strtod %.17g",
+                                                s.c_str(), d.toDouble(), ref);
+        }
+        if (f != strtof(s.c_str(), nullptr)) {
+            if (badFloat++ < 3) fails += fail("numeric", "'%s': %.9g != strtof %.9g",
+                                               s.c_str(), f, strtof(s.c_str(), nullptr));
+        }
+    }
+    printf("  exactness: %zu values, %zu double / %zu float mismatches\n",
+           numbers.size(), badDouble, badFloat);
+
+    long double maxErrE7 = 0, maxErrLegacy = 0;
+    for (size_t i = 0; i < coords.size(); i++) {
+        int32_t e7;
+        if (!nmeaParseCoordE7(coords[i].text.c_str(), coords[i].text.size(), coords[i].hemi, e7)) {
+            fails += fail("numeric", "coordinate '%s' rejected", coords[i].text.c_str());
+            continue;
+        }
+        long double ref = referenceE7(coords[i].text, coords[i].hemi);
+        long double err = fabsl((long double)e7 - ref);
+        long double errLegacy = fabsl((long double)legacyCoord(coords[i].text, coords[i].hemi) * 1e7L - ref);
+        if (err > maxErrE7) maxErrE7 = err;
+        if (errLegacy > maxErrLegacy) maxErrLegacy = errLegacy;
+    }
+    // 1e-7° = 6e-6 minute; print in 1e-5 minute (the NMEA resolution)
+    printf("  coordinates: %zu, max error E7 %.3Lf / legacy float %.3Lf (1e-5 min)\n",
+           coords.size(), maxErrE7 * 0.6L, maxErrLegacy * 0.6L);
+    if (maxErrE7 > 0.5L) fails += fail("numeric", "E7 coordinate error %.3Lf > 0.5e-7 deg", maxErrE7);
+
+    // ── Throughput ─────────────────────────────────────────────────────────
+    const int iters = options().iterations;
+    const uint64_t n = (uint64_t)numbers.size() * iters;
+    float sum = 0;
+
+    Result r = measure(n, [&]() {
+        for (int it = 0; it < iters; it++)
+            for (size_t i = 0; i < numbers.size(); i++) sum += atof(numbers[i].c_str());
+    });
+    report("atof", r, "field");
+
+    r = measure(n, [&]() {
+        float v;
+        for (int it = 0; it < iters; it++)
+            for (size_t i = 0; i < numbers.size(); i++) {
+                nmeaParseFloat(numbers[i].c_str(), numbers[i].size(), v);
+                sum += v;
+            }
+    });
+    report("nmeaParseFloat", r, "field");
+
+    const uint64_t nc = (uint64_t)coords.size() * iters * 20;
+    r = measure(nc, [&]() {
+        for (int it = 0; it < iters * 20; it++)
+            for (size_t i = 0; i < coords.size(); i++) sum += legacyCoord(coords[i].text, coords[i].hemi);
+    });
+    report("legacy atof coordinate", r, "coord");
+
+    int64_t acc = 0;
+    r = measure(nc, [&]() {
+        int32_t e7;
+        for (int it = 0; it < iters * 20; it++)
+            for (size_t i = 0; i < coords.size(); i++) {
+                nmeaParseCoordE7(coords[i].text.c_str(), coords[i].text.size(), coords[i].hemi, e7);
+                acc += e7;
+            }
+    });
+    report("nmeaParseCoordE7", r, "coord");
+
+    static const char* hex[] = { "5D", "0a", "FF", "3c", "00", "7E", "b4", "C9" };
+    const uint64_t nh = 1000000ull * iters;
+    unsigned hsum = 0;
+    r = measure(nh, [&]() {
+        for (uint64_t i = 0; i < nh; i++) {
+            uint8_t v = 0;
+            sscanf(hex[i & 7], "%02hhx", &v);
+            hsum += v;
+        }
+    });
+    report("sscanf %02hhx", r, "byte");
+
+    r = measure(nh, [&]() {
+        for (uint64_t i = 0; i < nh; i++) {
+            uint8_t v = 0;
+            nmeaParseHexByte(hex[i & 7], v);
+            hsum += v;
+        }
+    });
+    report("nmeaParseHexByte", r, "byte");
+
+    keep(sum);
+    keep(acc);
+    keep(hsum);
+    return fails;
+}
@@ -0,0 +1,135 @@
+/**
+ * @file bench_parser.cpp
+ * @brief NMEAParser::parseLine replay over the recorded corpora.
+ *
+ * Reports sentences/s, ns and cycles per sentence and heap allocations per
+ * sentence.  The self-check compares the parser's valid/invalid counters
+ * with an independent checksum pass over the same corpus.
+ */
+
+#include "bench.h"
+#include "nmea_parser.h"
+#include "boat_state.h"
+#include <freertos/semphr.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+using namespace bench;
+
+/** Reference checksum validator, deliberately independent of the parser. */
+static bool referenceValid(const std::string& s) {
+    if (s.empty() || (s[0] != '$' && s[0] != '!')) return false;
+    size_t star = s.find('*');
+    if (star == std::string::npos || star > 80 || star + 3 > s.size()) return false;
+    uint8_t cs = 0;
+    for (size_t i = 1; i < star; i++) cs ^= (uint8_t)s[i];
+    return strtoul(s.substr(star + 1, 2).c_str(), nullptr, 16) == cs;
+}
+
+static int replay(const char* name, const std::string& path, bool withState) {
+    std::vector<std::string> lines;
+    if (!loadLines(path, lines)) return fail(name, "corpus missing");
+
+    uint64_t expectedValid = 0;
+    for (size_t i = 0; i < lines.size(); i++) expectedValid += referenceValid(lines[i]);
+
+    BoatState state;
+    state.init();
+    NMEAParser parser(withState ? &state : nullptr);
+    NMEASentence out;
+
+    // Warm-up pass populates the AIS table and the branch predictors
+    for (size_t i = 0; i < lines.size(); i++) parser.parseLine(lines[i].c_str(), out);
+
+    const int iters = options().iterations;
+    uint64_t locks0 = hostSemaphoreTakeCount();
+    Result r = measure((uint64_t)lines.size() * iters, [&]() {
+        for (int it = 0; it < iters; it++) {
+            for (size_t i = 0; i < lines.size(); i++) {
+                parser.parseLine(lines[i].c_str(), out);
+            }
+        }
+    });
+    keep(out);
+
+    char label[64];
+    snprintf(label, sizeof(label), "%s (%zu lines)", name, lines.size());
+    report(label, r);
+    if (withState) {
+        printf("  %-40s %12.2f mutex takes/sentence\n", "",
+               (double)(hostSemaphoreTakeCount() - locks0) / (double)r.items);
+    }
+
+    int fails = 0;
+    uint64_t passes = (uint64_t)iters + 1;
+    if (parser.getValidSentences() != expectedValid * passes) {
+        fails += fail(name, "valid sentences %u, expected %llu", parser.getValidSentences(),
+                      (unsigned long long)(expectedValid * passes));
+    }
+    if (parser.getInvalidSentences() != (lines.size() - expectedValid) * passes) {
+        fails += fail(name, "invalid sentences %u, expected %llu", parser.getInvalidSentences(),
+                      (unsigned long long)((lines.size() - expectedValid) * passes));
+    }
+    return fails;
+}
+
+BENCH_SECTION(parse_mixed) {
+    int fails = replay("parseLine mixed", options().mixedCorpus, true);
+    fails    += replay("parseLine mixed, no state", options().mixedCorpus, false);
+    return fails;
+}
+
+BENCH_SECTION(parse_ais) {
+    int fails = replay("parseLine AIS", options().aisCorpus, true);
+
+    // Decoded targets must land in BoatState, names included
+    std::vector<std::string> lines;
+    loadLines(options().aisCorpus, lines);
+    BoatState state;
+    state.init();
+    NMEAParser parser(&state);
+    NMEASentence out;
+    for (size_t i = 0; i < lines.size(); i++) parser.parseLine(lines[i].c_str(), out);
+
+    std::vector<AISTarget> ais(state.getAISCapacity());
+    int count = state.getAISTargets(ais.data(), (int)ais.size());
+    int named = 0;
+    for (int i = 0; i < count; i++) named += ais[i].name[0] != '\0';
+    printf("  AIS table: %d targets, %d named\n", count, named);
+    if (count == 0)           fails += fail("parse_ais", "no AIS target decoded");
+    if (named == 0)           fails += fail("parse_ais", "no AIS target name decoded");
+    return fails;
+}
+
+// ── Dispatch ─────────────────────────────────────────────────────────────────
+
+static void countXDR(const NMEAFields& f, BoatState*, void* ctx) {
+    (*(int*)ctx)++;
+}
+
+BENCH_SECTION(dispatch) {
+    BoatState state;
+    state.init();
+    NMEAParser parser(&state);
+    NMEASentence out;
+    int fails = 0;
+
+    int xdrCalls = 0;
+    if (!parser.registerHandler("XDR", countXDR, &xdrCalls)) {
+        fails += fail("dispatch", "registerHandler(XDR) rejected");
+    }
+    parser.parseLine("$IIXDR,P,1.02481,B,Barometer*29", out);
+    parser.parseLine("$WIXDR,C,19.5,C,AirTemp*35", out);
+    parser.parseLine("$PGXDR,A,1,B,2*59", out);  // proprietary — not routed
+    if (xdrCalls != 2) fails += fail("dispatch", "custom XDR handler called %d times, expected 2", xdrCalls);
+
+    // Talker-agnostic: GN / IN talkers reach the GGA handler too
+    parser.parseLine("$INGGA,103000.00,4738.71800,N,00328.87200,W,1,09,0.9,12.3,M,47.0,M,,*5D", out);
+    GPSData gps = state.getGPS();
+    if (!gps.position.lat.valid || fabsf(gps.position.lat.value - 47.6453f) > 1e-3f) {
+        fails += fail("dispatch", "$INGGA not dispatched to GGA handler");
+    }
+    return fails;
+}
@@ -0,0 +1,190 @@
+/**
+ * @file bench_pipeline.cpp
+ * @brief PipelineStats: histogram accuracy and the cost of instrumenting.
+ *
+ * The histogram is checked against exact percentiles of a log-normal-ish
+ * latency sample (bucket bounds must contain every value and stay within
+ * the documented 12.5 %), the pool high-water mark is raised from several
+ * threads at once, as the UART RX and AsyncTCP tasks do, then the corpus is run through the host copy of
+ * the firmware path — pool, merger, parser, index ring — with and without
+ * recording, to show what the instrumentation itself costs per sentence.
+ */
+
+#include "bench.h"
+#include "pipeline_stats.h"
+#include "sentence_pool.h"
+#include "nmea_merge.h"
+#include "index_ring.h"
+#include "nmea_parser.h"
+#include "boat_state.h"
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace bench;
+
+namespace {
+
+// Deterministic LCG so runs are comparable
+uint32_t rng(uint32_t& s) {
+    s = s * 1664525u + 1013904223u;
+    return s >> 8;
+}
+
+} // namespace
+
+BENCH_SECTION(pipeline) {
+    int fails = 0;
+
+    // ── Bucket bounds ────────────────────────────────────────────────────────
+    {
+        uint32_t bad = 0, tooWide = 0;
+        uint32_t seed = 7;
+        for (int i = 0; i < 200000; i++) {
+            uint32_t v = (i < 70000) ? (uint32_t)i : rng(seed) >> (rng(seed) % 24);
+            uint16_t b = LatencyHistogram::bucketOf(v);
+            uint32_t upper = LatencyHistogram::bucketUpper(b);
+            uint32_t lower = b ? LatencyHistogram::bucketUpper(b - 1) + 1 : 0;
+            if (v < lower || v > upper) bad++;
+            if (b < LATENCY_BUCKETS - 1 && v >= LATENCY_LINEAR && upper - lower + 1 > lower / 8) tooWide++;
+        }
+        if (bad)     fails += fail("pipeline", "%u values outside their bucket bounds", bad);
+        if (tooWide) fails += fail("pipeline", "%u buckets wider than 12.5 %%", tooWide);
+    }
+
+    // ── Percentiles against an exact sort ────────────────────────────────────
+    {
+        LatencyHistogram h;
+        std::vector<uint32_t> sample;
+        uint32_t seed = 11;
+        for (int i = 0; i < 100000; i++) {
+            // Mostly tens of µs with a long tail into milliseconds
+            double u = (rng(seed) + 1) / 16777217.0;
+            uint32_t v = (uint32_t)(20.0 * exp(2.0 * sqrt(-log(u))) - 20.0);
+            sample.push_back(v);
+            h.record(v);
+        }
+        std::sort(sample.begin(), sample.end());
+
+        static const uint16_t kPermille[] = { 500, 900, 990, 999 };
+        for (size_t i = 0; i < sizeof(kPermille) / sizeof(kPermille[0]); i++) {
+            size_t   rank  = ((size_t)sample.size() * kPermille[i] + 999) / 1000;
+            uint32_t exact = sample[rank - 1];
+            uint32_t got   = h.percentile(kPermille[i]);
+            printf("  p%-5.1f exact %8u µs  histogram %8u µs\n", kPermille[i] / 10.0, exact, got);
+            if (got < exact || got > exact + exact / 8 + 1)
+                fails += fail("pipeline", "p%.1f = %u, exact %u", kPermille[i] / 10.0, got, exact);
+        }
+        if (h.max() != sample.back()) fails += fail("pipeline", "max %u, expected %u", h.max(), sample.back());
+        if (h.count() != sample.size()) fails += fail("pipeline", "count %u", h.count());
+    }
+
+    // ── High-water mark from several writers ─────────────────────────────────
+    {
+        PipelineStats shared;
+        const uint16_t kPeak = 60000;
+        std::vector<std::thread> threads;
+        for (uint32_t p = 0; p < 4; p++) {
+            threads.push_back(std::thread([&, p]() {
+                uint32_t seed = 17 + p;
+                for (int i = 0; i < 200000; i++) {
+                    uint16_t depth = (uint16_t)(rng(seed) % (kPeak - 8));
+                    if (i == 100000) depth = (uint16_t)(kPeak - p);
+                    shared.recordDepth(QUEUE_POOL, depth);
+                }
+            }));
+        }
+        for (size_t t = 0; t < threads.size(); t++) threads[t].join();
+        if (shared.highWater(QUEUE_POOL) != kPeak)
+            fails += fail("pipeline", "pool high-water %u after 4 writers, expected %u",
+                          shared.highWater(QUEUE_POOL), kPeak);
+    }
+
+    // ── Instrumentation overhead ─────────────────────────────────────────────
+    std::vector<std::string> lines;
+    loadLines(options().mixedCorpus, lines);
+    if (lines.empty()) return fails + fail("pipeline", "no corpus lines");
+
+    BoatState state;
+    state.init();
+    NMEAParser   parser(&state);
+    SentencePool pool;
+    pool.begin();
+    NMEAMerger   merger(pool);
+    static IndexRing<NMEA_QUEUE_SIZE> queue;
+    PipelineStats stats;
+
+    const int iters = options().iterations;
+    const uint64_t items = (uint64_t)lines.size() * iters;
+
+    for (int instrumented = 0; instrumented < 2; instrumented++) {
+        uint64_t sink = 0;
+        Result r = measure(items, [&]() {
+            for (int it = 0; it < iters; it++) {
+                for (size_t i = 0; i < lines.size(); i++) {
+                    // UART task
+                    uint8_t port = (uint8_t)(i & 1);
+                    SentenceRef ref = pool.acquire(lines[i].data(), lines[i].size(), port, micros());
+                    merger.push(port, ref);
+                    if (instrumented) {
+                        stats.recordDepth(QUEUE_POOL, pool.capacity() - pool.available());
+                        stats.recordDepth((PipelineQueue)(QUEUE_MERGE0 + port), merger.pending(port));
+                    }
+
+                    // Merge task
+                    ref = merger.front();
+                    SentenceBuf& buf = pool.at(ref);
+                    uint32_t start = instrumented ? micros() : 0;
+                    if (instrumented) stats.recordLatency(STAGE_MERGE_WAIT, start - buf.arrivalUs);
+                    bool valid = parser.parseLine(buf.raw);
+                    if (instrumented) {
+                        buf.queuedUs = micros();
+                        stats.recordLatency(STAGE_PARSE, buf.queuedUs - start);
+                    }
+                    if (valid) {
+                        pool.retain(ref);
+                        queue.push(ref);
+                        if (instrumented) stats.recordDepth(QUEUE_NMEA, queue.size());
+                    } else if (instrumented) {
+                        stats.recordDrop(DROP_CHECKSUM);
+                    }
+                    merger.pop();
+
+                    // Processor task
+                    if (queue.pop(ref)) {
+                        const SentenceBuf& b = pool.at(ref);
+                        if (instrumented) {
+                            uint32_t t0 = micros();
+                            stats.recordLatency(STAGE_QUEUE_WAIT, t0 - b.queuedUs);
+                            sink += (uint8_t)b.raw[1];
+                            uint32_t t1 = micros();
+                            stats.recordLatency(STAGE_FANOUT_TCP, t1 - t0);
+                            stats.recordLatency(STAGE_FANOUT_WS, 0);
+                            stats.recordLatency(STAGE_END_TO_END, t1 - b.arrivalUs);
+                        } else {
+                            sink += (uint8_t)b.raw[1];
+                        }
+                        pool.release(ref);
+                    }
+                }
+            }
+        });
+        keep(sink);
+        report(instrumented ? "pipeline, instrumented" : "pipeline, bare", r);
+    }
+
+    const LatencyHistogram& e2e = stats.stage(STAGE_END_TO_END);
+    printf("  host end-to-end: p50 %u µs, p99 %u µs, max %u µs over %u sentences; %u checksum drops\n",
+           e2e.percentile(500), e2e.percentile(990), e2e.max(), e2e.count(),
+           stats.dropped(DROP_CHECKSUM));
+    if (stats.stage(STAGE_PARSE).count() != items)
+        fails += fail("pipeline", "parse stage saw %u of %llu sentences",
+                      stats.stage(STAGE_PARSE).count(), (unsigned long long)items);
+    if (pool.available() != pool.capacity())
+        fails += fail("pipeline", "%u pool buffers leaked", (unsigned)(pool.capacity() - pool.available()));
+
+    return fails;
+}
@@ -0,0 +1,227 @@
+/**
+ * @file bench_pool.cpp
+ * @brief SentencePool + IndexRing: concurrency checks and per-sentence cost.
+ *
+ * The MPMC stress pushes every value exactly once from two producer
+ * threads and pops from two consumers; each must come out exactly once.
+ * The pool stress mirrors the firmware: producers acquire a buffer, hand
+ * one reference to the "processor" and one to the "logger" thread, and
+ * every buffer must be back in the pool at the end with its text intact
+ * while it was held.
+ *
+ * The cost comparison replays the corpus through the old by-value path
+ * (NMEASentence through a kernel queue plus a 120-byte LogEntry copy) and
+ * through the reference path (one pool copy, 2-byte refs through a ring and
+ * a 4-byte log entry through a kernel queue).
+ */
+
+#include "bench.h"
+#include "sentence_pool.h"
+#include "index_ring.h"
+#include "types.h"
+#include <freertos/queue.h>
+#include <atomic>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace bench;
+
+namespace {
+
+// Layout of the logger queue entries before and after the pool
+struct LegacyLogEntry {
+    uint8_t type;
+    char    data[120];
+};
+
+struct RefLogEntry {
+    uint8_t     type;
+    SentenceRef ref;
+};
+
+} // namespace
+
+BENCH_SECTION(pool) {
+    int fails = 0;
+
+    // ── IndexRing: 2 producers / 2 consumers ─────────────────────────────────
+    {
+        static IndexRing<64> ring;
+        // Values carry the producer in bit 15: at most 32768 per producer
+        const uint32_t perProducer = options().iterations > 1 ? 32768u : 30000u;
+        std::vector<std::atomic<uint8_t> > seen(2 * perProducer);
+        for (size_t i = 0; i < seen.size(); i++) seen[i].store(0);
+        std::atomic<uint32_t> popped(0);
+
+        std::vector<std::thread> threads;
+        for (uint32_t p = 0; p < 2; p++) {
+            threads.push_back(std::thread([&, p]() {
+                for (uint32_t i = 0; i < perProducer; i++) {
+                    uint16_t v = (uint16_t)((p << 15) | i);
+                    while (!ring.push(v)) std::this_thread::yield();
+                }
+            }));
+        }
+        for (int c = 0; c < 2; c++) {
+            threads.push_back(std::thread([&]() {
+                uint16_t v;
+                while (popped.load(std::memory_order_relaxed) < 2 * perProducer) {
+                    if (!ring.pop(v)) { std::this_thread::yield(); continue; }
+                    uint32_t idx = (v >> 15) * perProducer + (v & 0x7FFF);
+                    if (idx < seen.size()) seen[idx]++;
+                    popped++;
+                }
+            }));
+        }
+        for (size_t i = 0; i < threads.size(); i++) threads[i].join();
+
+        uint32_t missing = 0, dup = 0;
+        for (size_t i = 0; i < seen.size(); i++) {
+            if (seen[i] == 0) missing++;
+            if (seen[i] > 1)  dup++;
+        }
+        printf("  %-34s %10u values, %u missing, %u duplicated\n", "ring 2P/2C", popped.load(), missing, dup);
+        if (missing || dup) fails += fail("pool", "ring lost %u / duplicated %u values", missing, dup);
+    }
+
+    // ── Pool: shared references across threads ───────────────────────────────
+    {
+        SentencePool pool;
+        pool.begin();
+        static IndexRing<64> toProcessor;
+        static IndexRing<64> toLogger;
+        const uint32_t perProducer = 20000u * options().iterations;
+        std::atomic<int>      producing(2);
+        std::atomic<uint32_t> corrupt(0), consumed(0), dropped(0);
+
+        std::vector<std::thread> threads;
+        for (uint32_t p = 0; p < 2; p++) {
+            threads.push_back(std::thread([&, p]() {
+                char text[NMEA_MAX_LENGTH];
+                for (uint32_t i = 0; i < perProducer; i++) {
+                    int n = snprintf(text, sizeof(text), "$GPXXX,%u,%u*00", p, i);
+                    SentenceRef ref = pool.acquire(text, (size_t)n, (uint8_t)p, i);
+                    if (ref == SENTENCE_NONE) { dropped++; std::this_thread::yield(); continue; }
+
+                    // One reference per consumer, as mergeTask does.  Wait for
+                    // ring space so that the pool, not the rings, runs dry
+                    pool.retain(ref);
+                    while (!toLogger.push(ref))    std::this_thread::yield();
+                    while (!toProcessor.push(ref)) std::this_thread::yield();
+                }
+                producing--;
+            }));
+        }
+        IndexRing<64>* rings[2] = { &toProcessor, &toLogger };
+        for (int c = 0; c < 2; c++) {
+            threads.push_back(std::thread([&, c]() {
+                IndexRing<64>& in = *rings[c];
+                for (;;) {
+                    bool done = producing.load() == 0;
+                    SentenceRef ref;
+                    while (in.pop(ref)) {
+                        const SentenceBuf& b = pool.at(ref);
+                        unsigned src, seq;
+                        if (sscanf(b.raw, "$GPXXX,%u,%u*", &src, &seq) != 2 ||
+                            src != b.source || seq != b.arrivalUs) corrupt++;
+                        pool.release(ref);
+                        consumed++;
+                    }
+                    if (done) break;
+                    std::this_thread::yield();
+                }
+            }));
+        }
+        for (size_t i = 0; i < threads.size(); i++) threads[i].join();
+
+        printf("  %-34s %10u refs consumed, %u dropped, low water %u/%u, %u exhausted\n",
+               "pool 2 producers / 2 consumers", consumed.load(), dropped.load(),
+               pool.lowWater(), pool.capacity(), pool.exhausted());
+        if (corrupt) fails += fail("pool", "%u buffers overwritten while referenced", corrupt.load());
+        if (pool.available() != pool.capacity())
+            fails += fail("pool", "%u buffers never returned", (unsigned)(pool.capacity() - pool.available()));
+        if (!consumed) fails += fail("pool", "threads made no progress");
+    }
+
+    // ── Cost per sentence: by value vs by reference ──────────────────────────
+    {
+        std::vector<std::string> lines;
+        loadLines(options().mixedCorpus, lines);
+        if (lines.empty()) return fails + fail("pool", "no corpus lines");
+        const int iters = options().iterations * 5;
+        const uint64_t items = (uint64_t)lines.size() * iters;
+
+        // Old path: parseLine fills an NMEASentence, which is copied into and
+        // out of nmeaQueue; logNMEA copies the text into a LogEntry, which is
+        // copied into and out of the log queue
+        QueueHandle_t nmeaQ = xQueueCreate(64, sizeof(NMEASentence));
+        QueueHandle_t logQ  = xQueueCreate(128, sizeof(LegacyLogEntry));
+        uint64_t sink = 0;
+        Result byValue = measure(items, [&]() {
+            NMEASentence   in, out;
+            LegacyLogEntry le, lo;
+            for (int it = 0; it < iters; it++) {
+                for (size_t i = 0; i < lines.size(); i++) {
+                    strncpy(in.raw, lines[i].c_str(), sizeof(in.raw) - 1);
+                    in.raw[sizeof(in.raw) - 1] = '\0';
+                    le.type = 0;
+                    strncpy(le.data, lines[i].c_str(), sizeof(le.data) - 1);
+                    le.data[sizeof(le.data) - 1] = '\0';
+                    xQueueSend(logQ, &le, 0);
+                    xQueueSend(nmeaQ, &in, 0);
+                    xQueueReceive(nmeaQ, &out, 0);
+                    xQueueReceive(logQ, &lo, 0);
+                    sink += (uint8_t)out.raw[1] + (uint8_t)lo.data[1];
+                }
+            }
+        });
+        vQueueDelete(nmeaQ);
+        vQueueDelete(logQ);
+        keep(sink);
+        report("by value (NMEASentence + LogEntry)", byValue);
+
+        SentencePool pool;
+        pool.begin();
+        static IndexRing<64> ring;
+        logQ = xQueueCreate(128, sizeof(RefLogEntry));
+        Result byRef = measure(items, [&]() {
+            RefLogEntry le, lo;
+            for (int it = 0; it < iters; it++) {
+                for (size_t i = 0; i < lines.size(); i++) {
+                    SentenceRef ref = pool.acquire(lines[i].data(), lines[i].size(), 0, 0);
+                    pool.retain(ref);
+                    le.type = 0;
+                    le.ref  = ref;
+                    xQueueSend(logQ, &le, 0);
+                    ring.push(ref);
+                    SentenceRef r;
+                    ring.pop(r);
+                    sink += (uint8_t)pool.text(r)[1];
+                    pool.release(r);
+                    xQueueReceive(logQ, &lo, 0);
+                    sink += (uint8_t)pool.text(lo.ref)[1];
+                    pool.release(lo.ref);
+                }
+            }
+        });
+        vQueueDelete(logQ);
+        keep(sink);
+        report("by reference (pool + IndexRing)", byRef);
+
+        double avgLen = 0;
+        for (size_t i = 0; i < lines.size(); i++) avgLen += lines[i].size();
+        avgLen /= lines.size();
+        // Bytes written or read per sentence along each path
+        double oldBytes = 128 + 2.0 * sizeof(NMEASentence) + 120 + 2.0 * sizeof(LegacyLogEntry);
+        double newBytes = avgLen + 2.0 * sizeof(SentenceRef) + 2.0 * sizeof(RefLogEntry);
+        printf("  copied per sentence: %.0f B by value, %.0f B by reference (%.1fx less)\n",
+               oldBytes, newBytes, oldBytes / newBytes);
+        if (pool.available() != pool.capacity())
+            fails += fail("pool", "reference path leaked %u buffers", (unsigned)(pool.capacity() - pool.available()));
+    }
+
+    return fails;
+}
@@ -0,0 +1,104 @@
+/**
+ * @file bench_range.cpp
+ * @brief Range / If-Range parsing for /api/sd/download.
+ *
+ * Every form a download client sends (curl -C -, browsers resuming, the
+ * suffix form some players use) must resolve to the right bytes; a range
+ * past the end must be a 416, and anything malformed, reversed or
+ * multi-range must fall back to the whole file rather than an error.
+ * If-Range must only let the range through for the same version.
+ */
+
+#include "bench.h"
+#include "http_range.h"
+#include <stdio.h>
+
+using namespace bench;
+
+namespace {
+
+struct RangeCase {
+    const char*     header;
+    uint64_t        size;
+    HttpRangeResult result;
+    uint64_t        first;
+    uint64_t        last;
+};
+
+const RangeCase kRangeCases[] = {
+    { "bytes=0-499",            10000, HTTP_RANGE_OK,            0,    499 },
+    { "bytes=500-",             10000, HTTP_RANGE_OK,            500,  9999 },
+    { "bytes=9000-20000",       10000, HTTP_RANGE_OK,            9000, 9999 },
+    { "bytes=-500",             10000, HTTP_RANGE_OK,            9500, 9999 },
+    { "bytes=-20000",           10000, HTTP_RANGE_OK,            0,    9999 },
+    { "BYTES = 10 - 19 ",       10000, HTTP_RANGE_OK,            10,   19 },
+    { "bytes=9999-9999",        10000, HTTP_RANGE_OK,            9999, 9999 },
+    { "bytes=10000-",           10000, HTTP_RANGE_UNSATISFIABLE, 0,    0 },
+    { "bytes=0-",               0,     HTTP_RANGE_UNSATISFIABLE, 0,    0 },
+    { "bytes=-0",               10000, HTTP_RANGE_UNSATISFIABLE, 0,    0 },
+    { "bytes=-5",               0,     HTTP_RANGE_UNSATISFIABLE, 0,    0 },
+    { "bytes=500-499",          10000, HTTP_RANGE_NONE,          0,    0 },
+    { "bytes=0-1,5-9",          10000, HTTP_RANGE_NONE,          0,    0 },
+    { "bytes=-",                10000, HTTP_RANGE_NONE,          0,    0 },
+    { "bytes=abc-",             10000, HTTP_RANGE_NONE,          0,    0 },
+    { "bytes=1-2x",             10000, HTTP_RANGE_NONE,          0,    0 },
+    { "items=0-1",              10000, HTTP_RANGE_NONE,          0,    0 },
+    { "bytes=99999999999999999999-", 10000, HTTP_RANGE_NONE,     0,    0 },
+    { "",                       10000, HTTP_RANGE_NONE,          0,    0 },
+};
+
+const char* kETag         = "\"2710-65a1b2c3\"";
+const char* kLastModified = "Fri, 12 Jan 2024 18:04:51 GMT";
+
+} // namespace
+
+BENCH_SECTION(http_range) {
+    int fails = 0;
+
+    for (size_t i = 0; i < sizeof(kRangeCases) / sizeof(kRangeCases[0]); i++) {
+        const RangeCase& c = kRangeCases[i];
+        uint64_t first = 0, last = 0;
+        HttpRangeResult r = parseHttpRange(c.header, c.size, first, last);
+        if (r != c.result || (r == HTTP_RANGE_OK && (first != c.first || last != c.last))) {
+            fails += fail("http_range", "\"%s\" of %llu: got %d %llu-%llu, expected %d %llu-%llu", c.header,
+                          (unsigned long long)c.size, (int)r, (unsigned long long)first, (unsigned long long)last,
+                          (int)c.result, (unsigned long long)c.first, (unsigned long long)c.last);
+        }
+    }
+    uint64_t first, last;
+    if (parseHttpRange(nullptr, 10, first, last) != HTTP_RANGE_NONE) fails += fail("http_range", "no header");
+
+    // ── If-Range ─────────────────────────────────────────────────────────────
+    struct { const char* ifRange; const char* lastModified; bool match; } ifRanges[] = {
+        { "\"2710-65a1b2c3\"",                 kLastModified, true  },
+        { " \"2710-65a1b2c3\" ",               kLastModified, true  },
+        { "\"2800-65a1b2c3\"",                 kLastModified, false },   // Grew since
+        { "W/\"2710-65a1b2c3\"",               kLastModified, false },   // Weak: never
+        { "Fri, 12 Jan 2024 18:04:51 GMT",     kLastModified, true  },
+        { "Fri, 12 Jan 2024 18:04:52 GMT",     kLastModified, false },
+        { "Fri, 12 Jan 2024 18:04:51 GMT",     nullptr,       false },   // No clock when written
+    };
+    for (size_t i = 0; i < sizeof(ifRanges) / sizeof(ifRanges[0]); i++) {
+        if (httpIfRangeMatches(ifRanges[i].ifRange, kETag, ifRanges[i].lastModified) != ifRanges[i].match) {
+            fails += fail("http_range", "If-Range '%s' should %smatch", ifRanges[i].ifRange,
+                          ifRanges[i].match ? "" : "not ");
+        }
+    }
+
+    // ── Cost: once per download request, must not allocate ───────────────────
+    const int n = 1000 * options().iterations;
+    uint64_t sum = 0;
+    Result r = measure((uint64_t)n, [&]() {
+        for (int k = 0; k < n; k++) {
+            if (httpIfRangeMatches(kETag, kETag, kLastModified) &&
+                parseHttpRange("bytes=1048576-", 52428800, first, last) == HTTP_RANGE_OK) {
+                sum += first;
+            }
+        }
+    });
+    keep(sum);
+    report("If-Range + Range", r, "request");
+    if (r.allocs) fails += fail("http_range", "%llu allocations parsing %d headers", (unsigned long long)r.allocs, n);
+
+    return fails;
+}
@@ -0,0 +1,134 @@
+/**
+ * @file bench_route.cpp
+ * @brief NMEARouter: routing matrix and echo suppression as the processor task drives it.
+ *
+ * The corpus is routed at 10 sentences per simulated millisecond.  A
+ * TCP client and a device on UART0 that repeat everything they receive
+ * must have every repeat dropped, so nothing loops back out; a client that
+ * resends its own sentence must not be mistaken for an echo.  The cost of
+ * route() per sentence is measured with and without a guarded output.
+ */
+
+#include "bench.h"
+#include "nmea_router.h"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace bench;
+
+BENCH_SECTION(route) {
+    int fails = 0;
+
+    std::vector<std::string> lines;
+    loadLines(options().mixedCorpus, lines);
+    if (lines.empty()) return fails + fail("route", "no corpus lines");
+
+    const uint8_t everything = ROUTE_ALL;
+
+    // ── Defaults and the forced-off diagonal ─────────────────────────────────
+    {
+        NMEARouter r;
+        for (uint8_t s = 0; s < NMEA_PORT_MAX; s++) {
+            if (r.routes(s) != ROUTE_DEFAULT_UART) fails += fail("route", "uart%u default 0x%02X", s, r.routes(s));
+        }
+        if (r.routes(NMEA_SOURCE_TCP) != ROUTE_DEFAULT_TCP)
+            fails += fail("route", "tcp default 0x%02X", r.routes(NMEA_SOURCE_TCP));
+        r.setRoutes(1, 0xFF);
+        if (r.routes(1) & ROUTE_UART_TX(1)) fails += fail("route", "uart1 routed out of its own TX");
+        if (r.routes(1) != (ROUTE_ALL & ~ROUTE_UART_TX(1))) fails += fail("route", "uart1 routes 0x%02X", r.routes(1));
+        if (r.route("$GPXXX,1", 8, 0, NMEA_NO_CLIENT, ROUTE_WS, 0) != ROUTE_WS)
+            fails += fail("route", "unavailable outputs not masked out");
+    }
+
+    // ── Echoing peers ────────────────────────────────────────────────────────
+    // uart0 → tcp, and a client on slot 2 repeats each sentence 3 ms later;
+    // the same client's own input goes to uart0, whose device repeats it too
+    {
+        NMEARouter r;
+        r.setRoutes(0, ROUTE_TCP | ROUTE_WS);
+        r.setRoutes(NMEA_SOURCE_TCP, ROUTE_UART_TX(0) | ROUTE_WS);
+
+        uint32_t forwarded = 0, leakedTcp = 0, leakedUart = 0;
+        for (size_t i = 0; i < lines.size(); i++) {
+            const std::string& l = lines[i];
+            uint32_t now = (uint32_t)(i / 10);
+            if (r.route(l.data(), l.size(), 0, NMEA_NO_CLIENT, everything, now) & ROUTE_TCP) forwarded++;
+            // The client's copy comes back; if routed, the device on uart0 repeats it as well
+            uint8_t out = r.route(l.data(), l.size(), NMEA_SOURCE_TCP, 2, everything, now + 3);
+            if (out) leakedTcp++;
+            if ((out & ROUTE_UART_TX(0)) && r.route(l.data(), l.size(), 0, NMEA_NO_CLIENT, everything, now + 5))
+                leakedUart++;
+        }
+        printf("  echoing client: %u forwarded, %u echoes dropped, %u leaked, %u looped through uart0\n",
+               forwarded, r.looped(NMEA_SOURCE_TCP), leakedTcp, leakedUart);
+        if (forwarded != lines.size()) fails += fail("route", "only %u of %zu sentences reached TCP", forwarded, lines.size());
+        if (leakedTcp || leakedUart) fails += fail("route", "%u echoes left TCP, %u looped via uart0", leakedTcp, leakedUart);
+        if (r.looped(NMEA_SOURCE_TCP) != lines.size())
+            fails += fail("route", "%u echoes counted for %zu", r.looped(NMEA_SOURCE_TCP), lines.size());
+    }
+
+    // ── Autopilot on uart0 repeating what it is sent ─────────────────────────
+    {
+        NMEARouter r;
+        r.setRoutes(NMEA_SOURCE_TCP, ROUTE_UART_TX(0));
+        const char* apb = "$GPAPB,A,A,0.10,R,N,V,V,011,M,DEST,011,M,011,M*3C";
+        if (r.route(apb, strlen(apb), NMEA_SOURCE_TCP, 0, everything, 1000) != ROUTE_UART_TX(0))
+            fails += fail("route", "client sentence not routed to uart0");
+        if (r.route(apb, strlen(apb), 0, NMEA_NO_CLIENT, everything, 1050) != 0)
+            fails += fail("route", "uart0 echo of its TX not dropped");
+        if (r.route(apb, strlen(apb), 1, NMEA_NO_CLIENT, everything, 1060) == 0)
+            fails += fail("route", "uart1 sentence dropped as uart0's echo");
+        if (r.route(apb, strlen(apb), 0, NMEA_NO_CLIENT, everything, 1000 + ROUTE_ECHO_MS) == 0)
+            fails += fail("route", "sentence dropped after the echo window");
+    }
+
+    // ── A client repeating itself with tcp → tcp ─────────────────────────────
+    {
+        NMEARouter r;
+        r.setRoutes(NMEA_SOURCE_TCP, ROUTE_TCP);
+        const char* wpl = "$GPWPL,5030.000,N,00400.000,E,WP1*42";
+        for (uint32_t t = 0; t < 5; t++) {
+            if (r.route(wpl, strlen(wpl), NMEA_SOURCE_TCP, 1, everything, t * 100) != ROUTE_TCP)
+                fails += fail("route", "client 1 resending its own sentence flagged as an echo");
+        }
+        // Client 0 was sent it: its copy is an echo
+        if (r.route(wpl, strlen(wpl), NMEA_SOURCE_TCP, 0, everything, 450) != 0)
+            fails += fail("route", "client 0 echo of client 1 not dropped");
+    }
+
+    // ── Cost per sentence ────────────────────────────────────────────────────
+    const int iters = options().iterations * 5;
+    const uint64_t items = (uint64_t)lines.size() * iters;
+    {
+        NMEARouter r;   // Nothing that can echo back: no hash at all
+        r.setRoutes(0, ROUTE_UDP | ROUTE_WS);
+        uint32_t sink = 0;
+        Result res = measure(items, [&]() {
+            for (int it = 0; it < iters; it++) {
+                for (size_t i = 0; i < lines.size(); i++) {
+                    sink += r.route(lines[i].data(), lines[i].size(), 0, NMEA_NO_CLIENT, everything, (uint32_t)i);
+                }
+            }
+        });
+        keep(sink);
+        report("route, uart0 → udp/ws", res);
+    }
+    {
+        NMEARouter r;
+        r.setRoutes(0, ROUTE_TCP | ROUTE_UART_TX(1));
+        uint32_t sink = 0;
+        Result res = measure(items, [&]() {
+            for (int it = 0; it < iters; it++) {
+                for (size_t i = 0; i < lines.size(); i++) {
+                    sink += r.route(lines[i].data(), lines[i].size(), 0, NMEA_NO_CLIENT, everything, (uint32_t)i);
+                }
+            }
+        });
+        keep(sink);
+        report("route + echo check, uart0 → tcp/uart1", res);
+    }
+
+    return fails;
+}
@@ -0,0 +1,116 @@
+/**
+ * @file bench_seqlock.cpp
+ * @brief BoatState seqlock stress test: concurrent Writers vs lock-free readers.
+ *
+ * Two writer threads publish self-consistent updates through
+ * BoatState::Writer (GPS position/SOG and one AIS target carry the same
+ * counter value); three reader threads hammer getGPS()/getAIS() and check
+ * that every snapshot they get back is internally consistent.  A torn read
+ * — half of one update, half of the next — fails the section.
+ */
+
+#include "bench.h"
+#include "boat_state.h"
+#include <stdio.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace bench;
+
+namespace {
+
+const uint32_t STRESS_MMSI = 227000001;
+
+void publish(BoatState& state, uint32_t k) {
+    AISTarget t;
+    t.mmsi      = STRESS_MMSI;
+    t.lat       = (float)(k & 0xFFFF);
+    t.lon       = t.lat;
+    t.sog       = t.lat;
+    t.cog       = t.lat;
+    t.heading   = t.lat;
+    t.timestamp = millis();
+    snprintf(t.name, sizeof(t.name), "K%06u", (unsigned)(k & 0xFFFF));
+
+    BoatState::Writer w(state);
+    w.setGPSPositionE7((int32_t)k, -(int32_t)k);
+    w.setGPSSOG((float)(k & 0xFFFF));
+    w.addOrUpdateAISTarget(t);
+}
+
+bool gpsConsistent(const GPSData& g) {
+    if (g.position.latE7 != -g.position.lonE7) return false;
+    return g.sog.value == (float)((uint32_t)g.position.latE7 & 0xFFFF);
+}
+
+bool aisConsistent(const AISTarget* targets, int count) {
+    if (count != 1) return false;
+    const AISTarget& t = targets[0];
+    if (t.lon != t.lat || t.sog != t.lat || t.cog != t.lat || t.heading != t.lat) return false;
+    char name[sizeof(t.name)];
+    snprintf(name, sizeof(name), "K%06u", (unsigned)t.lat);
+    return strcmp(name, t.name) == 0;
+}
+
+} // namespace
+
+BENCH_SECTION(seqlock) {
+    BoatState state;
+    state.init();
+    publish(state, 1);
+
+    const uint64_t durationNs = 300ull * 1000 * 1000 * options().iterations;
+
+    std::atomic<bool>     stop(false);
+    std::atomic<uint32_t> counter(2);
+    std::atomic<uint64_t> writes(0), gpsReads(0), aisReads(0);
+    std::atomic<uint64_t> tornGPS(0), tornAIS(0);
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 2; i++) {
+        threads.push_back(std::thread([&]() {
+            uint64_t n = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                publish(state, counter.fetch_add(1, std::memory_order_relaxed));
+                n++;
+            }
+            writes += n;
+        }));
+    }
+    for (int i = 0; i < 3; i++) {
+        threads.push_back(std::thread([&, i]() {
+            uint64_t g = 0, a = 0, tg = 0, ta = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                GPSData gps = state.getGPS();
+                if (!gpsConsistent(gps)) tg++;
+                g++;
+                // AIS copies go through the table; read them less often than GPS
+                if (((g + i) & 7) == 0) {
+                    AISTarget ais[4];
+                    int n = state.getAISTargets(ais, 4);
+                    if (!aisConsistent(ais, n)) ta++;
+                    a++;
+                }
+            }
+            gpsReads += g; aisReads += a; tornGPS += tg; tornAIS += ta;
+        }));
+    }
+
+    uint64_t t0 = nowNs();
+    while (nowNs() - t0 < durationNs) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    stop = true;
+    for (size_t i = 0; i < threads.size(); i++) threads[i].join();
+    double secs = (nowNs() - t0) / 1e9;
+
+    printf("  %-34s %10.0f writes/s %10.0f gps reads/s %9.0f ais reads/s\n",
+           "2 writers / 3 readers", writes / secs, gpsReads / secs, aisReads / secs);
+    printf("  %-34s %10u retries %10u mutex fallbacks\n",
+           "reader contention", state.getReadRetries(), state.getReadFallbacks());
+
+    int fails = 0;
+    if (tornGPS) fails += fail("seqlock", "%llu torn GPS snapshots", (unsigned long long)tornGPS.load());
+    if (tornAIS) fails += fail("seqlock", "%llu torn AIS snapshots", (unsigned long long)tornAIS.load());
+    if (!writes || !gpsReads) fails += fail("seqlock", "threads made no progress");
+    return fails;
+}
@@ -0,0 +1,187 @@
+/**
+ * @file bench_state.cpp
+ * @brief BoatState setter and PolarData lookup micro-benchmarks, change tracking.
+ */
+
+#include "bench.h"
+#include "boat_state.h"
+#include <stdio.h>
+
+using namespace bench;
+
+BENCH_SECTION(state_setters) {
+    BoatState state;
+    state.init();
+
+    const int n = 20000 * options().iterations;
+
+    Result r = measure(n, [&]() {
+        for (int i = 0; i < n; i++) state.setGPSPosition(47.6f + i * 1e-7f, -3.48f);
+    });
+    report("setGPSPosition", r, "call");
+
+    r = measure(n, [&]() {
+        for (int i = 0; i < n; i++) state.setApparentWind(14.0f + (i & 7) * 0.1f, 35.0f);
+    });
+    report("setApparentWind (+derived)", r, "call");
+
+    r = measure(n, [&]() {
+        for (int i = 0; i < n; i++) state.setSTW(5.9f + (i & 7) * 0.05f);
+    });
+    report("setSTW (+performance)", r, "call");
+
+    r = measure(n, [&]() {
+        for (int i = 0; i < n; i++) { GPSData g = state.getGPS(); keep(g); }
+    });
+    report("getGPS copy", r, "call");
+
+    return 0;
+}
+
+BENCH_SECTION(polar_lookup) {
+    LittleFS.setRoot(BENCH_DATA_DIR);
+
+    PolarData polar;
+    if (!polar.loadFromFile("/sample.pol")) return fail("polar_lookup", "sample.pol did not load");
+
+    const int n = 50000 * options().iterations;
+    float sum = 0;
+    Result r = measure(n, [&]() {
+        for (int i = 0; i < n; i++) {
+            float tws = 3.0f + (i % 230) * 0.1f;
+            float twa = (float)(i % 181);
+            sum += polar.getTargetSTW(tws, twa);
+        }
+    });
+    keep(sum);
+    report("getTargetSTW", r, "call");
+
+    float t = polar.getTargetSTW(12.0f, 90.0f);
+    if (!(t > 0.0f && t < 20.0f)) return fail("polar_lookup", "getTargetSTW(12, 90) = %f", t);
+    return 0;
+}
+
+namespace {
+
+struct ListenerProbe {
+    uint32_t calls;
+    uint32_t bits;
+};
+
+void probeListener(uint32_t changed, void* ctx) {
+    ListenerProbe* p = static_cast<ListenerProbe*>(ctx);
+    p->calls++;
+    p->bits |= changed;
+}
+
+} // namespace
+
+BENCH_SECTION(state_listeners) {
+    BoatState state;
+    state.init();
+
+    ListenerProbe wind = {0, 0}, gps = {0, 0};
+    int windId = state.subscribe(BOAT_MASK(BOAT_SECTION_WIND), probeListener, &wind);
+    int gpsId  = state.subscribe(BOAT_MASK(BOAT_SECTION_GPS), probeListener, &gps);
+    if (windId < 0 || gpsId < 0) return fail("state_listeners", "subscribe failed");
+
+    int fails = 0;
+    uint32_t g0 = state.getGeneration(BOAT_SECTION_GPS);
+    {
+        BoatState::Writer w(state);
+        w.setGPSPositionE7(476000000, -34800000);
+        w.setGPSSOG(5.2f);
+        w.setGPSCOG(212.0f);
+    }
+    if (state.getGeneration(BOAT_SECTION_GPS) != g0 + 1)
+        fails += fail("state_listeners", "one Writer commit bumped GPS generation by %u",
+                      state.getGeneration(BOAT_SECTION_GPS) - g0);
+    if (gps.calls != 1 || gps.bits != BOAT_MASK(BOAT_SECTION_GPS))
+        fails += fail("state_listeners", "GPS listener: %u calls, bits 0x%x", gps.calls, gps.bits);
+    if (wind.calls != 0) fails += fail("state_listeners", "wind listener woken by GPS update");
+
+    // Apparent wind with STW + heading known → derived true wind in the same commit
+    state.setSTW(6.0f);
+    state.setTrueHeading(90.0f);
+    uint32_t perf0 = state.getGeneration(BOAT_SECTION_PERFORMANCE);
+    state.setApparentWind(12.0f, 40.0f);
+    if (wind.calls != 1 || wind.bits != BOAT_MASK(BOAT_SECTION_WIND))
+        fails += fail("state_listeners", "wind listener: %u calls, bits 0x%x", wind.calls, wind.bits);
+    if (state.getGeneration(BOAT_SECTION_PERFORMANCE) != perf0)
+        fails += fail("state_listeners", "apparent wind alone bumped performance generation");
+
+    state.unsubscribe(windId);
+    state.setApparentWind(13.0f, 42.0f);
+    if (wind.calls != 1) fails += fail("state_listeners", "listener called after unsubscribe");
+
+    const int n = 20000 * options().iterations;
+    Result r = measure(n, [&]() {
+        for (int i = 0; i < n; i++) state.setGPSSOG(5.0f + (i & 7) * 0.1f);
+    });
+    report("setGPSSOG (+1 listener)", r, "call");
+
+    r = measure(n, [&]() {
+        for (int i = 0; i < n; i++) keep(state.getGeneration(BOAT_SECTION_GPS));
+    });
+    report("getGeneration", r, "call");
+
+    state.unsubscribe(gpsId);
+    return fails;
+}
+
+// ETag / long-poll cursor: the change stamp must move on every commit to
+// one of its sections, and on a value timing out, and on nothing else
+BENCH_SECTION(state_stamps) {
+    BoatState state;
+    state.init();
+
+    int fails = 0;
+    const uint32_t navMask  = BOAT_MASK(BOAT_SECTION_GPS) | BOAT_MASK(BOAT_SECTION_DEPTH);
+    const uint32_t windMask = BOAT_MASK(BOAT_SECTION_WIND);
+
+    state.setGPSSOG(5.2f);
+    state.setDepth(12.5f);
+    hostFreezeMillis(true);
+    state.cleanupStaleData();              // First sweep records what is fresh
+    uint32_t nav  = state.getChangeStamp(navMask);
+    uint32_t wind = state.getChangeStamp(windMask);
+
+    state.cleanupStaleData();
+    if (state.getChangeStamp(navMask) != nav)
+        fails += fail("state_stamps", "sweep with nothing timing out moved the stamp");
+
+    state.setGPSSOG(5.3f);
+    if (state.getChangeStamp(navMask) != nav + 1)
+        fails += fail("state_stamps", "one GPS commit moved the stamp by %u", state.getChangeStamp(navMask) - nav);
+    if (state.getChangeStamp(windMask) != wind)
+        fails += fail("state_stamps", "GPS commit moved the wind stamp");
+    nav = state.getChangeStamp(navMask);
+
+    // SOG and depth time out together: one bump per section, once
+    hostAdvanceMillis(DATA_TIMEOUT_DEFAULT + 1);
+    state.cleanupStaleData();
+    if (state.getChangeStamp(navMask) != nav + 2)
+        fails += fail("state_stamps", "values timing out moved the stamp by %u, expected 2",
+                      state.getChangeStamp(navMask) - nav);
+    nav = state.getChangeStamp(navMask);
+    state.cleanupStaleData();
+    if (state.getChangeStamp(navMask) != nav)
+        fails += fail("state_stamps", "already stale values moved the stamp again");
+    if (state.getChangeStamp(windMask) != wind)
+        fails += fail("state_stamps", "sweep moved the stamp of a section with no values");
+    hostFreezeMillis(false);
+
+    const int n = 20000 * options().iterations;
+    Result r = measure(n, [&]() {
+        for (int i = 0; i < n; i++) keep(state.getChangeStamp(BOAT_MASK_ALL));
+    });
+    report("getChangeStamp (all sections)", r, "call");
+
+    const int sweeps = 2000 * options().iterations;
+    r = measure(sweeps, [&]() {
+        for (int i = 0; i < sweeps; i++) state.cleanupStaleData();
+    });
+    report("cleanupStaleData", r, "sweep");
+
+    return fails;
+}
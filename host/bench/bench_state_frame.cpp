@@ -0,0 +1,153 @@
+/**
+ * @file bench_state_frame.cpp
+ * @brief /ws/state frames: capture, delta encoding and the client's decode.
+ *
+ * The corpus is parsed into a BoatState and a simulated client is pushed
+ * a frame every WS_STATE_PUSH_MS, 10 sentences apart.  After every push
+ * the client's decoded view must equal the snapshot exactly, keyframes
+ * must come at the WS_STATE_KEYFRAME_MS cadence and no more, and the bytes
+ * sent are compared with the same fields as REST JSON DataPoints.
+ * capture() + encode() must not allocate.
+ */
+
+#include "bench.h"
+#include "state_frame.h"
+#include "boat_state.h"
+#include "nmea_parser.h"
+#include "config.h"
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace bench;
+
+namespace {
+
+bool sameView(const StateSnapshot& a, const StateSnapshot& b) {
+    return memcmp(a.values, b.values, sizeof(a.values)) == 0;
+}
+
+/** Bytes the same fields take as REST DataPoints: "sog":{"value":6.2,"unit":"kn","age":0.4}, */
+size_t jsonSize(const StateSnapshot& s) {
+    char tmp[96];
+    size_t total = 2;
+    for (uint8_t f = 0; f < STATE_FIELD_COUNT; f++) {
+        int32_t v = s.values[f];
+        total += v == STATE_NO_VALUE
+            ? (size_t)snprintf(tmp, sizeof(tmp), "\"field\":{\"value\":null,\"unit\":\"kn\",\"age\":null},")
+            : (size_t)snprintf(tmp, sizeof(tmp), "\"field\":{\"value\":%g,\"unit\":\"kn\",\"age\":0.4},",
+                               (double)v / StateSnapshot::scale(f));
+    }
+    return total;
+}
+
+} // namespace
+
+BENCH_SECTION(state_frame) {
+    int fails = 0;
+
+    std::vector<std::string> lines;
+    loadLines(options().mixedCorpus, lines);
+    if (lines.empty()) return fails + fail("state_frame", "no corpus lines");
+
+    // ── Fixed point ──────────────────────────────────────────────────────────
+    {
+        BoatState state;
+        state.init();
+        {
+            BoatState::Writer w(state);
+            w.setGPSPositionE7(476123457, -34812345);
+            w.setSTW(6.37f);
+            w.setApparentWind(14.2f, -35.5f);
+            w.setDepth(12.345f);
+        }
+        StateSnapshot s;
+        s.capture(state);
+        if (s.values[SF_LAT] != 476123457 || s.values[SF_LON] != -34812345)
+            fails += fail("state_frame", "position %d,%d lost resolution", s.values[SF_LAT], s.values[SF_LON]);
+        if (s.values[SF_STW] != 637)   fails += fail("state_frame", "stw 6.37 → %d", s.values[SF_STW]);
+        if (s.values[SF_AWA] != -355)  fails += fail("state_frame", "awa -35.5 → %d", s.values[SF_AWA]);
+        if (s.values[SF_DEPTH] != 1235) fails += fail("state_frame", "depth 12.345 → %d", s.values[SF_DEPTH]);
+        if (s.values[SF_SOG] != STATE_NO_VALUE) fails += fail("state_frame", "unset sog sent as %d", s.values[SF_SOG]);
+        if (s.values[SF_POLAR_LOADED] != 0) fails += fail("state_frame", "polar reported loaded");
+    }
+
+    // ── Malformed frames ─────────────────────────────────────────────────────
+    {
+        StateSnapshot view;
+        const uint8_t shortFrame[] = { 0, 2, SF_STW, 1, 0, 0, 0 };
+        const uint8_t unknown[]    = { 0, 1, 200, 1, 0, 0, 0 };
+        if (applyStateFrame(shortFrame, sizeof(shortFrame), view)) fails += fail("state_frame", "truncated frame accepted");
+        if (!applyStateFrame(unknown, sizeof(unknown), view))      fails += fail("state_frame", "unknown field id rejected");
+        if (view.values[SF_STW] != STATE_NO_VALUE)                 fails += fail("state_frame", "truncated frame applied");
+    }
+
+    // ── Corpus replay, one push every WS_STATE_PUSH_MS ───────────────────────
+    BoatState state;
+    state.init();
+    NMEAParser parser(&state);
+    NMEASentence out;
+
+    StateFrameEncoder enc;
+    StateSnapshot snap, view;
+    uint8_t frame[STATE_FRAME_MAX];
+    const size_t perPush = 10;
+
+    uint32_t pushes = 0, frames = 0, mismatches = 0;
+    uint64_t frameBytes = 0, jsonBytes = 0;
+    uint32_t now = 0;
+    for (size_t i = 0; i < lines.size(); i += perPush, now += WS_STATE_PUSH_MS) {
+        for (size_t j = i; j < i + perPush && j < lines.size(); j++) parser.parseLine(lines[j].c_str(), out);
+
+        snap.capture(state);
+        size_t len = enc.encode(snap, now, frame);
+        pushes++;
+        if (len) {
+            frames++;
+            frameBytes += len;
+            if (!applyStateFrame(frame, len, view)) fails += fail("state_frame", "own frame rejected");
+        }
+        if (!sameView(view, snap)) mismatches++;
+        jsonBytes += jsonSize(snap);
+    }
+
+    uint32_t maxKeys = now / WS_STATE_KEYFRAME_MS + 1;
+    printf("  %u pushes: %u frames (%u keyframes), %.1f B/frame vs %.0f B as JSON DataPoints\n",
+           pushes, frames, enc.getKeyframes(), frames ? (double)frameBytes / frames : 0.0,
+           (double)jsonBytes / pushes);
+    if (mismatches) fails += fail("state_frame", "client view differs from the state after %u pushes", mismatches);
+    if (enc.getKeyframes() > maxKeys || enc.getKeyframes() + 1 < maxKeys)
+        fails += fail("state_frame", "%u keyframes over %u ms, expected %u", enc.getKeyframes(), now, maxKeys);
+    if (frameBytes * 4 > jsonBytes) fails += fail("state_frame", "frames not 4× smaller than JSON");
+
+    // An unchanged state sends nothing until the next keyframe
+    {
+        StateFrameEncoder idle;
+        idle.encode(snap, 0, frame);
+        if (idle.encode(snap, WS_STATE_PUSH_MS, frame) != 0) fails += fail("state_frame", "unchanged state sent a frame");
+        if (idle.encode(snap, WS_STATE_KEYFRAME_MS, frame) != STATE_FRAME_MAX)
+            fails += fail("state_frame", "no full keyframe after %u ms", WS_STATE_KEYFRAME_MS);
+    }
+
+    // ── Cost of one push: capture + encode for each client ───────────────────
+    const int n = 20000 * options().iterations;
+    StateFrameEncoder clients[WS_STATE_MAX_CLIENTS];
+    size_t sink = 0;
+    Result r = measure(n, [&]() {
+        for (int k = 0; k < n; k++) {
+            state.setSTW(5.0f + (k & 15) * 0.1f);
+            snap.capture(state);
+            for (size_t c = 0; c < WS_STATE_MAX_CLIENTS; c++) {
+                sink += clients[c].encode(snap, (uint32_t)k * WS_STATE_PUSH_MS, frame);
+            }
+        }
+    });
+    keep(sink);
+    char label[64];
+    snprintf(label, sizeof(label), "setSTW + capture + encode × %u clients", WS_STATE_MAX_CLIENTS);
+    report(label, r, "push");
+    if (r.allocs) fails += fail("state_frame", "%llu allocations in %d pushes", (unsigned long long)r.allocs, n);
+
+    return fails;
+}
@@ -0,0 +1,315 @@
+/**
+ * @file bench_stream.cpp
+ * @brief StreamRing: TCP and WebSocket client batching as TCPServer and WSStream drive it.
+ *
+ * A simulated client with an AsyncTCP-like send buffer (space() bytes,
+ * refilled as the link drains at a given rate) is fed the corpus at a
+ * given sentence rate, in 1 ms ticks: each sentence is appended, and the
+ * ring is drained whenever due() — a full MSS or TCP_COALESCE_MS of
+ * waiting — exactly as broadcast() / flush() / onAck do.  The stream the
+ * client receives must be the corpus byte for byte, no sentence may wait
+ * much past the latency bound, and the number of writes is compared with
+ * the old one-write-per-sentence path.
+ *
+ * A slow link must lose whole sentences only, never tear one, and must not
+ * be taken for a stalled one; a link that stops draining must be.
+ *
+ * For /ws/nmea the whole ring goes out as one frame once due() with
+ * WS_BATCH_BYTES / WS_BATCH_MS, on arrivals and on the processor wake-ups
+ * msUntilFlush() asks for.  Every sentence must arrive, within the bound,
+ * in no more frames than the old 10 Hz cap sent.  A client whose send
+ * queue stays full must be retried once per WS_BATCH_MS, never with a zero
+ * wait that would spin the processor task.
+ */
+
+#include "bench.h"
+#include "stream_ring.h"
+#include "config.h"
+#include <algorithm>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace bench;
+
+namespace {
+
+const size_t kMss = TCP_DEFAULT_MSS;
+
+struct Sink {
+    size_t      window;       ///< Send buffer size (AsyncClient::space() when idle)
+    size_t      inFlight;     ///< Bytes not yet drained by the link
+    uint32_t    bytesPerMs;   ///< Link rate; 0 = stalled
+    uint32_t    writes;       ///< add()+send() batches
+    std::string received;
+
+    size_t space() const { return window - inFlight; }
+    void   tick() { inFlight = inFlight > bytesPerMs ? inFlight - bytesPerMs : 0; }
+};
+
+/** TCPServer::drain() against the simulated sink. */
+size_t drain(StreamRing& ring, Sink& sink) {
+    size_t total = 0;
+    while (ring.pending() > 0 && sink.space() > 0) {
+        const char* data;
+        size_t len = ring.peek(data);
+        if (len > sink.space()) len = sink.space();
+        sink.received.append(data, len);
+        sink.inFlight += len;
+        ring.consume(len);
+        total += len;
+    }
+    if (total) sink.writes++;
+    return total;
+}
+
+struct RunResult {
+    uint32_t sentences;
+    uint32_t dropped;
+    uint32_t writes;
+    uint32_t maxWaitMs;     ///< Longest time a byte sat in the ring
+    uint32_t stalledMs;     ///< Longest overflowingFor() seen
+};
+
+/**
+ * Feed @p count corpus lines at @p perSecond through a ring into @p sink.
+ * @p expected receives the text a lossless client would see.
+ */
+RunResult run(const std::vector<std::string>& lines, size_t count, uint32_t perSecond,
+              StreamRing& ring, Sink& sink, std::string* expected) {
+    RunResult r;
+    memset(&r, 0, sizeof(r));
+    ring.clear();
+
+    // Sentence i is broadcast at tick i * 1000 / perSecond
+    size_t   next = 0;
+    uint32_t now  = 1000;
+    uint32_t oldestQueued = 0;
+    while (next < count || ring.pending() > 0) {
+        while (next < count && (uint64_t)next * 1000 / perSecond <= now - 1000) {
+            const std::string& l = lines[next % lines.size()];
+            bool wasEmpty = ring.pending() == 0;
+            if (ring.appendLine(l.data(), l.size(), now)) {
+                if (expected) expected->append(l).append("\r\n");
+                if (wasEmpty) oldestQueued = now;
+            } else {
+                r.dropped++;
+            }
+            r.sentences++;
+            next++;
+            if (ring.due(now, kMss, TCP_COALESCE_MS) && drain(ring, sink) && ring.pending() == 0)
+                oldestQueued = 0;
+        }
+        uint32_t stalled = ring.overflowingFor(now);
+        if (stalled > r.stalledMs) r.stalledMs = stalled;
+        if (stalled >= TCP_CLIENT_STALL_MS) break;     // Evicted
+
+        // flush() on the processor's TCP_COALESCE_MS wake-ups, onAck as the window reopens
+        sink.tick();
+        now++;
+        if (ring.due(now, kMss, TCP_COALESCE_MS) && drain(ring, sink) && ring.pending() == 0) {
+            uint32_t wait = now - oldestQueued;
+            if (oldestQueued && wait > r.maxWaitMs) r.maxWaitMs = wait;
+            oldestQueued = 0;
+        }
+        if (next >= count && sink.bytesPerMs == 0) break;
+    }
+    r.writes = sink.writes;
+    return r;
+}
+
+/** Every CRLF-terminated line of @p text must be one of the corpus lines. */
+uint32_t tornLines(const std::string& text, const std::vector<std::string>& lines) {
+    std::vector<std::string> sorted(lines);
+    std::sort(sorted.begin(), sorted.end());
+    uint32_t torn = 0;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find("\r\n", pos);
+        if (end == std::string::npos) return torn + 1;
+        if (!std::binary_search(sorted.begin(), sorted.end(), text.substr(pos, end - pos))) torn++;
+        pos = end + 2;
+    }
+    return torn;
+}
+
+} // namespace
+
+BENCH_SECTION(stream) {
+    int fails = 0;
+
+    std::vector<std::string> lines;
+    loadLines(options().mixedCorpus, lines);
+    if (lines.empty()) return fails + fail("stream", "no corpus lines");
+
+    StreamRing ring;
+    if (!ring.begin(TCP_CLIENT_BUFFER)) return fails + fail("stream", "cannot allocate ring");
+
+    // ── Wrap-around and all-or-nothing appends ───────────────────────────────
+    {
+        StreamRing small;
+        small.begin(16);
+        const char* data;
+        small.append("0123456789", 10, 0);
+        small.consume(8);                                 // head at 8, "89" queued
+        if (!small.appendLine("ABCDEFGHIJ", 10, 0))       // 12 bytes wrap past the end
+            fails += fail("stream", "append refused with room");
+        std::string out;
+        for (size_t n; (n = small.peek(data)) > 0; small.consume(n)) out.append(data, n);
+        if (out != "89ABCDEFGHIJ\r\n") fails += fail("stream", "wrapped read gave \"%s\"", out.c_str());
+        small.append("0123456789", 10, 0);
+        if (small.appendLine("abcde", 5, 5) || small.pending() != 10)   // 7 bytes, 6 free
+            fails += fail("stream", "partial append on a full ring");
+        if (small.overflowingFor(105) != 100) fails += fail("stream", "overflow age %u", small.overflowingFor(105));
+        small.consume(1);
+        if (small.overflowingFor(200) != 0) fails += fail("stream", "overflow not cleared by a drain");
+    }
+
+    // ── Coalescing at NMEA rates ─────────────────────────────────────────────
+    static const uint32_t kRates[] = { 50, 200, 1000 };
+    const size_t count = lines.size() * options().iterations;
+    for (size_t i = 0; i < sizeof(kRates) / sizeof(kRates[0]); i++) {
+        Sink sink = { 4 * kMss, 0, 1000, 0, std::string() };   // ~8 Mbit/s WiFi, 4 segments of window
+        std::string expected;
+        RunResult r = run(lines, count, kRates[i], ring, sink, &expected);
+        printf("  %4u sentences/s: %u sentences in %u writes (%.1f per write, was 1), max wait %u ms, %u dropped\n",
+               kRates[i], r.sentences, r.writes, (double)r.sentences / (r.writes ? r.writes : 1),
+               r.maxWaitMs, r.dropped);
+        if (sink.received != expected || r.dropped)
+            fails += fail("stream", "%u/s: client stream differs from the corpus", kRates[i]);
+        if (r.maxWaitMs > TCP_COALESCE_MS + 1)
+            fails += fail("stream", "%u/s: a batch waited %u ms (bound %u)", kRates[i], r.maxWaitMs, TCP_COALESCE_MS);
+        if (r.writes * 2 > r.sentences)
+            fails += fail("stream", "%u/s: only %.1f sentences per write", kRates[i], (double)r.sentences / r.writes);
+    }
+
+    // ── Slow and stalled clients ─────────────────────────────────────────────
+    {
+        // 1000 sentences/s (~40 kB/s) into a 10 kB/s link: drops, no eviction
+        Sink slow = { 4 * kMss, 0, 10, 0, std::string() };
+        RunResult r = run(lines, count, 1000, ring, slow, nullptr);
+        uint32_t torn = tornLines(slow.received, lines);
+        printf("  slow client: %u of %u sentences dropped, %u torn, longest overflow %u ms\n",
+               r.dropped, r.sentences, torn, r.stalledMs);
+        if (!r.dropped) fails += fail("stream", "slow client dropped nothing");
+        if (torn)       fails += fail("stream", "slow client received %u torn sentences", torn);
+        if (r.stalledMs >= TCP_CLIENT_STALL_MS) fails += fail("stream", "draining client taken for stalled");
+
+        Sink dead = { 4 * kMss, 0, 0, 0, std::string() };
+        r = run(lines, count, 50, ring, dead, nullptr);
+        printf("  stalled client: evicted after %u ms of overflow\n", r.stalledMs);
+        if (r.stalledMs < TCP_CLIENT_STALL_MS) fails += fail("stream", "stalled client not evicted");
+    }
+
+    // ── WebSocket frames ─────────────────────────────────────────────────────
+    {
+        StreamRing ws;
+        if (!ws.begin(WS_CLIENT_BUFFER)) return fails + fail("stream", "cannot allocate ws ring");
+        for (size_t i = 0; i < sizeof(kRates) / sizeof(kRates[0]); i++) {
+            std::string expected, received;
+            uint32_t frames = 0, maxWaitMs = 0, wakeAt = 0, dropped = 0;
+            size_t   next = 0;
+            uint32_t now  = 0;
+            for (; next < count || ws.pending() > 0; now++) {
+                bool woken = false;
+                while (next < count && (uint64_t)next * 1000 / kRates[i] <= now) {
+                    const std::string& l = lines[next % lines.size()];
+                    if (ws.appendLine(l.data(), l.size(), now)) expected.append(l).append("\r\n");
+                    else dropped++;
+                    next++;
+                    woken = true;
+                }
+                if (!woken && now < wakeAt) continue;
+                if (ws.due(now, WS_BATCH_BYTES, WS_BATCH_MS)) {
+                    if (ws.waited(now) > maxWaitMs) maxWaitMs = ws.waited(now);
+                    const char* data;
+                    for (size_t n; (n = ws.peek(data)) > 0; ws.consume(n)) received.append(data, n);
+                    frames++;
+                }
+                wakeAt = now + ws.msUntilDue(now, WS_BATCH_MS);
+            }
+            // The old path sent at most one sentence per 1000 / 10 Hz and dropped the rest
+            uint32_t before = (uint32_t)std::min<uint64_t>(count, (uint64_t)now / 100);
+            printf("  ws %4u sentences/s: %zu sentences in %u frames (%.1f per frame), max wait %u ms (was %u frames of one sentence)\n",
+                   kRates[i], count, frames, (double)count / (frames ? frames : 1), maxWaitMs, before);
+            if (received != expected || dropped)
+                fails += fail("stream", "ws %u/s: client stream differs from the corpus", kRates[i]);
+            if (maxWaitMs > WS_BATCH_MS)
+                fails += fail("stream", "ws %u/s: a frame waited %u ms (bound %u)", kRates[i], maxWaitMs, WS_BATCH_MS);
+            if (frames > now / WS_BATCH_MS + 1)
+                fails += fail("stream", "ws %u/s: %u frames in %u ms, more than one per %u ms", kRates[i], frames, now, WS_BATCH_MS);
+        }
+    }
+
+    // ── WebSocket client with a full send queue ──────────────────────────────
+    {
+        // 10 sentences at 50/s to a client whose queue stays full for 2 s, then
+        // drains: the processor must sleep between retries, not wake on every tick
+        StreamRing ws;
+        ws.begin(WS_CLIENT_BUFFER);
+        uint32_t timerWakes = 0, spins = 0, frames = 0, wakeAt = 0;
+        const uint32_t stuckMs = 2000, endMs = 3000;
+        size_t next = 0;
+        for (uint32_t now = 0; now < endMs; now++) {
+            bool woken = false;
+            while (next < 10 && (uint64_t)next * 1000 / 50 <= now) {
+                const std::string& l = lines[next % lines.size()];
+                ws.appendLine(l.data(), l.size(), now);
+                next++;
+                woken = true;
+            }
+            if (!woken) {
+                if (now < wakeAt) continue;
+                timerWakes++;
+            }
+            if (ws.due(now, WS_BATCH_BYTES, WS_BATCH_MS)) {
+                if (now < stuckMs) {
+                    ws.sinkRefused(now);
+                } else {
+                    const char* data;
+                    for (size_t n; (n = ws.peek(data)) > 0; ws.consume(n)) {}
+                    frames++;
+                }
+            }
+            uint32_t wait = ws.msUntilDue(now, WS_BATCH_MS);
+            if (wait == 0) spins++;
+            wakeAt = now + wait;
+        }
+        printf("  ws stuck client: %u timer wakes in %u ms, %u zero waits, %u frames once drained\n",
+               timerWakes, endMs, spins, frames);
+        if (spins) fails += fail("stream", "ws stuck client: %u zero waits (the processor task would spin)", spins);
+        if (timerWakes > endMs / WS_BATCH_MS + 1)
+            fails += fail("stream", "ws stuck client: %u timer wakes, more than one per %u ms", timerWakes, WS_BATCH_MS);
+        if (!frames || ws.pending())
+            fails += fail("stream", "ws stuck client: backlog not sent once the queue drained");
+    }
+
+    // ── Cost per sentence ────────────────────────────────────────────────────
+    {
+        const int iters = options().iterations * 5;
+        const uint64_t items = (uint64_t)lines.size() * iters;
+        char sink[TCP_DEFAULT_MSS * 4];
+        uint64_t bytes = 0;
+        ring.clear();
+        Result r = measure(items, [&]() {
+            for (int it = 0; it < iters; it++) {
+                for (size_t i = 0; i < lines.size(); i++) {
+                    ring.appendLine(lines[i].data(), lines[i].size(), (uint32_t)i);
+                    if (ring.due((uint32_t)i, kMss, TCP_COALESCE_MS)) {
+                        const char* data;
+                        for (size_t n; (n = ring.peek(data)) > 0; ring.consume(n)) {
+                            memcpy(sink, data, n < sizeof(sink) ? n : sizeof(sink));
+                            bytes += n;
+                        }
+                    }
+                }
+            }
+        });
+        keep(bytes);
+        keep(sink);
+        report("appendLine + batched drain", r);
+    }
+
+    return fails;
+}
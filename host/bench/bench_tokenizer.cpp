@@ -0,0 +1,95 @@
+/**
+ * @file bench_tokenizer.cpp
+ * @brief Field splitting: per-field rescans vs NMEAParser::tokenize().
+ *
+ * legacyParseField() is the scanner NMEAParser used before the single-pass
+ * tokenizer; it walks from the start of the line for every field.  Both are
+ * timed extracting every field of every corpus sentence, and the field
+ * contents are cross-checked.
+ */
+
+#include "bench.h"
+#include "nmea_parser.h"
+#include <string.h>
+
+using namespace bench;
+
+static int legacyParseField(const char* line, int fieldIndex, char* buffer, size_t bufferSize) {
+    const char* ptr = line;
+    int currentField = 0;
+
+    while (*ptr && currentField < fieldIndex) {
+        if (*ptr == ',') currentField++;
+        ptr++;
+    }
+
+    if (currentField != fieldIndex) {
+        buffer[0] = '\0';
+        return 0;
+    }
+
+    size_t i = 0;
+    while (*ptr && *ptr != ',' && *ptr != '*' && i < bufferSize - 1) {
+        buffer[i++] = *ptr++;
+    }
+    buffer[i] = '\0';
+    return i;
+}
+
+static int countFields(const std::string& s) {
+    int n = 1;
+    for (size_t i = 0; i < s.size() && s[i] != '*'; i++) n += s[i] == ',';
+    return n;
+}
+
+BENCH_SECTION(tokenizer) {
+    std::vector<std::string> lines;
+    if (!loadLines(options().mixedCorpus, lines)) return fail("tokenizer", "corpus missing");
+
+    std::vector<int> fieldCounts(lines.size());
+    for (size_t i = 0; i < lines.size(); i++) fieldCounts[i] = countFields(lines[i]);
+
+    const int iters = options().iterations;
+    uint64_t sink = 0;
+
+    Result legacy = measure((uint64_t)lines.size() * iters, [&]() {
+        char buf[96];
+        for (int it = 0; it < iters; it++) {
+            for (size_t i = 0; i < lines.size(); i++) {
+                for (int k = 1; k < fieldCounts[i]; k++) {
+                    sink += legacyParseField(lines[i].c_str(), k, buf, sizeof(buf));
+                }
+            }
+        }
+    });
+    report("parseField rescans (legacy)", legacy);
+
+    Result single = measure((uint64_t)lines.size() * iters, [&]() {
+        NMEAFields f;
+        for (int it = 0; it < iters; it++) {
+            for (size_t i = 0; i < lines.size(); i++) {
+                NMEAParser::tokenize(lines[i].c_str(), f);
+                for (int k = 1; k < f.count; k++) sink += f[k].len;
+            }
+        }
+    });
+    report("tokenize single pass", single);
+    keep(sink);
+
+    // Field-by-field equivalence
+    int fails = 0;
+    for (size_t i = 0; i < lines.size() && fails < 5; i++) {
+        const char* line = lines[i].c_str();
+        NMEAFields f;
+        NMEAParser::tokenize(line, f);
+        char buf[96];
+        for (int k = 1; k < fieldCounts[i] && k < NMEA_MAX_FIELDS; k++) {
+            int n = legacyParseField(line, k, buf, sizeof(buf));
+            if (n != f[k].len || memcmp(buf, f[k].ptr, n) != 0) {
+                fails += fail("tokenizer", "line %zu field %d differs: '%s'", i, k, buf);
+                break;
+            }
+        }
+    }
+    return fails;
+}
@@ -0,0 +1,361 @@
+#!/usr/bin/env python3
+"""
+gen_corpus.py  --  regenerate the replay corpus used by nmea_bench.
+
+Simulates a yacht sailing off the Brittany coast with a multiplexed
+NMEA-0183 feed (GPS, compass, wind, depth, log) and a dual-channel AIS
+receiver surrounded by a busy harbour fleet.  The output is deterministic
+(fixed seed) so that benchmark numbers stay comparable across commits.
+
+Outputs (next to this script):
+    mixed.nmea   full multiplexed bus, ~1 % corrupted checksums
+    ais.nmea     AIS sentences only
+    sample.pol   polar diagram in the LittleFS upload format
+
+Usage:  python3 gen_corpus.py
+"""
+
+import math
+import random
+from pathlib import Path
+
+OUT_DIR  = Path(__file__).resolve().parent
+SECONDS  = 120
+FLEET    = 120
+SEED     = 0x5EA7A1C
+
+rng = random.Random(SEED)
+
+
+# ── NMEA helpers ──────────────────────────────────────────────────────────────
+
+def checksum(body):
+    c = 0
+    for ch in body:
+        c ^= ord(ch)
+    return c
+
+
+def sentence(lead, body, corrupt=False):
+    cs = checksum(body)
+    if corrupt:
+        cs ^= 0x5A
+    return f"{lead}{body}*{cs:02X}"
+
+
+def fmt_lat(lat):
+    hemi = "N" if lat >= 0 else "S"
+    lat = abs(lat)
+    deg = int(lat)
+    return f"{deg:02d}{(lat - deg) * 60:08.5f}", hemi
+
+
+def fmt_lon(lon):
+    hemi = "E" if lon >= 0 else "W"
+    lon = abs(lon)
+    deg = int(lon)
+    return f"{deg:03d}{(lon - deg) * 60:08.5f}", hemi
+
+
+# ── AIS helpers ───────────────────────────────────────────────────────────────
+
+class Bits:
+    def __init__(self):
+        self.bits = []
+
+    def u(self, width, value):
+        value = int(value) & ((1 << width) - 1)
+        for i in range(width - 1, -1, -1):
+            self.bits.append((value >> i) & 1)
+        return self
+
+    def s(self, width, value):
+        return self.u(width, int(value) & ((1 << width) - 1))
+
+    def text(self, chars, value):
+        value = value.upper().ljust(chars, "@")[:chars]
+        for ch in value:
+            c = ord(ch)
+            self.u(6, c - 64 if c >= 64 else c)
+        return self
+
+    def armor(self):
+        fill = (-len(self.bits)) % 6
+        bits = self.bits + [0] * fill
+        out = []
+        for i in range(0, len(bits), 6):
+            v = 0
+            for b in bits[i:i + 6]:
+                v = (v << 1) | b
+            out.append(chr(v + 48 if v < 40 else v + 56))
+        return "".join(out), fill
+
+
+def ais_lines(bits, channel, seq_id, corrupt=False, talker="AIVDM"):
+    payload, fill = bits.armor()
+    if len(payload) <= 60:
+        return [sentence("!", f"{talker},1,1,,{channel},{payload},{fill}", corrupt)]
+    parts = [payload[i:i + 60] for i in range(0, len(payload), 60)]
+    out = []
+    for n, part in enumerate(parts, 1):
+        f = fill if n == len(parts) else 0
+        out.append(sentence("!", f"{talker},{len(parts)},{n},{seq_id},{channel},{part},{f}",
+                            corrupt and n == 1))
+    return out
+
+
+def ais_lon(lon):
+    return round(lon * 600000)
+
+
+def ais_lat(lat):
+    return round(lat * 600000)
+
+
+NAMES = ["AVEL MOR", "KORRIGAN", "ENEZ GLAZ", "BREIZH IZEL", "PENN AR BED",
+         "MARIE GALANTE", "LA BELLE ILE", "ARMORIQUE", "BELLE DE GROIX",
+         "TI BIHAN", "GWENN HA DU", "STERENN", "MOR BRAZ", "KERLOUAN",
+         "ILE AUX MOINES", "QUIBERON", "ROZ AVEL", "AR VRO", "LOCMARIA",
+         "SAINT GILDAS", "MEN GWEN", "HOUAT", "HOEDIC", "KERNEVEL"]
+
+
+class Vessel:
+    def __init__(self, idx, own_lat, own_lon):
+        self.mmsi   = 227000000 + rng.randint(0, 999999) if idx % 7 else 316000000 + idx
+        self.name   = f"{rng.choice(NAMES)} {idx}"[:20]
+        self.cls_b  = idx % 3 == 0
+        r           = rng.uniform(0.2, 12.0) / 60.0
+        a           = rng.uniform(0, 2 * math.pi)
+        self.lat    = own_lat + r * math.cos(a)
+        self.lon    = own_lon + r * math.sin(a) / math.cos(math.radians(own_lat))
+        self.sog    = rng.choice([0.0, 0.1, rng.uniform(2, 18)])
+        self.cog    = rng.uniform(0, 360)
+        self.hdg    = int(self.cog) % 360
+
+    def step(self, dt):
+        d = self.sog * dt / 3600.0 / 60.0
+        self.lat += d * math.cos(math.radians(self.cog))
+        self.lon += d * math.sin(math.radians(self.cog)) / math.cos(math.radians(self.lat))
+
+    def position(self, t):
+        b = Bits()
+        if self.cls_b:
+            b.u(6, 18).u(2, 0).u(30, self.mmsi).u(8, 0)
+            b.u(10, round(self.sog * 10)).u(1, 1)
+            b.s(28, ais_lon(self.lon)).s(27, ais_lat(self.lat))
+            b.u(12, round(self.cog * 10) % 3600).u(9, self.hdg)
+            b.u(6, t % 60).u(2, 0).u(1, 1).u(1, 0).u(1, 1).u(1, 1).u(1, 1).u(1, 0)
+            b.u(1, 0).u(1, 0).u(20, 0x60000 | rng.randint(0, 0xFFFF))
+        else:
+            b.u(6, rng.choice([1, 1, 1, 3])).u(2, 0).u(30, self.mmsi)
+            b.u(4, 0 if self.sog > 0.5 else 5).s(8, 0)
+            b.u(10, round(self.sog * 10)).u(1, 0)
+            b.s(28, ais_lon(self.lon)).s(27, ais_lat(self.lat))
+            b.u(12, round(self.cog * 10) % 3600).u(9, self.hdg)
+            b.u(6, t % 60).u(2, 0).u(3, 0).u(1, 0).u(19, rng.randint(0, 0x7FFFF))
+        return b
+
+    def static(self):
+        b = Bits()
+        b.u(6, 5).u(2, 0).u(30, self.mmsi).u(2, 0).u(30, 9000000 + self.mmsi % 999999)
+        b.text(7, f"F{self.mmsi % 100000}")
+        b.text(20, self.name)
+        b.u(8, rng.choice([30, 36, 37, 60, 70, 80]))
+        b.u(9, 12).u(9, 8).u(6, 3).u(6, 3).u(4, 1)
+        b.u(4, 7).u(5, 15).u(5, 12).u(6, 30).u(8, 25)
+        b.text(20, "LORIENT")
+        b.u(1, 0).u(1, 0)
+        return b
+
+    def static24(self, part):
+        b = Bits().u(6, 24).u(2, 0).u(30, self.mmsi).u(2, part)
+        if part == 0:
+            b.text(20, self.name).u(8, 0)
+        else:
+            b.u(8, 37).text(3, "NAV").u(4, 1).u(20, self.mmsi % 1000000)
+            b.text(7, f"F{self.mmsi % 100000}")
+            b.u(9, 6).u(9, 4).u(6, 2).u(6, 2).u(6, 0)
+        return b
+
+    def extended19(self, t):
+        b = Bits().u(6, 19).u(2, 0).u(30, self.mmsi).u(8, 0)
+        b.u(10, round(self.sog * 10)).u(1, 1)
+        b.s(28, ais_lon(self.lon)).s(27, ais_lat(self.lat))
+        b.u(12, round(self.cog * 10) % 3600).u(9, self.hdg).u(6, t % 60).u(4, 0)
+        b.text(20, self.name).u(8, 37)
+        b.u(9, 6).u(9, 4).u(6, 2).u(6, 2).u(4, 1).u(1, 0).u(1, 1).u(1, 0).u(4, 0)
+        return b
+
+    def long_range27(self):
+        b = Bits().u(6, 27).u(2, 3).u(30, self.mmsi).u(1, 0).u(1, 0)
+        b.u(4, 0 if self.sog > 0.5 else 5)
+        b.s(18, round(self.lon * 600)).s(17, round(self.lat * 600))
+        b.u(6, min(62, round(self.sog))).u(9, round(self.cog) % 360).u(1, 0).u(1, 0)
+        return b
+
+
+def base_station(t, lat, lon):
+    b = Bits().u(6, 4).u(2, 0).u(30, 2275300)
+    b.u(14, 2026).u(4, 7).u(5, 15).u(5, 10).u(6, (t // 60) % 60).u(6, t % 60)
+    b.u(1, 1).s(28, ais_lon(lon)).s(27, ais_lat(lat)).u(4, 7).u(10, 0).u(1, 0)
+    b.u(19, rng.randint(0, 0x7FFFF))
+    return b
+
+
+def sar_aircraft(t, lat, lon):
+    b = Bits().u(6, 9).u(2, 0).u(30, 111227501).u(12, 300).u(10, 120).u(1, 1)
+    b.s(28, ais_lon(lon)).s(27, ais_lat(lat)).u(12, 900).u(6, t % 60).u(8, 0)
+    b.u(1, 0).u(3, 0).u(1, 0).u(1, 0).u(20, 0)
+    return b
+
+
+def aid_to_navigation(lat, lon):
+    b = Bits().u(6, 21).u(2, 0).u(30, 992271001).u(5, 14)
+    b.text(20, "PEN MEN CARDINAL N").u(1, 1)
+    b.s(28, ais_lon(lon)).s(27, ais_lat(lat))
+    b.u(9, 0).u(9, 0).u(6, 0).u(6, 0).u(4, 7).u(6, 60).u(1, 0).u(8, 0)
+    b.u(1, 0).u(1, 1).u(1, 0).u(1, 0)
+    return b
+
+
+def safety_broadcast():
+    b = Bits().u(6, 14).u(2, 0).u(30, 2275300).u(2, 0)
+    b.text(30, "NAV WARNING BUOY ADRIFT")
+    return b
+
+
+# ── Simulation ────────────────────────────────────────────────────────────────
+
+def main():
+    lat, lon = 47.6453, -3.4812
+    sog, cog = 6.2, 215.0
+    twd, tws = 262.0, 12.0
+    depth    = 18.0
+    trip, total = 12.3, 1834.2
+    fleet = [Vessel(i, lat, lon) for i in range(FLEET)]
+
+    mixed, ais = [], []
+    seq = 0
+
+    def emit(line, is_ais=False):
+        mixed.append(line)
+        if is_ais:
+            ais.append(line)
+
+    def bad():
+        return rng.random() < 0.01
+
+    for t in range(SECONDS):
+        hh, mm, ss = 10, 30 + t // 60, t % 60
+        utc = f"{hh:02d}{mm:02d}{ss:02d}.00"
+        la, ns = fmt_lat(lat)
+        lo, ew = fmt_lon(lon)
+
+        emit(sentence("$", f"GPGGA,{utc},{la},{ns},{lo},{ew},1,{rng.randint(7, 12):02d},"
+                           f"{rng.uniform(0.7, 1.4):.1f},12.3,M,47.0,M,,", bad()))
+        emit(sentence("$", f"GPRMC,{utc},A,{la},{ns},{lo},{ew},{sog:.1f},{cog:.1f},150726,1.2,W,A",
+                      bad()))
+        emit(sentence("$", f"GPGLL,{la},{ns},{lo},{ew},{utc},A,A", bad()))
+        emit(sentence("$", f"GPVTG,{cog:.1f},T,{cog + 1.2:.1f},M,{sog:.1f},N,{sog * 1.852:.1f},K,A",
+                      bad()))
+        emit(sentence("$", f"GNZDA,{utc},15,07,2026,00,00", bad()))
+
+        for k in range(5):
+            hdg = (cog + 2.0 + rng.uniform(-3, 3)) % 360
+            emit(sentence("$", f"HEHDT,{hdg:.1f},T", bad()))
+            emit(sentence("$", f"HCHDM,{(hdg + 1.2) % 360:.1f},M", bad()))
+            awa = (twd - hdg + rng.uniform(-5, 5)) % 360
+            emit(sentence("$", f"WIMWV,{awa:05.1f},R,{tws * 1.3 + rng.uniform(-1, 1):.1f},N,A",
+                          bad()))
+            if k % 2 == 0:
+                stw = sog - 0.3 + rng.uniform(-0.2, 0.2)
+                emit(sentence("$", f"VWVHW,{hdg:.1f},T,{(hdg + 1.2) % 360:.1f},M,{stw:.1f},N,"
+                                   f"{stw * 1.852:.1f},K", bad()))
+
+            # AIS traffic: dual-channel receiver, bursts of position reports
+            for _ in range(rng.randint(1, 3)):
+                v = rng.choice(fleet)
+                ch = rng.choice("AB")
+                for line in ais_lines(v.position(t), ch, 0, bad()):
+                    emit(line, True)
+
+        emit(sentence("$", f"WIMWV,{(twd - cog) % 360:05.1f},T,{tws:.1f},N,A", bad()))
+        emit(sentence("$", f"WIMWD,{twd:.1f},T,{twd + 1.2:.1f},M,{tws:.1f},N,{tws * 0.514:.1f},M",
+                      bad()))
+        emit(sentence("$", f"SDDPT,{depth:.1f},0.5", bad()))
+        emit(sentence("$", f"SDDBT,{depth * 3.28:.1f},f,{depth:.1f},M,{depth * 0.547:.1f},F", bad()))
+        emit(sentence("$", f"YXMTW,{17.5 + rng.uniform(-0.2, 0.2):.1f},C", bad()))
+        emit(sentence("$", f"VWVLW,{total:.1f},N,{trip:.1f},N", bad()))
+
+        # Static data — type 5 parts are interleaved between channels A and B
+        # every few seconds, as a dual-channel receiver emits them.
+        if t % 3 == 0:
+            a, b = rng.sample(fleet, 2)
+            seq = (seq % 9) + 1
+            la_ = ais_lines(a.static(), "A", seq)
+            seq = (seq % 9) + 1
+            lb_ = ais_lines(b.static(), "B", seq)
+            if t % 6 == 0:
+                order = [la_[0], lb_[0], la_[1], lb_[1]]
+            else:
+                order = la_ + lb_
+            for line in order:
+                emit(line, True)
+        if t % 4 == 1:
+            v = rng.choice([f for f in fleet if f.cls_b])
+            for part in (0, 1):
+                for line in ais_lines(v.static24(part), rng.choice("AB"), 0):
+                    emit(line, True)
+        if t % 10 == 2:
+            for line in ais_lines(base_station(t, 47.7300, -3.3600), "A", 0):
+                emit(line, True)
+        if t % 15 == 4:
+            v = rng.choice(fleet)
+            for line in ais_lines(v.extended19(t), "B", 0):
+                emit(line, True)
+        if t % 20 == 5:
+            for line in ais_lines(aid_to_navigation(47.6435, -3.5101), "A", 0):
+                emit(line, True)
+        if t % 30 == 7:
+            for line in ais_lines(sar_aircraft(t, 47.60, -3.30), "B", 0):
+                emit(line, True)
+            for line in ais_lines(safety_broadcast(), "A", 0):
+                emit(line, True)
+        if t % 12 == 9:
+            v = rng.choice(fleet)
+            for line in ais_lines(v.long_range27(), "B", 0):
+                emit(line, True)
+
+        # Advance own ship and fleet by one second
+        d = sog / 3600.0 / 60.0
+        lat += d * math.cos(math.radians(cog))
+        lon += d * math.sin(math.radians(cog)) / math.cos(math.radians(lat))
+        trip  += sog / 3600.0
+        total += sog / 3600.0
+        depth  = max(4.0, depth + rng.uniform(-0.3, 0.3))
+        cog    = (cog + rng.uniform(-0.5, 0.5)) % 360
+        for v in fleet:
+            v.step(1.0)
+
+    (OUT_DIR / "mixed.nmea").write_text("\r\n".join(mixed) + "\r\n")
+    (OUT_DIR / "ais.nmea").write_text("\r\n".join(ais) + "\r\n")
+
+    tws_cols = [4, 6, 8, 10, 12, 14, 16, 20, 25]
+    twa_rows = [0, 32, 36, 40, 45, 52, 60, 70, 80, 90, 100, 110, 120, 135, 150, 165, 180]
+    polar = ["TWA\\TWS\t" + "\t".join(str(c) for c in tws_cols)]
+    for twa in twa_rows:
+        row = [str(twa)]
+        for tws_ in tws_cols:
+            if twa < 32:
+                row.append("0")
+                continue
+            v = min(8.2, 2.3 * math.log1p(tws_) * math.sin(math.radians(min(twa, 110)) * 0.9 + 0.25))
+            row.append(f"{v:.2f}")
+        polar.append("\t".join(row))
+    (OUT_DIR / "sample.pol").write_text("\n".join(polar) + "\n")
+
+    print(f"mixed.nmea: {len(mixed)} lines, ais.nmea: {len(ais)} lines")
+
+
+if __name__ == "__main__":
+    main()
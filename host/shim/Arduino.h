@@ -0,0 +1,53 @@
+#pragma once
+
+/**
+ * @file Arduino.h
+ * @brief Host (Linux) stand-in for the ESP32 Arduino core.
+ *
+ * Only what the parsing / state core in src/ actually touches is provided:
+ * timing (millis, micros, delay), the Arduino String class, a stdout-backed
+ * Serial object and the usual math helpers.  Nothing here is used by the
+ * firmware build — PlatformIO never sees the host/ directory.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+#include "WString.h"
+
+#ifndef PI
+#define PI          3.1415926535897932384626433832795
+#endif
+#define DEG_TO_RAD  0.017453292519943295769236907684886
+#define RAD_TO_DEG  57.295779513082320876798154814105
+
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+using std::min;
+using std::max;
+
+uint32_t millis();
+uint32_t micros();
+void     delay(uint32_t ms);
+
+/** Host-only: hold millis() at its current value (true) or let it run again. */
+void     hostFreezeMillis(bool freeze);
+/** Host-only: move millis() forward by @p ms, frozen or not (timeouts without waiting). */
+void     hostAdvanceMillis(uint32_t ms);
+
+/** Serial port replacement — everything goes to stdout. */
+class HostSerial {
+public:
+    void   begin(unsigned long) {}
+    size_t print(const char* s);
+    size_t println(const char* s = "");
+    size_t printf(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+};
+
+extern HostSerial Serial;
+extern HostSerial Serial0;
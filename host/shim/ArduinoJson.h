@@ -0,0 +1,12 @@
+#pragma once
+
+/**
+ * @file ArduinoJson.h
+ * @brief Declaration-only stand-in so boat_state.h parses on the host.
+ *
+ * JSON serialization lives in src/boat_state_json.cpp, which the host build
+ * does not compile.
+ */
+
+class JsonObject;
+class JsonArray;
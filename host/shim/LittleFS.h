@@ -0,0 +1,42 @@
+#pragma once
+
+/**
+ * @file LittleFS.h
+ * @brief Host stand-in for the ESP32 LittleFS object.
+ *
+ * Paths are resolved relative to a root directory on the host filesystem
+ * (current directory by default, see LittleFSHost::setRoot()).  Only the
+ * read-side API used by PolarData is provided.
+ */
+
+#include <stdio.h>
+#include <stddef.h>
+#include <string>
+
+class File {
+public:
+    File() : fp(nullptr), sz(0) {}
+    File(FILE* f, size_t size) : fp(f), sz(size) {}
+
+    explicit operator bool() const { return fp != nullptr; }
+    size_t size() const { return sz; }
+    size_t readBytes(char* buf, size_t len) { return fp ? fread(buf, 1, len, fp) : 0; }
+    void   close() { if (fp) { fclose(fp); fp = nullptr; } }
+
+private:
+    FILE*  fp;
+    size_t sz;
+};
+
+class LittleFSHost {
+public:
+    void setRoot(const char* dir) { root = dir ? dir : "."; }
+    bool exists(const char* path);
+    File open(const char* path, const char* mode = "r");
+
+private:
+    std::string root = ".";
+    std::string resolve(const char* path) const { return root + path; }
+};
+
+extern LittleFSHost LittleFS;
@@ -0,0 +1,73 @@
+#pragma once
+
+/**
+ * @file WString.h
+ * @brief Minimal Arduino String for the host build, backed by std::string.
+ *
+ * Heap behaviour differs from the ESP32 core (SSO size, growth policy) but
+ * an allocation still shows up as an allocation in the benchmark counters.
+ */
+
+#include <stdint.h>
+#include <string>
+
+class String {
+public:
+    String() {}
+    String(const char* s) : s_(s ? s : "") {}
+    String(const std::string& s) : s_(s) {}
+    String(char c) : s_(1, c) {}
+    explicit String(int v)           : s_(std::to_string(v)) {}
+    explicit String(unsigned int v)  : s_(std::to_string(v)) {}
+    explicit String(long v)          : s_(std::to_string(v)) {}
+    explicit String(unsigned long v) : s_(std::to_string(v)) {}
+    String(float v, unsigned int decimals = 2)  { fromDouble(v, decimals); }
+    String(double v, unsigned int decimals = 2) { fromDouble(v, decimals); }
+
+    const char*  c_str()   const { return s_.c_str(); }
+    unsigned int length()  const { return (unsigned int)s_.size(); }
+    bool         isEmpty() const { return s_.empty(); }
+    char operator[](unsigned int i) const { return i < s_.size() ? s_[i] : '\0'; }
+
+    String& operator+=(const String& o) { s_ += o.s_; return *this; }
+    String& operator+=(const char* o)   { if (o) s_ += o; return *this; }
+    String& operator+=(char c)          { s_ += c; return *this; }
+
+    friend String operator+(const String& a, const String& b) { return String(a.s_ + b.s_); }
+    friend String operator+(const String& a, const char* b)   { return String(a.s_ + (b ? b : "")); }
+    friend String operator+(const char* a, const String& b)   { return String(std::string(a ? a : "") + b.s_); }
+
+    bool operator==(const String& o) const { return s_ == o.s_; }
+    bool operator==(const char* o)   const { return o && s_ == o; }
+    bool operator!=(const String& o) const { return s_ != o.s_; }
+    bool operator!=(const char* o)   const { return !(*this == o); }
+
+    bool equals(const char* o)     const { return *this == o; }
+    bool startsWith(const char* p) const { return p && s_.compare(0, strlen_(p), p) == 0; }
+    int  indexOf(char c)           const { size_t p = s_.find(c); return p == std::string::npos ? -1 : (int)p; }
+    int  indexOf(const char* t)    const { size_t p = s_.find(t); return p == std::string::npos ? -1 : (int)p; }
+    int  lastIndexOf(char c)       const { size_t p = s_.rfind(c); return p == std::string::npos ? -1 : (int)p; }
+
+    String substring(unsigned int from) const {
+        return from >= s_.size() ? String() : String(s_.substr(from));
+    }
+    String substring(unsigned int from, unsigned int to) const {
+        if (from >= s_.size() || to <= from) return String();
+        return String(s_.substr(from, to - from));
+    }
+
+    void replace(char from, char to) {
+        for (size_t i = 0; i < s_.size(); i++) if (s_[i] == from) s_[i] = to;
+    }
+    void toLowerCase() {
+        for (size_t i = 0; i < s_.size(); i++) {
+            if (s_[i] >= 'A' && s_[i] <= 'Z') s_[i] = (char)(s_[i] - 'A' + 'a');
+        }
+    }
+
+private:
+    std::string s_;
+
+    static size_t strlen_(const char* p) { size_t n = 0; while (p[n]) n++; return n; }
+    void fromDouble(double v, unsigned int decimals);
+};
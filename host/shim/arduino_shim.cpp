@@ -0,0 +1,96 @@
+/**
+ * @file arduino_shim.cpp
+ * @brief Host implementations of the Arduino core functions in Arduino.h,
+ *        WString.h and LittleFS.h.
+ */
+
+#include "Arduino.h"
+#include "LittleFS.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <stdarg.h>
+#include <sys/stat.h>
+
+HostSerial   Serial;
+HostSerial   Serial0;
+LittleFSHost LittleFS;
+
+static const std::chrono::steady_clock::time_point bootTime = std::chrono::steady_clock::now();
+
+static std::atomic<int64_t>  frozenMillis(-1);
+static std::atomic<uint32_t> millisOffset(0);
+
+uint32_t millis() {
+    int64_t frozen = frozenMillis.load(std::memory_order_relaxed);
+    if (frozen >= 0) return (uint32_t)frozen;
+    return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - bootTime).count() + millisOffset.load(std::memory_order_relaxed);
+}
+
+void hostFreezeMillis(bool freeze) {
+    frozenMillis.store(-1, std::memory_order_relaxed);
+    if (freeze) frozenMillis.store(millis(), std::memory_order_relaxed);
+}
+
+void hostAdvanceMillis(uint32_t ms) {
+    millisOffset.fetch_add(ms, std::memory_order_relaxed);
+    int64_t frozen = frozenMillis.load(std::memory_order_relaxed);
+    if (frozen >= 0) frozenMillis.store((uint32_t)(frozen + ms), std::memory_order_relaxed);
+}
+
+uint32_t micros() {
+    return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - bootTime).count();
+}
+
+void delay(uint32_t ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+// ── Serial ────────────────────────────────────────────────────────────────────
+
+size_t HostSerial::print(const char* s) {
+    if (!s) return 0;
+    fputs(s, stdout);
+    return strlen(s);
+}
+
+size_t HostSerial::println(const char* s) {
+    size_t n = print(s);
+    fputc('\n', stdout);
+    return n + 1;
+}
+
+size_t HostSerial::printf(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int n = vprintf(fmt, args);
+    va_end(args);
+    return n > 0 ? (size_t)n : 0;
+}
+
+// ── String ────────────────────────────────────────────────────────────────────
+
+void String::fromDouble(double v, unsigned int decimals) {
+    char buf[48];
+    snprintf(buf, sizeof(buf), "%.*f", (int)decimals, v);
+    s_ = buf;
+}
+
+// ── LittleFS ──────────────────────────────────────────────────────────────────
+
+bool LittleFSHost::exists(const char* path) {
+    struct stat st;
+    return path && stat(resolve(path).c_str(), &st) == 0;
+}
+
+File LittleFSHost::open(const char* path, const char* mode) {
+    if (!path) return File();
+    std::string full = resolve(path);
+    struct stat st;
+    size_t size = (stat(full.c_str(), &st) == 0) ? (size_t)st.st_size : 0;
+    FILE* fp = fopen(full.c_str(), mode);
+    return fp ? File(fp, size) : File();
+}
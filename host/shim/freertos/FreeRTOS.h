@@ -0,0 +1,28 @@
+#pragma once
+
+/**
+ * @file FreeRTOS.h
+ * @brief Host stand-in for the FreeRTOS kernel types used by src/.
+ *
+ * One tick is one millisecond (configTICK_RATE_HZ = 1000), matching the
+ * ESP32 Arduino default.  Semaphores and queues are implemented on top of
+ * std::mutex / std::condition_variable in freertos_shim.cpp.
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint32_t TickType_t;
+typedef int      BaseType_t;
+typedef unsigned UBaseType_t;
+
+#define configTICK_RATE_HZ      1000
+#define portMAX_DELAY           ((TickType_t)0xFFFFFFFFUL)
+#define portTICK_PERIOD_MS      ((TickType_t)1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(ms))
+#define pdTICKS_TO_MS(ticks)    ((uint32_t)(ticks))
+
+#define pdFALSE                 ((BaseType_t)0)
+#define pdTRUE                  ((BaseType_t)1)
+#define pdFAIL                  pdFALSE
+#define pdPASS                  pdTRUE
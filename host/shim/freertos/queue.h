@@ -0,0 +1,14 @@
+#pragma once
+
+#include "FreeRTOS.h"
+
+struct HostQueue;
+typedef HostQueue* QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+BaseType_t    xQueueSend(QueueHandle_t q, const void* item, TickType_t ticks);
+BaseType_t    xQueueReceive(QueueHandle_t q, void* item, TickType_t ticks);
+UBaseType_t   uxQueueMessagesWaiting(QueueHandle_t q);
+void          vQueueDelete(QueueHandle_t q);
+
+#define xQueueSendToBack(q, item, ticks) xQueueSend((q), (item), (ticks))
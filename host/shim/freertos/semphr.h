@@ -0,0 +1,15 @@
+#pragma once
+
+#include "FreeRTOS.h"
+#include <stdint.h>
+
+struct HostSemaphore;
+typedef HostSemaphore* SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex();
+BaseType_t        xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
+BaseType_t        xSemaphoreGive(SemaphoreHandle_t sem);
+void              vSemaphoreDelete(SemaphoreHandle_t sem);
+
+/** Host-only: number of xSemaphoreTake() calls so far (lock-traffic metric). */
+uint64_t hostSemaphoreTakeCount();
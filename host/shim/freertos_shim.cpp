@@ -0,0 +1,128 @@
+/**
+ * @file freertos_shim.cpp
+ * @brief Host implementations of the FreeRTOS semaphore / queue / task API.
+ *
+ * Mutexes map onto std::timed_mutex; queues are a fixed-capacity ring of
+ * fixed-size items guarded by a mutex and two condition variables, which is
+ * close enough to the kernel's copy-in / copy-out semantics for profiling.
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <string.h>
+
+// ── Semaphores ────────────────────────────────────────────────────────────────
+
+struct HostSemaphore {
+    std::timed_mutex m;
+};
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+    return new HostSemaphore();
+}
+
+static std::atomic<uint64_t> s_takeCount(0);
+
+uint64_t hostSemaphoreTakeCount() { return s_takeCount.load(std::memory_order_relaxed); }
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+    if (!sem) return pdFALSE;
+    s_takeCount.fetch_add(1, std::memory_order_relaxed);
+    if (ticks == portMAX_DELAY) {
+        sem->m.lock();
+        return pdTRUE;
+    }
+    return sem->m.try_lock_for(std::chrono::milliseconds(ticks)) ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    if (!sem) return pdFALSE;
+    sem->m.unlock();
+    return pdTRUE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) {
+    delete sem;
+}
+
+// ── Queues ────────────────────────────────────────────────────────────────────
+
+struct HostQueue {
+    std::mutex              m;
+    std::condition_variable notEmpty;
+    std::condition_variable notFull;
+    std::vector<uint8_t>    storage;
+    UBaseType_t             length;
+    UBaseType_t             itemSize;
+    UBaseType_t             head  = 0;
+    UBaseType_t             count = 0;
+};
+
+template <typename Pred>
+static bool waitFor(std::condition_variable& cv, std::unique_lock<std::mutex>& lk,
+                    TickType_t ticks, Pred pred) {
+    if (ticks == portMAX_DELAY) {
+        cv.wait(lk, pred);
+        return true;
+    }
+    return cv.wait_for(lk, std::chrono::milliseconds(ticks), pred);
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+    if (length == 0 || itemSize == 0) return nullptr;
+    HostQueue* q = new HostQueue();
+    q->length   = length;
+    q->itemSize = itemSize;
+    q->storage.resize((size_t)length * itemSize);
+    return q;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void* item, TickType_t ticks) {
+    if (!q) return pdFALSE;
+    std::unique_lock<std::mutex> lk(q->m);
+    if (!waitFor(q->notFull, lk, ticks, [q] { return q->count < q->length; })) return pdFALSE;
+    UBaseType_t tail = (q->head + q->count) % q->length;
+    memcpy(&q->storage[(size_t)tail * q->itemSize], item, q->itemSize);
+    q->count++;
+    lk.unlock();
+    q->notEmpty.notify_one();
+    return pdTRUE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void* item, TickType_t ticks) {
+    if (!q) return pdFALSE;
+    std::unique_lock<std::mutex> lk(q->m);
+    if (!waitFor(q->notEmpty, lk, ticks, [q] { return q->count > 0; })) return pdFALSE;
+    memcpy(item, &q->storage[(size_t)q->head * q->itemSize], q->itemSize);
+    q->head = (q->head + 1) % q->length;
+    q->count--;
+    lk.unlock();
+    q->notFull.notify_one();
+    return pdTRUE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+    if (!q) return 0;
+    std::lock_guard<std::mutex> lk(q->m);
+    return q->count;
+}
+
+void vQueueDelete(QueueHandle_t q) {
+    delete q;
+}
+
+// ── Tasks ─────────────────────────────────────────────────────────────────────
+
+void vTaskDelay(TickType_t ticks) {
+    if (ticks == 0) std::this_thread::yield();
+    else            std::this_thread::sleep_for(std::chrono::milliseconds(ticks));
+}
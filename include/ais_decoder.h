@@ -0,0 +1,123 @@
+#ifndef AIS_DECODER_H
+#define AIS_DECODER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @file ais_decoder.h
+ * @brief Table-driven AIS (ITU-R M.1371) message decoder.
+ *
+ * Each supported message type is described by a list of field descriptors
+ * (bit offset, width, signedness, scale, not-available sentinel) that a
+ * single generic loop walks.  Bits are read through a 64-bit window loaded
+ * once per field, so a field costs the same whatever its width.
+ *
+ * Supported: 1/2/3 (Class A position), 4 (base station), 5 (static and
+ * voyage), 9 (SAR aircraft), 14 (safety broadcast), 18 (Class B position),
+ * 19 (extended Class B), 21 (aid to navigation), 24 A/B (Class B static),
+ * 27 (long-range position).
+ *
+ * No BoatState dependency: NMEAParser maps the decoded AISMessage onto
+ * the target table.
+ */
+
+// Longest payload we reassemble: 5 sentences × 64 armoured chars × 6 bits
+// (AIS_REASSEMBLY_MAX_PARTS × AIS_FRAGMENT_MAX_CHARS, see ais_reassembly.h)
+#define AIS_MAX_PAYLOAD_BITS  (5 * 64 * 6)
+
+// The word-at-a-time reader may load up to 8 bytes past the last field:
+// size bit buffers with AIS_BITBUF_BYTES(), never exactly.
+#define AIS_BITBUF_BYTES(bits)  (((bits) + 7) / 8 + 8)
+
+#define AIS_TEXT_MAX  161     ///< Type 14: 968 bits of 6-bit text
+
+/** Numeric fields; AISMessage::value[] is indexed by these. */
+enum AISField : uint8_t {
+    AIS_SOG = 0,      ///< kn
+    AIS_COG,          ///< deg
+    AIS_HEADING,      ///< deg true
+    AIS_LAT,          ///< deg
+    AIS_LON,          ///< deg
+    AIS_ALTITUDE,     ///< m (type 9)
+    AIS_SHIP_TYPE,    ///< ITU ship and cargo type
+    AIS_PART,         ///< type 24 part number (0 = A, 1 = B)
+    AIS_FIELD_COUNT,
+
+    // Text fields: decoded into the AISMessage character arrays
+    AIS_NAME = 32,    ///< Vessel / aid-to-navigation name
+    AIS_CALLSIGN,
+    AIS_TEXT          ///< Safety-related broadcast text
+};
+
+/** Field encoding in the bit stream. */
+enum AISFieldKind : uint8_t {
+    AIS_UNSIGNED,
+    AIS_SIGNED,       ///< two's complement
+    AIS_6BIT_TEXT     ///< width 0 = up to the end of the message
+};
+
+#define AIS_NO_SENTINEL  INT32_MIN
+
+/** One field of a message layout. */
+struct AISFieldDesc {
+    uint8_t  field;       ///< AISField
+    uint8_t  kind;        ///< AISFieldKind
+    uint16_t offset;      ///< First bit (0 = MSB of the first payload char)
+    uint16_t width;       ///< Bits
+    float    scale;       ///< value = raw × scale
+    int32_t  na;          ///< Raw "not available" value, or AIS_NO_SENTINEL
+};
+
+/** Decoded message.  A field is present when has() is true. */
+struct AISMessage {
+    uint8_t  type;
+    uint8_t  repeat;
+    uint32_t mmsi;
+    uint32_t valid;                     ///< 1 << AISField for numeric fields present
+    float    value[AIS_FIELD_COUNT];
+    char     name[21];                  ///< "" when absent, padding trimmed
+    char     callsign[8];
+    char     text[AIS_TEXT_MAX + 1];
+
+    bool  has(AISField f) const { return valid & (1UL << f); }
+    float get(AISField f, float fallback = 0.0f) const { return has(f) ? value[f] : fallback; }
+    bool  hasPosition() const { return has(AIS_LAT) && has(AIS_LON); }
+};
+
+/**
+ * @brief Convert armoured 6-bit ASCII payload characters into packed bits.
+ *
+ * @param payload  Payload characters (NMEA field 5, not NUL-terminated)
+ * @param len      Number of characters
+ * @param out      Destination, at least AIS_BITBUF_BYTES(len * 6) bytes
+ * @param outSize  Size of @p out in bytes
+ * @return         Number of payload bits written
+ */
+size_t aisUnarmor(const char* payload, size_t len, uint8_t* out, size_t outSize);
+
+/**
+ * @brief Read @p width (1–32) bits MSB-first starting at bit @p start.
+ *
+ * @p bits must have the 8 bytes of slack that AIS_BITBUF_BYTES() reserves.
+ */
+static inline uint32_t aisBits(const uint8_t* bits, unsigned start, unsigned width) {
+    const uint8_t* p = bits + (start >> 3);
+    uint64_t w = ((uint64_t)p[0] << 56) | ((uint64_t)p[1] << 48) |
+                 ((uint64_t)p[2] << 40) | ((uint64_t)p[3] << 32) |
+                 ((uint64_t)p[4] << 24);
+    return (uint32_t)((w << (start & 7)) >> (64 - width));
+}
+
+/**
+ * @brief Decode a reassembled message.
+ * @return false for unsupported types or a payload shorter than the
+ *         message header; fields past the end of a short payload are
+ *         simply left absent.
+ */
+bool aisDecode(const uint8_t* bits, size_t bitLen, AISMessage& out);
+
+/** True for the message types aisDecode() understands. */
+bool aisIsSupported(uint8_t type);
+
+#endif // AIS_DECODER_H
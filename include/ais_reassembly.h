@@ -0,0 +1,107 @@
+#ifndef AIS_REASSEMBLY_H
+#define AIS_REASSEMBLY_H
+
+#include <Arduino.h>
+
+/**
+ * @file ais_reassembly.h
+ * @brief Multi-sentence AIS (!xxVDM / !xxVDO) reassembly pool.
+ *
+ * Fragments are grouped by (talker, sequential message id, channel), so
+ * a dual-channel receiver interleaving type 5 parts from channels A and B
+ * no longer makes the two messages destroy each other.  Parts may arrive
+ * in any order; a slot not completed within AIS_REASSEMBLY_TIMEOUT_MS is
+ * recycled and its fragments counted as expired.
+ */
+
+// Messages that can be in flight at once.  Two channels rarely have more
+// than one multi-sentence message each outstanding; the rest is headroom.
+#ifndef AIS_REASSEMBLY_SLOTS
+#define AIS_REASSEMBLY_SLOTS       4
+#endif
+
+// IEC 61162-1 allows up to 9 sentences, but no ITU-R M.1371 message needs
+// more than 5 (type 26 with a full binary payload).
+#define AIS_REASSEMBLY_MAX_PARTS   5
+
+// A fragment's payload field; an 82-char sentence leaves at most 63.
+#define AIS_FRAGMENT_MAX_CHARS     64
+
+// Fragments of one message are transmitted back to back: a slot still
+// incomplete after this long will never complete.
+#ifndef AIS_REASSEMBLY_TIMEOUT_MS
+#define AIS_REASSEMBLY_TIMEOUT_MS  2000
+#endif
+
+/** One sentence of a multi-sentence message, as split by parseAIVDM(). */
+struct AISFragment {
+    char        talker[2];   ///< "AI", "AB", "BS"...
+    char        seqId;       ///< Sequential message id, '\0' when empty
+    char        channel;     ///< 'A' / 'B' (or '1' / '2'), '\0' when empty
+    uint8_t     total;       ///< Sentences in the message
+    uint8_t     num;         ///< This sentence, 1-based
+    const char* payload;     ///< Armoured payload characters, not NUL-terminated
+    uint8_t     len;
+    uint8_t     fillBits;    ///< Only meaningful on the last sentence
+};
+
+/**
+ * @brief Fixed pool of reassembly slots, no heap allocation.
+ *
+ * Not thread-safe: owned by NMEAParser, which runs on the processor task.
+ */
+class AISReassembler {
+public:
+    AISReassembler();
+
+    /**
+     * @brief Add one fragment.
+     * @return true when @p frag completed a message; message(), messageLen()
+     *         and messageFillBits() are then valid until the next add().
+     */
+    bool add(const AISFragment& frag, unsigned long now);
+
+    /** Recycle slots older than AIS_REASSEMBLY_TIMEOUT_MS (add() does this too). */
+    void expire(unsigned long now);
+
+    const char* message()         const { return assembled; }
+    size_t      messageLen()      const { return assembledLen; }
+    uint8_t     messageFillBits() const { return assembledFill; }
+
+    uint32_t fragments() const { return fragmentCount; }  ///< Fragments offered to add()
+    uint32_t completed() const { return completedCount; } ///< Messages reassembled
+    uint32_t dropped()   const { return droppedCount; }   ///< Malformed, duplicate or evicted fragments
+    uint32_t expired()   const { return expiredCount; }   ///< Fragments of messages that timed out
+    uint8_t  inFlight()  const;
+
+private:
+    struct Slot {
+        bool          active;
+        char          talker[2];
+        char          seqId;
+        char          channel;
+        uint8_t       total;
+        uint8_t       received;     ///< Bit n-1 set when part n is stored
+        uint8_t       fillBits;
+        unsigned long started;
+        uint8_t       partLen[AIS_REASSEMBLY_MAX_PARTS];
+        char          part[AIS_REASSEMBLY_MAX_PARTS][AIS_FRAGMENT_MAX_CHARS];
+    };
+
+    Slot*   findSlot(const AISFragment& frag);
+    Slot*   claimSlot();
+    void    release(Slot& s, uint32_t& counter);
+    static uint8_t partCount(uint8_t mask);
+
+    Slot     slots[AIS_REASSEMBLY_SLOTS];
+    char     assembled[AIS_REASSEMBLY_MAX_PARTS * AIS_FRAGMENT_MAX_CHARS];
+    size_t   assembledLen;
+    uint8_t  assembledFill;
+
+    uint32_t fragmentCount;
+    uint32_t completedCount;
+    uint32_t droppedCount;
+    uint32_t expiredCount;
+};
+
+#endif // AIS_REASSEMBLY_H
@@ -0,0 +1,132 @@
+#ifndef AIS_TABLE_H
+#define AIS_TABLE_H
+
+#include <Arduino.h>
+
+// Timeout for AIS targets in milliseconds
+#define DATA_TIMEOUT_AIS     60000  // 60 seconds for AIS
+
+// Maximum AIS targets to keep in memory.  Override per board from
+// platformio.ini (-DAIS_MAX_TARGETS=...); on PSRAM boards the table lives
+// in PSRAM, so a few hundred targets cost no internal RAM.
+#ifndef AIS_MAX_TARGETS
+#define AIS_MAX_TARGETS 64
+#endif
+
+// Targets whose closest approach is within this horizon rank by CPA
+// rather than by current distance when the table has to evict.
+#define AIS_TCPA_HORIZON_MIN 30.0f
+
+/**
+ * AIS Target structure
+ */
+struct AISTarget {
+    uint32_t mmsi;
+    char name[21];          // 20 six-bit chars + NUL, "" until type 5/19/21/24 seen
+    char callsign[8];       // "" until type 5/24B seen
+    uint8_t shipType;       // ITU ship and cargo type, 0 = unknown
+    uint8_t msgType;        // Last position message type (1-3, 4, 9, 18, 19, 21, 27)
+    bool hasProximity;      // distance/bearing/cpa/tcpa computed from own fix
+    float lat;
+    float lon;
+    float cog;
+    float sog;
+    float heading;
+    float distance;         // Distance to target (nm)
+    float bearing;          // Bearing to target (deg)
+    float cpa;             // Closest Point of Approach (nm)
+    float tcpa;            // Time to CPA (minutes)
+    unsigned long timestamp;
+
+    AISTarget() : mmsi(0), shipType(0), msgType(0), hasProximity(false),
+                  lat(0), lon(0), cog(0), sog(0),
+                  heading(0), distance(0), bearing(0), cpa(0), tcpa(0),
+                  timestamp(0) {
+        name[0] = '\0';
+        callsign[0] = '\0';
+    }
+};
+
+/**
+ * @brief Fixed-capacity AIS target store with an MMSI hash index.
+ *
+ * Targets are kept densely packed in slots[0..size()) so a reader can copy
+ * the live set with one memcpy.  An open-addressed (linear probing) index
+ * maps MMSI → slot; removal swaps the last slot into the hole and uses
+ * backward-shift deletion, so there are no tombstones to clean up.
+ *
+ * When the table is full a new vessel replaces, in order of preference,
+ * the oldest stale target, then the least important one: targets on a
+ * closing course rank by CPA, others by distance, targets without a
+ * computed position rank last.  A newcomer less important than every
+ * current target is dropped and counted in rejected().
+ *
+ * Not thread-safe: BoatState serialises writers and publishes the slots
+ * to readers through its seqlock.
+ */
+class AISTargetTable {
+public:
+    AISTargetTable();
+    ~AISTargetTable();
+
+    /**
+     * @brief Allocate storage for @p capacity targets (PSRAM when available).
+     * @return false if the allocation failed; the table then stays empty.
+     */
+    bool begin(uint16_t capacity = AIS_MAX_TARGETS);
+
+    uint16_t capacity() const { return cap; }
+    uint16_t size()     const { return count; }
+
+    /** Live targets, densely packed: data()[0..size()). */
+    const AISTarget* data() const { return slots; }
+
+    AISTarget*       find(uint32_t mmsi);
+    const AISTarget* find(uint32_t mmsi) const;
+
+    /**
+     * @brief Insert or update a target.
+     *
+     * Static data (name, call sign, ship type) already known is kept when
+     * @p target does not carry it — position reports never do.
+     * @return false if the table is full and the target ranked below all others.
+     */
+    bool addOrUpdate(const AISTarget& target);
+
+    /**
+     * @brief Merge static data into a target, creating a position-less stub if needed.
+     * @param name, callsign  nullptr or "" = unchanged
+     * @param shipType        0 = unchanged
+     */
+    bool setStatic(uint32_t mmsi, const char* name, const char* callsign, uint8_t shipType);
+
+    /** @return number of targets removed. */
+    int removeStale(unsigned long timeout = DATA_TIMEOUT_AIS);
+
+    uint32_t evictions() const { return evicted; }   ///< Targets replaced by a newcomer
+    uint32_t rejected()  const { return dropped; }   ///< Newcomers that did not make it in
+
+private:
+    AISTarget* slots;
+    uint16_t*  index;       ///< slot + 1, 0 = empty bucket
+    uint16_t   cap;
+    uint16_t   count;
+    uint16_t   indexMask;
+    uint32_t   evicted;
+    uint32_t   dropped;
+
+    uint16_t home(uint32_t mmsi) const;
+    int      lookup(uint32_t mmsi) const;    ///< Bucket holding mmsi, or -1
+    void     indexInsert(uint32_t mmsi, uint16_t slot);
+    void     indexErase(int bucket);
+    void     removeAt(uint16_t slot);
+    AISTarget* insert(const AISTarget& target);
+
+    static float rank(const AISTarget& t);
+    int  pickVictim(const AISTarget& incoming, unsigned long now) const;
+
+    AISTargetTable(const AISTargetTable&);
+    AISTargetTable& operator=(const AISTargetTable&);
+};
+
+#endif // AIS_TABLE_H
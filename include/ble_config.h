@@ -8,7 +8,9 @@
 // ============================================================
 #define BLE_DEVICE_NAME         "MarineGateway"
 #define BLE_DEFAULT_PIN         "123456"
-#define BLE_UPDATE_INTERVAL_MS  1000    // 1 Hz update rate
+#define BLE_UPDATE_INTERVAL_MS  1000    // Admin data rate / idle wake-up period
+#define BLE_MIN_NOTIFY_INTERVAL_MS 200  // Coalescing window between change pushes (max 5 Hz)
+#define BLE_REFRESH_INTERVAL_MS 5000    // Full push so values that went stale get cleared
 
 // ============================================================
 // Service UUIDs  (custom base: 4D475743-xxxx-4E41-5649-474154494F4E)
@@ -130,7 +130,7 @@ public:
               WiFiManager*    wifiMgr    = nullptr);
     void start();
     void stop();
-    void update();
+    void update();                    ///< Push every characteristic now
 
     bool      isEnabled()           const { return config.enabled; }
     void      setEnabled(bool en);
@@ -188,8 +188,16 @@ private:
     uint32_t       connectedDevices;
 
     // ── FreeRTOS update task ────────────────────────────────────
+    // Woken by BoatState change notifications (task notification bits =
+    // BOAT_MASK() of the changed sections) instead of polling.
     TaskHandle_t   updateTaskHandle;
+    int            stateListenerId;
+    uint32_t       lastRefreshMs;
+    uint32_t       lastAdminMs;
     static void    updateTask(void* param);
+    static void    onStateChanged(uint32_t changed, void* ctx);
+
+    void push(uint32_t changed, bool admin);
 
     // ── Internal helpers ────────────────────────────────────────
     void setupSecurity();
@@ -0,0 +1,102 @@
+#ifndef BOAT_POLL_H
+#define BOAT_POLL_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <ESPAsyncWebServer.h>
+#include "config.h"
+#include "boat_state.h"
+
+class MetricsRegistry;
+
+/**
+ * @brief Conditional GET and long-poll for the boat data endpoints (/api/boat/*).
+ *
+ * Each endpoint reads a set of BoatState sections; their change stamp
+ * (BoatState::getChangeStamp()) versions the body.  Every 200 carries it as
+ * a weak ETag, W/"<boot>-<stamp>" — weak because the ages in the body keep
+ * counting while the data does not change — and as X-Generation.
+ *
+ *   - If-None-Match with the current tag → 304, nothing serialized.
+ *   - ?since=<X-Generation> → 304 if nothing changed, 200 otherwise.
+ *   - ?wait=<ms> with either of the above → the request is parked until one
+ *     of the sections changes (200) or the wait runs out (304), capped at
+ *     HTTP_LONGPOLL_MAX_WAIT_MS.  With HTTP_LONGPOLL_MAX requests already
+ *     parked the answer is 503 with Retry-After.
+ *
+ * handle() runs on the AsyncTCP task; poll() runs on the processor task
+ * after each drain of the sentence queue, so a parked request is answered
+ * on the wake that committed the change.  The slots are shared under a
+ * mutex; bodies are always rendered outside it.  A parked request is held
+ * through AsyncWebServerRequest::pause(): if the client goes away the
+ * weak pointer expires and the slot is dropped on the next poll().
+ */
+class BoatPoll {
+public:
+    /**
+     * @brief Send the 200 body of endpoint @p id, tagged with tag(response, @p stamp).
+     *
+     * Called on the AsyncTCP task for an immediate answer and on the
+     * processor task for a parked request that woke up.
+     */
+    typedef void (*Sender)(AsyncWebServerRequest* request, uint8_t id, uint32_t stamp, void* ctx);
+
+    BoatPoll(BoatState* state, Sender send, void* ctx);
+    ~BoatPoll();
+
+    /** Create the mutex and pick the boot id.  Once, before start. */
+    bool init();
+
+    /**
+     * @brief Answer a GET of endpoint @p id, whose body reads the sections in @p mask.
+     *
+     * Sends 304, parks the request, or calls the Sender right away.
+     */
+    void handle(AsyncWebServerRequest* request, uint8_t id, uint32_t mask);
+
+    /** Add ETag, X-Generation and Cache-Control: no-cache to a response. */
+    void tag(AsyncWebServerResponse* response, uint32_t stamp) const;
+
+    /** Answer the parked requests that changed or timed out (processor task, every wake). */
+    void poll();
+
+    size_t getParkedCount();
+
+    void registerMetrics(MetricsRegistry& reg);
+
+private:
+    struct Slot {
+        AsyncWebServerRequestPtr request;   // expired → the client went away
+        uint32_t mask;
+        uint32_t since;
+        uint32_t deadline;
+        uint8_t  id;
+        bool     used;
+    };
+
+    /** Quoted opaque tag, "<boot>-<stamp>", as If-None-Match carries it. */
+    void formatTag(char* out, size_t len, uint32_t stamp) const;
+    bool matchesTag(AsyncWebServerRequest* request, uint32_t stamp) const;
+    void sendNotModified(AsyncWebServerRequest* request, uint32_t stamp);
+
+    BoatState*        boatState;
+    Sender            send;
+    void*             ctx;
+    uint32_t          bootId;          ///< Keeps a tag from an earlier boot from matching
+    Slot              slots[HTTP_LONGPOLL_MAX];
+    volatile size_t   parked;
+    SemaphoreHandle_t slotsMutex;
+    bool              initialized;
+
+    // For /metrics
+    volatile uint32_t notModified;
+    volatile uint32_t wokeChanged;
+    volatile uint32_t wokeTimeout;
+    volatile uint32_t rejected;
+
+    BoatPoll(const BoatPoll&);
+    BoatPoll& operator=(const BoatPoll&);
+};
+
+#endif // BOAT_POLL_H
@@ -2,18 +2,18 @@
 #define BOAT_STATE_H
 
 #include "polar.h"
+#include "ais_table.h"
 #include <time.h>
 #include <Arduino.h>
 #include <ArduinoJson.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
+#include <atomic>
 
-// Timeout values in milliseconds
-#define DATA_TIMEOUT_DEFAULT 10000  // 10 seconds for most data
-#define DATA_TIMEOUT_AIS     60000  // 60 seconds for AIS
+class JsonWriter;
 
-// Maximum AIS targets to keep in memory
-#define MAX_AIS_TARGETS 20
+// Timeout values in milliseconds (AIS: see ais_table.h)
+#define DATA_TIMEOUT_DEFAULT 10000  // 10 seconds for most data
 
 /**
  * Structure for storing a single data point with timestamp and unit
@@ -97,15 +97,35 @@ struct GPSDateTime {
 
 /**
  * GPS Position structure
+ *
+ * lat/lon DataPoints carry a float for the generic consumers; latE7/lonE7
+ * keep the full fix resolution (1e-7 degree, ~1 cm) that a float cannot
+ * hold at these magnitudes.  Use latitude()/longitude() for output.
  */
 struct GPSPosition {
     DataPoint lat;
     DataPoint lon;
+    int32_t   latE7;
+    int32_t   lonE7;
+
+    GPSPosition() : latE7(0), lonE7(0) {}
     
     void set(float latitude, float longitude) {
         lat.set(latitude, "deg");
         lon.set(longitude, "deg");
+        latE7 = (int32_t)lround(latitude  * 1e7);
+        lonE7 = (int32_t)lround(longitude * 1e7);
+    }
+
+    void setE7(int32_t latitudeE7, int32_t longitudeE7) {
+        latE7 = latitudeE7;
+        lonE7 = longitudeE7;
+        lat.set((float)(latitudeE7  * 1e-7), "deg");
+        lon.set((float)(longitudeE7 * 1e-7), "deg");
     }
+
+    double latitude()  const { return latE7 * 1e-7; }
+    double longitude() const { return lonE7 * 1e-7; }
 };
 
 /**
@@ -180,18 +200,20 @@ struct CalculatedData {
  * Autopilot data structure (for future SeaTalk1 integration)
  */
 struct AutopilotData {
-    String mode;            // "standby", "auto", "wind", "track", "manual"
-    String status;          // "engaged", "standby", "alarm"
+    char mode[12];          // "standby", "auto", "wind", "track", "manual"
+    char status[12];        // "engaged", "standby", "alarm"
     DataPoint heading_target;
     DataPoint wind_angle_target;
     DataPoint rudder_angle;
     DataPoint locked_heading;
     DataPoint xte;          // Cross Track Error
-    String alarm;
+    char alarm[32];
     unsigned long timestamp;
     bool valid;
     
-    AutopilotData() : mode(""), status(""), alarm(""), timestamp(0), valid(false) {}
+    AutopilotData() : timestamp(0), valid(false) {
+        mode[0] = status[0] = alarm[0] = '\0';
+    }
     
     bool isStale(unsigned long timeout = DATA_TIMEOUT_DEFAULT) const {
         if (!valid) return true;
@@ -199,69 +221,6 @@ struct AutopilotData {
     }
 };
 
-/**
- * AIS Target structure
- */
-struct AISTarget {
-    uint32_t mmsi;
-    String name;
-    float lat;
-    float lon;
-    float cog;
-    float sog;
-    float heading;
-    float distance;         // Distance to target (nm)
-    float bearing;          // Bearing to target (deg)
-    float cpa;             // Closest Point of Approach (nm)
-    float tcpa;            // Time to CPA (minutes)
-    unsigned long timestamp;
-    
-    AISTarget() : mmsi(0), name(""), lat(0), lon(0), cog(0), sog(0), 
-                  heading(0), distance(0), bearing(0), cpa(0), tcpa(0), 
-                  timestamp(0) {}
-};
-
-/**
- * AIS data structure
- */
-struct AISData {
-    AISTarget targets[MAX_AIS_TARGETS];
-    int targetCount;
-    
-    AISData() : targetCount(0) {}
-    
-    void addOrUpdateTarget(const AISTarget& target) {
-        // Search for existing target with same MMSI
-        for (int i = 0; i < targetCount; i++) {
-            if (targets[i].mmsi == target.mmsi) {
-                targets[i] = target;
-                return;
-            }
-        }
-        
-        // Add new target if space available
-        if (targetCount < MAX_AIS_TARGETS) {
-            targets[targetCount++] = target;
-        }
-    }
-    
-    void removeStaleTargets(unsigned long timeout = DATA_TIMEOUT_AIS) {
-        unsigned long now = millis();
-        int writeIndex = 0;
-        
-        for (int i = 0; i < targetCount; i++) {
-            if ((now - targets[i].timestamp) <= timeout) {
-                if (writeIndex != i) {
-                    targets[writeIndex] = targets[i];
-                }
-                writeIndex++;
-            }
-        }
-        
-        targetCount = writeIndex;
-    }
-};
-
 // ============================================================
 // Performance data (polar-based calculations)
 // ============================================================
@@ -292,6 +251,67 @@ struct PerformanceData {
     }
 };
 
+// ============================================================
+// Change notification
+// ============================================================
+
+/**
+ * @brief BoatState sections, one generation counter each.
+ *
+ * A section's generation is bumped once per Writer commit that touched it
+ * (derived wind/VMG/performance updates included), so consumers can tell
+ * "nothing changed" from a single integer compare.
+ */
+enum BoatSection : uint8_t {
+    BOAT_SECTION_GPS = 0,
+    BOAT_SECTION_SPEED,
+    BOAT_SECTION_HEADING,
+    BOAT_SECTION_DEPTH,
+    BOAT_SECTION_WIND,
+    BOAT_SECTION_ENVIRONMENT,
+    BOAT_SECTION_CALCULATED,
+    BOAT_SECTION_AUTOPILOT,
+    BOAT_SECTION_AIS,
+    BOAT_SECTION_PERFORMANCE,
+    BOAT_SECTION_COUNT
+};
+
+#define BOAT_MASK(section)  (1UL << (section))
+#define BOAT_MASK_ALL       (BOAT_MASK(BOAT_SECTION_COUNT) - 1)
+
+// Maximum number of change listeners (BLE, logger, web push...)
+#define BOATSTATE_MAX_LISTENERS 8
+
+/**
+ * @brief Change listener, called after a commit that touched a watched section.
+ *
+ * Runs on the writing task (UART processor, SeaTalk...) after the state
+ * lock is released: keep it short — typically xTaskNotify() or
+ * xEventGroupSetBits() with the mask, and do the real work in the
+ * consumer's own task.
+ *
+ * @param changed  BOAT_MASK() bits of the sections that changed, already
+ *                 filtered by the listener's mask.
+ */
+typedef void (*BoatStateListener)(uint32_t changed, void* ctx);
+
+/**
+ * @brief The AIS targets a streamed response lists, fixed when the list starts.
+ *
+ * The list goes out one target per part, over many TCP callbacks, while
+ * the table keeps inserting, evicting and compacting (a removal moves the
+ * last slot into the hole): walked by slot index it could skip a target or
+ * list one twice.  The MMSIs are copied once instead, and each target is
+ * looked up when its part is written; one gone by then is left out.
+ */
+struct AISList {
+    uint32_t mmsi[AIS_MAX_TARGETS];
+    uint16_t count;
+    uint16_t next;      ///< Next entry of mmsi[] to look up
+
+    AISList() : count(0), next(0) {}
+};
+
 /**
  * Main Boat State class
  * Thread-safe storage for all boat data
@@ -307,7 +327,9 @@ public:
     // Initialization
     void init();
     
-    // Data access (getters return copies for thread safety)
+    // Data access (getters return copies for thread safety).
+    // Lock-free: readers retry while a Writer is active (seqlock) and only
+    // fall back to the mutex if a writer keeps them out for too long.
     GPSData getGPS();
     SpeedData getSpeed();
     HeadingData getHeading();
@@ -316,11 +338,106 @@ public:
     EnvironmentData getEnvironment();
     CalculatedData getCalculated();
     AutopilotData getAutopilot();
-    AISData getAIS();
     PerformanceData getPerformance();
 
-    // Data setters
+    /**
+     * @brief Copy the live AIS targets into @p out (unordered).
+     * @return Number of targets copied, at most @p maxCount.
+     *         Size the buffer with getAISCapacity() to get them all.
+     */
+    int getAISTargets(AISTarget* out, int maxCount);
+    /** Fill @p list with the targets heard within DATA_TIMEOUT_AIS, in one consistent read. */
+    void listAISTargets(AISList& list);
+    /** Copy the next target of @p list still in the table into @p out.  @return false once @p list is done. */
+    bool nextAISTarget(AISList& list, AISTarget& out);
+    uint16_t getAISCount()    const { return ais.size(); }
+    uint16_t getAISCapacity() const { return ais.capacity(); }
+    uint32_t getAISEvictions() const { return ais.evictions(); }
+    uint32_t getAISRejected()  const { return ais.rejected(); }
+
+    /**
+     * @brief Scoped batch writer: takes the state mutex once for several updates.
+     *
+     * Exposes the same setters as BoatState.  Derived values (true wind,
+     * VMG, polar %) that individual setters would recompute are computed once
+     * when the writer goes out of scope, before the mutex is released.
+     *
+     * @code
+     *   BoatState::Writer w(*boatState);
+     *   w.setGPSPositionE7(lat, lon);
+     *   w.setGPSSatellites(sats);
+     * @endcode
+     *
+     * Do not call BoatState getters/setters while a Writer is alive on the
+     * same task — the mutex is not recursive.
+     */
+    class Writer {
+    public:
+        explicit Writer(BoatState& state);
+        ~Writer();
+
+        /** Read access to current values for read-modify-write updates. */
+        const WindData& wind() const { return state.wind; }
+
+        void setGPSPosition(float lat, float lon);
+        void setGPSPositionE7(int32_t latE7, int32_t lonE7);  ///< 1e-7 degree units
+        void setGPSSOG(float sog);
+        void setGPSCOG(float cog);
+        void setGPSSatellites(int count);
+        void setGPSFixQuality(int quality);
+        void setGPSHDOP(float hdop);
+        void setGPSDateTime(uint16_t year,
+                        uint8_t month,
+                        uint8_t day,
+                        uint8_t hour,
+                        uint8_t minute,
+                        uint8_t second);
+    
+        void setSTW(float stw);
+        void setTrip(float trip);
+        void setTotal(float total);
+    
+        void setMagneticHeading(float heading);
+        void setTrueHeading(float heading);
+    
+        void setDepth(float depth);
+        void setDepthOffset(float offset);
+    
+        void setApparentWind(float speed, float angle);
+        void setTrueWind(float speed, float angle, float direction);
+    
+        void setWaterTemp(float temp);
+        void setAirTemp(float temp);
+        void setPressure(float pressure);
+    
+        void setVMGWind(float vmg);
+        void setVMGWaypoint(float vmg);
+        void setCurrentSetDrift(float set, float drift);
+    
+        void setAutopilotMode(const String& mode);
+        void setAutopilotStatus(const String& status);
+        void setAutopilotHeadingTarget(float heading);
+        void setAutopilotWindAngleTarget(float angle);
+        void setAutopilotRudderAngle(float angle);
+        void setAutopilotXTE(float xte);
+        void setAutopilotAlarm(const String& alarm);
+    
+        void addOrUpdateAISTarget(const AISTarget& target);
+        void setAISTargetStatic(uint32_t mmsi, const char* name,
+                                const char* callsign = nullptr, uint8_t shipType = 0);
+
+    private:
+        BoatState& state;
+        bool       perfDirty;      ///< setSTW() seen → updatePerformance on commit
+        bool       derivedDirty;   ///< setApparentWind() seen → calculateDerivedData on commit
+
+        Writer(const Writer&);
+        Writer& operator=(const Writer&);
+    };
+
+    // Data setters (each takes the mutex; use Writer to batch)
     void setGPSPosition(float lat, float lon);
+    void setGPSPositionE7(int32_t latE7, int32_t lonE7);  ///< 1e-7 degree units
     void setGPSSOG(float sog);
     void setGPSCOG(float cog);
     void setGPSSatellites(int count);
@@ -364,6 +481,13 @@ public:
     
     void addOrUpdateAISTarget(const AISTarget& target);
 
+    /**
+     * Merge AIS static data (name, call sign, ship type) into a target,
+     * creating a stub if it is not known yet.  Empty / 0 = unchanged.
+     */
+    void setAISTargetStatic(uint32_t mmsi, const char* name,
+                            const char* callsign = nullptr, uint8_t shipType = 0);
+
     /**
      * @brief Recompute VMG and polarPct from current STW, TWS, TWA.
      *
@@ -386,12 +510,65 @@ public:
     /** @brief Return the current EMA damping time constant (seconds). */
     float getDampingTau() const;
 
+    // ── Change notification ─────────────────────────────────────────────────
+
+    /** Generation of a section: incremented on every commit that changed it. */
+    uint32_t getGeneration(BoatSection section) const {
+        return generation[section].load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Change stamp of the sections in @p mask: the sum of their generations.
+     *
+     * Only ever grows, and differs from an earlier reading exactly when one
+     * of the sections changed since — an ETag / long-poll cursor in one int.
+     */
+    uint32_t getChangeStamp(uint32_t mask) const {
+        uint32_t stamp = 0;
+        for (int i = 0; i < BOAT_SECTION_COUNT; i++) {
+            if (mask & BOAT_MASK(i)) stamp += generation[i].load(std::memory_order_acquire);
+        }
+        return stamp;
+    }
+
+    /**
+     * @brief Register a change listener for the sections in @p mask.
+     * @return Listener id for unsubscribe(), or -1 if the table is full.
+     */
+    int subscribe(uint32_t mask, BoatStateListener fn, void* ctx = nullptr);
+    void unsubscribe(int id);
+
+    /** Seqlock read retries / mutex fallbacks since boot (diagnostics). */
+    uint32_t getReadRetries()   const { return readRetries.load(std::memory_order_relaxed); }
+    uint32_t getReadFallbacks() const { return readFallbacks.load(std::memory_order_relaxed); }
+
     // Utility functions
+    /**
+     * @brief Drop the AIS targets that timed out and count values going stale as changes.
+     *
+     * A value that times out reads as null, so the sections whose set of
+     * fresh values changed since the last sweep get their generation
+     * bumped.  Run about once a second (BOATSTATE_SWEEP_MS).
+     */
     void cleanupStaleData();
     void calculateDerivedData();
     
     // JSON serialization for API
-    String toJSON();
+    /** What writeJSON() keeps between parts: one per response. */
+    struct JsonContext {
+        BoatState* state;
+        AISList    ais;
+
+        explicit JsonContext(BoatState* s) : state(s) {}
+    };
+
+    /**
+     * @brief JsonProducer for the full state document (/api/boat/state); @p ctx is a JsonContext.
+     *
+     * One part per group of sections, then one per AIS target, so the
+     * document streams in JSON_STREAM_PART_MAX pieces (boat_state_stream.cpp).
+     */
+    static bool writeJSON(JsonWriter& w, uint32_t part, void* ctx);
     String getNavigationJSON();
     String getWindJSON();
     String getAISJSON();
@@ -406,11 +583,35 @@ private:
     EnvironmentData environment;
     CalculatedData calculated;
     AutopilotData autopilot;
-    AISData ais;
+    AISTargetTable ais;
     PerformanceData performance;
     
-    // Thread safety
-    SemaphoreHandle_t mutex;
+    // Thread safety: writers serialise on mutex and bump seq around every
+    // update (odd = write in progress); readers copy between two equal even
+    // seq reads.  All data structs above are trivially copyable for this;
+    // the AIS table publishes its (fixed) slot array the same way.
+    SemaphoreHandle_t     mutex;
+    std::atomic<uint32_t> seq;
+    std::atomic<uint32_t> readRetries;
+    std::atomic<uint32_t> readFallbacks;
+
+    // Change tracking: sections touched by the current writer (under mutex)
+    // and the listener table (modified under mutex, read at commit).
+    struct Listener {
+        uint32_t          mask;
+        BoatStateListener fn;
+        void*             ctx;
+    };
+    uint32_t              dirty;
+    std::atomic<uint32_t> generation[BOAT_SECTION_COUNT];
+    uint32_t              freshness[BOAT_SECTION_COUNT];   ///< Fresh-value bits at the last sweep (under mutex)
+    Listener              listeners[BOATSTATE_MAX_LISTENERS];
+
+    void beginWrite();
+    void endWrite();
+    void touch(BoatSection section) { dirty |= BOAT_MASK(section); }
+    template <typename Fn> void readConsistent(Fn copy);
+    template <typename T> T snapshot(const T& src);
 
     // ── EMA damping state ──────────────────────────────────────────────────
     float    _dampingTau   = 0.0f;   ///< Time constant in seconds (0 = disabled)
@@ -422,7 +623,11 @@ private:
     uint32_t _lastPerfMs   = 0;
 
     // Helper functions
+    void calculateDerivedDataLocked();  ///< Caller holds mutex
+    uint32_t freshBitsLocked(BoatSection section) const;   ///< One bit per value not stale; caller holds mutex
+    void updatePerformanceLocked();     ///< Caller holds mutex
     void addDataPointToJSON(JsonObject obj, const char* key, const DataPoint& dp);
+    void addAISTargetsToJSON(JsonArray aisArray, const AISTarget* targets, int count);
 };
 
 #endif // BOAT_STATE_H
@@ -44,8 +44,39 @@
 #define UART_RX_PIN              GPIO_NUM_6
 #define UART_TX_PIN              GPIO_NUM_5
 #define UART_BUFFER_SIZE         1024      // should be enough
+#define UART_TX_BUFFER_SIZE      512       // Driver TX ring for routed sentences
+#define UART_EVENT_QUEUE_SIZE    20        // Driver events (data, pattern, overflow)
+#define UART_PATTERN_QUEUE_SIZE  16        // '\n' positions tracked by the driver
+#define UART_READ_BLOCK          256       // Bytes framed per driver read
 #define UART_DEFAULT_BAUD        38400
 
+// Additional NMEA 0183 inputs.  Each port has its own UART, framer and
+// stats; a merge stage interleaves their sentences by arrival time.
+// Port 0 is NMEA0183_1 above.  Port 2 uses UART0, which is the debug
+// console unless DEBUG_SERIAL is moved to USB CDC.
+#define UART2_NUM                UART_NUM_2        // NMEA0183_2 (instruments)
+#define UART2_RX_PIN             GPIO_NUM_15
+#define UART2_TX_PIN             GPIO_NUM_16
+#define UART3_NUM                UART_NUM_0        // NMEA0183_3
+#define UART3_RX_PIN             GPIO_NUM_17
+#define UART3_TX_PIN             GPIO_NUM_18
+
+#define NMEA_PORT_MAX            3                 // UARTs on the ESP32-S3
+#ifndef NMEA_PORT_COUNT
+#define NMEA_PORT_COUNT          2                 // Ports brought up at boot
+#endif
+
+// TCP clients are one more input source after the UARTs (see nmea_router.h)
+#define NMEA_SOURCE_TCP          NMEA_PORT_MAX
+#define NMEA_SOURCE_MAX          (NMEA_PORT_MAX + 1)
+#define NMEA_NO_CLIENT           0xFF              // Sentence not typed in by a TCP client
+
+// Default baud per port: GPS/AIS receiver, then 4800 instruments
+#define NMEA_PORT_DEFAULT_BAUDS  { 38400, 4800, 4800 }
+
+// Framed sentences buffered per port ahead of the merge stage (power of two)
+#define NMEA_MERGE_DEPTH         16
+
 // --- Configuration SeaTalk1 ---
 
 #define ST1_RX_PIN          GPIO_NUM_7
@@ -68,15 +99,66 @@
 #define TCP_PORT                 10110
 #define TCP_MAX_CLIENTS          5
 
+// Per-client output batching (see tcp_server.h)
+#ifndef TCP_CLIENT_BUFFER
+#define TCP_CLIENT_BUFFER        4096      // Output ring per client, ~1 s of traffic (PSRAM when available)
+#endif
+#ifndef TCP_COALESCE_MS
+#define TCP_COALESCE_MS          50        // Longest a sentence waits for a fuller segment
+#endif
+#ifndef TCP_CLIENT_STALL_MS
+#define TCP_CLIENT_STALL_MS      5000      // Disconnect a client whose ring stays full this long
+#endif
+#define TCP_DEFAULT_MSS          1436      // When AsyncClient::getMss() is not known yet
+
+// UDP output (see udp_output.h) — defaults until set through /api/config/udp
+#define UDP_DEFAULT_ENABLED      false
+#define UDP_DEFAULT_PORT         10110
+#define UDP_DEFAULT_GROUP        "239.192.0.1"   // Multicast mode only (organisation-local scope)
+#define UDP_DEFAULT_DATAGRAM     1472      // Bytes per datagram: largest unfragmented payload
+#define UDP_DEFAULT_DELAY_MS     50        // Longest a sentence waits for a fuller datagram
+#define UDP_MIN_DATAGRAM         128       // Still room for the longest sentence
+#define UDP_MIN_DELAY_MS         10
+#define UDP_MAX_DELAY_MS         1000
+
 // Web Server
 #define WEB_SERVER_PORT          80
 
-// Websocket configuration
-#define WS_MAX_RATE_HZ   10      // max WebSocket frames per second
+// WebSocket NMEA stream (/ws/nmea): sentences batched per client into
+// one text frame every WS_BATCH_MS, or sooner once WS_BATCH_BYTES wait
+#define WS_MAX_CLIENTS           4
+#define WS_CLIENT_BUFFER         16384     // Per-client ring (PSRAM when available)
+#define WS_BATCH_MS              100       // Longest a sentence waits for its frame
+#define WS_BATCH_BYTES           8192      // ~160 ms of the busiest traffic
+#define WS_CLIENT_STALL_MS       5000      // Ring full this long → client disconnected
+
+// WebSocket instrument state (/ws/state): binary frames of the fields that
+// changed since each client's last frame (see state_frame.h)
+#define WS_STATE_MAX_CLIENTS     4
+#define WS_STATE_PUSH_MS         200       // At most 5 frames a second per client
+#define WS_STATE_KEYFRAME_MS     5000      // Full frame at least this often
+#define WS_STATE_SWEEP_MS        1000      // Re-read unchanged sections so stale values clear
+
+// Boat data REST endpoints (/api/boat/*): weak ETag from the sections'
+// change stamp, 304 on If-None-Match, long-poll with ?since=&wait= (boat_poll.h)
+#define BOATSTATE_SWEEP_MS       1000      // Values timing out count as changes at this resolution
+#define HTTP_LONGPOLL_MAX        8         // Requests parked at once; more get 503
+#define HTTP_LONGPOLL_MAX_WAIT_MS 25000    // Longest ?wait= honoured, under browser/proxy idle timeouts
+
+// Read-mostly REST bodies (storage, file lists, polar and SD status) kept
+// in RAM until a write / delete / mount invalidates them (response_cache.h)
+#define RESPONSE_CACHE_MAX_AGE_MS 10000    // Also rebuilt this often: log appends grow the card silently
 
 // NMEA - OPTIMISÉ POUR ÉVITER OVERFLOWS
 #define NMEA_MAX_LENGTH          86        // In theory the max is 83 bytes
-#define NMEA_QUEUE_SIZE          40        // Is monitored
+#define NMEA_QUEUE_SIZE          64        // Is monitored; power of two (index ring)
+
+// Shared sentence buffers: every stage (merge, processor, logger) holds a
+// reference instead of a copy.  Covers the merge rings, NMEA_QUEUE_SIZE and
+// the logger backlog; lives in PSRAM when the board has it.
+#ifndef SENTENCE_POOL_SIZE
+#define SENTENCE_POOL_SIZE       256
+#endif
 
 // NVS
 #define NVS_NAMESPACE            "marine_gw"
@@ -123,4 +205,9 @@
 #define SD_MOUNT_POINT      "/sdcard"
 #define SD_MAX_FILES        10          // max simultaneously open files on FAT
 
+// SD downloads (/api/sd/download): byte ranges, card read in large blocks
+#define SD_DOWNLOAD_BUFFER          32768   // Per download, PSRAM: multi-block SPI reads
+#define SD_DOWNLOAD_BUFFER_INTERNAL 4096    // Without PSRAM
+#define SD_DOWNLOAD_MAX_ACTIVE      2       // More get 503 + Retry-After
+
 #endif // CONFIG_H
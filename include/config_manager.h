@@ -14,14 +14,22 @@ public:
     bool getWiFiConfig(WiFiConfig& config);
     bool setWiFiConfig(const WiFiConfig& config);
     
-    // Serial configuration
-    bool getSerialConfig(UARTConfig& config);
-    bool setSerialConfig(const UARTConfig& config);
+    // Serial configuration, per NMEA input port (0..NMEA_PORT_MAX-1)
+    bool getSerialConfig(UARTConfig& config, uint8_t port = 0);
+    bool setSerialConfig(const UARTConfig& config, uint8_t port = 0);
         
     // BLE configuration
     bool getBLEConfig(BLEConfigData& config);
     bool setBLEConfig(const BLEConfigData& config);
     
+    // UDP output configuration
+    bool getUDPConfig(UDPConfig& config);
+    bool setUDPConfig(const UDPConfig& config);
+    
+    // Routing matrix
+    bool getRouteConfig(RouteConfig& config);
+    bool setRouteConfig(const RouteConfig& config);
+    
     // Factory reset
     void factoryReset();
     
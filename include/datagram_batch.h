@@ -0,0 +1,76 @@
+#ifndef DATAGRAM_BATCH_H
+#define DATAGRAM_BATCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @file datagram_batch.h
+ * @brief Packs NMEA sentences into UDP datagrams under a size and latency bound.
+ *
+ * Sentences are appended CR LF terminated to one datagram buffer.  The
+ * datagram is handed to the send callback when the next sentence would
+ * not fit in maxBytes, or when poll() finds its oldest sentence has waited
+ * maxDelayMs.  A datagram only ever holds whole sentences, so a receiver
+ * can split it on line ends exactly as it would a TCP stream.
+ */
+
+/** Largest IPv4 UDP payload that fits a 1500-byte Ethernet/WiFi MTU unfragmented. */
+#define DATAGRAM_MAX           1472
+
+/**
+ * @brief Receives one datagram.
+ * @param data  The sentences, CR LF terminated; valid only during the call
+ */
+typedef void (*DatagramSender)(const char* data, size_t len, void* ctx);
+
+class DatagramBatch {
+public:
+    DatagramBatch(DatagramSender sender = nullptr, void* ctx = nullptr);
+
+    void setSender(DatagramSender sender, void* ctx = nullptr);
+
+    /** @p maxBytes is clamped to DATAGRAM_MAX.  Drops anything pending. */
+    void setLimits(size_t maxBytes, uint32_t maxDelayMs);
+
+    /**
+     * @brief Queue one sentence (without line end).
+     *
+     * Sends the pending datagram first if the sentence does not fit behind
+     * it.  A sentence longer than maxBytes on its own is dropped.
+     */
+    void add(const char* line, size_t len, uint32_t nowMs);
+
+    /** Send the pending datagram if its latency bound has expired.  @return true if sent */
+    bool poll(uint32_t nowMs);
+
+    /** Send whatever is pending now. */
+    void flush();
+
+    /** Time left before poll() sends the pending datagram (maxDelayMs when empty). */
+    uint32_t msUntilDue(uint32_t nowMs) const;
+
+    size_t   pending()    const { return used; }
+    size_t   maxBytes()   const { return limitBytes; }
+    uint32_t maxDelayMs() const { return limitMs; }
+
+    uint32_t datagrams()  const { return datagramCount; }
+    uint32_t sentences()  const { return sentenceCount; }
+    uint32_t oversize()   const { return oversizeCount; }
+
+private:
+    DatagramSender sender;
+    void*          ctx;
+
+    char     buf[DATAGRAM_MAX];
+    size_t   used;
+    size_t   limitBytes;
+    uint32_t limitMs;
+    uint32_t oldestMs;       ///< When the first pending sentence was added
+
+    uint32_t datagramCount;
+    uint32_t sentenceCount;
+    uint32_t oversizeCount;
+};
+
+#endif // DATAGRAM_BATCH_H
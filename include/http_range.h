@@ -0,0 +1,42 @@
+#ifndef HTTP_RANGE_H
+#define HTTP_RANGE_H
+
+#include <stdint.h>
+
+/**
+ * @file http_range.h
+ * @brief Range / If-Range request headers (RFC 9110 §14), for resumable downloads.
+ *
+ * Single byte ranges only: a multi-range request is answered with the
+ * whole file, which the RFC allows and every download client accepts.
+ * A Range header that does not parse is ignored, as the RFC requires.
+ */
+
+enum HttpRangeResult : uint8_t {
+    HTTP_RANGE_NONE = 0,        ///< No usable range: send the whole body (200)
+    HTTP_RANGE_OK,              ///< Send [first, last] (206)
+    HTTP_RANGE_UNSATISFIABLE    ///< Starts past the end (416, Content-Range: bytes * / size)
+};
+
+/**
+ * @brief Resolve a Range header value against a body of @p size bytes.
+ *
+ * Accepts "bytes=a-b", "bytes=a-" and the suffix form "bytes=-n";
+ * @p last is clamped to the end of the body.
+ *
+ * @param header  Range header value, or nullptr
+ * @param first,last  Inclusive byte positions, set on HTTP_RANGE_OK
+ */
+HttpRangeResult parseHttpRange(const char* header, uint64_t size, uint64_t& first, uint64_t& last);
+
+/**
+ * @brief Does an If-Range value still name this version of the body?
+ *
+ * A strong entity tag must equal @p etag; a date must equal
+ * @p lastModified exactly (nullptr: the body has no date).  A weak tag
+ * never matches.  On false the Range header is ignored and the whole body
+ * is sent, so a resumed download never splices two versions of a file.
+ */
+bool httpIfRangeMatches(const char* ifRange, const char* etag, const char* lastModified);
+
+#endif // HTTP_RANGE_H
@@ -0,0 +1,93 @@
+#ifndef INDEX_RING_H
+#define INDEX_RING_H
+
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * @file index_ring.h
+ * @brief Bounded lock-free MPMC ring of 16-bit indices.
+ *
+ * Each cell carries a sequence number that tells producers and consumers
+ * whether it is free or filled for the current lap, so any number of tasks
+ * on either core may push and pop concurrently without a critical section
+ * (Vyukov's bounded queue).  push() fails instead of blocking when full;
+ * pop() fails when empty.  Waiting is left to the caller, typically a task
+ * notification from the producer.
+ *
+ * push() can also fail, transiently, on a ring that is not full if the pop
+ * of the cell it needs was preempted half-way; callers treat that as a
+ * drop, so do not use a ring where an element must never be lost.
+ *
+ * @tparam N Capacity, a power of two.
+ */
+template <uint16_t N>
+class IndexRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "IndexRing capacity must be a power of two");
+
+public:
+    IndexRing() : head(0), tail(0) {
+        for (uint32_t i = 0; i < N; i++) cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    bool push(uint16_t value) {
+        uint32_t pos = head.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell&   c   = cells[pos & (N - 1)];
+            int32_t dif = (int32_t)(c.seq.load(std::memory_order_acquire) - pos);
+            if (dif == 0) {
+                if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    c.value = value;
+                    c.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (dif < 0) {
+                return false;   // Full
+            } else {
+                pos = head.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool pop(uint16_t& value) {
+        uint32_t pos = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell&   c   = cells[pos & (N - 1)];
+            int32_t dif = (int32_t)(c.seq.load(std::memory_order_acquire) - (pos + 1));
+            if (dif == 0) {
+                if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    value = c.value;
+                    c.seq.store(pos + N, std::memory_order_release);
+                    return true;
+                }
+            } else if (dif < 0) {
+                return false;   // Empty
+            } else {
+                pos = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /** Approximate fill level (exact when no push/pop is in flight). */
+    uint16_t size() const {
+        uint32_t n = head.load(std::memory_order_relaxed) - tail.load(std::memory_order_relaxed);
+        return (uint16_t)(n > N ? N : n);
+    }
+
+    static uint16_t capacity() { return N; }
+
+private:
+    struct Cell {
+        std::atomic<uint32_t> seq;
+        uint16_t              value;
+    };
+
+    Cell                  cells[N];
+    std::atomic<uint32_t> head;   ///< Next position to fill
+    std::atomic<uint32_t> tail;   ///< Next position to drain
+
+    IndexRing(const IndexRing&);
+    IndexRing& operator=(const IndexRing&);
+};
+
+#endif // INDEX_RING_H
@@ -0,0 +1,112 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @file json_writer.h
+ * @brief DOM-less JSON output for the large REST responses.
+ *
+ * JsonWriter appends tokens to a fixed buffer, inserting the commas and
+ * tracking nesting itself; it never allocates.  JsonStream turns a
+ * document into a chunked HTTP body: it asks a producer for the document
+ * one part at a time (a section, an AIS target, a file) into a
+ * JSON_STREAM_PART_MAX staging buffer and hands the bytes out as the
+ * response callback asks for them.  A response therefore costs one
+ * JsonStream plus the producer's cursor, whatever the size of the document.
+ */
+
+#ifndef JSON_STREAM_PART_MAX
+#define JSON_STREAM_PART_MAX   512     ///< Largest single part (one AIS target is ~350 B)
+#endif
+#define JSON_WRITER_MAX_DEPTH  16
+
+class JsonWriter {
+public:
+    JsonWriter(char* buf, size_t cap);
+
+    /** Drop the output written so far; the nesting state carries on. */
+    void rewind() { len = 0; }
+
+    const char* data()       const { return buf; }
+    size_t      length()     const { return len; }
+    /** Something did not fit: the output is truncated and must not be sent. */
+    bool        overflowed() const { return overflow; }
+
+    // Containers.  @p key names an object member; nullptr inside an array.
+    JsonWriter& beginObject(const char* key = nullptr);
+    JsonWriter& endObject();
+    JsonWriter& beginArray(const char* key = nullptr);
+    JsonWriter& endArray();
+
+    // Object members
+    JsonWriter& add(const char* key, const char* value);    ///< nullptr → null
+    JsonWriter& add(const char* key, bool value);
+    JsonWriter& add(const char* key, int value);
+    JsonWriter& add(const char* key, unsigned value);
+    JsonWriter& add(const char* key, long value);
+    JsonWriter& add(const char* key, unsigned long value);
+    JsonWriter& add(const char* key, long long value);
+    JsonWriter& add(const char* key, unsigned long long value);
+    JsonWriter& add(const char* key, float value);          ///< 7 significant digits; NaN → null
+    JsonWriter& add(const char* key, double value);         ///< 10 significant digits; NaN → null
+    JsonWriter& addNull(const char* key);
+
+    // Array elements
+    JsonWriter& value(const char* v)  { return add(nullptr, v); }
+    JsonWriter& value(unsigned v)     { return add(nullptr, v); }
+
+private:
+    void prefix(const char* key);
+    void put(char c);
+    void put(const char* s, size_t n);
+    void putString(const char* s);
+    void putNumber(const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+
+    char*    buf;
+    size_t   cap;
+    size_t   len;
+    bool     overflow;
+    uint8_t  depth;
+    bool     first[JSON_WRITER_MAX_DEPTH + 1];   ///< Nothing written yet at this level
+
+    JsonWriter(const JsonWriter&);
+    JsonWriter& operator=(const JsonWriter&);
+};
+
+/**
+ * @brief Write part @p part (0, 1, 2 ...) of a document.
+ * @return false if this was the last part.  Any part, the last included,
+ *         may write nothing.
+ */
+typedef bool (*JsonProducer)(JsonWriter& w, uint32_t part, void* ctx);
+
+class JsonStream {
+public:
+    JsonStream(JsonProducer fn, void* ctx);
+
+    /**
+     * @brief Copy the next bytes of the document into @p out.
+     * @return Bytes written, at most @p maxLen; 0 once the document is complete
+     */
+    size_t read(uint8_t* out, size_t maxLen);
+
+    /** A part overflowed JSON_STREAM_PART_MAX: the body stopped short. */
+    bool failed() const { return truncated; }
+
+private:
+    JsonProducer fn;
+    void*        ctx;
+    char         staging[JSON_STREAM_PART_MAX];
+    JsonWriter   writer;
+    size_t       pos;        ///< Bytes of the staged part already handed out
+    uint32_t     part;
+    bool         done;
+    bool         truncated;
+
+    JsonStream(const JsonStream&);
+    JsonStream& operator=(const JsonStream&);
+};
+
+#endif // JSON_WRITER_H
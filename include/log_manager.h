@@ -21,7 +21,8 @@
  *   A dedicated FreeRTOS task (logTask) consumes a queue of LogEntry items
  *   written by the NMEA/SeaTalk reception tasks.  The SD filesystem is never
  *   touched from the hot data path — the queue decouples producers from the
- *   (slow) SD I/O.
+ *   (slow) SD I/O.  Entries carry a reference into the shared SentencePool
+ *   rather than the text itself; the task releases it once written.
  *
  *   Files are flushed every LOG_FLUSH_INTERVAL_MS milliseconds.
  *   The flush period is a trade-off between crash safety and SD wear.
@@ -47,12 +48,15 @@
 #include <freertos/semphr.h>
 #include "boat_state.h"
 #include "sd_manager.h"
+#include "sentence_pool.h"
+
+class MetricsRegistry;
 
 // ─────────────────────────────────────────────────────────────────────────────
 // Compile-time constants
 // ─────────────────────────────────────────────────────────────────────────────
 
-#define LOG_QUEUE_SIZE        128   ///< Max pending log entries before drop
+#define LOG_QUEUE_SIZE        128   ///< Max pending log entries before drop (each pins a pool buffer)
 #define LOG_TASK_STACK        6144
 #define LOG_TASK_PRIORITY     1     ///< Lowest — behind all real-time tasks
 #define LOG_FLUSH_INTERVAL_MS 10000 ///< Flush/sync every 10 seconds
@@ -72,10 +76,10 @@ enum LogEntryType : uint8_t {
     LOG_CSV_SNAP = 2,   ///< CSV snapshot trigger (payload unused)
 };
 
-/** Fixed-size queue entry — avoids heap allocation in ISR/task context. */
+/** Queue entry: the payload stays in the sentence pool. */
 struct LogEntry {
     LogEntryType type;
-    char         data[120]; ///< Null-terminated payload
+    SentenceRef  ref;   ///< Pool buffer holding the text, SENTENCE_NONE for LOG_CSV_SNAP
 };
 
 /** Configuration held in RAM and persisted to NVS. */
@@ -111,8 +115,9 @@ public:
     /**
      * @param sdMgr     SD card manager (must outlive LogManager).
      * @param boatState Shared boat state for GPS fix detection and CSV snapshots.
+     * @param pool      Sentence pool the NMEA / SeaTalk entries live in.
      */
-    LogManager(SDManager* sdMgr, BoatState* boatState);
+    LogManager(SDManager* sdMgr, BoatState* boatState, SentencePool* pool);
     ~LogManager();
 
     // ── Lifecycle ─────────────────────────────────────────────────────────────
@@ -143,22 +148,23 @@ public:
     // ── Producer API (called from NMEA / SeaTalk tasks) ───────────────────────
 
     /**
-     * @brief Enqueue a raw NMEA sentence for logging.
+     * @brief Enqueue a pooled NMEA sentence for logging.
      *
-     * Silently discarded if no GPS fix is available yet.
+     * Silently discarded if no GPS fix is available yet.  Takes its own
+     * reference on @p ref; the caller keeps (and still releases) its own.
      * Non-blocking — drops the entry and increments droppedEntries if the
      * queue is full.  Safe to call from any task/core.
      *
-     * @param sentence Null-terminated NMEA sentence (including '$' prefix).
+     * @param ref Pool buffer holding the sentence (including '$' prefix).
      */
-    void logNMEA(const char* sentence);
+    void logNMEA(SentenceRef ref);
 
     /**
      * @brief Enqueue a SeaTalk datagram for logging.
      *
      * Silently discarded if no GPS fix is available yet.
-     * The datagram is formatted as uppercase hex bytes separated by spaces,
-     * e.g. "52 01 02 FF".
+     * The datagram is formatted into a pool buffer as uppercase hex bytes
+     * separated by spaces, e.g. "52 01 02 FF".
      *
      * @param data Raw bytes of the SeaTalk datagram.
      * @param len  Number of bytes (3–18).
@@ -182,6 +188,9 @@ public:
      */
     String   openFilePaths() const;
 
+    /** Expose the session line counters on /metrics (they restart with each session). */
+    void registerMetrics(MetricsRegistry& reg) const;
+
 private:
     // ── GPS fix guard ─────────────────────────────────────────────────────────
 
@@ -190,6 +199,8 @@ private:
      *
      * Condition: GPSDateTime::getTimestamp() > 1.
      * This is the gate used by all logging entry points and by openFiles().
+     * The result is cached against the BoatState GPS generation, so the
+     * per-sentence check costs one atomic load until the GPS data changes.
      */
     bool hasGPSFix() const;
 
@@ -221,9 +232,13 @@ private:
     /** Close and null-out all file handles. */
     void closeFiles();
 
-    /** Process a single LogEntry dispatched from the queue. */
+    /** Process a single LogEntry dispatched from the queue (does not release it). */
     void processEntry(const LogEntry& entry);
 
+    /** Queue @p entry or count it dropped; releases its buffer when dropped. */
+    void enqueue(const LogEntry& entry);
+    void countDropped();
+
     /**
      * @brief Write a CSV row for the current boatState snapshot.
      *
@@ -238,8 +253,9 @@ private:
 
     // ── Members ───────────────────────────────────────────────────────────────
 
-    SDManager*  sdManager;
-    BoatState*  boatState;
+    SDManager*    sdManager;
+    BoatState*    boatState;
+    SentencePool* pool;
     Preferences nvs;
 
     LogConfig   config;
@@ -258,6 +274,9 @@ private:
     uint32_t lastFlushMs;
     uint32_t lastCsvSnapMs;
 
+    /// (GPS generation << 1) | fix — see hasGPSFix()
+    mutable std::atomic<uint32_t> fixCache;
+
     // Session counter (persisted in NVS across reboots)
     uint16_t sessionCounter;
 
@@ -0,0 +1,117 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+
+class LatencyHistogram;
+
+/**
+ * @file metrics.h
+ * @brief Registry of gateway metrics with OpenMetrics text exposition.
+ *
+ * Modules register their counters, gauges and histograms once at init,
+ * each with a read callback (or a histogram pointer) instead of a copy of
+ * the value, so registration costs nothing on the data path.  render()
+ * writes the exposition into a caller buffer a few lines at a time and
+ * resumes from a MetricsCursor, so /metrics streams as a chunked response
+ * without building the document in a String or a JsonDocument.
+ *
+ * Samples of one family (same name, different labels) are kept together
+ * whatever order they are registered in, and share one # TYPE / # HELP
+ * header.  Names, help texts and label strings must be static.
+ */
+
+#ifndef METRICS_MAX
+#define METRICS_MAX  112
+#endif
+
+/** Longest line render() produces; longer ones are skipped. */
+#define METRICS_LINE_MAX  192
+
+enum MetricType : uint8_t {
+    METRIC_COUNTER = 0,
+    METRIC_GAUGE,
+    METRIC_HISTOGRAM
+};
+
+/** Reads a counter or gauge; @p ctx is the pointer given at registration. */
+typedef int64_t (*MetricReadFn)(const void* ctx);
+
+/** Resume point of a streamed render. Start zeroed. */
+struct MetricsCursor {
+    uint16_t metric;   ///< Registry index
+    uint16_t line;     ///< Line within that metric
+    bool     done;
+
+    MetricsCursor() : metric(0), line(0), done(false) {}
+};
+
+/** Static label set `port="N"` for per-port samples, `port="tcp"` for NMEA_SOURCE_TCP; nullptr past the table. */
+const char* metricsPortLabel(uint8_t port);
+
+class MetricsRegistry {
+public:
+    MetricsRegistry();
+
+    /**
+     * @brief Register a monotonically increasing value.
+     * @param name   Family name without the "_total" suffix, e.g. "espnav_nmea_sentences"
+     * @param labels Label set without braces, e.g. "port=\"0\"", or nullptr
+     * @return false when the registry is full
+     */
+    bool addCounter(const char* name, const char* help, MetricReadFn fn, const void* ctx,
+                    const char* labels = nullptr);
+    bool addGauge(const char* name, const char* help, MetricReadFn fn, const void* ctx,
+                  const char* labels = nullptr);
+    /** Shorthands for a plain 32-bit variable. */
+    bool addCounter(const char* name, const char* help, const volatile uint32_t* value,
+                    const char* labels = nullptr);
+    bool addGauge(const char* name, const char* help, const volatile uint32_t* value,
+                  const char* labels = nullptr);
+
+    /**
+     * @brief Register a latency histogram (values in µs).
+     *
+     * Exposed with fixed buckets at power-of-two bounds (le="15", "31", …
+     * "1048575", "+Inf"), which fall exactly on LatencyHistogram bucket
+     * edges, plus _count and _sum.
+     */
+    bool addHistogram(const char* name, const char* help, const LatencyHistogram* hist,
+                      const char* labels = nullptr);
+
+    uint16_t size() const { return count; }
+
+    /**
+     * @brief Write the next complete lines of the exposition into @p buf.
+     *
+     * Lines never straddle two calls, so each value is read exactly once.
+     * A line longer than @p maxLen on its own is skipped.
+     * @return Bytes written; 0 once "# EOF" has been written.
+     */
+    size_t render(MetricsCursor& cursor, char* buf, size_t maxLen) const;
+
+private:
+    struct Metric {
+        const char* name;
+        const char* help;
+        const char* labels;
+        MetricType  type;
+        MetricReadFn fn;
+        const void*  ctx;   ///< Callback context or LatencyHistogram*
+    };
+
+    bool add(const char* name, const char* help, MetricType type, MetricReadFn fn,
+             const void* ctx, const char* labels);
+    /** Format line @p line of metric @p m; -1 past its last line. */
+    int  formatLine(uint16_t m, uint16_t line, char* out, size_t outLen) const;
+    int  formatSample(const Metric& m, const char* suffix, const char* extraLabel,
+                      int64_t value, char* out, size_t outLen) const;
+
+    Metric   metrics[METRICS_MAX];
+    uint16_t count;
+
+    MetricsRegistry(const MetricsRegistry&);
+    MetricsRegistry& operator=(const MetricsRegistry&);
+};
+
+#endif // METRICS_H
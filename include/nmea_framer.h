@@ -0,0 +1,71 @@
+#ifndef NMEA_FRAMER_H
+#define NMEA_FRAMER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+
+/**
+ * @file nmea_framer.h
+ * @brief Splits a raw serial byte stream into NMEA 0183 sentences.
+ *
+ * Bytes are fed in blocks as they come off the UART driver.  A sentence
+ * that lies entirely inside one block is terminated in place (its CR or
+ * LF overwritten with NUL) and handed to the callback without a copy;
+ * only a sentence split across two blocks goes through the small carry
+ * buffer.
+ *
+ * Framing rules (unchanged from the old byte-at-a-time reader):
+ *   - '$' or '!' starts a sentence and discards any partial one
+ *   - LF ends it; a CR before the LF is stripped
+ *   - sentences longer than NMEA_MAX_LENGTH - 1 are dropped (overlong)
+ *   - text ending in LF with no start character is dropped (noise);
+ *     blank lines are ignored
+ */
+
+/**
+ * @brief Receives one framed sentence.
+ * @param line  NUL-terminated, starts with '$' or '!'; valid only during the call
+ * @param len   strlen(line)
+ */
+typedef void (*NMEALineHandler)(char* line, size_t len, void* ctx);
+
+class NMEALineFramer {
+public:
+    NMEALineFramer(NMEALineHandler handler = nullptr, void* ctx = nullptr);
+
+    void setHandler(NMEALineHandler handler, void* ctx = nullptr);
+
+    /**
+     * @brief Frame a block of received bytes.
+     *
+     * @p data is modified in place and must stay valid only for the call.
+     * A trailing partial sentence is kept for the next feed().
+     */
+    void feed(char* data, size_t len);
+
+    /** Drop any partial sentence (after an RX overflow, say). */
+    void reset();
+
+    uint32_t lines()    const { return lineCount; }
+    uint32_t overlong() const { return overlongCount; }
+    uint32_t noise()    const { return noiseCount; }
+
+private:
+    void emit(char* line, size_t len);
+
+    NMEALineHandler handler;
+    void*           ctx;
+
+    char     carry[NMEA_MAX_LENGTH + 1];   ///< Longest sentence + CR + NUL
+    size_t   carryLen;
+    bool     inSentence;     ///< A '$' / '!' has been seen since the last LF
+    bool     discarding;     ///< Current sentence already overlong
+    bool     dirty;          ///< Non-blank bytes since the last LF outside a sentence
+
+    uint32_t lineCount;
+    uint32_t overlongCount;
+    uint32_t noiseCount;
+};
+
+#endif // NMEA_FRAMER_H
@@ -0,0 +1,76 @@
+#ifndef NMEA_MERGE_H
+#define NMEA_MERGE_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "config.h"
+#include "sentence_pool.h"
+
+class MetricsRegistry;
+
+/**
+ * @file nmea_merge.h
+ * @brief Merges framed sentences from several input ports by arrival time.
+ *
+ * Each port's RX task pushes references to pooled sentences (see
+ * sentence_pool.h) into its own single-producer/single-consumer ring; the
+ * merge task pops the oldest head across all rings, using the arrival time
+ * stamped in the buffer.  A chatty port therefore cannot delay a quiet one
+ * by more than the sentences that genuinely arrived before it, and when a
+ * ring fills up only that port loses sentences.  Ties (same arrival tick)
+ * are broken round-robin.
+ *
+ * Sources are the UART ports plus NMEA_SOURCE_TCP, fed by the TCP server's
+ * client reader.
+ *
+ * Lock-free: one producer per source, one consumer overall.
+ */
+
+class NMEAMerger {
+public:
+    explicit NMEAMerger(SentencePool& pool);
+
+    /**
+     * @brief Queue sentence @p ref from @p source (producer side, one task per source).
+     *
+     * Takes over the caller's reference.
+     * @return false if the source's ring is full; the sentence is released and counted.
+     */
+    bool push(uint8_t source, SentenceRef ref);
+
+    /**
+     * @brief Oldest queued sentence across all sources (consumer side).
+     * @return SENTENCE_NONE when every ring is empty.  The reference stays
+     *         queued until pop(); retain it to keep the buffer past that.
+     */
+    SentenceRef front();
+
+    /** Dequeue the sentence returned by the last front(), dropping the ring's reference. */
+    void pop();
+
+    uint32_t merged(uint8_t source)  const { return source < NMEA_SOURCE_MAX ? rings[source].merged : 0; }
+    uint32_t dropped(uint8_t source) const { return source < NMEA_SOURCE_MAX ? rings[source].dropped : 0; }
+    uint8_t  pending(uint8_t source) const;
+
+    /** Expose merged / dropped counters for ports 0..@p ports-1 and TCP input on /metrics. */
+    void registerMetrics(MetricsRegistry& reg, uint8_t ports) const;
+
+private:
+    struct Ring {
+        std::atomic<uint32_t> head;     ///< Next slot to write (producer)
+        std::atomic<uint32_t> tail;     ///< Next slot to read (consumer)
+        uint32_t              merged;   ///< Written by the consumer only
+        uint32_t              dropped;  ///< Written by the producer only
+        SentenceRef           slot[NMEA_MERGE_DEPTH];
+    };
+
+    SentencePool& pool;
+    Ring    rings[NMEA_SOURCE_MAX];
+    int8_t  current;   ///< Source of the line handed out by front(), -1 = none
+    uint8_t rrNext;    ///< Round-robin start for tie-breaking
+
+    NMEAMerger(const NMEAMerger&);
+    NMEAMerger& operator=(const NMEAMerger&);
+};
+
+#endif // NMEA_MERGE_H
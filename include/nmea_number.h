@@ -0,0 +1,59 @@
+#ifndef NMEA_NUMBER_H
+#define NMEA_NUMBER_H
+
+/**
+ * @file nmea_number.h
+ * @brief Allocation-free, locale-free numeric field parsing for NMEA 0183.
+ *
+ * Replaces atof/atoi/sscanf in the sentence handlers.  Every function works
+ * on a (ptr, len) field view, never reads past len, never allocates and
+ * ignores the C locale.  Only the plain decimal syntax NMEA uses is
+ * accepted: optional sign, digits, optional '.', digits (no exponent).
+ */
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @brief Decimal value as integer mantissa and power-of-ten exponent.
+ *
+ * value = mantissa × 10^exponent.  Up to 9 significant digits are kept;
+ * further integer digits bump the exponent, further fraction digits are
+ * dropped (truncation).
+ */
+struct NMEADecimal {
+    int32_t mantissa;
+    int8_t  exponent;
+
+    /** Nearest float (correctly rounded when |mantissa| < 2^24). */
+    float  toFloat() const;
+    /** Nearest double (correctly rounded, same result as strtod). */
+    double toDouble() const;
+};
+
+/** Parse a decimal field.  @return false if empty or malformed. */
+bool nmeaParseDecimal(const char* s, size_t len, NMEADecimal& out);
+
+/** Parse a decimal field into a float.  @return false if empty or malformed. */
+bool nmeaParseFloat(const char* s, size_t len, float& out);
+
+/** Parse a signed integer field (no fraction).  @return false if empty or malformed. */
+bool nmeaParseInt(const char* s, size_t len, int32_t& out);
+
+/** Parse exactly two hex digits (checksum).  @return false on a non-hex digit. */
+bool nmeaParseHexByte(const char* s, uint8_t& out);
+
+/**
+ * @brief Parse an NMEA ddmm.mmmm / dddmm.mmmm coordinate to 1e-7 degrees.
+ *
+ * The degree/minute split is taken from the position of the decimal point,
+ * minutes are kept to 1e-6 minute before the single rounding division, so
+ * the result is exact to ±0.5e-7° (about 5 mm) — unlike the float path,
+ * which loses the 1e-5 minute digit at 47° and beyond.
+ *
+ * @param hemi  'N'/'S'/'E'/'W' field; 'S' and 'W' negate the result
+ * @return false if empty, malformed or out of range (|lat| > 90 / |lon| > 180)
+ */
+bool nmeaParseCoordE7(const char* s, size_t len, char hemi, int32_t& outE7);
+
+#endif // NMEA_NUMBER_H
@@ -4,58 +4,185 @@
 #include <Arduino.h>
 #include "types.h"
 #include "boat_state.h"
+#include "nmea_number.h"
+#include "ais_decoder.h"
+#include "ais_reassembly.h"
+
+class MetricsRegistry;
+
+// Upper bound on comma-separated fields kept per sentence (address included).
+// NMEA 0183 caps a sentence at 82 chars; GSV/RMB-class sentences stay < 24.
+#define NMEA_MAX_FIELDS  24
+
+/**
+ * @brief Non-owning view of one sentence field (points into the raw line).
+ *
+ * The view is not NUL-terminated: the byte at ptr[len] is the ',' or '*'
+ * that ended the field.
+ */
+struct NMEAField {
+    const char* ptr;
+    uint8_t     len;
+
+    bool empty() const { return len == 0; }
+    char first() const { return len ? ptr[0] : '\0'; }
+};
+
+/**
+ * @brief A sentence split once into field views.
+ *
+ * Field 0 is the address ("GPGGA", "AIVDM"); the checksum is not a field.
+ * Indexing past the last field yields an empty view, which matches what the
+ * old per-field scanner returned for missing fields.
+ */
+struct NMEAFields {
+    NMEAField field[NMEA_MAX_FIELDS];
+    uint8_t   count;
+
+    const NMEAField& operator[](uint8_t i) const {
+        static const NMEAField none = { "", 0 };
+        return i < count ? field[i] : none;
+    }
+};
+
+/**
+ * @brief Pack a 3-character sentence formatter ("GGA") into a dispatch key.
+ *
+ * The talker ID is deliberately not part of the key: $GPGGA, $GNGGA and
+ * $INGGA all dispatch to the same handler.
+ */
+constexpr uint32_t nmeaFormatterKey(char a, char b, char c) {
+    return ((uint32_t)(uint8_t)a << 16) | ((uint32_t)(uint8_t)b << 8) | (uint32_t)(uint8_t)c;
+}
+
+/**
+ * @brief Handler for a sentence type added with NMEAParser::registerHandler().
+ *
+ * @param fields  Sentence split into field views (fields[0] is the address)
+ * @param state   BoatState the parser was constructed with
+ * @param ctx     Opaque pointer given at registration
+ */
+typedef void (*NMEASentenceHandler)(const NMEAFields& fields, BoatState* state, void* ctx);
+
+/**
+ * @brief Observer for every decoded AIS message, set with NMEAParser::setAISHandler().
+ *
+ * Called before the message is applied to BoatState; sees the types that
+ * carry no target data too (e.g. type 14 safety broadcasts).
+ */
+typedef void (*AISMessageHandler)(const AISMessage& msg, void* ctx);
+
+// Dispatch table size (2^NMEA_DISPATCH_BITS, open addressing).  Built-in
+// handlers use 16 slots; the rest is available to registerHandler().
+#define NMEA_DISPATCH_BITS   5
+#define NMEA_DISPATCH_SLOTS  (1 << NMEA_DISPATCH_BITS)
 
 class NMEAParser {
 public:
     NMEAParser(BoatState* boatState = nullptr);
     
     bool parseLine(const char* line, NMEASentence& out);
+    /** Validate and dispatch @p line in place, without copying it out. */
+    bool parseLine(const char* line);
     bool validateChecksum(const char* line);
+
+    /**
+     * @brief Split a sentence into field views in a single pass.
+     *
+     * Scanning starts after the leading '$' / '!' and stops at '*', CR, LF
+     * or end of string.  Fields beyond NMEA_MAX_FIELDS are ignored.
+     *
+     * @return Number of fields found
+     */
+    static uint8_t tokenize(const char* line, NMEAFields& out);
+
+    /**
+     * @brief Route an additional sentence formatter to a custom handler.
+     *
+     * Must be called during setup, before the parser task starts: the
+     * dispatch table is not locked.  Registering a formatter that already
+     * has a handler (built-in or custom) replaces it.
+     *
+     * @param formatter  3-character formatter, e.g. "XDR" (talker-agnostic)
+     * @return false if the formatter is malformed or the table is full
+     */
+    bool registerHandler(const char* formatter, NMEASentenceHandler handler, void* ctx = nullptr);
     
+    /** Install (or clear with nullptr) the AIS message observer.  Setup only. */
+    void setAISHandler(AISMessageHandler handler, void* ctx = nullptr) {
+        aisHandler    = handler;
+        aisHandlerCtx = ctx;
+    }
+
     uint32_t getValidSentences() const { return validSentences; }
     uint32_t getInvalidSentences() const { return invalidSentences; }
+
+    /** Messages decoded per AIS message type (index 0..27). */
+    uint32_t getAISDecoded(uint8_t type) const { return type < 28 ? aisDecoded[type] : 0; }
+
+    /** Multi-sentence AIS reassembly counters (fragments, completed, dropped, expired). */
+    const AISReassembler& getAISReassembly() const { return aisReassembly; }
+
+    /** Expose sentence and AIS reassembly counters on /metrics. */
+    void registerMetrics(MetricsRegistry& reg) const;
     
 private:
     uint8_t calculateChecksum(const char* data, size_t len);
     void extractSentenceType(const char* line, char* type, size_t maxLen);
+
+    // ── Sentence dispatch ──────────────────────────────────────────────────
+    typedef void (NMEAParser::*BuiltinHandler)(const NMEAFields& f);
+
+    struct DispatchEntry {
+        uint32_t            key;      ///< nmeaFormatterKey(), 0 = free slot
+        BuiltinHandler      builtin;
+        NMEASentenceHandler custom;
+        void*               ctx;
+    };
+
+    DispatchEntry* dispatchSlot(uint32_t key);
+    void dispatch(const NMEAFields& f);
     
     // NMEA 0183 sentence parsers
-    void parseGGA(const char* line);  // GPS Fix Data
-    void parseZDA(const char* line);  // Date & Time
-    void parseRMC(const char* line);  // Recommended Minimum
-    void parseGLL(const char* line);  // Geographic Position
-    void parseVTG(const char* line);  // Track Made Good and Ground Speed
-    void parseHDT(const char* line);  // True Heading
-    void parseHDM(const char* line);  // Magnetic Heading
-    void parseDPT(const char* line);  // Depth
-    void parseDBT(const char* line);  // Depth Below Transducer
-    void parseMWV(const char* line);  // Wind Speed and Angle
-    void parseMWD(const char* line);  // Wind Direction & Speed
-    void parseMTW(const char* line);  // Water Temperature
-    void parseVHW(const char* line);  // Water Speed and Heading
-    void parseVLW(const char* line);  // Distance Traveled through Water
+    void parseGGA(const NMEAFields& f);  // GPS Fix Data
+    void parseZDA(const NMEAFields& f);  // Date & Time
+    void parseRMC(const NMEAFields& f);  // Recommended Minimum
+    void parseGLL(const NMEAFields& f);  // Geographic Position
+    void parseVTG(const NMEAFields& f);  // Track Made Good and Ground Speed
+    void parseHDT(const NMEAFields& f);  // True Heading
+    void parseHDM(const NMEAFields& f);  // Magnetic Heading
+    void parseDPT(const NMEAFields& f);  // Depth
+    void parseDBT(const NMEAFields& f);  // Depth Below Transducer
+    void parseMWV(const NMEAFields& f);  // Wind Speed and Angle
+    void parseMWD(const NMEAFields& f);  // Wind Direction & Speed
+    void parseMTW(const NMEAFields& f);  // Water Temperature
+    void parseVHW(const NMEAFields& f);  // Water Speed and Heading
+    void parseVLW(const NMEAFields& f);  // Distance Traveled through Water
     
     // AIS parser
-    void parseAIVDM(const char* line);  // AIS VHF Data-link Message
+    void parseAIVDM(const NMEAFields& f);  // AIS VHF Data-link Message
     
     // AIS helper functions
-    uint8_t aisCharTo6Bit(char c);
-    uint32_t extractBits(const uint8_t* payload, int start, int length);
-    void decodeAISType1(const uint8_t* payload, int payloadLen);  // Position Report
-    void decodeAISType5(const uint8_t* payload, int payloadLen);  // Ship Static Data
-    void decodeAISType18(const uint8_t* payload, int payloadLen); // Standard Class B Position Report
-    void decodeAISType24(const uint8_t* payload, int payloadLen); // Static Data Report
-    
-    // Utility functions
-    float parseLatitude(const char* lat, const char* ns);
-    float parseLongitude(const char* lon, const char* ew);
-    float parseKnots(const char* speed);
-    float parseDegrees(const char* degrees);
-    int parseField(const char* line, int fieldIndex, char* buffer, size_t bufferSize);
+    void decodeAIS(const char* payload, int len, int fillBits);  // Unarmor + aisDecode()
+    void applyAISMessage(const AISMessage& msg);                 // Map onto BoatState targets
+    
+    // Utility functions (locale-free, see nmea_number.h).  Missing or
+    // malformed fields read as 0, as they did with atof/atoi.
+    static float   fieldFloat(const NMEAField& f);
+    static int32_t fieldInt(const NMEAField& f);
+    void updatePosition(BoatState::Writer& w,
+                        const NMEAField& lat, const NMEAField& ns,
+                        const NMEAField& lon, const NMEAField& ew);
     
     uint32_t validSentences;
     uint32_t invalidSentences;
     BoatState* boatState;
+    DispatchEntry dispatchTable[NMEA_DISPATCH_SLOTS];
+
+    AISMessageHandler aisHandler;
+    void*             aisHandlerCtx;
+    uint32_t          aisDecoded[28];
+    AISReassembler    aisReassembly;
 };
 
 #endif // NMEA_PARSER_H
\ No newline at end of file
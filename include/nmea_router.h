@@ -0,0 +1,150 @@
+#ifndef NMEA_ROUTER_H
+#define NMEA_ROUTER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "config.h"
+
+class MetricsRegistry;
+
+/**
+ * @file nmea_router.h
+ * @brief Which outputs each input source feeds, and loop prevention.
+ *
+ * Sources are the UART input ports (0..NMEA_PORT_MAX-1) and TCP clients
+ * (NMEA_SOURCE_TCP).  Each has a mask of outputs: the UART TX lines, TCP
+ * clients, UDP and the WebSocket monitor.  The processor task asks
+ * route() once per sentence and fans out to the outputs it returns.
+ *
+ * Loops are prevented three ways:
+ *   - a UART input is never sent back out of its own TX line
+ *   - a TCP client's sentence is never sent back to that client
+ *     (TCPServer::broadcast skips the origin)
+ *   - a sentence arriving on a source identical to one sent out of that
+ *     source's return path (same UART's TX, or to that TCP client) less
+ *     than ROUTE_ECHO_MS ago is an echo: it goes nowhere.  This breaks
+ *     loops through devices that repeat what they receive, like a
+ *     plotter forwarding its whole input back over the same connection.
+ */
+
+// Output mask bits
+#define ROUTE_UART_TX(port)    ((uint8_t)(1u << (port)))  ///< UART port's TX line
+#define ROUTE_TCP              ((uint8_t)(1u << NMEA_PORT_MAX))
+#define ROUTE_UDP              ((uint8_t)(1u << (NMEA_PORT_MAX + 1)))
+#define ROUTE_WS               ((uint8_t)(1u << (NMEA_PORT_MAX + 2)))
+#define ROUTE_OUTPUT_COUNT     (NMEA_PORT_MAX + 3)
+#define ROUTE_ALL              ((uint8_t)((1u << ROUTE_OUTPUT_COUNT) - 1))
+
+/** What every port fed before routing existed; TCP input goes to the first UART's TX. */
+#define ROUTE_DEFAULT_UART     (ROUTE_TCP | ROUTE_UDP | ROUTE_WS)
+#define ROUTE_DEFAULT_TCP      (ROUTE_UART_TX(0) | ROUTE_WS)
+
+#ifndef ROUTE_ECHO_MS
+#define ROUTE_ECHO_MS          1000       ///< How long a sent sentence can come back as an echo
+#endif
+#define ROUTE_GUARD_TCP        256        ///< Sentences remembered for TCP (~1 s of full traffic)
+#define ROUTE_GUARD_UART       32         ///< Per UART TX line
+
+/**
+ * @brief The last N sentences sent out of one output, by hash.
+ *
+ * Each entry also holds the TCP client that was skipped (the sentence's
+ * own origin), so a client repeating its own sentence is not mistaken for
+ * one echoing another's.
+ */
+template <uint16_t N>
+class LoopGuard {
+public:
+    LoopGuard() : next(0), lastMs(0), any(false) {
+        for (uint16_t i = 0; i < N; i++) {
+            entries[i].hash   = 0;
+            entries[i].ms     = 0;
+            entries[i].except = NMEA_NO_CLIENT;
+            entries[i].used   = false;
+        }
+    }
+
+    void record(uint32_t hash, uint32_t nowMs, uint8_t except = NMEA_NO_CLIENT) {
+        Entry& e = entries[next];
+        e.hash   = hash;
+        e.ms     = nowMs;
+        e.except = except;
+        e.used   = true;
+        next   = (uint16_t)((next + 1) % N);
+        lastMs = nowMs;
+        any    = true;
+    }
+
+    /** Anything recorded within ROUTE_ECHO_MS (otherwise seen() is false without a scan). */
+    bool recent(uint32_t nowMs) const { return any && nowMs - lastMs < ROUTE_ECHO_MS; }
+
+    /** Was @p hash sent to @p client (or to everyone) within ROUTE_ECHO_MS? */
+    bool seen(uint32_t hash, uint32_t nowMs, uint8_t client = NMEA_NO_CLIENT) const {
+        if (!recent(nowMs)) return false;
+        for (uint16_t i = 0; i < N; i++) {
+            const Entry& e = entries[i];
+            if (e.used && e.hash == hash && nowMs - e.ms < ROUTE_ECHO_MS &&
+                (client == NMEA_NO_CLIENT || e.except != client)) return true;
+        }
+        return false;
+    }
+
+private:
+    struct Entry {
+        uint32_t hash;
+        uint32_t ms;
+        uint8_t  except;
+        bool     used;
+    };
+    Entry    entries[N];
+    uint16_t next;
+    uint32_t lastMs;
+    bool     any;
+};
+
+class NMEARouter {
+public:
+    NMEARouter();
+
+    /** Outputs fed by @p source.  A UART's own TX bit is always cleared. */
+    void    setRoutes(uint8_t source, uint8_t outputs);
+    uint8_t routes(uint8_t source) const { return source < NMEA_SOURCE_MAX ? table[source] : 0; }
+
+    /**
+     * @brief Outputs one sentence goes to, and remember it where it can echo back.
+     *
+     * Called by the processor task only.
+     * @param source     NMEA port or NMEA_SOURCE_TCP
+     * @param client     TCP client slot for NMEA_SOURCE_TCP, else NMEA_NO_CLIENT
+     * @param available  Outputs that can take a sentence now (clients connected, port running)
+     * @return Subset of routes(@p source) & @p available; 0 for an echo
+     */
+    uint8_t route(const char* text, size_t len, uint8_t source, uint8_t client,
+                  uint8_t available, uint32_t nowMs);
+
+    /** Sentences from @p source dropped as echoes. */
+    uint32_t looped(uint8_t source) const { return source < NMEA_SOURCE_MAX ? echoes[source] : 0; }
+
+    /** Expose echoes dropped per source on /metrics. */
+    void registerMetrics(MetricsRegistry& reg) const;
+
+    /** "uart0".."uart2", "tcp", "udp", "ws" for output bit @p output (0..ROUTE_OUTPUT_COUNT-1). */
+    static const char* outputName(uint8_t output);
+    /** "uart0".."uart2", "tcp" */
+    static const char* sourceName(uint8_t source);
+
+    /** FNV-1a over the sentence text. */
+    static uint32_t hash(const char* text, size_t len);
+
+private:
+    volatile uint8_t  table[NMEA_SOURCE_MAX];   ///< Written by the web server, read per sentence
+    uint32_t          echoes[NMEA_SOURCE_MAX];
+
+    LoopGuard<ROUTE_GUARD_TCP>  tcpSent;
+    LoopGuard<ROUTE_GUARD_UART> uartSent[NMEA_PORT_MAX];
+
+    NMEARouter(const NMEARouter&);
+    NMEARouter& operator=(const NMEARouter&);
+};
+
+#endif // NMEA_ROUTER_H
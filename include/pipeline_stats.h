@@ -0,0 +1,160 @@
+#ifndef PIPELINE_STATS_H
+#define PIPELINE_STATS_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "config.h"
+
+class MetricsRegistry;
+
+/**
+ * @file pipeline_stats.h
+ * @brief Per-stage latency, queue depth and drop accounting for the NMEA path.
+ *
+ * The sentence path is:
+ *
+ *   UART_RX<n>  frame line, stamp arrivalUs, push to merge ring
+ *   mergeTask   pop oldest (merge wait), parse + BoatState update (parse),
+ *               push to nmeaQueue and the logger queue
+ *   processor   pop (queue wait), TCP fan-out, WebSocket fan-out
+ *   logTask     write to SD (arrival → written)
+ *
+ * Each stage records into its own LatencyHistogram, written by one task
+ * only, so recording is a handful of plain stores with no locking.
+ * Queue depths are not: the pool depth is noted by every UART RX task and
+ * by the AsyncTCP task (TCP input), so high-water marks are raised by CAS
+ * and drops are atomic counters.  Readers (the web server) may see a
+ * histogram mid-update; the figures are statistics, not accounts.
+ */
+
+// ── Latency histogram ───────────────────────────────────────────────────────
+
+// Log-linear buckets (HDR-style): values below 16 µs get their own bucket,
+// then every power of two is split into 8 sub-buckets (≤ 12.5 % error).
+// The top bucket collects everything from 2^27 µs (~134 s) up.
+#define LATENCY_SUB_BITS     3
+#define LATENCY_LINEAR       16
+#define LATENCY_MAX_MSB      27
+#define LATENCY_BUCKETS      (LATENCY_LINEAR + (LATENCY_MAX_MSB - 3) * (1 << LATENCY_SUB_BITS))
+
+class LatencyHistogram {
+public:
+    LatencyHistogram() { reset(); }
+
+    void record(uint32_t us) {
+        counts[bucketOf(us)]++;
+        total++;
+        sumUs += us;
+        if (us > maxUs) maxUs = us;
+    }
+
+    void reset();
+
+    uint32_t count() const { return total; }
+    uint32_t max()   const { return maxUs; }
+    uint32_t mean()  const { return total ? (uint32_t)(sumUs / total) : 0; }
+    uint64_t sum()   const { return sumUs; }
+
+    /** Upper bound of the bucket holding the @p permille-th value (500 = median). */
+    uint32_t percentile(uint16_t permille) const;
+
+    static uint16_t bucketOf(uint32_t us);
+    /** Largest value that falls into bucket @p b. */
+    static uint32_t bucketUpper(uint16_t b);
+    uint32_t bucketCount(uint16_t b) const { return b < LATENCY_BUCKETS ? counts[b] : 0; }
+
+private:
+    uint32_t counts[LATENCY_BUCKETS];
+    uint32_t total;
+    uint32_t maxUs;
+    uint64_t sumUs;
+};
+
+// ── Pipeline ────────────────────────────────────────────────────────────────
+
+enum PipelineStage : uint8_t {
+    STAGE_MERGE_WAIT = 0,  ///< Framed → popped by the merge task
+    STAGE_PARSE,           ///< Checksum, tokenize, BoatState update
+    STAGE_QUEUE_WAIT,      ///< Pushed to nmeaQueue → popped by the processor
+    STAGE_FANOUT_TCP,      ///< TCPServer::broadcast()
+    STAGE_FANOUT_WS,       ///< WebServer::broadcastNMEA() (queued per client)
+    STAGE_FANOUT_UDP,      ///< UDPOutput::broadcast()
+    STAGE_FANOUT_UART,     ///< UARTHandler::send() on routed TX lines
+    STAGE_END_TO_END,      ///< Framed → fan-out done
+    STAGE_LOG,             ///< Framed → written to the SD log
+    STAGE_COUNT
+};
+
+enum PipelineQueue : uint8_t {
+    QUEUE_MERGE0 = 0,                        ///< One merge ring per input port, then TCP input
+    QUEUE_NMEA   = QUEUE_MERGE0 + NMEA_SOURCE_MAX,
+    QUEUE_LOG,
+    QUEUE_POOL,                              ///< Pool buffers in use
+    QUEUE_COUNT
+};
+
+enum DropReason : uint8_t {
+    DROP_POOL_EXHAUSTED = 0,  ///< No free sentence buffer at framing time
+    DROP_MERGE_FULL,          ///< Port's merge ring full
+    DROP_CHECKSUM,            ///< Bad checksum / not a sentence
+    DROP_NMEA_QUEUE_FULL,     ///< Processor behind
+    DROP_LOG_QUEUE_FULL,      ///< SD logger behind
+    DROP_REASON_COUNT
+};
+
+class PipelineStats {
+public:
+    PipelineStats();
+
+    void recordLatency(PipelineStage stage, uint32_t us) {
+        if (stage < STAGE_COUNT) stages[stage].record(us);
+    }
+
+    /** Note the current depth of @p queue; keeps the high-water mark.  Safe from any task. */
+    void recordDepth(PipelineQueue queue, uint16_t depth) {
+        if (queue >= QUEUE_COUNT) return;
+        queues[queue].depth = depth;
+        std::atomic<uint16_t>& high = queues[queue].highWater;
+        uint16_t seen = high.load(std::memory_order_relaxed);
+        while (depth > seen && !high.compare_exchange_weak(seen, depth, std::memory_order_relaxed)) {
+        }
+    }
+
+    /** Safe from any task: drops are counted from several. */
+    void recordDrop(DropReason reason) {
+        if (reason < DROP_REASON_COUNT) drops[reason].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    const LatencyHistogram& stage(PipelineStage s) const { return stages[s]; }
+    uint16_t depth(PipelineQueue q)     const { return q < QUEUE_COUNT ? queues[q].depth : 0; }
+    uint16_t highWater(PipelineQueue q) const {
+        return q < QUEUE_COUNT ? queues[q].highWater.load(std::memory_order_relaxed) : 0;
+    }
+    uint32_t dropped(DropReason r)      const {
+        return r < DROP_REASON_COUNT ? drops[r].load(std::memory_order_relaxed) : 0;
+    }
+
+    /** Clear histograms and high-water marks (drop counters keep running). */
+    void reset();
+
+    static const char* stageName(PipelineStage s);
+    static const char* dropName(DropReason r);
+
+    /** Expose stage histograms, drops and queue high-water marks on /metrics. */
+    void registerMetrics(MetricsRegistry& reg) const;
+
+private:
+    struct QueueDepth {
+        volatile uint16_t     depth;      ///< Last value noted (any writer wins)
+        std::atomic<uint16_t> highWater;  ///< Raised by CAS: several tasks note the pool depth
+    };
+
+    LatencyHistogram  stages[STAGE_COUNT];
+    QueueDepth        queues[QUEUE_COUNT];
+    std::atomic<uint32_t> drops[DROP_REASON_COUNT];
+
+    PipelineStats(const PipelineStats&);
+    PipelineStats& operator=(const PipelineStats&);
+};
+
+#endif // PIPELINE_STATS_H
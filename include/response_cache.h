@@ -0,0 +1,96 @@
+#ifndef RESPONSE_CACHE_H
+#define RESPONSE_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "config.h"
+
+class MetricsRegistry;
+
+/**
+ * @file response_cache.h
+ * @brief Built JSON bodies of the read-mostly endpoints, kept until what they read changes.
+ *
+ * Storage usage, the LittleFS listing, the polar status and the SD
+ * statistics cost a filesystem walk or a FAT free-cluster count (on the
+ * SPI bus shared with the logger) per request, for answers that change
+ * only when a file is written, deleted or the card is (un)mounted.
+ *
+ * Each body depends on a set of sources; each source has a generation
+ * that the code changing it bumps through invalidate(), from any task.
+ * An entry built at one stamp (sum of its sources' generations, read
+ * before reading the data) is served until the stamp moves, or for
+ * RESPONSE_CACHE_MAX_AGE_MS at most: appends to an open log file grow the
+ * card's usage without an event.
+ *
+ * get() and put() are for one task (the AsyncTCP task); a returned body
+ * stays valid until the next put() of the same key.  Buffers are kept and
+ * reused, so a rebuild of a body no longer than before does not allocate.
+ */
+
+/** What the cached bodies are built from. */
+enum CacheSource : uint8_t {
+    CACHE_SOURCE_LITTLEFS = 0,   ///< Any file written or removed, format
+    CACHE_SOURCE_SD,             ///< SDManager change listener (write, delete, mkdir, format, mount)
+    CACHE_SOURCE_POLAR,          ///< Polar table reloaded
+    CACHE_SOURCE_COUNT
+};
+
+#define CACHE_MASK(source)  (1UL << (source))
+
+#define RESPONSE_CACHE_SLOTS  8
+
+class ResponseCache {
+public:
+    /** @param maxAgeMs  Longest an entry is served; 0 = until invalidated. */
+    explicit ResponseCache(uint32_t maxAgeMs = RESPONSE_CACHE_MAX_AGE_MS);
+    ~ResponseCache();
+
+    /** The sources in @p sources changed: entries built from them are dropped on their next get(). */
+    void invalidate(uint32_t sources);
+
+    /** Stamp to put() a body built from @p sources with; read it before reading the data. */
+    uint32_t stamp(uint32_t sources) const;
+
+    /**
+     * @brief The body cached for @p key, NUL-terminated.
+     * @return nullptr if absent, invalidated or older than the max age (counted as a miss)
+     */
+    const char* get(uint8_t key, uint32_t now, size_t* len = nullptr);
+
+    /**
+     * @brief Cache @p body for @p key, built from @p sources at @p stamp.
+     * @return false if @p key is out of range or the buffer could not be allocated
+     */
+    bool put(uint8_t key, uint32_t sources, uint32_t stamp, uint32_t now, const char* body, size_t len);
+
+    uint32_t getHits()          const { return hits; }
+    uint32_t getMisses()        const { return misses; }
+    uint32_t getInvalidations() const { return invalidations.load(std::memory_order_relaxed); }
+
+    void registerMetrics(MetricsRegistry& reg);
+
+private:
+    struct Entry {
+        char*    body;       ///< nullptr = never built
+        size_t   cap;
+        size_t   len;
+        uint32_t sources;
+        uint32_t stamp;
+        uint32_t builtAt;
+        bool     valid;
+    };
+
+    Entry                 entries[RESPONSE_CACHE_SLOTS];
+    std::atomic<uint32_t> generation[CACHE_SOURCE_COUNT];
+    uint32_t              maxAgeMs;
+    volatile uint32_t     hits;
+    volatile uint32_t     misses;
+    std::atomic<uint32_t> invalidations;
+
+    ResponseCache(const ResponseCache&);
+    ResponseCache& operator=(const ResponseCache&);
+};
+
+#endif // RESPONSE_CACHE_H
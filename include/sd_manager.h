@@ -40,6 +40,25 @@ struct SDFileInfo {
     SDFileInfo() : size(0), isDir(false) {}
 };
 
+#define SD_LIST_MAX_DEPTH 4
+
+/**
+ * @brief Depth-first walk over a directory tree, one entry per SDManager::nextEntry().
+ *
+ * The directories on the way down stay open between calls, so a listing
+ * can be streamed out without collecting it first.  The SD mutex is only
+ * held inside each call; a cursor opened before an unmount or remount just
+ * ends.
+ */
+struct SDDirCursor {
+    File     dirs[SD_LIST_MAX_DEPTH + 1];
+    int8_t   depth;       ///< Innermost open directory, -1 once finished
+    uint8_t  maxDepth;
+    uint32_t mountEpoch;  ///< SDManager mount the handles belong to
+
+    SDDirCursor() : depth(-1), maxDepth(0), mountEpoch(0) {}
+};
+
 /**
  * @brief SD card storage statistics.
  */
@@ -56,6 +75,15 @@ struct SDStorageInfo {
           usedPct(0), mounted(false) {}
 };
 
+/**
+ * @brief Called after anything that changes the card's contents or mount state.
+ *
+ * Runs on the task that made the change (web server, logger) once the SD
+ * mutex is released: keep it short.  Writes through an already open File
+ * are not reported.
+ */
+typedef void (*SDChangeListener)(void* ctx);
+
 // ─────────────────────────────────────────────────────────────────────────────
 // SDManager
 // ─────────────────────────────────────────────────────────────────────────────
@@ -91,6 +119,9 @@ public:
     /** @return true when a card is currently mounted and accessible. */
     bool isMounted() const { return mounted; }
 
+    /** Set the one change listener (nullptr to clear). */
+    void setChangeListener(SDChangeListener fn, void* ctx = nullptr);
+
     /**
      * @brief Return storage statistics.
      * @return SDStorageInfo struct; mounted=false when no card is present.
@@ -109,6 +140,22 @@ public:
     std::vector<SDFileInfo> listFiles(const char* dirPath = "/",
                                        uint8_t maxDepth = 4);
 
+    /**
+     * @brief Start walking @p dirPath as listFiles() would, without collecting it.
+     * @return false if unmounted or @p dirPath is not a directory.
+     */
+    bool openDir(SDDirCursor& cursor, const char* dirPath = "/",
+                 uint8_t maxDepth = SD_LIST_MAX_DEPTH);
+
+    /**
+     * @brief Next entry in listFiles() order: each directory is followed by its contents.
+     * @return false once the walk is over (closes the cursor).
+     */
+    bool nextEntry(SDDirCursor& cursor, SDFileInfo& out);
+
+    /** Close a cursor before the end of its walk. */
+    void closeDir(SDDirCursor& cursor);
+
     /**
      * @brief Delete a single file by path.
      * @param path  Absolute file path.
@@ -168,8 +215,13 @@ public:
 
 private:
     bool               mounted;
+    uint32_t           mountEpoch;  ///< Bumped on every mount, invalidates SDDirCursor
     SPIClass*          spi;
     SemaphoreHandle_t  mutex;
+    SDChangeListener   changeListener;
+    void*              changeCtx;
+
+    void notifyChange() { if (changeListener) changeListener(changeCtx); }
 
     // Internal recursive listing helper
     void listDir(File& dir, std::vector<SDFileInfo>& out, uint8_t depth,
@@ -0,0 +1,131 @@
+#ifndef SENTENCE_FILTER_H
+#define SENTENCE_FILTER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @file sentence_filter.h
+ * @brief Per-client sentence whitelist and rate limits for the TCP server.
+ *
+ * A client configures its filter with a proprietary sentence on the same
+ * connection (checksum optional, so it can be typed into nc):
+ *
+ *   $PMAR,FILTER,<rule>,<rule>,...   replace the rule list
+ *   $PMAR,FILTER                     no rules: receive everything (default)
+ *   $PMAR,FILTER,?                   report the current rules
+ *
+ * A rule is a pattern with an optional maximum rate in Hz:
+ *
+ *   RMC        that sentence type from any talker
+ *   GPRMC      exactly that address
+ *   AI*  P*    any address starting with the prefix
+ *   *          anything
+ *   MWV/2      at most 2 per second, per address (GN and GP RMC separately)
+ *   VDM/0.2    one every 5 s
+ *
+ * With rules set, a sentence goes through if the first rule it matches
+ * lets it; sentences matching no rule are dropped.  The reply is
+ * $PMAR,OK,FILTER,<rules> or $PMAR,ERR,FILTER,<reason>; a list with a
+ * bad rule is rejected as a whole and the previous rules stay.
+ *
+ * Multi-sentence AIS messages are decided on their first fragment, and
+ * the remaining fragments follow it, so a rate limit never hands the
+ * client half a message.  Messages in progress are told apart by
+ * (talker, sequential id, channel), as AISReassembler does, so parts
+ * interleaved from two channels or receivers each follow their own
+ * first fragment; FILTER_AIS_GROUPS of them are tracked per client.
+ */
+
+#ifndef FILTER_MAX_RULES
+#define FILTER_MAX_RULES       16
+#endif
+#ifndef FILTER_RATE_SLOTS
+#define FILTER_RATE_SLOTS      24     ///< Rate-limited addresses tracked per client
+#endif
+#ifndef FILTER_AIS_GROUPS
+#define FILTER_AIS_GROUPS      4      ///< Multi-part AIS messages in progress tracked per client
+#endif
+#define FILTER_ADDRESS_MAX     8      ///< "GPRMC", "PGRME", "PMAR" …
+/** Longest rule as describe() writes it: comma, 7-character prefix, "*", "/99.9". */
+#define FILTER_RULE_TEXT_MAX   (1 + (FILTER_ADDRESS_MAX - 1) + 1 + 5)
+/** Room for the longest reply: "$PMAR,OK,FILTER" and every rule at its longest, "*hh\r\n", NUL. */
+#define FILTER_REPLY_MAX       (sizeof("$PMAR,OK,FILTER*hh\r\n") + FILTER_MAX_RULES * FILTER_RULE_TEXT_MAX)
+
+/** The parts of a sentence a filter looks at, extracted once per broadcast. */
+struct SentenceKey {
+    char    address[FILTER_ADDRESS_MAX];   ///< Between '$'/'!' and the first ',' (NUL-terminated)
+    uint8_t addressLen;
+    uint8_t fragments;    ///< AIS VDM/VDO: fragment count (0 = not AIS)
+    uint8_t fragment;     ///< AIS: this fragment's number
+    char    seqId;        ///< AIS: sequential message id ('\0' for single-part)
+    char    channel;
+
+    /** Fill from @p line (starting with '$' or '!').  @return false if it is not a sentence. */
+    bool parse(const char* line, size_t len);
+};
+
+class SentenceFilter {
+public:
+    SentenceFilter();
+
+    /** Forget all rules and rate state (new connection). */
+    void clear();
+
+    /** True when the client should get this sentence; records it against its rate. */
+    bool accept(const SentenceKey& key, uint32_t nowMs);
+
+    /**
+     * @brief Handle a $PMAR,FILTER command received from the client.
+     * @param line  The command, with or without '*hh' (validated when present)
+     * @param reply Filled with the sentence to send back, CR LF terminated
+     * @return false if @p line is not a $PMAR,FILTER command (reply untouched)
+     */
+    bool command(const char* line, size_t len, char* reply, size_t replyLen);
+
+    bool    active()    const { return ruleCount > 0; }
+    uint8_t rules()     const { return ruleCount; }
+    /** Current rules as they would be given to $PMAR,FILTER (empty when none). */
+    size_t  describe(char* out, size_t outLen) const;
+
+    /** Write "$<body>*hh\r\n" into @p out.  @return length, 0 if it does not fit. */
+    static size_t formatSentence(char* out, size_t outLen, const char* body);
+
+private:
+    struct Rule {
+        char     pattern[FILTER_ADDRESS_MAX];
+        uint8_t  len;
+        bool     prefix;           ///< Trailing '*': prefix match (empty = anything)
+        uint32_t minIntervalMs;    ///< 0 = no rate limit
+        uint16_t rateTenthsHz;     ///< As given, for describe()
+    };
+    /** Multi-part AIS message in progress: the following fragments share the first one's fate. */
+    struct AISGroup {
+        char     talker[2];
+        char     seqId;
+        char     channel;
+        uint8_t  next;             ///< Next expected fragment number, 0 = slot free
+        bool     pass;
+        uint32_t used;             ///< LRU stamp
+    };
+    struct RateSlot {
+        char     address[FILTER_ADDRESS_MAX];
+        uint32_t lastMs;
+        uint32_t used;             ///< LRU stamp
+    };
+
+    const Rule* match(const SentenceKey& key) const;
+    bool        allowRate(const Rule& rule, const SentenceKey& key, uint32_t nowMs);
+    AISGroup*   findGroup(const SentenceKey& key);
+    bool        parseRule(const char* text, size_t len, Rule& rule) const;
+    void        replyRules(char* reply, size_t replyLen) const;
+
+    Rule     ruleList[FILTER_MAX_RULES];
+    uint8_t  ruleCount;
+    RateSlot rate[FILTER_RATE_SLOTS];
+    uint32_t rateClock;
+    AISGroup ais[FILTER_AIS_GROUPS];
+    uint32_t aisClock;
+};
+
+#endif // SENTENCE_FILTER_H
@@ -0,0 +1,95 @@
+#ifndef SENTENCE_POOL_H
+#define SENTENCE_POOL_H
+
+#include <Arduino.h>
+#include <atomic>
+#include "config.h"
+
+class MetricsRegistry;
+
+/**
+ * @file sentence_pool.h
+ * @brief Fixed pool of reference-counted sentence buffers.
+ *
+ * A sentence is copied exactly once, from the UART read block into a pool
+ * buffer, and from then on only its 16-bit reference travels: through the
+ * merge rings, the NMEA ring to the processor task, and the logger queue.
+ * Every holder releases its reference when done; the last release returns
+ * the buffer to the pool.
+ *
+ * Free buffers are tracked in a bitmap claimed with compare-and-swap, so
+ * acquire() and release() are lock-free and safe from any task on either
+ * core.  (A ring would not do here: a release racing a pop that was
+ * preempted half-way can find the ring "full" and lose the buffer.)
+ */
+
+typedef uint16_t SentenceRef;
+
+#define SENTENCE_NONE  ((SentenceRef)0xFFFF)
+
+static_assert(SENTENCE_POOL_SIZE < SENTENCE_NONE, "SENTENCE_POOL_SIZE too large for SentenceRef");
+
+/** One shared sentence. Written by the acquirer only, read-only once published. */
+struct SentenceBuf {
+    std::atomic<uint32_t> refs;
+    uint32_t arrivalUs;             ///< micros() when the RX task framed it
+    uint32_t queuedUs;              ///< micros() when parsed and handed to the processor
+    uint8_t  source;                ///< Input port, or NMEA_SOURCE_TCP
+    uint8_t  origin;                ///< TCP client slot for NMEA_SOURCE_TCP, else NMEA_NO_CLIENT
+    uint8_t  len;
+    char     raw[NMEA_MAX_LENGTH];  ///< NUL-terminated
+};
+
+class SentencePool {
+public:
+    SentencePool();
+    ~SentencePool();
+
+    /** Allocate the buffers (PSRAM when available) and fill the free list. */
+    bool begin();
+
+    /**
+     * @brief Take a free buffer with one reference held by the caller.
+     * @return SENTENCE_NONE when the pool is exhausted (counted).
+     */
+    SentenceRef acquire();
+
+    /** Copy @p len bytes of @p text into a fresh buffer. SENTENCE_NONE if exhausted. */
+    SentenceRef acquire(const char* text, size_t len, uint8_t source, uint32_t arrivalUs);
+
+    /** Add @p n references, one per extra holder the buffer is handed to. */
+    void retain(SentenceRef ref, uint32_t n = 1) {
+        bufs[ref].refs.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    /** Drop one reference; the last one returns the buffer to the pool. */
+    void release(SentenceRef ref);
+
+    SentenceBuf&       at(SentenceRef ref)       { return bufs[ref]; }
+    const SentenceBuf& at(SentenceRef ref) const { return bufs[ref]; }
+    const char*        text(SentenceRef ref) const { return bufs[ref].raw; }
+
+    uint16_t capacity()  const { return bufs ? SENTENCE_POOL_SIZE : 0; }
+    uint16_t available() const { return (uint16_t)freeCount.load(std::memory_order_relaxed); }
+    /** Lowest available() seen since begin(). */
+    uint16_t lowWater()  const { return (uint16_t)lowMark.load(std::memory_order_relaxed); }
+    uint32_t exhausted() const { return exhaustedCount.load(std::memory_order_relaxed); }
+
+    /** Expose size, free buffers, low water and exhaustion on /metrics. */
+    void registerMetrics(MetricsRegistry& reg) const;
+
+private:
+    enum { FREE_WORDS = (SENTENCE_POOL_SIZE + 31) / 32 };
+
+    SentenceBuf*          bufs;
+    std::atomic<uint32_t> freeMap[FREE_WORDS];   ///< Bit set = buffer free
+    std::atomic<uint32_t> freeCount;
+    std::atomic<uint32_t> hint;                  ///< Word to start the next search at
+    std::atomic<uint32_t> lowMark;               ///< Lowered by CAS: acquirers run on both cores
+    std::atomic<uint32_t> exhaustedCount;
+
+    SentencePool(const SentencePool&);
+    SentencePool& operator=(const SentencePool&);
+};
+
+#endif // SENTENCE_POOL_H
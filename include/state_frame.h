@@ -0,0 +1,112 @@
+#ifndef STATE_FRAME_H
+#define STATE_FRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+class BoatState;
+
+/**
+ * @file state_frame.h
+ * @brief Binary instrument frames for /ws/state: field id + fixed-point value.
+ *
+ * Every instrument the dashboard shows is one field with a fixed scale, so
+ * a value travels as an int32 instead of a JSON DataPoint.  A frame is
+ *
+ *   byte 0     STATE_FRAME_KEY for a keyframe (every field), else 0
+ *   byte 1     number of entries
+ *   then       per entry: field id (1 byte), value (int32, little-endian)
+ *
+ * value / scale is the reading in the field's unit; STATE_NO_VALUE means
+ * invalid or stale.  A client gets a keyframe first and then only the
+ * fields whose value differs from what it was last sent, with a keyframe
+ * again at least every WS_STATE_KEYFRAME_MS.
+ *
+ * The table below is the wire contract: ids are never reused, new fields go
+ * at the end (web-dashboard/src/services/websocket.js mirrors it).
+ */
+
+enum StateField : uint8_t {
+    SF_LAT = 0,         ///< deg × 1e7
+    SF_LON,             ///< deg × 1e7
+    SF_SOG,             ///< kn × 100
+    SF_COG,             ///< deg × 10
+    SF_SATELLITES,      ///< count
+    SF_HDOP,            ///< × 100
+    SF_STW,             ///< kn × 100
+    SF_TRIP,            ///< nm × 100
+    SF_TOTAL,           ///< nm × 10
+    SF_HEADING_MAG,     ///< deg × 10
+    SF_HEADING_TRUE,    ///< deg × 10
+    SF_DEPTH,           ///< m × 100
+    SF_AWS,             ///< kn × 100
+    SF_AWA,             ///< deg × 10
+    SF_TWS,             ///< kn × 100
+    SF_TWA,             ///< deg × 10
+    SF_TWD,             ///< deg × 10
+    SF_WATER_TEMP,      ///< °C × 10
+    SF_VMG,             ///< kn × 100
+    SF_POLAR_PCT,       ///< % × 10
+    SF_POLAR_LOADED,    ///< 0 / 1
+    STATE_FIELD_COUNT
+};
+
+#define STATE_NO_VALUE       ((int32_t)0x80000000)   ///< INT32_MIN: invalid or stale
+#define STATE_FRAME_KEY      0x01
+#define STATE_FRAME_HEADER   2
+#define STATE_FRAME_ENTRY    5
+#define STATE_FRAME_MAX      (STATE_FRAME_HEADER + STATE_FIELD_COUNT * STATE_FRAME_ENTRY)
+
+/** Every field's wire value at one instant. */
+struct StateSnapshot {
+    int32_t values[STATE_FIELD_COUNT];
+
+    StateSnapshot() { clear(); }
+
+    /** All fields STATE_NO_VALUE. */
+    void clear();
+
+    /** Read every section of @p state (seqlock copies, no allocation). */
+    void capture(BoatState& state);
+
+    /** Divisor turning field @p field's wire value into its unit. */
+    static int32_t scale(uint8_t field);
+};
+
+/**
+ * @brief One client's view: what it was last sent, and when its last keyframe went.
+ *
+ * Not thread-safe: the owner serialises encode() and reset() per client.
+ */
+class StateFrameEncoder {
+public:
+    StateFrameEncoder();
+
+    /** Forget what was sent: the next frame is a keyframe (new connection). */
+    void reset();
+
+    /**
+     * @brief Frame @p now against what this client was last sent.
+     * @param out  At least STATE_FRAME_MAX bytes
+     * @return Frame length; 0 when nothing changed and no keyframe is due
+     */
+    size_t encode(const StateSnapshot& now, uint32_t nowMs, uint8_t* out);
+
+    uint32_t getKeyframes() const { return keyframes; }
+    uint32_t getDeltas()    const { return deltas; }
+
+private:
+    int32_t  sent[STATE_FIELD_COUNT];
+    uint32_t lastKeyMs;
+    bool     primed;
+    uint32_t keyframes;
+    uint32_t deltas;
+};
+
+/**
+ * @brief Apply a frame to @p into, as a client does (keyframes overwrite every field).
+ * @return false on a malformed frame; @p into is then partially updated
+ */
+bool applyStateFrame(const uint8_t* frame, size_t len, StateSnapshot& into);
+
+#endif // STATE_FRAME_H
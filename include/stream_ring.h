@@ -0,0 +1,98 @@
+#ifndef STREAM_RING_H
+#define STREAM_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/**
+ * @file stream_ring.h
+ * @brief Per-connection byte ring that batches sentences into large writes.
+ *
+ * A producer appends whole sentences; a sink drains the ring in as few,
+ * as large, contiguous chunks as it will accept.  due() says when a drain
+ * is worth it: once a full batch (typically one TCP MSS) is waiting, or
+ * once the oldest waiting byte has been queued for the latency bound.
+ *
+ * A sentence is appended whole or not at all, so a full ring never tears
+ * a sentence in the stream; refused appends are counted as overflows.
+ * overflowingFor() tells how long appends have been refused without the
+ * sink draining anything, which is the slow-client eviction signal.
+ *
+ * Not thread-safe: the owner serialises append and drain (TCPServer does
+ * both under its clients mutex).
+ */
+class StreamRing {
+public:
+    StreamRing();
+    ~StreamRing();
+
+    /** Allocate @p capacity bytes (PSRAM when available).  Once, at init. */
+    bool begin(size_t capacity);
+
+    /** Drop everything queued and reset the counters (new connection). */
+    void clear();
+
+    /** Queue @p len bytes, all or nothing.  @return false on overflow. */
+    bool append(const char* data, size_t len, uint32_t nowMs);
+
+    /** As append(), adding CR LF when @p data does not already end with it. */
+    bool appendLine(const char* data, size_t len, uint32_t nowMs);
+
+    /**
+     * @brief Oldest queued bytes that are contiguous in memory.
+     * @return Their length (0 when empty); call again after consume() for
+     *         the part that wrapped around.
+     */
+    size_t peek(const char*& data) const;
+
+    /** Release @p n bytes returned by peek() once the sink has taken them. */
+    void consume(size_t n);
+
+    /** True when a full @p batchBytes is queued or anything has waited @p maxDelayMs. */
+    bool due(uint32_t nowMs, size_t batchBytes, uint32_t maxDelayMs) const;
+
+    /**
+     * @brief How long the owner may sleep before due() turns true by age.
+     *
+     * @p maxDelayMs when empty.  After sinkRefused(), counts from the refusal
+     * instead, so a sink that stays blocked is retried once per bound
+     * rather than reported due (0) on every call until it drains.
+     */
+    uint32_t msUntilDue(uint32_t nowMs, uint32_t maxDelayMs) const;
+
+    /** A due drain was refused by the sink (its queue is full); cleared by the next consume(). */
+    void sinkRefused(uint32_t nowMs) { refused = true; refusedAt = nowMs; }
+
+    /** How long the oldest queued byte has waited; 0 when empty. */
+    uint32_t waited(uint32_t nowMs) const { return used ? nowMs - pendingSince : 0; }
+
+    /** How long appends have been refused with nothing drained; 0 if not overflowing. */
+    uint32_t overflowingFor(uint32_t nowMs) const;
+
+    size_t   pending()   const { return used; }
+    size_t   capacity()  const { return size; }
+    size_t   space()     const { return size - used; }
+    uint32_t overflows() const { return overflowCount; }   ///< Appends refused
+    uint32_t appended()  const { return appendCount; }     ///< Appends accepted
+
+private:
+    void put(const char* data, size_t len);
+    bool refuse(uint32_t nowMs);
+
+    char*    buf;
+    size_t   size;
+    size_t   head;            ///< Next byte to read
+    size_t   used;
+    uint32_t pendingSince;    ///< When the ring last went from empty to non-empty
+    uint32_t overflowSince;   ///< First refused append since the last drain
+    bool     overflowing;
+    uint32_t refusedAt;       ///< Last sinkRefused() since the last drain
+    bool     refused;
+    uint32_t overflowCount;
+    uint32_t appendCount;
+
+    StreamRing(const StreamRing&);
+    StreamRing& operator=(const StreamRing&);
+};
+
+#endif // STREAM_RING_H
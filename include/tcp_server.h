@@ -5,56 +5,134 @@
 #include <freertos/FreeRTOS.h>
 #include <freertos/semphr.h>
 #include <AsyncTCP.h>
-#include <vector>
-#include <map>
 #include "config.h"
+#include "stream_ring.h"
+#include "sentence_filter.h"
+#include "nmea_framer.h"
+
+class MetricsRegistry;
+
+/**
+ * @brief Receives one line typed in by a TCP client (on the AsyncTCP task, clients locked).
+ * @param client  Slot number, 0..TCP_MAX_CLIENTS-1
+ */
+typedef void (*TCPInputHandler)(const char* line, size_t len, uint8_t client, void* ctx);
 
 // ═══════════════════════════════════════════════════════════════
-// Structure pour tracker les statistiques par client - NOUVEAU
+// Statistiques par client
 // ═══════════════════════════════════════════════════════════════
 struct ClientStats {
-    uint32_t lastSend;          // Timestamp du dernier envoi réussi
-    uint32_t failedSends;       // Nombre d'échecs consécutifs actuels
-    uint32_t totalSent;         // Total messages envoyés avec succès
-    uint32_t totalSkipped;      // Total messages skippés (buffer plein)
+    uint32_t lastSend;          // millis() of the last batch handed to lwIP
+    uint32_t totalSent;         // Sentences queued for this client
+    uint32_t totalSkipped;      // Sentences dropped: output ring full
+    uint32_t totalFiltered;     // Sentences withheld by the client's $PMAR,FILTER rules
+    uint32_t bytesSent;         // Bytes handed to lwIP
+    uint32_t segments;          // Batches sent (one send() each)
 };
 
+/**
+ * @brief NMEA 0183 over TCP (port 10110), transmit side.
+ *
+ * broadcast() only appends the sentence to each client's StreamRing.
+ * A ring is drained into AsyncTCP when a full MSS is waiting or its
+ * oldest byte has waited TCP_COALESCE_MS (checked by broadcast() and by
+ * flush(), which the processor task calls on every wake), and again from
+ * the client's onAck / onPoll callbacks as the send window reopens.  So
+ * a client gets a few MSS-sized segments a second instead of one small
+ * segment per sentence.
+ *
+ * A client that cannot keep up fills its ring: further sentences are
+ * dropped for it alone, and once its ring has stayed full for
+ * TCP_CLIENT_STALL_MS without draining, it is disconnected.
+ *
+ * Each client may narrow what it receives with $PMAR,FILTER commands on
+ * the same connection (see sentence_filter.h); the sentence address is
+ * extracted once per broadcast and checked against each client's rules
+ * before anything is copied into its ring.
+ *
+ * Any other line a client sends goes to the input handler with the
+ * client's slot number, so the gateway can feed it to the parser and out
+ * the UART TX lines (see nmea_router.h).  A sentence broadcast back to
+ * TCP skips the client it came from.
+ */
 class TCPServer {
 public:
     TCPServer();
     ~TCPServer();
-    
+
     void init(uint16_t port);
     void start();
     void stop();
-    
+
+    /** Take client input (anything but $PMAR,FILTER).  Without a handler it is ignored. */
+    void setInputHandler(TCPInputHandler handler, void* ctx = nullptr);
+
     // Broadcast methods
     void broadcast(const char* data);
-    void broadcast(const char* data, size_t len);
-    
+    /** @param except  Client slot that sent the sentence, skipped; NMEA_NO_CLIENT for none */
+    void broadcast(const char* data, size_t len, uint8_t except = NMEA_NO_CLIENT);
+
+    /** Send batches whose latency bound has expired; evict stalled clients. */
+    void flush();
+
     // Client management
-    size_t getClientCount();
+    /** A word read, without the clients mutex: for gauges and the "anyone connected?" check. */
+    size_t getClientCount() const { return clientCount; }
     bool getClientStats(AsyncClient* client, ClientStats& stats);
-    
+
+    // Metrics
+    void registerMetrics(MetricsRegistry& reg);
+
 private:
+    struct Slot {
+        AsyncClient* client;        // nullptr = free
+        uint16_t     mss;
+        StreamRing   ring;
+        ClientStats  stats;
+        SentenceFilter filter;
+        NMEALineFramer framer;      // Client → gateway lines
+    };
+
     AsyncServer* server;
-    std::vector<AsyncClient*> clients;
-    std::map<AsyncClient*, ClientStats> clientStats;  // NOUVEAU: Stats par client
+    Slot slots[TCP_MAX_CLIENTS];
+    volatile size_t clientCount;
     SemaphoreHandle_t clientsMutex;
-    
+
     uint16_t port;
     bool initialized;
     bool running;
-    
+
+    // Totals across clients, for /metrics
+    volatile uint32_t bytesSent;
+    volatile uint32_t segmentsSent;
+    volatile uint32_t sentencesDropped;
+    volatile uint32_t sentencesFiltered;
+    volatile uint32_t evictions;
+    volatile uint32_t linesReceived;   // Client lines handed to the input handler
+    uint32_t lastStatsLog;
+    Slot* rxSlot;               // Slot whose input is being framed (clientsMutex held)
+    TCPInputHandler inputHandler;
+    void* inputCtx;
+
     // Client event handlers
     void onConnect(AsyncClient* client);
     void onDisconnect(AsyncClient* client);
     void onData(AsyncClient* client, void* data, size_t len);
     void onError(AsyncClient* client, int8_t error);
-    
-    // Internal methods
+    void onAck(AsyncClient* client);
+    void onPoll(AsyncClient* client);
+    static void onClientLine(char* line, size_t len, void* ctx);
+    void handleClientLine(Slot& s, const char* line, size_t len);
+
+    // Internal methods (clientsMutex held)
+    Slot* findSlot(AsyncClient* client);
+    size_t drain(Slot& s, uint32_t now);
+    /** Free the slot of a stalled client; returns the client for closing after unlock. */
+    AsyncClient* evictIfStalled(Slot& s, uint32_t now);
+    void logStats(uint32_t now);
+
     void addClient(AsyncClient* client);
     void removeClient(AsyncClient* client);
 };
 
-#endif // TCP_SERVER_H
\ No newline at end of file
+#endif // TCP_SERVER_H
@@ -2,6 +2,7 @@
 #define TYPES_H
 
 #include <stdint.h>
+#include "config.h"
 
 // WiFi configuration structure
 struct WiFiConfig {
@@ -43,8 +44,9 @@ struct UARTConfig {
     uint8_t dataBits;  // 5-8
     uint8_t parity;    // 0=None, 1=Even, 2=Odd
     uint8_t stopBits;  // 1-2
+    bool enabled;      // Port brought up at boot (port 0 always is)
     
-    UARTConfig() : baudRate(38400), dataBits(8), parity(0), stopBits(1) {}
+    UARTConfig() : baudRate(38400), dataBits(8), parity(0), stopBits(1), enabled(true) {}
 };
 
 // BLE configuration structure
@@ -59,6 +61,29 @@ struct BLEConfigData {
     }
 };
 
+// UDP output configuration
+struct UDPConfig {
+    bool enabled;
+    uint8_t mode;           // 0=Broadcast, 1=Multicast
+    uint16_t port;
+    char group[16];         // Multicast group, dotted quad
+    uint16_t maxDatagram;   // Bytes per datagram
+    uint16_t maxDelayMs;    // Longest a sentence waits for a fuller datagram
+
+    UDPConfig() : enabled(false), mode(0), port(10110), maxDatagram(1472), maxDelayMs(50) {
+        strcpy(group, "239.192.0.1");
+    }
+};
+
+// Routing: output mask per input source (see nmea_router.h)
+struct RouteConfig {
+    uint8_t outputs[NMEA_SOURCE_MAX];   // Indexed by UART port, then NMEA_SOURCE_TCP
+
+    RouteConfig() {
+        for (uint8_t s = 0; s < NMEA_SOURCE_MAX; s++) outputs[s] = 0;
+    }
+};
+
 // NMEA sentence structure
 struct NMEASentence {
     char raw[128];
@@ -4,37 +4,94 @@
 #include <Arduino.h>
 #include "config.h"
 #include "types.h"
+#include "nmea_framer.h"
 #include <freertos/FreeRTOS.h>
-#include <freertos/stream_buffer.h>
+#include <freertos/queue.h>
 
+class MetricsRegistry;
+
+/**
+ * @brief NMEA 0183 UART input.
+ *
+ * The UART driver's event queue wakes the RX task when a '\n' arrives
+ * (pattern detection) or the RX FIFO crosses its threshold.  The task then
+ * bulk-reads whatever the driver has buffered and frames it in place with
+ * NMEALineFramer, so there is one driver call per block instead of one
+ * kernel call per byte.  Complete sentences go to the line handler on the
+ * RX task.
+ *
+ * One instance per NMEA input port (see NMEA_PORT_COUNT); each owns its
+ * UART, RX task, framer and counters.
+ *
+ * The TX line carries sentences routed to the port (see nmea_router.h).
+ * send() never blocks the caller: it tracks when the driver's TX buffer
+ * will have drained at the configured baud rate and drops a sentence that
+ * would not fit, so a 4800 baud listener cannot stall the processor task.
+ */
 class UARTHandler {
 public:
     UARTHandler();
     ~UARTHandler();
-    
-    void init(const UARTConfig& config);
+
+    /** Bring up input @p port (0..NMEA_PORT_MAX-1) with its UART and pins from config.h. */
+    void init(uint8_t port, const UARTConfig& config);
     void start();
     void stop();
-    bool readLine(char* buffer, size_t maxLen, TickType_t timeout);
-    
-    uint32_t getSentencesReceived() const { return sentencesReceived; }
-    uint32_t getErrors() const { return errors; }
-    
+
+    /**
+     * @brief Route framed sentences to @p handler (called on the RX task).
+     * Set before start().
+     */
+    void setLineHandler(NMEALineHandler handler, void* ctx = nullptr);
+
+    uint8_t  getPort() const { return port; }
+    bool     isRunning() const { return running; }
+    uint32_t getBaudRate() const { return config.baudRate; }
+
+    uint32_t getSentencesReceived() const { return framer.lines(); }
+    /** Line errors (overlong, noise) plus UART frame / parity errors. */
+    uint32_t getErrors() const { return errors + framer.overlong() + framer.noise(); }
+    /** RX FIFO or driver buffer overflows: bytes were lost. */
+    uint32_t getOverflows() const { return overflows; }
+
+    /**
+     * @brief Write one sentence (without line end) out of the TX pin, CR LF terminated.
+     *
+     * Called by the processor task only.
+     * @return false if the port is down or the TX buffer is still too full (counted)
+     */
+    bool send(const char* line, size_t len);
+
+    uint32_t getTxSentences() const { return txSentences; }
+    /** Sentences dropped because the line could not keep up. */
+    uint32_t getTxDropped() const { return txDropped; }
+
+    /** Expose this port's counters on /metrics, labelled port="N".  After init(). */
+    void registerMetrics(MetricsRegistry& reg) const;
+
 private:
     static void uartTask(void* parameter);
-    void handleUART();
-    
-    StreamBufferHandle_t streamBuffer;
+    void handleEvents();
+    void drainRx();
+
+    uint8_t port;
+    int uartNum;             ///< uart_port_t
+    QueueHandle_t eventQueue;
     TaskHandle_t taskHandle;
     UARTConfig config;
     bool initialized;
     bool running;
-    
-    uint32_t sentencesReceived;
+
     uint32_t errors;
-    
-    char lineBuffer[NMEA_MAX_LENGTH];
-    size_t linePos;
+    uint32_t overflows;
+
+    uint32_t txUsPerByte;    ///< Start + data + parity + stop bits at the baud rate
+    uint32_t txIdleUs;       ///< micros() when the driver's TX buffer will be empty
+    uint32_t txSentences;
+    uint32_t txDropped;
+
+    NMEALineFramer framer;
+    char block[UART_READ_BLOCK];
 };
 
 #endif // UART_HANDLER_H
@@ -0,0 +1,70 @@
+#ifndef UDP_OUTPUT_H
+#define UDP_OUTPUT_H
+
+#include <Arduino.h>
+#include <AsyncUDP.h>
+#include "config.h"
+#include "types.h"
+#include "datagram_batch.h"
+
+class MetricsRegistry;
+
+/**
+ * @brief NMEA 0183 over UDP, broadcast or multicast (port 10110 by default).
+ *
+ * One datagram reaches every listener on the network, however many
+ * plotters and phones there are, so the transmit cost does not grow with
+ * the number of consumers the way TCP clients do.  Sentences are packed
+ * CR LF terminated into datagrams of at most maxDatagram bytes, and a
+ * datagram goes out when the next sentence would not fit or its oldest
+ * sentence has waited maxDelayMs (see DatagramBatch).
+ *
+ * broadcast() and flush() are called from the processor task only.
+ * Configuration is read at boot; changes through /api/config/udp apply
+ * after a restart, like the serial ports.
+ */
+class UDPOutput {
+public:
+    UDPOutput();
+
+    void init(const UDPConfig& config);
+    void start();
+    void stop();
+
+    void broadcast(const char* data);
+    void broadcast(const char* data, size_t len);
+
+    /** Send the pending datagram once its latency bound has expired. */
+    void flush();
+
+    /** How long the processor task may sleep before flush() has work. */
+    uint32_t msUntilFlush() const;
+
+    bool             isRunning() const { return running; }
+    const UDPConfig& getConfig() const { return config; }
+
+    uint32_t getDatagramsSent() const { return batch.datagrams(); }
+    uint32_t getSentencesSent() const { return batch.sentences(); }
+    uint32_t getSendErrors()    const { return sendErrors; }
+
+    // Metrics
+    void registerMetrics(MetricsRegistry& reg);
+
+private:
+    static void onDatagram(const char* data, size_t len, void* ctx);
+    void send(const char* data, size_t len);
+
+    AsyncUDP      udp;
+    UDPConfig     config;
+    IPAddress     target;         ///< 255.255.255.255 or the multicast group
+    DatagramBatch batch;
+
+    bool initialized;
+    bool running;
+
+    // For /metrics
+    volatile uint32_t bytesSent;
+    volatile uint32_t sendErrors;
+};
+
+#endif // UDP_OUTPUT_H
@@ -7,7 +7,8 @@
  *
  * Exposes:
  *   - REST API  (/api/*)        — configuration, status, boat data, OTA, storage
- *   - WebSocket (/ws/nmea)     — real-time NMEA sentence stream
+ *   - WebSocket (/ws/nmea)     — real-time NMEA sentence stream, batched per client (WSStream)
+ *   - /api/boat/*               — ETag / 304 and long-poll on BoatState changes (BoatPoll)
  *   - Static files             — React SPA served from LittleFS or PROGMEM
  *
  * SD card endpoints are available under /api/sd/* when an SDManager
@@ -25,12 +26,17 @@
 #include "ble_manager.h"
 #include "seatalk_manager.h"
 #include "sd_manager.h"
+#include "ws_stream.h"
+#include "ws_state.h"
+#include "response_cache.h"
 
 // Forward declarations
 class TCPServer;
 class UARTHandler;
 class NMEAParser;
 class BoatState;
+class MetricsRegistry;
+class BoatPoll;
 
 #ifdef WEB_UI_PROGMEM
 class AsyncWebServer;
@@ -43,7 +49,7 @@ public:
      * @param cm      Configuration manager (NVS)
      * @param wm      WiFi manager
      * @param tcp     TCP server (NMEA stream)
-     * @param uart    UART handler
+     * @param uart    UART handlers, one per NMEA input port (NMEA_PORT_COUNT)
      * @param nmea    NMEA parser
      * @param bs      Boat state
      * @param ble     BLE manager
@@ -57,7 +63,17 @@ public:
     void init();
     void start();
     void stop();
-    void broadcastNMEA(const char* sentence);
+
+    /** Queue a sentence for the /ws/nmea clients (processor task). */
+    void broadcastNMEA(const char* sentence, size_t len);
+    /** Send the WebSocket frames that are due (processor task, every wake). */
+    void flushNMEA();
+    /** How long the processor task may sleep before flushNMEA() has work. */
+    uint32_t msUntilFlushNMEA();
+    /** Push the /ws/state frames and answer the boat data long-polls that are due (processor task, every wake). */
+    void pollState();
+
+    void registerMetrics(MetricsRegistry& reg);
 
 private:
     void registerRoutes();
@@ -68,9 +84,21 @@ private:
     void handleGetSerialConfig(AsyncWebServerRequest* request);
     void handlePostSerialConfig(AsyncWebServerRequest* request, uint8_t* data, size_t len);
     void handleGetStatus(AsyncWebServerRequest* request);
+    /** /api/status body, streamed part by part (web_server.cpp) */
+    struct StatusResponse;
+    void handleGetMetrics(AsyncWebServerRequest* request);
+    void handleGetOpenMetrics(AsyncWebServerRequest* request);
     void handleRestart(AsyncWebServerRequest* request);
     void handlePostSeatalkExtra(AsyncWebServerRequest* request, uint8_t* data, size_t len);
 
+    // ── UDP output handlers ───────────────────────────────────────────────────
+    void handleGetUDPConfig(AsyncWebServerRequest* request);
+    void handlePostUDPConfig(AsyncWebServerRequest* request, uint8_t* data, size_t len);
+
+    // ── Routing handlers ──────────────────────────────────────────────────────
+    void handleGetRoutes(AsyncWebServerRequest* request);
+    void handlePostRoutes(AsyncWebServerRequest* request, uint8_t* data, size_t len);
+
     // ── BLE handlers ──────────────────────────────────────────────────────────
     void handleGetBLEConfig(AsyncWebServerRequest* request);
     void handlePostBLEConfig(AsyncWebServerRequest* request, uint8_t* data, size_t len);
@@ -87,11 +115,23 @@ private:
     void handleGetLogConfig(AsyncWebServerRequest* request);
 
     // ── Boat data handlers ────────────────────────────────────────────────────
-    void handleGetNavigation(AsyncWebServerRequest* request);
-    void handleGetWind(AsyncWebServerRequest* request);
-    void handleGetAIS(AsyncWebServerRequest* request);
-    void handleGetBoatState(AsyncWebServerRequest* request);
-    void handleGetPerformance(AsyncWebServerRequest* request);
+    /** BoatPoll endpoint ids; kBoatEndpointMask (web_server.cpp) lists their sections */
+    enum BoatEndpoint : uint8_t {
+        BOAT_NAVIGATION = 0,
+        BOAT_WIND,
+        BOAT_AIS,
+        BOAT_STATE,
+        BOAT_PERFORMANCE
+    };
+    /** GET /api/boat/* — 304, long-poll or body, decided by BoatPoll */
+    void handleGetBoatData(AsyncWebServerRequest* request, BoatEndpoint endpoint);
+    /** BoatPoll::Sender: the 200 body of @p id, tagged with @p stamp */
+    static void sendBoatData(AsyncWebServerRequest* request, uint8_t id, uint32_t stamp, void* ctx);
+    void handleGetNavigation(AsyncWebServerRequest* request, uint32_t stamp);
+    void handleGetWind(AsyncWebServerRequest* request, uint32_t stamp);
+    void handleGetAIS(AsyncWebServerRequest* request, uint32_t stamp);
+    void handleGetBoatState(AsyncWebServerRequest* request, uint32_t stamp);
+    void handleGetPerformance(AsyncWebServerRequest* request, uint32_t stamp);
     void handleGetPerformanceConfig(AsyncWebServerRequest* request);
     void handlePostPerformanceConfig(AsyncWebServerRequest* request, uint8_t* data, size_t len);
 
@@ -122,7 +162,7 @@ private:
     /** GET /api/sd/files — recursive file listing */
     void handleListSDFiles(AsyncWebServerRequest* request);
 
-    /** GET /api/sd/download?path=<file> — stream a file to the browser */
+    /** GET /api/sd/download?path=<file>[&gzip=1] — stream a file, Range / If-Range for resuming */
     void handleDownloadSDFile(AsyncWebServerRequest* request);
 
     /** DELETE /api/sd/delete?path=<file> — delete a single file */
@@ -140,18 +180,33 @@ private:
     /** POST /api/sd/unmount — safely unmount the SD card */
     void handleUnmountSD(AsyncWebServerRequest* request);
 
-    // ── WebSocket handlers ────────────────────────────────────────────────────
-    void handleWebSocketEvent(AsyncWebSocket* server, AsyncWebSocketClient* client,
-                              AwsEventType type, void* arg, uint8_t* data, size_t len);
 
         
+    // ── Response cache ────────────────────────────────────────────────────────
+    /** ResponseCache keys; kCachedSources (web_server.cpp) lists what each is built from */
+    enum CachedResponse : uint8_t {
+        CACHED_STORAGE_INFO = 0,
+        CACHED_STORAGE_FILES,
+        CACHED_POLAR_STATUS,
+        CACHED_SD_STATUS
+    };
+    /** Send @p key from RAM if still valid; otherwise false and the @p stamp to build it with. */
+    bool sendCached(AsyncWebServerRequest* request, CachedResponse key, uint32_t& stamp);
+    /** Send @p body and keep it for the next requests. */
+    void sendAndCache(AsyncWebServerRequest* request, CachedResponse key, uint32_t stamp, const String& body);
+    /** SDChangeListener: the card changed, drop what was read from it. */
+    static void onSDChange(void* ctx);
+
     // ── Members ───────────────────────────────────────────────────────────────
     AsyncWebServer* server;
-    AsyncWebSocket* wsNMEA;
+    WSStream*       wsNMEA;
+    WSState*        wsState;
+    BoatPoll*       boatPoll;
+    ResponseCache   responseCache;
     ConfigManager*  configManager;
     WiFiManager*    wifiManager;
     TCPServer*      tcpServer;
-    UARTHandler*    uartHandler;
+    UARTHandler*    uartPorts;      ///< Array of NMEA_PORT_COUNT
     NMEAParser*     nmeaParser;
     BoatState*      boatState;
     BLEManager*     bleManager;
@@ -0,0 +1,123 @@
+#ifndef WS_CLIENT_SLOTS_H
+#define WS_CLIENT_SLOTS_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <AsyncWebSocket.h>
+#include "functions.h"
+#include "metrics.h"
+
+/**
+ * @file ws_client_slots.h
+ * @brief Fixed client table of a WebSocket endpoint.
+ *
+ * Connect and disconnect events arrive on the AsyncTCP task; the endpoint
+ * walks the slots from the processor task to send.  Both sides hold the
+ * table's mutex (lock() / unlock() for the walk).  A client beyond the
+ * N slots is closed on connect.
+ *
+ * count() is a word read, without the mutex: good for a gauge or for
+ * skipping a walk when nobody is connected, not for indexing the slots.
+ *
+ * @tparam Slot  Per-client state with an `AsyncWebSocketClient* client`
+ *               member, nullptr when the slot is free
+ * @tparam N     Number of slots
+ */
+template <typename Slot, size_t N>
+class WSClientSlots {
+public:
+    /** @param url  The endpoint, for the log lines */
+    explicit WSClientSlots(const char* url) : url(url), used(0), mutex(NULL) {
+        for (size_t i = 0; i < N; i++) slots[i].client = NULL;
+    }
+
+    ~WSClientSlots() {
+        if (mutex) vSemaphoreDelete(mutex);
+    }
+
+    /** Create the mutex.  Once, before the socket's events are hooked. */
+    bool init() {
+        if (!mutex) mutex = xSemaphoreCreateMutex();
+        return mutex != NULL;
+    }
+
+    /**
+     * @brief WS_EVT_CONNECT: give @p client a free slot, or close it.
+     * @param onJoin  Called with the slot, mutex held, to reset its state
+     */
+    template <typename Fn>
+    bool connect(AsyncWebSocketClient* client, Fn onJoin) {
+        lock();
+        Slot* slot = NULL;
+        for (size_t i = 0; !slot && i < N; i++) {
+            if (!slots[i].client) slot = &slots[i];
+        }
+        if (slot) {
+            slot->client = client;
+            onJoin(*slot);
+            used++;
+        }
+        size_t count = used;
+        unlock();
+
+        if (slot) {
+            serialPrintf("[WebSocket] %s client #%u connected from %s (%u/%u)\n",
+                         url, client->id(), client->remoteIP().toString().c_str(), count, N);
+        } else {
+            serialPrintf("[WebSocket] ⚠️  %s: max clients reached (%u), closing #%u\n", url, N, client->id());
+            client->close();
+        }
+        return slot != NULL;
+    }
+
+    /**
+     * @brief WS_EVT_DISCONNECT: free @p client's slot.
+     * @param onLeave  Called with the slot before it is freed, mutex held
+     */
+    template <typename Fn>
+    void disconnect(AsyncWebSocketClient* client, Fn onLeave) {
+        lock();
+        for (size_t i = 0; i < N; i++) {
+            if (slots[i].client == client) {
+                onLeave(slots[i]);
+                release(slots[i]);
+            }
+        }
+        unlock();
+    }
+
+    /** Free a slot from the sending side (eviction).  Mutex held. */
+    void release(Slot& s) {
+        s.client = NULL;
+        used--;
+    }
+
+    void lock()   { xSemaphoreTake(mutex, portMAX_DELAY); }
+    void unlock() { xSemaphoreGive(mutex); }
+
+    /** Slot @p i (0 .. N-1); mutex held. */
+    Slot& operator[](size_t i) { return slots[i]; }
+
+    size_t count() const { return used; }
+
+    /** Expose count() on /metrics as gauge @p name. */
+    void registerGauge(MetricsRegistry& reg, const char* name, const char* help) const {
+        reg.addGauge(name, help, readCount, this);
+    }
+
+private:
+    static int64_t readCount(const void* ctx) {
+        return (int64_t)static_cast<const WSClientSlots*>(ctx)->count();
+    }
+
+    const char*       url;
+    Slot              slots[N];
+    volatile size_t   used;
+    SemaphoreHandle_t mutex;
+
+    WSClientSlots(const WSClientSlots&);
+    WSClientSlots& operator=(const WSClientSlots&);
+};
+
+#endif // WS_CLIENT_SLOTS_H
@@ -0,0 +1,84 @@
+#ifndef WS_STATE_H
+#define WS_STATE_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <ESPAsyncWebServer.h>
+#include <AsyncWebSocket.h>
+#include "config.h"
+#include "boat_state.h"
+#include "state_frame.h"
+#include "ws_client_slots.h"
+
+class MetricsRegistry;
+
+/**
+ * @brief The live instrument channel on /ws/state.
+ *
+ * poll() runs on every processor wake and, at most every WS_STATE_PUSH_MS,
+ * captures one StateSnapshot — only when a shown BoatState section's
+ * generation moved, or WS_STATE_SWEEP_MS went by so values that went stale
+ * are cleared — and sends each client a binary frame of the fields that
+ * changed since its own last frame (see state_frame.h).  A new client gets
+ * a keyframe on the next push; everyone gets one every WS_STATE_KEYFRAME_MS.
+ *
+ * Frames are at most STATE_FRAME_MAX bytes and built in a fixed buffer; a
+ * client whose send queue is full skips the push and catches up with the
+ * next delta, since its encoder still holds what it was actually sent.
+ *
+ * poll() is called from the processor task; connect / disconnect events
+ * arrive on the AsyncTCP task.  The client slots are a WSClientSlots table,
+ * shared under its mutex.
+ */
+class WSState {
+public:
+    WSState(const char* url, BoatState* state);
+
+    /** Hook the socket's events.  Once, before start. */
+    bool init();
+
+    /** The socket to add to the AsyncWebServer. */
+    AsyncWebSocket* handler() { return &socket; }
+
+    /** Push the frames that are due (processor task, every wake). */
+    void poll();
+
+    size_t getClientCount() const { return clients.count(); }
+
+    void registerMetrics(MetricsRegistry& reg);
+
+private:
+    struct Slot {
+        AsyncWebSocketClient* client;   // nullptr = free
+        StateFrameEncoder     encoder;
+    };
+
+    void onEvent(AsyncWebSocketClient* client, AwsEventType type);
+
+    /** Did any section the frame carries change since the last capture? */
+    bool sectionsChanged();
+
+    AsyncWebSocket    socket;
+    BoatState*        boatState;
+    WSClientSlots<Slot, WS_STATE_MAX_CLIENTS> clients;
+    bool              initialized;
+    uint32_t          lastPush;
+    uint32_t          lastCapture;
+    uint32_t          lastCleanup;
+    volatile bool     joined;          ///< A client connected: capture afresh for its keyframe
+    uint32_t          generations[BOAT_SECTION_COUNT];
+    StateSnapshot     snapshot;
+    uint8_t           frame[STATE_FRAME_MAX];
+
+    // Totals across clients, for /metrics
+    volatile uint32_t keyframesSent;
+    volatile uint32_t deltasSent;
+    volatile uint32_t bytesSent;
+    volatile uint32_t skipped;
+
+    WSState(const WSState&);
+    WSState& operator=(const WSState&);
+};
+
+#endif // WS_STATE_H
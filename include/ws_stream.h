@@ -0,0 +1,86 @@
+#ifndef WS_STREAM_H
+#define WS_STREAM_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <ESPAsyncWebServer.h>
+#include <AsyncWebSocket.h>
+#include "config.h"
+#include "stream_ring.h"
+#include "ws_client_slots.h"
+
+class MetricsRegistry;
+
+/**
+ * @brief The NMEA monitor stream on /ws/nmea.
+ *
+ * Every sentence goes to every client: broadcast() appends it CR LF
+ * terminated to the client's StreamRing, and the ring is sent as one text
+ * frame once its oldest sentence has waited WS_BATCH_MS or WS_BATCH_BYTES
+ * are queued (checked by broadcast() and by flush(), which the processor
+ * task calls on every wake).  A frame therefore holds ~100 ms of traffic,
+ * newline-separated, instead of one frame per sentence.
+ *
+ * A client whose WebSocket send queue is full is not given another frame,
+ * and is retried once per WS_BATCH_MS rather than on every wake; its ring
+ * fills and further sentences are dropped for it alone, and once the ring
+ * has stayed full for WS_CLIENT_STALL_MS it is disconnected.
+ *
+ * broadcast(), flush() and msUntilFlush() are called from the processor
+ * task; connect / disconnect events arrive on the AsyncTCP task.  The
+ * client slots are a WSClientSlots table, shared under its mutex.
+ */
+class WSStream {
+public:
+    explicit WSStream(const char* url);
+
+    /** Allocate the client rings and hook the socket's events.  Once, before start. */
+    bool init();
+
+    /** The socket to add to the AsyncWebServer. */
+    AsyncWebSocket* handler() { return &socket; }
+
+    void broadcast(const char* data, size_t len);
+
+    /** Send frames whose latency bound has expired; evict stalled clients. */
+    void flush();
+
+    /** How long the processor task may sleep before flush() has work. */
+    uint32_t msUntilFlush();
+
+    size_t getClientCount() const { return clients.count(); }
+
+    void registerMetrics(MetricsRegistry& reg);
+
+private:
+    struct Slot {
+        AsyncWebSocketClient* client;   // nullptr = free
+        StreamRing            ring;
+        uint32_t              sentences;
+        uint32_t              dropped;
+        uint32_t              frames;
+    };
+
+    void onEvent(AsyncWebSocketClient* client, AwsEventType type);
+
+    // clients locked
+    bool          sendFrame(Slot& s, uint32_t now);
+    AsyncWebSocketClient* evictIfStalled(Slot& s, uint32_t now);
+
+    AsyncWebSocket    socket;
+    WSClientSlots<Slot, WS_MAX_CLIENTS> clients;
+    bool              initialized;
+    uint32_t          lastCleanup;
+
+    // Totals across clients, for /metrics
+    volatile uint32_t framesSent;
+    volatile uint32_t sentencesSent;
+    volatile uint32_t sentencesDropped;
+    volatile uint32_t evictions;
+
+    WSStream(const WSStream&);
+    WSStream& operator=(const WSStream&);
+};
+
+#endif // WS_STREAM_H
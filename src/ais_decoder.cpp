@@ -0,0 +1,220 @@
+#include "ais_decoder.h"
+#include <string.h>
+
+// ============================================================
+// Message layouts (ITU-R M.1371-5, Annex 8)
+// ============================================================
+
+// Shared scales / sentinels
+#define DEG_1E4_MIN   (1.0f / 600000.0f)   // 1/10000 minute → degree
+#define DEG_1E1_MIN   (1.0f / 600.0f)      // 1/10 minute → degree (type 27)
+#define LON_NA        108600000            // 181°
+#define LAT_NA        54600000             //  91°
+#define LON_NA_27     108600
+#define LAT_NA_27     54600
+
+#define F(field, kind, offset, width, scale, na) \
+    { (uint8_t)(field), (uint8_t)(kind), (offset), (width), (scale), (na) }
+
+static const AISFieldDesc kClassA[] = {             // 1, 2, 3
+    F(AIS_SOG,     AIS_UNSIGNED,  50, 10, 0.1f,        1023),
+    F(AIS_LON,     AIS_SIGNED,    61, 28, DEG_1E4_MIN, LON_NA),
+    F(AIS_LAT,     AIS_SIGNED,    89, 27, DEG_1E4_MIN, LAT_NA),
+    F(AIS_COG,     AIS_UNSIGNED, 116, 12, 0.1f,        3600),
+    F(AIS_HEADING, AIS_UNSIGNED, 128,  9, 1.0f,        511),
+};
+
+static const AISFieldDesc kBaseStation[] = {        // 4 (and 11)
+    F(AIS_LON,     AIS_SIGNED,    79, 28, DEG_1E4_MIN, LON_NA),
+    F(AIS_LAT,     AIS_SIGNED,   107, 27, DEG_1E4_MIN, LAT_NA),
+};
+
+static const AISFieldDesc kStaticVoyage[] = {       // 5
+    F(AIS_CALLSIGN,  AIS_6BIT_TEXT,  70,  42, 1.0f, AIS_NO_SENTINEL),
+    F(AIS_NAME,      AIS_6BIT_TEXT, 112, 120, 1.0f, AIS_NO_SENTINEL),
+    F(AIS_SHIP_TYPE, AIS_UNSIGNED,  232,   8, 1.0f, 0),
+};
+
+static const AISFieldDesc kSarAircraft[] = {        // 9
+    F(AIS_ALTITUDE, AIS_UNSIGNED,  38, 12, 1.0f,        4095),
+    F(AIS_SOG,      AIS_UNSIGNED,  50, 10, 1.0f,        1023),   // whole knots
+    F(AIS_LON,      AIS_SIGNED,    61, 28, DEG_1E4_MIN, LON_NA),
+    F(AIS_LAT,      AIS_SIGNED,    89, 27, DEG_1E4_MIN, LAT_NA),
+    F(AIS_COG,      AIS_UNSIGNED, 116, 12, 0.1f,        3600),
+};
+
+static const AISFieldDesc kSafety[] = {             // 14
+    F(AIS_TEXT, AIS_6BIT_TEXT, 40, 0, 1.0f, AIS_NO_SENTINEL),
+};
+
+static const AISFieldDesc kClassB[] = {             // 18
+    F(AIS_SOG,     AIS_UNSIGNED,  46, 10, 0.1f,        1023),
+    F(AIS_LON,     AIS_SIGNED,    57, 28, DEG_1E4_MIN, LON_NA),
+    F(AIS_LAT,     AIS_SIGNED,    85, 27, DEG_1E4_MIN, LAT_NA),
+    F(AIS_COG,     AIS_UNSIGNED, 112, 12, 0.1f,        3600),
+    F(AIS_HEADING, AIS_UNSIGNED, 124,  9, 1.0f,        511),
+};
+
+static const AISFieldDesc kClassBExtended[] = {     // 19
+    F(AIS_SOG,       AIS_UNSIGNED,   46,  10, 0.1f,        1023),
+    F(AIS_LON,       AIS_SIGNED,     57,  28, DEG_1E4_MIN, LON_NA),
+    F(AIS_LAT,       AIS_SIGNED,     85,  27, DEG_1E4_MIN, LAT_NA),
+    F(AIS_COG,       AIS_UNSIGNED,  112,  12, 0.1f,        3600),
+    F(AIS_HEADING,   AIS_UNSIGNED,  124,   9, 1.0f,        511),
+    F(AIS_NAME,      AIS_6BIT_TEXT, 143, 120, 1.0f,        AIS_NO_SENTINEL),
+    F(AIS_SHIP_TYPE, AIS_UNSIGNED,  263,   8, 1.0f,        0),
+};
+
+static const AISFieldDesc kAidToNav[] = {           // 21
+    F(AIS_NAME, AIS_6BIT_TEXT,  43, 120, 1.0f,        AIS_NO_SENTINEL),
+    F(AIS_LON,  AIS_SIGNED,    164,  28, DEG_1E4_MIN, LON_NA),
+    F(AIS_LAT,  AIS_SIGNED,    192,  27, DEG_1E4_MIN, LAT_NA),
+};
+
+static const AISFieldDesc kStatic24A[] = {          // 24 part A
+    F(AIS_NAME, AIS_6BIT_TEXT, 40, 120, 1.0f, AIS_NO_SENTINEL),
+};
+
+static const AISFieldDesc kStatic24B[] = {          // 24 part B
+    F(AIS_SHIP_TYPE, AIS_UNSIGNED,  40,  8, 1.0f, 0),
+    F(AIS_CALLSIGN,  AIS_6BIT_TEXT, 90, 42, 1.0f, AIS_NO_SENTINEL),
+};
+
+static const AISFieldDesc kLongRange[] = {          // 27
+    F(AIS_LON, AIS_SIGNED,   44, 18, DEG_1E1_MIN, LON_NA_27),
+    F(AIS_LAT, AIS_SIGNED,   62, 17, DEG_1E1_MIN, LAT_NA_27),
+    F(AIS_SOG, AIS_UNSIGNED, 79,  6, 1.0f,        63),          // whole knots
+    F(AIS_COG, AIS_UNSIGNED, 85,  9, 1.0f,        511),         // whole degrees
+};
+
+#undef F
+
+struct AISLayout {
+    const AISFieldDesc* fields;
+    uint8_t             count;
+};
+
+#define LAYOUT(t) { t, (uint8_t)(sizeof(t) / sizeof(t[0])) }
+
+// Indexed by message type; 24 is resolved by part number in aisDecode()
+static const AISLayout kLayouts[28] = {
+    /*  0 */ { nullptr, 0 },
+    /*  1 */ LAYOUT(kClassA),
+    /*  2 */ LAYOUT(kClassA),
+    /*  3 */ LAYOUT(kClassA),
+    /*  4 */ LAYOUT(kBaseStation),
+    /*  5 */ LAYOUT(kStaticVoyage),
+    /*  6 */ { nullptr, 0 }, { nullptr, 0 }, { nullptr, 0 },
+    /*  9 */ LAYOUT(kSarAircraft),
+    /* 10 */ { nullptr, 0 },
+    /* 11 */ LAYOUT(kBaseStation),          // UTC/date response, same layout as 4
+    /* 12 */ { nullptr, 0 }, { nullptr, 0 },
+    /* 14 */ LAYOUT(kSafety),
+    /* 15 */ { nullptr, 0 }, { nullptr, 0 }, { nullptr, 0 },
+    /* 18 */ LAYOUT(kClassB),
+    /* 19 */ LAYOUT(kClassBExtended),
+    /* 20 */ { nullptr, 0 },
+    /* 21 */ LAYOUT(kAidToNav),
+    /* 22 */ { nullptr, 0 }, { nullptr, 0 },
+    /* 24 */ LAYOUT(kStatic24A),
+    /* 25 */ { nullptr, 0 }, { nullptr, 0 },
+    /* 27 */ LAYOUT(kLongRange),
+};
+
+static const AISLayout kLayout24B = LAYOUT(kStatic24B);
+
+#undef LAYOUT
+
+// ============================================================
+// Bit-level helpers
+// ============================================================
+
+size_t aisUnarmor(const char* payload, size_t len, uint8_t* out, size_t outSize) {
+    // Whole characters that fit, leaving the reader's slack untouched
+    size_t maxChars = outSize > 8 ? ((outSize - 8) * 8) / 6 : 0;
+    if (len > maxChars) len = maxChars;
+    memset(out, 0, outSize);
+
+    // Accumulate 6-bit groups and flush whole bytes
+    uint32_t acc   = 0;
+    unsigned nbits = 0;
+    uint8_t* o     = out;
+    for (size_t i = 0; i < len; i++) {
+        uint8_t v = (uint8_t)payload[i] - 48;
+        if (v > 40) v -= 8;
+        acc = (acc << 6) | (v & 0x3F);
+        nbits += 6;
+        if (nbits >= 8) {
+            nbits -= 8;
+            *o++ = (uint8_t)(acc >> nbits);
+        }
+    }
+    if (nbits) *o = (uint8_t)(acc << (8 - nbits));
+    return len * 6;
+}
+
+static void decodeText(const uint8_t* bits, unsigned start, unsigned chars, char* out, size_t outSize) {
+    if (chars > outSize - 1) chars = outSize - 1;
+    for (unsigned i = 0; i < chars; i++) {
+        uint8_t v = (uint8_t)aisBits(bits, start + i * 6, 6);
+        out[i] = (char)(v < 32 ? v + 64 : v);    // 0 → '@', 1..26 → 'A'..'Z'
+    }
+    // Trim '@' padding and trailing spaces
+    while (chars > 0 && (out[chars - 1] == '@' || out[chars - 1] == ' ')) chars--;
+    out[chars] = '\0';
+}
+
+// ============================================================
+// aisDecode
+// ============================================================
+
+bool aisIsSupported(uint8_t type) {
+    return type < sizeof(kLayouts) / sizeof(kLayouts[0]) && kLayouts[type].fields != nullptr;
+}
+
+bool aisDecode(const uint8_t* bits, size_t bitLen, AISMessage& out) {
+    if (bitLen < 38) return false;
+
+    out.type     = (uint8_t)aisBits(bits, 0, 6);
+    out.repeat   = (uint8_t)aisBits(bits, 6, 2);
+    out.mmsi     = aisBits(bits, 8, 30);
+    out.valid    = 0;
+    out.name[0] = out.callsign[0] = out.text[0] = '\0';
+
+    if (!aisIsSupported(out.type)) return false;
+
+    const AISLayout* layout = &kLayouts[out.type];
+    if (out.type == 24) {
+        if (bitLen < 40) return false;
+        uint32_t part = aisBits(bits, 38, 2);
+        out.value[AIS_PART] = (float)part;
+        out.valid |= 1UL << AIS_PART;
+        if (part == 1)      layout = &kLayout24B;
+        else if (part != 0) return true;
+    }
+
+    for (uint8_t i = 0; i < layout->count; i++) {
+        const AISFieldDesc& d = layout->fields[i];
+
+        if (d.kind == AIS_6BIT_TEXT) {
+            unsigned width = d.width ? d.width : (bitLen > d.offset ? bitLen - d.offset : 0);
+            if (d.offset + width > bitLen) width = bitLen > d.offset ? bitLen - d.offset : 0;
+            char*  dst  = d.field == AIS_NAME ? out.name : d.field == AIS_CALLSIGN ? out.callsign : out.text;
+            size_t size = d.field == AIS_NAME ? sizeof(out.name)
+                        : d.field == AIS_CALLSIGN ? sizeof(out.callsign) : sizeof(out.text);
+            decodeText(bits, d.offset, width / 6, dst, size);
+            continue;
+        }
+
+        if (d.offset + d.width > bitLen) continue;    // short payload
+        uint32_t raw = aisBits(bits, d.offset, d.width);
+        int32_t  v   = (d.kind == AIS_SIGNED)
+                     ? (int32_t)(raw << (32 - d.width)) >> (32 - d.width)
+                     : (int32_t)raw;
+        if (v == d.na) continue;
+
+        out.value[d.field] = (float)v * d.scale;
+        out.valid |= 1UL << d.field;
+    }
+    return true;
+}
@@ -0,0 +1,116 @@
+#include "ais_reassembly.h"
+#include <string.h>
+
+AISReassembler::AISReassembler()
+    : assembledLen(0), assembledFill(0),
+      fragmentCount(0), completedCount(0), droppedCount(0), expiredCount(0) {
+    memset(slots, 0, sizeof(slots));
+    assembled[0] = '\0';
+}
+
+// ============================================================
+// Slot management
+// ============================================================
+
+uint8_t AISReassembler::partCount(uint8_t mask) {
+    uint8_t n = 0;
+    for (; mask; mask &= mask - 1) n++;
+    return n;
+}
+
+void AISReassembler::release(Slot& s, uint32_t& counter) {
+    counter += partCount(s.received);
+    s.active   = false;
+    s.received = 0;
+}
+
+uint8_t AISReassembler::inFlight() const {
+    uint8_t n = 0;
+    for (int i = 0; i < AIS_REASSEMBLY_SLOTS; i++) n += slots[i].active;
+    return n;
+}
+
+void AISReassembler::expire(unsigned long now) {
+    for (int i = 0; i < AIS_REASSEMBLY_SLOTS; i++) {
+        Slot& s = slots[i];
+        if (s.active && now - s.started > AIS_REASSEMBLY_TIMEOUT_MS) release(s, expiredCount);
+    }
+}
+
+AISReassembler::Slot* AISReassembler::findSlot(const AISFragment& frag) {
+    for (int i = 0; i < AIS_REASSEMBLY_SLOTS; i++) {
+        Slot& s = slots[i];
+        if (s.active && s.seqId == frag.seqId && s.channel == frag.channel &&
+            s.total == frag.total &&
+            s.talker[0] == frag.talker[0] && s.talker[1] == frag.talker[1]) {
+            return &s;
+        }
+    }
+    return nullptr;
+}
+
+AISReassembler::Slot* AISReassembler::claimSlot() {
+    // A free slot, or else the oldest message in flight gives way
+    Slot* oldest = &slots[0];
+    for (int i = 0; i < AIS_REASSEMBLY_SLOTS; i++) {
+        if (!slots[i].active) return &slots[i];
+        if (slots[i].started < oldest->started) oldest = &slots[i];
+    }
+    release(*oldest, droppedCount);
+    return oldest;
+}
+
+// ============================================================
+// add
+// ============================================================
+
+bool AISReassembler::add(const AISFragment& frag, unsigned long now) {
+    fragmentCount++;
+    expire(now);
+
+    if (frag.total < 2 || frag.total > AIS_REASSEMBLY_MAX_PARTS ||
+        frag.num < 1 || frag.num > frag.total ||
+        frag.len == 0 || frag.len > AIS_FRAGMENT_MAX_CHARS) {
+        droppedCount++;
+        return false;
+    }
+
+    uint8_t bit  = (uint8_t)(1u << (frag.num - 1));
+    Slot*   slot = findSlot(frag);
+
+    // Same key and part seen again: the sequential id has wrapped onto a
+    // message that never completed — it is lost, start over
+    if (slot && (slot->received & bit)) release(*slot, droppedCount);
+
+    if (!slot || !slot->active) {
+        if (!slot) slot = claimSlot();
+        slot->active     = true;
+        slot->talker[0]  = frag.talker[0];
+        slot->talker[1]  = frag.talker[1];
+        slot->seqId      = frag.seqId;
+        slot->channel    = frag.channel;
+        slot->total      = frag.total;
+        slot->received   = 0;
+        slot->fillBits   = 0;
+        slot->started    = now;
+    }
+
+    memcpy(slot->part[frag.num - 1], frag.payload, frag.len);
+    slot->partLen[frag.num - 1] = frag.len;
+    slot->received |= bit;
+    if (frag.num == frag.total) slot->fillBits = frag.fillBits;
+
+    if (slot->received != (uint8_t)((1u << slot->total) - 1)) return false;
+
+    // Complete: concatenate in part order and free the slot
+    assembledLen = 0;
+    for (uint8_t p = 0; p < slot->total; p++) {
+        memcpy(assembled + assembledLen, slot->part[p], slot->partLen[p]);
+        assembledLen += slot->partLen[p];
+    }
+    assembledFill  = slot->fillBits;
+    slot->active   = false;
+    slot->received = 0;
+    completedCount++;
+    return true;
+}
@@ -0,0 +1,235 @@
+#include "ais_table.h"
+#include "functions.h"
+#include <stdlib.h>
+#include <string.h>
+
+// ============================================================
+// Construction / allocation
+// ============================================================
+
+AISTargetTable::AISTargetTable()
+    : slots(nullptr), index(nullptr), cap(0), count(0), indexMask(0),
+      evicted(0), dropped(0) {
+}
+
+AISTargetTable::~AISTargetTable() {
+    free(slots);
+    free(index);
+}
+
+bool AISTargetTable::begin(uint16_t capacity) {
+    free(slots);
+    free(index);
+    slots = nullptr;
+    index = nullptr;
+    cap = count = indexMask = 0;
+
+    if (capacity == 0 || capacity > 0x7FFF) return false;
+
+    // Index at most half full keeps linear probes short
+    uint32_t buckets = 16;
+    while (buckets < 2u * capacity) buckets <<= 1;
+
+    size_t slotBytes = (size_t)capacity * sizeof(AISTarget);
+#ifdef BOARD_HAS_PSRAM
+    slots = (AISTarget*)ps_malloc(slotBytes);
+#endif
+    if (!slots) slots = (AISTarget*)malloc(slotBytes);
+    // The index is probed on every AIS sentence: keep it in internal RAM
+    index = (uint16_t*)calloc(buckets, sizeof(uint16_t));
+
+    if (!slots || !index) {
+        free(slots);
+        free(index);
+        slots = nullptr;
+        index = nullptr;
+        serialPrintf("[AIS] ❌ Cannot allocate table for %u targets\n", capacity);
+        return false;
+    }
+
+    cap       = capacity;
+    indexMask = (uint16_t)(buckets - 1);
+    serialPrintf("[AIS] ✓ Target table: %u targets (%u bytes), %u index buckets\n",
+                 cap, (unsigned)slotBytes, (unsigned)buckets);
+    return true;
+}
+
+// ============================================================
+// MMSI index (open addressing, linear probing)
+// ============================================================
+
+uint16_t AISTargetTable::home(uint32_t mmsi) const {
+    // Fibonacci hashing: MMSIs share long prefixes (country MID), so mix
+    // the low digits into the high bits before masking
+    return (uint16_t)((mmsi * 2654435769u) >> 16) & indexMask;
+}
+
+int AISTargetTable::lookup(uint32_t mmsi) const {
+    if (!index) return -1;
+    for (uint16_t b = home(mmsi); index[b]; b = (b + 1) & indexMask) {
+        if (slots[index[b] - 1].mmsi == mmsi) return b;
+    }
+    return -1;
+}
+
+void AISTargetTable::indexInsert(uint32_t mmsi, uint16_t slot) {
+    uint16_t b = home(mmsi);
+    while (index[b]) b = (b + 1) & indexMask;
+    index[b] = slot + 1;
+}
+
+void AISTargetTable::indexErase(int bucket) {
+    // Backward-shift deletion: pull later entries of the probe chain into
+    // the hole unless that would move them before their home bucket
+    uint16_t hole = (uint16_t)bucket;
+    uint16_t b    = hole;
+    index[hole] = 0;
+    while (true) {
+        b = (b + 1) & indexMask;
+        if (!index[b]) return;
+        uint16_t h = home(slots[index[b] - 1].mmsi);
+        bool stays = (hole <= b) ? (hole < h && h <= b) : (hole < h || h <= b);
+        if (!stays) {
+            index[hole] = index[b];
+            index[b]    = 0;
+            hole        = b;
+        }
+    }
+}
+
+// ============================================================
+// Slot management
+// ============================================================
+
+AISTarget* AISTargetTable::find(uint32_t mmsi) {
+    int b = lookup(mmsi);
+    return b < 0 ? nullptr : &slots[index[b] - 1];
+}
+
+const AISTarget* AISTargetTable::find(uint32_t mmsi) const {
+    int b = lookup(mmsi);
+    return b < 0 ? nullptr : &slots[index[b] - 1];
+}
+
+void AISTargetTable::removeAt(uint16_t slot) {
+    indexErase(lookup(slots[slot].mmsi));
+
+    // Keep the slots dense: move the last target into the hole
+    uint16_t last = count - 1;
+    if (slot != last) {
+        int b = lookup(slots[last].mmsi);
+        slots[slot] = slots[last];
+        index[b]    = slot + 1;
+    }
+    count--;
+}
+
+float AISTargetTable::rank(const AISTarget& t) {
+    // Lower is more important
+    if (!t.hasProximity) return 1e9f;
+    if (t.tcpa > 0 && t.tcpa < AIS_TCPA_HORIZON_MIN) return t.cpa;
+    return t.distance;
+}
+
+int AISTargetTable::pickVictim(const AISTarget& incoming, unsigned long now) const {
+    // One pass: the oldest stale target wins outright (the next cleanup
+    // would drop it anyway), otherwise the least important target, least
+    // recently updated on ties
+    int           stale  = -1;
+    unsigned long oldest = DATA_TIMEOUT_AIS;
+    int           worst  = -1;
+    float         worstRank = -1.0f;
+
+    for (uint16_t i = 0; i < count; i++) {
+        const AISTarget& t = slots[i];
+        unsigned long age = now - t.timestamp;
+        if (age > oldest) {
+            oldest = age;
+            stale  = i;
+        }
+        float r = rank(t);
+        if (r > worstRank || (r == worstRank && t.timestamp < slots[worst].timestamp)) {
+            worstRank = r;
+            worst     = i;
+        }
+    }
+
+    if (stale >= 0) return stale;
+    return (rank(incoming) <= worstRank) ? worst : -1;
+}
+
+AISTarget* AISTargetTable::insert(const AISTarget& target) {
+    if (count == cap) {
+        int victim = pickVictim(target, millis());
+        if (victim < 0) {
+            dropped++;
+            return nullptr;
+        }
+        removeAt((uint16_t)victim);
+        evicted++;
+    }
+
+    slots[count] = target;
+    indexInsert(target.mmsi, count);
+    return &slots[count++];
+}
+
+// ============================================================
+// Public updates
+// ============================================================
+
+bool AISTargetTable::addOrUpdate(const AISTarget& target) {
+    if (!slots || target.mmsi == 0) return false;
+
+    // Position reports carry no static data: keep what we learnt before
+    AISTarget* existing = find(target.mmsi);
+    if (existing) {
+        AISTarget prev = *existing;
+        *existing = target;
+        if (target.name[0] == '\0')     memcpy(existing->name, prev.name, sizeof(prev.name));
+        if (target.callsign[0] == '\0') memcpy(existing->callsign, prev.callsign, sizeof(prev.callsign));
+        if (target.shipType == 0)       existing->shipType = prev.shipType;
+        return true;
+    }
+
+    return insert(target) != nullptr;
+}
+
+bool AISTargetTable::setStatic(uint32_t mmsi, const char* name, const char* callsign,
+                               uint8_t shipType) {
+    if (!slots || mmsi == 0) return false;
+
+    AISTarget* t = find(mmsi);
+    if (!t) {
+        // Target not yet known — create a stub so the static data is preserved
+        AISTarget stub;
+        stub.mmsi = mmsi;
+        t = insert(stub);
+        if (!t) return false;
+    }
+    if (name && name[0]) {
+        strncpy(t->name, name, sizeof(t->name) - 1);
+        t->name[sizeof(t->name) - 1] = '\0';
+    }
+    if (callsign && callsign[0]) {
+        strncpy(t->callsign, callsign, sizeof(t->callsign) - 1);
+        t->callsign[sizeof(t->callsign) - 1] = '\0';
+    }
+    if (shipType) t->shipType = shipType;
+    t->timestamp = millis();
+    return true;
+}
+
+int AISTargetTable::removeStale(unsigned long timeout) {
+    unsigned long now = millis();
+    int removed = 0;
+
+    // Walk backwards so the target swapped into a hole was already checked
+    for (int i = (int)count - 1; i >= 0; i--) {
+        if ((now - slots[i].timestamp) > timeout) {
+            removeAt((uint16_t)i);
+            removed++;
+        }
+    }
+    return removed;
+}
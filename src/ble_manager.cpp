@@ -17,6 +17,13 @@
         } \
     } while (0)
 
+// BoatState sections feeding each data characteristic
+#define BLE_NAV_MASK         (BOAT_MASK(BOAT_SECTION_GPS) | BOAT_MASK(BOAT_SECTION_SPEED) | \
+                              BOAT_MASK(BOAT_SECTION_HEADING) | BOAT_MASK(BOAT_SECTION_DEPTH))
+#define BLE_WIND_MASK        BOAT_MASK(BOAT_SECTION_WIND)
+#define BLE_AUTOPILOT_MASK   BOAT_MASK(BOAT_SECTION_AUTOPILOT)
+#define BLE_PERFORMANCE_MASK (BOAT_MASK(BOAT_SECTION_PERFORMANCE) | BOAT_MASK(BOAT_SECTION_WIND))
+
 // ============================================================
 // MarineServerCallbacks — NimBLE 2.x signatures
 // ============================================================
@@ -32,6 +39,11 @@ void MarineServerCallbacks::onConnect(NimBLEServer* pServer, NimBLEConnInfo& con
     if (manager->connectedDevices >= BLE_MAX_CONNECTIONS) {
         manager->stopAdvertising();
     }
+
+    // Give the new central current values right away
+    if (manager->updateTaskHandle) {
+        xTaskNotify(manager->updateTaskHandle, BOAT_MASK_ALL, eSetBits);
+    }
 }
 
 void MarineServerCallbacks::onDisconnect(NimBLEServer* pServer, NimBLEConnInfo& connInfo, int reason) {
@@ -204,7 +216,8 @@ BLEManager::BLEManager()
       boatState(nullptr), seatalkManager(nullptr),
       configManager(nullptr), wifiManager(nullptr),
       initialized(false), advertising(false),
-      connectedDevices(0), updateTaskHandle(nullptr) {
+      connectedDevices(0), updateTaskHandle(nullptr),
+      stateListenerId(-1), lastRefreshMs(0), lastAdminMs(0) {
 }
 
 BLEManager::~BLEManager() {
@@ -273,20 +286,34 @@ void BLEManager::start() {
         0
     );
 
+    if (boatState) {
+        stateListenerId = boatState->subscribe(BLE_NAV_MASK | BLE_WIND_MASK |
+                                               BLE_AUTOPILOT_MASK | BLE_PERFORMANCE_MASK,
+                                               onStateChanged, this);
+    }
+
     serialPrintf("[BLE] ✓ Started\n");
 }
 
 void BLEManager::stop() {
+    if (boatState && stateListenerId >= 0) {
+        boatState->unsubscribe(stateListenerId);
+        stateListenerId = -1;
+    }
     if (updateTaskHandle) { vTaskDelete(updateTaskHandle); updateTaskHandle = nullptr; }
     stopAdvertising();
     serialPrintf("[BLE] Stopped\n");
 }
 
 // ============================================================
-// update — called by FreeRTOS task at 1 Hz
+// update — driven by BoatState change notifications
 // ============================================================
 
 void BLEManager::update() {
+    push(BOAT_MASK_ALL, true);
+}
+
+void BLEManager::push(uint32_t changed, bool admin) {
     if (!initialized || !config.enabled || connectedDevices == 0) return;
 
     // Watchdog: restart advertising if it dropped unexpectedly
@@ -296,18 +323,37 @@ void BLEManager::update() {
         advertising = true;
     }
 
-    updateNavData();
-    updateWindData();
-    updateAutopilotData();
-    updatePerformanceData();
-    updateAdminData();
+    if (changed & BLE_NAV_MASK)         updateNavData();
+    if (changed & BLE_WIND_MASK)        updateWindData();
+    if (changed & BLE_AUTOPILOT_MASK)   updateAutopilotData();
+    if (changed & BLE_PERFORMANCE_MASK) updatePerformanceData();
+    if (admin)                          updateAdminData();
+}
+
+void BLEManager::onStateChanged(uint32_t changed, void* ctx) {
+    BLEManager* mgr = static_cast<BLEManager*>(ctx);
+    if (mgr->updateTaskHandle) xTaskNotify(mgr->updateTaskHandle, changed, eSetBits);
 }
 
 void BLEManager::updateTask(void* param) {
     BLEManager* mgr = static_cast<BLEManager*>(param);
     while (true) {
-        mgr->update();
-        vTaskDelay(pdMS_TO_TICKS(BLE_UPDATE_INTERVAL_MS));
+        uint32_t changed = 0;
+        xTaskNotifyWait(0, ULONG_MAX, &changed, pdMS_TO_TICKS(BLE_UPDATE_INTERVAL_MS));
+
+        // Periodic full push: nothing is notified when a value merely goes stale
+        uint32_t now = millis();
+        if (now - mgr->lastRefreshMs >= BLE_REFRESH_INTERVAL_MS) {
+            changed |= BOAT_MASK_ALL;
+            mgr->lastRefreshMs = now;
+        }
+        bool admin = (now - mgr->lastAdminMs >= BLE_UPDATE_INTERVAL_MS);
+        if (admin) mgr->lastAdminMs = now;
+
+        mgr->push(changed, admin);
+
+        // Let the rest of an NMEA burst land before the next round
+        vTaskDelay(pdMS_TO_TICKS(BLE_MIN_NOTIFY_INTERVAL_MS));
     }
 }
 
@@ -539,8 +585,8 @@ String BLEManager::buildAutopilotJSON() {
     JsonDocument doc;
     AutopilotData ap = boatState->getAutopilot();
 
-    doc["mode"]   = ap.mode;
-    doc["status"] = ap.status;
+    doc["mode"]   = (const char*)ap.mode;
+    doc["status"] = (const char*)ap.status;
     SET_JSON_DP(doc, "heading_target", ap.heading_target);
     SET_JSON_DP(doc, "wind_target",    ap.wind_angle_target);
     SET_JSON_DP(doc, "rudder",         ap.rudder_angle);
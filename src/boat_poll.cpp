@@ -0,0 +1,216 @@
+#include "boat_poll.h"
+#include "functions.h"
+#include "metrics.h"
+#include <esp_system.h>
+
+BoatPoll::BoatPoll(BoatState* state, Sender send, void* ctx)
+    : boatState(state), send(send), ctx(ctx), bootId(0), parked(0), slotsMutex(NULL), initialized(false),
+      notModified(0), wokeChanged(0), wokeTimeout(0), rejected(0) {
+    for (size_t i = 0; i < HTTP_LONGPOLL_MAX; i++) {
+        slots[i].used = false;
+    }
+}
+
+BoatPoll::~BoatPoll() {
+    if (slotsMutex) {
+        vSemaphoreDelete(slotsMutex);
+    }
+}
+
+bool BoatPoll::init() {
+    if (initialized) {
+        return true;
+    }
+
+    slotsMutex = xSemaphoreCreateMutex();
+    if (slotsMutex == NULL) {
+        serialPrintf("[Web] ❌ Failed to create long-poll mutex!\n");
+        return false;
+    }
+
+    bootId      = esp_random();
+    initialized = true;
+    serialPrintf("[Web] Boat data: ETag + long-poll, %u parked requests, wait ≤ %u ms\n",
+                 HTTP_LONGPOLL_MAX, HTTP_LONGPOLL_MAX_WAIT_MS);
+    return true;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Tags
+// ═══════════════════════════════════════════════════════════════
+
+void BoatPoll::formatTag(char* out, size_t len, uint32_t stamp) const {
+    snprintf(out, len, "\"%08lx-%lu\"", (unsigned long)bootId, (unsigned long)stamp);
+}
+
+bool BoatPoll::matchesTag(AsyncWebServerRequest* request, uint32_t stamp) const {
+    if (!request->hasHeader("If-None-Match")) {
+        return false;
+    }
+    // Weak comparison: the W/ prefix does not matter, the quotes do
+    String candidates = request->header("If-None-Match");
+    if (candidates.indexOf('*') >= 0) {
+        return true;
+    }
+    char quoted[24];
+    formatTag(quoted, sizeof(quoted), stamp);
+    return candidates.indexOf(quoted) >= 0;
+}
+
+void BoatPoll::tag(AsyncWebServerResponse* response, uint32_t stamp) const {
+    char etag[28] = "W/";
+    formatTag(etag + 2, sizeof(etag) - 2, stamp);
+    char generation[12];
+    snprintf(generation, sizeof(generation), "%lu", (unsigned long)stamp);
+
+    response->addHeader("ETag", etag);
+    response->addHeader("X-Generation", generation);
+    response->addHeader("Cache-Control", "no-cache");
+}
+
+void BoatPoll::sendNotModified(AsyncWebServerRequest* request, uint32_t stamp) {
+    AsyncWebServerResponse* response = request->beginResponse(304);
+    tag(response, stamp);
+    request->send(response);
+    notModified++;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Requests
+// ═══════════════════════════════════════════════════════════════
+
+void BoatPoll::handle(AsyncWebServerRequest* request, uint8_t id, uint32_t mask) {
+    // Read before any rendering: a change during it leaves the client one behind, not stuck
+    uint32_t stamp = boatState->getChangeStamp(mask);
+
+    // What the client already has, if it says
+    bool     known = false;
+    uint32_t since = 0;
+    if (request->hasParam("since")) {
+        since = (uint32_t)strtoul(request->getParam("since")->value().c_str(), NULL, 10);
+        known = true;
+    } else if (matchesTag(request, stamp)) {
+        since = stamp;
+        known = true;
+    }
+    if (!initialized || !known || since != stamp) {
+        send(request, id, stamp, ctx);
+        return;
+    }
+
+    uint32_t wait = request->hasParam("wait")
+                  ? (uint32_t)strtoul(request->getParam("wait")->value().c_str(), NULL, 10) : 0;
+    if (wait == 0) {
+        sendNotModified(request, stamp);
+        return;
+    }
+    if (wait > HTTP_LONGPOLL_MAX_WAIT_MS) {
+        wait = HTTP_LONGPOLL_MAX_WAIT_MS;
+    }
+
+    xSemaphoreTake(slotsMutex, portMAX_DELAY);
+    Slot* slot = NULL;
+    for (size_t i = 0; !slot && i < HTTP_LONGPOLL_MAX; i++) {
+        if (!slots[i].used) {
+            slot = &slots[i];
+        }
+    }
+    if (slot) {
+        slot->request  = request->pause();
+        slot->mask     = mask;
+        slot->since    = since;
+        slot->deadline = millis() + wait;
+        slot->id       = id;
+        slot->used     = true;
+        parked++;
+    }
+    xSemaphoreGive(slotsMutex);
+
+    if (!slot) {
+        rejected++;
+        AsyncWebServerResponse* response =
+            request->beginResponse(503, "application/json", "{\"error\":\"Too many waiting requests\"}");
+        response->addHeader("Retry-After", "1");
+        request->send(response);
+    }
+}
+
+void BoatPoll::poll() {
+    if (!initialized || parked == 0) {
+        return;
+    }
+
+    struct Due {
+        AsyncWebServerRequestPtr request;
+        uint32_t stamp;
+        uint8_t  id;
+        bool     changed;
+    };
+    Due      due[HTTP_LONGPOLL_MAX];
+    size_t   dueCount = 0;
+    uint32_t now      = millis();
+
+    xSemaphoreTake(slotsMutex, portMAX_DELAY);
+    for (size_t i = 0; i < HTTP_LONGPOLL_MAX; i++) {
+        Slot& s = slots[i];
+        if (!s.used) {
+            continue;
+        }
+        uint32_t stamp   = boatState->getChangeStamp(s.mask);
+        bool     changed = stamp != s.since;
+        bool     expired = s.request.expired();
+        if (!changed && !expired && (int32_t)(now - s.deadline) < 0) {
+            continue;
+        }
+        if (!expired) {
+            due[dueCount].request = s.request;
+            due[dueCount].stamp   = stamp;
+            due[dueCount].id      = s.id;
+            due[dueCount].changed = changed;
+            dueCount++;
+        }
+        s.request.reset();
+        s.used = false;
+        parked--;
+    }
+    xSemaphoreGive(slotsMutex);
+
+    // The bodies are rendered here, on the processor task, outside the mutex
+    for (size_t i = 0; i < dueCount; i++) {
+        std::shared_ptr<AsyncWebServerRequest> request = due[i].request.lock();
+        if (!request) {
+            continue;
+        }
+        if (due[i].changed) {
+            wokeChanged++;
+            send(request.get(), due[i].id, due[i].stamp, ctx);
+        } else {
+            wokeTimeout++;
+            sendNotModified(request.get(), due[i].stamp);
+        }
+    }
+}
+
+size_t BoatPoll::getParkedCount() {
+    return parked;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Metrics
+// ═══════════════════════════════════════════════════════════════
+
+namespace {
+
+int64_t readParked(const void* ctx) {
+    return (int64_t)const_cast<BoatPoll*>(static_cast<const BoatPoll*>(ctx))->getParkedCount();
+}
+
+} // namespace
+
+void BoatPoll::registerMetrics(MetricsRegistry& reg) {
+    reg.addCounter("espnav_http_not_modified", "Boat data requests answered 304 Not Modified", &notModified);
+    reg.addGauge("espnav_http_longpoll_parked", "Boat data requests waiting for a change", readParked, this);
+    reg.addCounter("espnav_http_longpoll_woken", "Parked boat data requests answered", &wokeChanged, "reason=\"change\"");
+    reg.addCounter("espnav_http_longpoll_woken", "Parked boat data requests answered", &wokeTimeout, "reason=\"timeout\"");
+    reg.addCounter("espnav_http_longpoll_rejected", "Long-polls refused with 503: every slot taken", &rejected);
+}
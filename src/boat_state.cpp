@@ -1,9 +1,13 @@
 #include "boat_state.h"
 #include "functions.h"
 #include <math.h>
+#include <type_traits>
 
-BoatState::BoatState() {
+BoatState::BoatState() : seq(0), readRetries(0), readFallbacks(0), dirty(0) {
     mutex = xSemaphoreCreateMutex();
+    for (int i = 0; i < BOAT_SECTION_COUNT; i++) generation[i].store(0, std::memory_order_relaxed);
+    memset(freshness, 0, sizeof(freshness));
+    memset(listeners, 0, sizeof(listeners));
 }
 
 BoatState::~BoatState() {
@@ -49,321 +53,601 @@ void BoatState::init() {
 
     performance.vmg.unit      = "kn";
     performance.polarPct.unit = "%";
+
+    ais.begin(AIS_MAX_TARGETS);
     
     serialPrintf("[BoatState] ✓ Initialization complete\n");
 }
 
 // ============================================================
-// Getters (thread-safe, return copies)
+// Seqlock publication
 // ============================================================
 
-GPSData BoatState::getGPS() {
+// Optimistic read attempts before a reader falls back to the mutex.  A
+// writer holds the sequence odd for a few µs; the fallback only matters
+// when the writer was preempted mid-update by the reading task itself.
+#define BOATSTATE_READ_SPINS  8
+
+void BoatState::beginWrite() {
     xSemaphoreTake(mutex, portMAX_DELAY);
-    GPSData copy = gps;
-    xSemaphoreGive(mutex);
-    return copy;
+    seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
 }
 
-SpeedData BoatState::getSpeed() {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    SpeedData copy = speed;
+void BoatState::endWrite() {
+    uint32_t changed = dirty;
+    dirty = 0;
+
+    for (int i = 0; i < BOAT_SECTION_COUNT; i++) {
+        if (changed & BOAT_MASK(i)) generation[i].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Collect the interested listeners while the table cannot change, call
+    // them once the lock is released so they may read the state back
+    Listener notify[BOATSTATE_MAX_LISTENERS];
+    int      notifyCount = 0;
+    if (changed) {
+        for (int i = 0; i < BOATSTATE_MAX_LISTENERS; i++) {
+            uint32_t bits = listeners[i].mask & changed;
+            if (listeners[i].fn && bits) {
+                notify[notifyCount]      = listeners[i];
+                notify[notifyCount].mask = bits;
+                notifyCount++;
+            }
+        }
+    }
+
+    seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
     xSemaphoreGive(mutex);
-    return copy;
+
+    for (int i = 0; i < notifyCount; i++) notify[i].fn(notify[i].mask, notify[i].ctx);
 }
 
-HeadingData BoatState::getHeading() {
+// ============================================================
+// Change listeners
+// ============================================================
+
+int BoatState::subscribe(uint32_t mask, BoatStateListener fn, void* ctx) {
+    if (!fn || !(mask & BOAT_MASK_ALL)) return -1;
+
+    int id = -1;
     xSemaphoreTake(mutex, portMAX_DELAY);
-    HeadingData copy = heading;
+    for (int i = 0; i < BOATSTATE_MAX_LISTENERS; i++) {
+        if (!listeners[i].fn) {
+            listeners[i].mask = mask & BOAT_MASK_ALL;
+            listeners[i].fn   = fn;
+            listeners[i].ctx  = ctx;
+            id = i;
+            break;
+        }
+    }
     xSemaphoreGive(mutex);
-    return copy;
+
+    if (id < 0) serialPrintf("[BoatState] ❌ Listener table full (%d)\n", BOATSTATE_MAX_LISTENERS);
+    return id;
 }
 
-DepthData BoatState::getDepth() {
+void BoatState::unsubscribe(int id) {
+    if (id < 0 || id >= BOATSTATE_MAX_LISTENERS) return;
     xSemaphoreTake(mutex, portMAX_DELAY);
-    DepthData copy = depth;
+    listeners[id].fn   = nullptr;
+    listeners[id].mask = 0;
     xSemaphoreGive(mutex);
-    return copy;
 }
 
-WindData BoatState::getWind() {
+template <typename Fn>
+void BoatState::readConsistent(Fn copy) {
+    for (int attempt = 0; attempt < BOATSTATE_READ_SPINS; attempt++) {
+        uint32_t before = seq.load(std::memory_order_acquire);
+        if (!(before & 1)) {
+            copy();
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq.load(std::memory_order_relaxed) == before) return;
+        }
+        readRetries.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Writer keeps us out: queue behind it on the mutex instead of spinning
+    readFallbacks.fetch_add(1, std::memory_order_relaxed);
     xSemaphoreTake(mutex, portMAX_DELAY);
-    WindData copy = wind;
+    copy();
     xSemaphoreGive(mutex);
-    return copy;
 }
 
-EnvironmentData BoatState::getEnvironment() {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    EnvironmentData copy = environment;
-    xSemaphoreGive(mutex);
+template <typename T>
+T BoatState::snapshot(const T& src) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "BoatState sections must be trivially copyable for seqlock reads");
+    T copy;
+    readConsistent([&]() { memcpy(&copy, &src, sizeof(T)); });
     return copy;
 }
 
-CalculatedData BoatState::getCalculated() {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    CalculatedData copy = calculated;
-    xSemaphoreGive(mutex);
-    return copy;
+// ============================================================
+// Getters (lock-free, return copies)
+// ============================================================
+
+GPSData         BoatState::getGPS()         { return snapshot(gps); }
+SpeedData       BoatState::getSpeed()       { return snapshot(speed); }
+HeadingData     BoatState::getHeading()     { return snapshot(heading); }
+DepthData       BoatState::getDepth()       { return snapshot(depth); }
+WindData        BoatState::getWind()        { return snapshot(wind); }
+EnvironmentData BoatState::getEnvironment() { return snapshot(environment); }
+CalculatedData  BoatState::getCalculated()  { return snapshot(calculated); }
+AutopilotData   BoatState::getAutopilot()   { return snapshot(autopilot); }
+PerformanceData BoatState::getPerformance() { return snapshot(performance); }
+
+int BoatState::getAISTargets(AISTarget* out, int maxCount) {
+    static_assert(std::is_trivially_copyable<AISTarget>::value,
+                  "AISTarget must be trivially copyable for seqlock reads");
+    int n = 0;
+    readConsistent([&]() {
+        // slots are allocated once in init(); only the count moves
+        n = ais.data() ? std::min<int>(ais.size(), maxCount) : 0;
+        if (n > 0) memcpy(out, ais.data(), n * sizeof(AISTarget));
+    });
+    return n;
+}
+
+void BoatState::listAISTargets(AISList& list) {
+    unsigned long now = millis();
+    readConsistent([&]() {
+        list.count = 0;
+        list.next  = 0;
+        const AISTarget* t = ais.data();
+        for (uint16_t i = 0; t && i < ais.size() && list.count < AIS_MAX_TARGETS; i++) {
+            if ((now - t[i].timestamp) / 1000 <= DATA_TIMEOUT_AIS / 1000) list.mmsi[list.count++] = t[i].mmsi;
+        }
+    });
+}
+
+bool BoatState::nextAISTarget(AISList& list, AISTarget& out) {
+    while (list.next < list.count) {
+        uint32_t mmsi  = list.mmsi[list.next++];
+        bool     found = false;
+        readConsistent([&]() {
+            // A torn read can land on a slot past the end: only trust a live one
+            const AISTarget* t = ais.find(mmsi);
+            found = t && t < ais.data() + ais.size();
+            if (found) memcpy(&out, t, sizeof(AISTarget));
+        });
+        if (found) return true;
+    }
+    return false;
 }
 
-AutopilotData BoatState::getAutopilot() {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    AutopilotData copy = autopilot;
-    xSemaphoreGive(mutex);
-    return copy;
+// ============================================================
+// Writer (batched updates under a single lock)
+// ============================================================
+
+BoatState::Writer::Writer(BoatState& s)
+    : state(s), perfDirty(false), derivedDirty(false) {
+    state.beginWrite();
 }
 
-AISData BoatState::getAIS() {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    AISData copy = ais;
-    xSemaphoreGive(mutex);
-    return copy;
+BoatState::Writer::~Writer() {
+    // Derived values first: true wind feeds the performance calculation
+    if (derivedDirty) state.calculateDerivedDataLocked();
+    if (perfDirty)    state.updatePerformanceLocked();
+    state.endWrite();
 }
 
-PerformanceData BoatState::getPerformance() {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    PerformanceData copy = performance;
-    xSemaphoreGive(mutex);
-    return copy;
+// ============================================================
+// Writer — GPS Setters
+// ============================================================
+
+void BoatState::Writer::setGPSPosition(float lat, float lon) {
+    state.gps.position.set(lat, lon);
+    state.touch(BOAT_SECTION_GPS);
+}
+
+void BoatState::Writer::setGPSPositionE7(int32_t latE7, int32_t lonE7) {
+    state.gps.position.setE7(latE7, lonE7);
+    state.touch(BOAT_SECTION_GPS);
+}
+
+void BoatState::Writer::setGPSSOG(float sog) {
+    state.gps.sog.set(sog, "kn");
+    state.touch(BOAT_SECTION_GPS);
+}
+
+void BoatState::Writer::setGPSCOG(float cog) {
+    state.gps.cog.set(cog, "deg");
+    state.touch(BOAT_SECTION_GPS);
+}
+
+void BoatState::Writer::setGPSSatellites(int count) {
+    state.gps.satellites.set(count, "count");
+    state.touch(BOAT_SECTION_GPS);
+}
+
+void BoatState::Writer::setGPSFixQuality(int quality) {
+    state.gps.fix_quality.set(quality, "");
+    state.touch(BOAT_SECTION_GPS);
+}
+
+void BoatState::Writer::setGPSHDOP(float hdop) {
+    state.gps.hdop.set(hdop, "");
+    state.touch(BOAT_SECTION_GPS);
+}
+
+void BoatState::Writer::setGPSDateTime( uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second) {
+    state.gps.datetime.set( year, month, day, hour, minute, second);
+    state.touch(BOAT_SECTION_GPS);
+}
+
+// ============================================================
+// Writer — Speed Setters
+// ============================================================
+
+void BoatState::Writer::setSTW(float stw) {
+    state.speed.stw.set(stw, "kn");
+    // Recompute performance metrics with the new STW value on commit
+    perfDirty = true;
+    state.touch(BOAT_SECTION_SPEED);
+}
+
+void BoatState::Writer::setTrip(float trip) {
+    state.speed.trip.set(trip, "nm");
+    state.touch(BOAT_SECTION_SPEED);
+}
+
+void BoatState::Writer::setTotal(float total) {
+    state.speed.total.set(total, "nm");
+    state.touch(BOAT_SECTION_SPEED);
+}
+
+// ============================================================
+// Writer — Heading Setters
+// ============================================================
+
+void BoatState::Writer::setMagneticHeading(float heading_val) {
+    state.heading.magnetic.set(heading_val, "deg");
+    state.touch(BOAT_SECTION_HEADING);
+}
+
+void BoatState::Writer::setTrueHeading(float heading_val) {
+    state.heading.true_heading.set(heading_val, "deg");
+    state.touch(BOAT_SECTION_HEADING);
+}
+
+// ============================================================
+// Writer — Depth Setters
+// ============================================================
+
+void BoatState::Writer::setDepth(float depth_val) {
+    state.depth.below_transducer.set(depth_val, "m");
+    state.touch(BOAT_SECTION_DEPTH);
+}
+
+void BoatState::Writer::setDepthOffset(float offset) {
+    state.depth.offset.set(offset, "m");
+    state.touch(BOAT_SECTION_DEPTH);
+}
+
+// ============================================================
+// Writer — Wind Setters
+// ============================================================
+
+void BoatState::Writer::setApparentWind(float speed, float angle) {
+    state.wind.aws.set(speed, "kn");
+    state.wind.awa.set(angle, "deg");
+    
+    // Trigger calculation of true wind on commit
+    derivedDirty = true;
+    state.touch(BOAT_SECTION_WIND);
+}
+
+void BoatState::Writer::setTrueWind(float speed, float angle, float direction) {
+    state.wind.tws.set(speed, "kn");
+    state.wind.twa.set(angle, "deg");
+    state.wind.twd.set(direction, "deg");
+    state.touch(BOAT_SECTION_WIND);
+}
+
+// ============================================================
+// Writer — Environment Setters
+// ============================================================
+
+void BoatState::Writer::setWaterTemp(float temp) {
+    state.environment.water_temp.set(temp, "C");
+    state.touch(BOAT_SECTION_ENVIRONMENT);
+}
+
+void BoatState::Writer::setAirTemp(float temp) {
+    state.environment.air_temp.set(temp, "C");
+    state.touch(BOAT_SECTION_ENVIRONMENT);
+}
+
+void BoatState::Writer::setPressure(float pressure) {
+    state.environment.pressure.set(pressure, "hPa");
+    state.touch(BOAT_SECTION_ENVIRONMENT);
+}
+
+// ============================================================
+// Writer — Calculated Data Setters
+// ============================================================
+
+void BoatState::Writer::setVMGWind(float vmg) {
+    state.calculated.vmg_wind.set(vmg, "kn");
+    state.touch(BOAT_SECTION_CALCULATED);
+}
+
+void BoatState::Writer::setVMGWaypoint(float vmg) {
+    state.calculated.vmg_waypoint.set(vmg, "kn");
+    state.touch(BOAT_SECTION_CALCULATED);
+}
+
+void BoatState::Writer::setCurrentSetDrift(float set, float drift) {
+    state.calculated.set.set(set, "deg");
+    state.calculated.drift.set(drift, "kn");
+    state.touch(BOAT_SECTION_CALCULATED);
+}
+
+// ============================================================
+// Writer — Autopilot Setters
+// ============================================================
+
+void BoatState::Writer::setAutopilotMode(const String& mode) {
+    strncpy(state.autopilot.mode, mode.c_str(), sizeof(state.autopilot.mode) - 1);
+    state.autopilot.mode[sizeof(state.autopilot.mode) - 1] = '\0';
+    state.autopilot.timestamp = millis();
+    state.autopilot.valid = true;
+    state.touch(BOAT_SECTION_AUTOPILOT);
+}
+
+void BoatState::Writer::setAutopilotStatus(const String& status) {
+    strncpy(state.autopilot.status, status.c_str(), sizeof(state.autopilot.status) - 1);
+    state.autopilot.status[sizeof(state.autopilot.status) - 1] = '\0';
+    state.autopilot.timestamp = millis();
+    state.autopilot.valid = true;
+    state.touch(BOAT_SECTION_AUTOPILOT);
+}
+
+void BoatState::Writer::setAutopilotHeadingTarget(float heading) {
+    state.autopilot.heading_target.set(heading, "deg");
+    state.autopilot.timestamp = millis();
+    state.autopilot.valid = true;
+    state.touch(BOAT_SECTION_AUTOPILOT);
+}
+
+void BoatState::Writer::setAutopilotWindAngleTarget(float angle) {
+    state.autopilot.wind_angle_target.set(angle, "deg");
+    state.autopilot.timestamp = millis();
+    state.autopilot.valid = true;
+    state.touch(BOAT_SECTION_AUTOPILOT);
+}
+
+void BoatState::Writer::setAutopilotRudderAngle(float angle) {
+    state.autopilot.rudder_angle.set(angle, "deg");
+    state.autopilot.timestamp = millis();
+    state.autopilot.valid = true;
+    state.touch(BOAT_SECTION_AUTOPILOT);
+}
+
+void BoatState::Writer::setAutopilotXTE(float xte) {
+    state.autopilot.xte.set(xte, "nm");
+    state.autopilot.timestamp = millis();
+    state.autopilot.valid = true;
+    state.touch(BOAT_SECTION_AUTOPILOT);
+}
+
+void BoatState::Writer::setAutopilotAlarm(const String& alarm) {
+    strncpy(state.autopilot.alarm, alarm.c_str(), sizeof(state.autopilot.alarm) - 1);
+    state.autopilot.alarm[sizeof(state.autopilot.alarm) - 1] = '\0';
+    state.autopilot.timestamp = millis();
+    state.autopilot.valid = true;
+    state.touch(BOAT_SECTION_AUTOPILOT);
+}
+
+// ============================================================
+// Writer — AIS
+// ============================================================
+
+void BoatState::Writer::addOrUpdateAISTarget(const AISTarget& target) {
+    if (state.ais.addOrUpdate(target)) state.touch(BOAT_SECTION_AIS);
+}
+
+void BoatState::Writer::setAISTargetStatic(uint32_t mmsi, const char* name,
+                                           const char* callsign, uint8_t shipType) {
+    if (state.ais.setStatic(mmsi, name, callsign, shipType)) state.touch(BOAT_SECTION_AIS);
 }
 
 // ============================================================
-// GPS Setters
+// GPS Setters (single-field convenience, one lock each)
 // ============================================================
 
 void BoatState::setGPSPosition(float lat, float lon) {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    gps.position.set(lat, lon);
-    xSemaphoreGive(mutex);
+    Writer w(*this);
+    w.setGPSPosition(lat, lon);
+}
+
+void BoatState::setGPSPositionE7(int32_t latE7, int32_t lonE7) {
+    Writer w(*this);
+    w.setGPSPositionE7(latE7, lonE7);
 }
 
 void BoatState::setGPSSOG(float sog) {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    gps.sog.set(sog, "kn");
-    xSemaphoreGive(mutex);
+    Writer w(*this);
+    w.setGPSSOG(sog);
 }
 
 void BoatState::setGPSCOG(float cog) {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    gps.cog.set(cog, "deg");
-    xSemaphoreGive(mutex);
+    Writer w(*this);
+    w.setGPSCOG(cog);
 }
 
 void BoatState::setGPSSatellites(int count) {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    gps.satellites.set(count, "count");
-    xSemaphoreGive(mutex);
+    Writer w(*this);
+    w.setGPSSatellites(count);
 }
 
 void BoatState::setGPSFixQuality(int quality) {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    gps.fix_quality.set(quality, "");
-    xSemaphoreGive(mutex);
+    Writer w(*this);
+    w.setGPSFixQuality(quality);
 }
 
 void BoatState::setGPSHDOP(float hdop) {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    gps.hdop.set(hdop, "");
-    xSemaphoreGive(mutex);
+    Writer w(*this);
+    w.setGPSHDOP(hdop);
 }
 
 void BoatState::setGPSDateTime( uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second) {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    gps.datetime.set( year, month, day, hour, minute, second);
-    xSemaphoreGive(mutex);
+    Writer w(*this);
+    w.setGPSDateTime(year, month, day, hour, minute, second);
 }
 
 // ============================================================
-// Speed Setters
+// Speed Setters (single-field convenience, one lock each)
 // ============================================================
 
 void BoatState::setSTW(float stw) {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    speed.stw.set(stw, "kn");
-    xSemaphoreGive(mutex);
-    // Recompute performance metrics with the new STW value
-    updatePerformance();
+    Writer w(*this);
+    w.setSTW(stw);
 }
 
 void BoatState::setTrip(float trip) {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    speed.trip.set(trip, "nm");
-    xSemaphoreGive(mutex);
+    Writer w(*this);
+    w.setTrip(trip);
 }
 
 void BoatState::setTotal(float total) {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    speed.total.set(total, "nm");
-    xSemaphoreGive(mutex);
+    Writer w(*this);
+    w.setTotal(total);
 }
 
 // ============================================================
-// Heading Setters
+// Heading Setters (single-field convenience, one lock each)
 // ============================================================
 
 void BoatState::setMagneticHeading(float heading_val) {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    heading.magnetic.set(heading_val, "deg");
-    xSemaphoreGive(mutex);
+    Writer w(*this);
+    w.setMagneticHeading(heading_val);
 }
 
 void BoatState::setTrueHeading(float heading_val) {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    heading.true_heading.set(heading_val, "deg");
-    xSemaphoreGive(mutex);
+    Writer w(*this);
+    w.setTrueHeading(heading_val);
 }
 
 // ============================================================
-// Depth Setters
+// Depth Setters (single-field convenience, one lock each)
 // ============================================================
 
 void BoatState::setDepth(float depth_val) {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    depth.below_transducer.set(depth_val, "m");
-    xSemaphoreGive(mutex);
+    Writer w(*this);
+    w.setDepth(depth_val);
 }
 
 void BoatState::setDepthOffset(float offset) {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    depth.offset.set(offset, "m");
-    xSemaphoreGive(mutex);
+    Writer w(*this);
+    w.setDepthOffset(offset);
 }
 
 // ============================================================
-// Wind Setters
+// Wind Setters (single-field convenience, one lock each)
 // ============================================================
 
 void BoatState::setApparentWind(float speed, float angle) {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    wind.aws.set(speed, "kn");
-    wind.awa.set(angle, "deg");
-    xSemaphoreGive(mutex);
-    
-    // Trigger calculation of true wind if we have necessary data
-    calculateDerivedData();
+    Writer w(*this);
+    w.setApparentWind(speed, angle);
 }
 
 void BoatState::setTrueWind(float speed, float angle, float direction) {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    wind.tws.set(speed, "kn");
-    wind.twa.set(angle, "deg");
-    wind.twd.set(direction, "deg");
-    xSemaphoreGive(mutex);
+    Writer w(*this);
+    w.setTrueWind(speed, angle, direction);
 }
 
 // ============================================================
-// Environment Setters
+// Environment Setters (single-field convenience, one lock each)
 // ============================================================
 
 void BoatState::setWaterTemp(float temp) {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    environment.water_temp.set(temp, "C");
-    xSemaphoreGive(mutex);
+    Writer w(*this);
+    w.setWaterTemp(temp);
 }
 
 void BoatState::setAirTemp(float temp) {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    environment.air_temp.set(temp, "C");
-    xSemaphoreGive(mutex);
+    Writer w(*this);
+    w.setAirTemp(temp);
 }
 
 void BoatState::setPressure(float pressure) {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    environment.pressure.set(pressure, "hPa");
-    xSemaphoreGive(mutex);
+    Writer w(*this);
+    w.setPressure(pressure);
 }
 
 // ============================================================
-// Calculated Data Setters
+// Calculated Data Setters (single-field convenience, one lock each)
 // ============================================================
 
 void BoatState::setVMGWind(float vmg) {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    calculated.vmg_wind.set(vmg, "kn");
-    xSemaphoreGive(mutex);
+    Writer w(*this);
+    w.setVMGWind(vmg);
 }
 
 void BoatState::setVMGWaypoint(float vmg) {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    calculated.vmg_waypoint.set(vmg, "kn");
-    xSemaphoreGive(mutex);
+    Writer w(*this);
+    w.setVMGWaypoint(vmg);
 }
 
 void BoatState::setCurrentSetDrift(float set, float drift) {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    calculated.set.set(set, "deg");
-    calculated.drift.set(drift, "kn");
-    xSemaphoreGive(mutex);
+    Writer w(*this);
+    w.setCurrentSetDrift(set, drift);
 }
 
 // ============================================================
-// Autopilot Setters
+// Autopilot Setters (single-field convenience, one lock each)
 // ============================================================
 
 void BoatState::setAutopilotMode(const String& mode) {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    autopilot.mode = mode;
-    autopilot.timestamp = millis();
-    autopilot.valid = true;
-    xSemaphoreGive(mutex);
+    Writer w(*this);
+    w.setAutopilotMode(mode);
 }
 
 void BoatState::setAutopilotStatus(const String& status) {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    autopilot.status = status;
-    autopilot.timestamp = millis();
-    autopilot.valid = true;
-    xSemaphoreGive(mutex);
+    Writer w(*this);
+    w.setAutopilotStatus(status);
 }
 
 void BoatState::setAutopilotHeadingTarget(float heading) {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    autopilot.heading_target.set(heading, "deg");
-    autopilot.timestamp = millis();
-    autopilot.valid = true;
-    xSemaphoreGive(mutex);
+    Writer w(*this);
+    w.setAutopilotHeadingTarget(heading);
 }
 
 void BoatState::setAutopilotWindAngleTarget(float angle) {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    autopilot.wind_angle_target.set(angle, "deg");
-    autopilot.timestamp = millis();
-    autopilot.valid = true;
-    xSemaphoreGive(mutex);
+    Writer w(*this);
+    w.setAutopilotWindAngleTarget(angle);
 }
 
 void BoatState::setAutopilotRudderAngle(float angle) {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    autopilot.rudder_angle.set(angle, "deg");
-    autopilot.timestamp = millis();
-    autopilot.valid = true;
-    xSemaphoreGive(mutex);
+    Writer w(*this);
+    w.setAutopilotRudderAngle(angle);
 }
 
 void BoatState::setAutopilotXTE(float xte) {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    autopilot.xte.set(xte, "nm");
-    autopilot.timestamp = millis();
-    autopilot.valid = true;
-    xSemaphoreGive(mutex);
+    Writer w(*this);
+    w.setAutopilotXTE(xte);
 }
 
 void BoatState::setAutopilotAlarm(const String& alarm) {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    autopilot.alarm = alarm;
-    autopilot.timestamp = millis();
-    autopilot.valid = true;
-    xSemaphoreGive(mutex);
+    Writer w(*this);
+    w.setAutopilotAlarm(alarm);
 }
 
 // ============================================================
-// AIS
+// AIS (single-field convenience, one lock each)
 // ============================================================
 
 void BoatState::addOrUpdateAISTarget(const AISTarget& target) {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    ais.addOrUpdateTarget(target);
-    xSemaphoreGive(mutex);
+    Writer w(*this);
+    w.addOrUpdateAISTarget(target);
+}
+
+void BoatState::setAISTargetStatic(uint32_t mmsi, const char* name,
+                                   const char* callsign, uint8_t shipType) {
+    Writer w(*this);
+    w.setAISTargetStatic(mmsi, name, callsign, shipType);
 }
 
 // ============================================================
@@ -371,13 +655,66 @@ void BoatState::addOrUpdateAISTarget(const AISTarget& target) {
 // ============================================================
 
 void BoatState::cleanupStaleData() {
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    ais.removeStaleTargets();
-    xSemaphoreGive(mutex);
+    beginWrite();
+    if (ais.removeStale() > 0) touch(BOAT_SECTION_AIS);
+    for (int i = 0; i < BOAT_SECTION_COUNT; i++) {
+        uint32_t bits = freshBitsLocked((BoatSection)i);
+        if (bits != freshness[i]) {
+            freshness[i] = bits;
+            touch((BoatSection)i);
+        }
+    }
+    endWrite();
+}
+
+namespace {
+
+inline uint32_t freshBit(const DataPoint& dp, int bit) {
+    return dp.isStale() ? 0 : (1UL << bit);
+}
+
+} // namespace
+
+uint32_t BoatState::freshBitsLocked(BoatSection section) const {
+    switch (section) {
+        case BOAT_SECTION_GPS:
+            return freshBit(gps.position.lat, 0) | freshBit(gps.position.lon, 1) | freshBit(gps.sog, 2) |
+                   freshBit(gps.cog, 3) | freshBit(gps.satellites, 4) | freshBit(gps.fix_quality, 5) |
+                   freshBit(gps.hdop, 6) | (gps.datetime.isStale() ? 0 : (1UL << 7));
+        case BOAT_SECTION_SPEED:
+            return freshBit(speed.stw, 0) | freshBit(speed.trip, 1) | freshBit(speed.total, 2);
+        case BOAT_SECTION_HEADING:
+            return freshBit(heading.magnetic, 0) | freshBit(heading.true_heading, 1);
+        case BOAT_SECTION_DEPTH:
+            return freshBit(depth.below_transducer, 0) | freshBit(depth.offset, 1);
+        case BOAT_SECTION_WIND:
+            return freshBit(wind.aws, 0) | freshBit(wind.awa, 1) | freshBit(wind.tws, 2) |
+                   freshBit(wind.twa, 3) | freshBit(wind.twd, 4);
+        case BOAT_SECTION_ENVIRONMENT:
+            return freshBit(environment.water_temp, 0) | freshBit(environment.air_temp, 1) |
+                   freshBit(environment.pressure, 2);
+        case BOAT_SECTION_CALCULATED:
+            return freshBit(calculated.vmg_wind, 0) | freshBit(calculated.vmg_waypoint, 1) |
+                   freshBit(calculated.set, 2) | freshBit(calculated.drift, 3);
+        case BOAT_SECTION_AUTOPILOT:
+            return (autopilot.isStale() ? 0 : 1UL) | freshBit(autopilot.heading_target, 1) |
+                   freshBit(autopilot.wind_angle_target, 2) | freshBit(autopilot.rudder_angle, 3) |
+                   freshBit(autopilot.locked_heading, 4) | freshBit(autopilot.xte, 5);
+        case BOAT_SECTION_PERFORMANCE:
+            return freshBit(performance.vmg, 0) | freshBit(performance.polarPct, 1);
+        default:
+            // AIS: timed-out targets are removed above
+            return 0;
+    }
 }
 
 void BoatState::calculateDerivedData() {
-    xSemaphoreTake(mutex, portMAX_DELAY);
+    beginWrite();
+    calculateDerivedDataLocked();
+    endWrite();
+}
+
+void BoatState::calculateDerivedDataLocked() {
     
     // Calculate True Wind from Apparent Wind if we have STW and COG
     if (wind.aws.valid && wind.awa.valid && speed.stw.valid && heading.true_heading.valid) {
@@ -404,6 +741,7 @@ void BoatState::calculateDerivedData() {
         wind.tws.set(tws, "kn");
         wind.twa.set(twa, "deg");
         wind.twd.set(twd, "deg");
+        touch(BOAT_SECTION_WIND);
     }
     
     // Calculate VMG to wind
@@ -411,6 +749,7 @@ void BoatState::calculateDerivedData() {
         float awa_rad = wind.awa.value * PI / 180.0;
         float vmg_wind = speed.stw.value * cos(awa_rad);
         calculated.vmg_wind.set(vmg_wind, "kn");
+        touch(BOAT_SECTION_CALCULATED);
     }
     
     // Calculate current (Set & Drift)
@@ -433,9 +772,8 @@ void BoatState::calculateDerivedData() {
         
         calculated.drift.set(drift, "kn");
         calculated.set.set(set, "deg");
+        touch(BOAT_SECTION_CALCULATED);
     }
-    
-    xSemaphoreGive(mutex);
 }
 
 void BoatState::setDampingTau(float tau) {
@@ -455,17 +793,19 @@ float BoatState::getDampingTau() const {
 // ============================================================
 
 void BoatState::updatePerformance() {
-    // Read current values — each getter acquires the mutex internally,
-    // so we must NOT hold the mutex ourselves when calling them.
-    SpeedData spd = getSpeed();
-    WindData  wnd = getWind();
+    beginWrite();
+    updatePerformanceLocked();
+    endWrite();
+}
+
+void BoatState::updatePerformanceLocked() {
+    const SpeedData& spd = speed;
+    const WindData&  wnd = wind;
 
     const bool haveSTW = spd.stw.valid && !spd.stw.isStale();
     const bool haveTWS = wnd.tws.valid && !wnd.tws.isStale();
     const bool haveTWA = wnd.twa.valid && !wnd.twa.isStale();
 
-    xSemaphoreTake(mutex, portMAX_DELAY);
-
     // ── EMA damping ────────────────────────────────────────────
     // If damping is enabled (tau > 0), smooth the inputs via an
     // exponential moving average with a time-dependent alpha so that
@@ -538,196 +878,5 @@ void BoatState::updatePerformance() {
         performance.polarPct.invalidate();
     }
 
-    xSemaphoreGive(mutex);
-}
-
-// ============================================================
-// JSON Serialization
-// ============================================================
-
-void BoatState::addDataPointToJSON(JsonObject obj, const char* key, const DataPoint& dp) {
-    JsonObject point = obj[key].to<JsonObject>();
-    if (dp.valid && !dp.isStale()) {
-        point["value"] = dp.value;
-        point["unit"] = dp.unit;
-        point["age"] = (millis() - dp.timestamp) / 1000.0;
-    } else {
-        point["value"] = nullptr;
-        point["unit"] = dp.unit;
-        point["age"] = nullptr;
-    }
-}
-
-String BoatState::toJSON() {
-    JsonDocument doc;
-    
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    
-    // GPS
-    JsonObject gpsObj = doc["gps"].to<JsonObject>();
-    JsonObject position = gpsObj["position"].to<JsonObject>();
-    addDataPointToJSON(position, "lat", gps.position.lat);
-    addDataPointToJSON(position, "lon", gps.position.lon);
-    addDataPointToJSON(gpsObj, "sog", gps.sog);
-    addDataPointToJSON(gpsObj, "cog", gps.cog);
-    addDataPointToJSON(gpsObj, "satellites", gps.satellites);
-    addDataPointToJSON(gpsObj, "fix_quality", gps.fix_quality);
-    addDataPointToJSON(gpsObj, "hdop", gps.hdop);
-    
-    // Speed
-    JsonObject speedObj = doc["speed"].to<JsonObject>();
-    addDataPointToJSON(speedObj, "stw", speed.stw);
-    addDataPointToJSON(speedObj, "trip", speed.trip);
-    addDataPointToJSON(speedObj, "total", speed.total);
-    
-    // Heading
-    JsonObject headingObj = doc["heading"].to<JsonObject>();
-    addDataPointToJSON(headingObj, "magnetic", heading.magnetic);
-    addDataPointToJSON(headingObj, "true", heading.true_heading);
-    
-    // Depth
-    JsonObject depthObj = doc["depth"].to<JsonObject>();
-    addDataPointToJSON(depthObj, "below_transducer", depth.below_transducer);
-    addDataPointToJSON(depthObj, "offset", depth.offset);
-    
-    // Wind
-    JsonObject windObj = doc["wind"].to<JsonObject>();
-    addDataPointToJSON(windObj, "aws", wind.aws);
-    addDataPointToJSON(windObj, "awa", wind.awa);
-    addDataPointToJSON(windObj, "tws", wind.tws);
-    addDataPointToJSON(windObj, "twa", wind.twa);
-    addDataPointToJSON(windObj, "twd", wind.twd);
-    
-    // Environment
-    JsonObject envObj = doc["environment"].to<JsonObject>();
-    addDataPointToJSON(envObj, "water_temp", environment.water_temp);
-    addDataPointToJSON(envObj, "air_temp", environment.air_temp);
-    addDataPointToJSON(envObj, "pressure", environment.pressure);
-    
-    // Calculated
-    JsonObject calcObj = doc["calculated"].to<JsonObject>();
-    addDataPointToJSON(calcObj, "vmg_wind", calculated.vmg_wind);
-    addDataPointToJSON(calcObj, "vmg_waypoint", calculated.vmg_waypoint);
-    addDataPointToJSON(calcObj, "set", calculated.set);
-    addDataPointToJSON(calcObj, "drift", calculated.drift);
-    
-    // Autopilot
-    JsonObject apObj = doc["autopilot"].to<JsonObject>();
-    if (autopilot.valid && !autopilot.isStale()) {
-        apObj["mode"] = autopilot.mode;
-        apObj["status"] = autopilot.status;
-        addDataPointToJSON(apObj, "heading_target", autopilot.heading_target);
-        addDataPointToJSON(apObj, "wind_angle_target", autopilot.wind_angle_target);
-        addDataPointToJSON(apObj, "rudder_angle", autopilot.rudder_angle);
-        addDataPointToJSON(apObj, "xte", autopilot.xte);
-        apObj["alarm"] = autopilot.alarm;
-        apObj["age"] = (millis() - autopilot.timestamp) / 1000.0;
-    } else {
-        apObj["mode"] = nullptr;
-        apObj["status"] = nullptr;
-        apObj["age"] = nullptr;
-    }
-    
-    // AIS
-    JsonArray aisArray = doc["ais"]["targets"].to<JsonArray>();
-    for (int i = 0; i < ais.targetCount; i++) {
-        AISTarget& target = ais.targets[i];
-        unsigned long age = (millis() - target.timestamp) / 1000;
-        
-        if (age <= DATA_TIMEOUT_AIS / 1000) {
-            JsonObject targetObj = aisArray.add<JsonObject>();
-            targetObj["mmsi"] = target.mmsi;
-            targetObj["name"] = target.name;
-            targetObj["lat"] = target.lat;
-            targetObj["lon"] = target.lon;
-            targetObj["cog"] = target.cog;
-            targetObj["sog"] = target.sog;
-            targetObj["heading"] = target.heading;
-            targetObj["distance"] = target.distance;
-            targetObj["bearing"] = target.bearing;
-            targetObj["cpa"] = target.cpa;
-            targetObj["tcpa"] = target.tcpa;
-            targetObj["age"] = age;
-        }
-    }
-    
-    xSemaphoreGive(mutex);
-    
-    String output;
-    serializeJson(doc, output);
-    return output;
-}
-
-String BoatState::getNavigationJSON() {
-    JsonDocument doc;
-    
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    
-    JsonObject position = doc["position"].to<JsonObject>();
-    addDataPointToJSON(position, "lat", gps.position.lat);
-    addDataPointToJSON(position, "lon", gps.position.lon);
-    
-    JsonObject root = doc.as<JsonObject>();
-    addDataPointToJSON(root, "stw", speed.stw);
-    addDataPointToJSON(root, "sog", gps.sog);
-    addDataPointToJSON(root, "cog", gps.cog);
-    addDataPointToJSON(root, "depth", depth.below_transducer);
-    xSemaphoreGive(mutex);
-    
-    String output;
-    serializeJson(doc, output);
-    return output;
-}
-
-String BoatState::getWindJSON() {
-    JsonDocument doc;
-    
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    
-    JsonObject root = doc.as<JsonObject>();
-    addDataPointToJSON(root, "aws", wind.aws);
-    addDataPointToJSON(root, "awa", wind.awa);
-    addDataPointToJSON(root, "tws", wind.tws);
-    addDataPointToJSON(root, "twa", wind.twa);
-    addDataPointToJSON(root, "twd", wind.twd);
-    
-    xSemaphoreGive(mutex);
-    
-    String output;
-    serializeJson(doc, output);
-    return output;
-}
-
-String BoatState::getAISJSON() {
-    JsonDocument doc;
-    
-    xSemaphoreTake(mutex, portMAX_DELAY);
-    
-    JsonArray aisArray = doc["targets"].to<JsonArray>();
-    for (int i = 0; i < ais.targetCount; i++) {
-        AISTarget& target = ais.targets[i];
-        unsigned long age = (millis() - target.timestamp) / 1000;
-        
-        if (age <= DATA_TIMEOUT_AIS / 1000) {
-            JsonObject targetObj = aisArray.add<JsonObject>();
-            targetObj["mmsi"] = target.mmsi;
-            targetObj["name"] = target.name;
-            targetObj["lat"] = target.lat;
-            targetObj["lon"] = target.lon;
-            targetObj["cog"] = target.cog;
-            targetObj["sog"] = target.sog;
-            targetObj["heading"] = target.heading;
-            targetObj["distance"] = target.distance;
-            targetObj["bearing"] = target.bearing;
-            targetObj["cpa"] = target.cpa;
-            targetObj["tcpa"] = target.tcpa;
-            targetObj["age"] = age;
-        }
-    }
-    
-    xSemaphoreGive(mutex);
-    
-    String output;
-    serializeJson(doc, output);
-    return output;
+    touch(BOAT_SECTION_PERFORMANCE);
 }
@@ -0,0 +1,117 @@
+/**
+ * @file boat_state_json.cpp
+ * @brief JSON serialization of BoatState for the REST API.
+ *
+ * Kept apart from boat_state.cpp so that the state core builds without
+ * ArduinoJson (see host/ for the native build used by the benchmarks).
+ */
+
+#include "boat_state.h"
+
+// ============================================================
+// JSON Serialization
+// ============================================================
+
+void BoatState::addDataPointToJSON(JsonObject obj, const char* key, const DataPoint& dp) {
+    JsonObject point = obj[key].to<JsonObject>();
+    if (dp.valid && !dp.isStale()) {
+        point["value"] = dp.value;
+        point["unit"] = dp.unit;
+        point["age"] = (millis() - dp.timestamp) / 1000.0;
+    } else {
+        point["value"] = nullptr;
+        point["unit"] = dp.unit;
+        point["age"] = nullptr;
+    }
+}
+
+/**
+ * Coordinates are re-emitted from the exact 1e-7° fields: the float in the
+ * DataPoint only resolves ~0.4 m at these magnitudes.
+ */
+static void setExactCoordinate(JsonObject point, const DataPoint& dp, double exact) {
+    if (dp.valid && !dp.isStale()) point["value"] = exact;
+}
+
+String BoatState::getNavigationJSON() {
+    JsonDocument doc;
+    
+    const GPSData   gpsData   = getGPS();
+    const SpeedData speedData = getSpeed();
+    const DepthData depthData = getDepth();
+    
+    JsonObject position = doc["position"].to<JsonObject>();
+    addDataPointToJSON(position, "lat", gpsData.position.lat);
+    addDataPointToJSON(position, "lon", gpsData.position.lon);
+    setExactCoordinate(position["lat"], gpsData.position.lat, gpsData.position.latitude());
+    setExactCoordinate(position["lon"], gpsData.position.lon, gpsData.position.longitude());
+    
+    JsonObject root = doc.as<JsonObject>();
+    addDataPointToJSON(root, "stw", speedData.stw);
+    addDataPointToJSON(root, "sog", gpsData.sog);
+    addDataPointToJSON(root, "cog", gpsData.cog);
+    addDataPointToJSON(root, "depth", depthData.below_transducer);
+    
+    String output;
+    serializeJson(doc, output);
+    return output;
+}
+
+String BoatState::getWindJSON() {
+    JsonDocument doc;
+    
+    const WindData windData = getWind();
+    
+    JsonObject root = doc.as<JsonObject>();
+    addDataPointToJSON(root, "aws", windData.aws);
+    addDataPointToJSON(root, "awa", windData.awa);
+    addDataPointToJSON(root, "tws", windData.tws);
+    addDataPointToJSON(root, "twa", windData.twa);
+    addDataPointToJSON(root, "twd", windData.twd);
+    
+    String output;
+    serializeJson(doc, output);
+    return output;
+}
+
+String BoatState::getAISJSON() {
+    JsonDocument doc;
+    
+    uint16_t   cap     = getAISCapacity();
+    AISTarget* targets = (AISTarget*)malloc(cap * sizeof(AISTarget));
+    int        count   = targets ? getAISTargets(targets, cap) : 0;
+    addAISTargetsToJSON(doc["targets"].to<JsonArray>(), targets, count);
+    
+    String output;
+    serializeJson(doc, output);
+    free(targets);
+    return output;
+}
+
+// The names are referenced, not copied: keep targets[] alive until the
+// document has been serialized.
+void BoatState::addAISTargetsToJSON(JsonArray aisArray, const AISTarget* targets, int count) {
+    for (int i = 0; i < count; i++) {
+        const AISTarget& target = targets[i];
+        unsigned long age = (millis() - target.timestamp) / 1000;
+        
+        if (age <= DATA_TIMEOUT_AIS / 1000) {
+            JsonObject targetObj = aisArray.add<JsonObject>();
+            targetObj["mmsi"] = target.mmsi;
+            targetObj["name"] = (const char*)target.name;
+            targetObj["callsign"] = (const char*)target.callsign;
+            targetObj["ship_type"] = target.shipType;
+            targetObj["msg_type"] = target.msgType;
+            targetObj["lat"] = target.lat;
+            targetObj["lon"] = target.lon;
+            targetObj["cog"] = target.cog;
+            targetObj["sog"] = target.sog;
+            targetObj["heading"] = target.heading;
+            targetObj["distance"] = target.distance;
+            targetObj["bearing"] = target.bearing;
+            targetObj["cpa"] = target.cpa;
+            targetObj["tcpa"] = target.tcpa;
+            targetObj["age"] = age;
+        }
+    }
+}
@@ -0,0 +1,185 @@
+/**
+ * @file boat_state_stream.cpp
+ * @brief The full state document for /api/boat/state, streamed part by part.
+ *
+ * Same document as the ArduinoJson helpers in boat_state_json.cpp produce
+ * for the smaller endpoints, written with JsonWriter so that it never
+ * exists whole in memory: no DOM, no String, no copy of the AIS table
+ * (only of its MMSIs, see AISList).
+ * Builds without ArduinoJson, so the host bench covers it.
+ */
+
+#include "boat_state.h"
+#include "json_writer.h"
+
+namespace {
+
+// Parts before the AIS targets
+enum StatePart : uint32_t {
+    PART_GPS = 0,
+    PART_SPEED_HEADING,
+    PART_DEPTH_WIND,
+    PART_ENVIRONMENT_CALCULATED,
+    PART_AUTOPILOT,
+    PART_AIS_FIRST
+};
+
+void writeDataPoint(JsonWriter& w, const char* key, const DataPoint& dp) {
+    w.beginObject(key);
+    if (dp.valid && !dp.isStale()) {
+        w.add("value", dp.value);
+        w.add("unit", dp.unit);
+        w.add("age", (millis() - dp.timestamp) / 1000.0);
+    } else {
+        w.addNull("value");
+        w.add("unit", dp.unit);
+        w.addNull("age");
+    }
+    w.endObject();
+}
+
+/** Coordinates come from the exact 1e-7° fields: the float only resolves ~0.4 m. */
+void writeCoordinate(JsonWriter& w, const char* key, const DataPoint& dp, double exact) {
+    w.beginObject(key);
+    if (dp.valid && !dp.isStale()) {
+        w.add("value", exact);
+        w.add("unit", dp.unit);
+        w.add("age", (millis() - dp.timestamp) / 1000.0);
+    } else {
+        w.addNull("value");
+        w.add("unit", dp.unit);
+        w.addNull("age");
+    }
+    w.endObject();
+}
+
+} // namespace
+
+bool BoatState::writeJSON(JsonWriter& w, uint32_t part, void* ctx) {
+    JsonContext& doc   = *static_cast<JsonContext*>(ctx);
+    BoatState&   state = *doc.state;
+
+    switch (part) {
+        case PART_GPS: {
+            const GPSData gps = state.getGPS();
+            w.beginObject();
+            w.beginObject("gps");
+            w.beginObject("position");
+            writeCoordinate(w, "lat", gps.position.lat, gps.position.latitude());
+            writeCoordinate(w, "lon", gps.position.lon, gps.position.longitude());
+            w.endObject();
+            writeDataPoint(w, "sog", gps.sog);
+            writeDataPoint(w, "cog", gps.cog);
+            writeDataPoint(w, "satellites", gps.satellites);
+            writeDataPoint(w, "fix_quality", gps.fix_quality);
+            writeDataPoint(w, "hdop", gps.hdop);
+            w.endObject();
+            return true;
+        }
+
+        case PART_SPEED_HEADING: {
+            const SpeedData   speed   = state.getSpeed();
+            const HeadingData heading = state.getHeading();
+            w.beginObject("speed");
+            writeDataPoint(w, "stw", speed.stw);
+            writeDataPoint(w, "trip", speed.trip);
+            writeDataPoint(w, "total", speed.total);
+            w.endObject();
+            w.beginObject("heading");
+            writeDataPoint(w, "magnetic", heading.magnetic);
+            writeDataPoint(w, "true", heading.true_heading);
+            w.endObject();
+            return true;
+        }
+
+        case PART_DEPTH_WIND: {
+            const DepthData depth = state.getDepth();
+            const WindData  wind  = state.getWind();
+            w.beginObject("depth");
+            writeDataPoint(w, "below_transducer", depth.below_transducer);
+            writeDataPoint(w, "offset", depth.offset);
+            w.endObject();
+            w.beginObject("wind");
+            writeDataPoint(w, "aws", wind.aws);
+            writeDataPoint(w, "awa", wind.awa);
+            writeDataPoint(w, "tws", wind.tws);
+            writeDataPoint(w, "twa", wind.twa);
+            writeDataPoint(w, "twd", wind.twd);
+            w.endObject();
+            return true;
+        }
+
+        case PART_ENVIRONMENT_CALCULATED: {
+            const EnvironmentData env  = state.getEnvironment();
+            const CalculatedData  calc = state.getCalculated();
+            w.beginObject("environment");
+            writeDataPoint(w, "water_temp", env.water_temp);
+            writeDataPoint(w, "air_temp", env.air_temp);
+            writeDataPoint(w, "pressure", env.pressure);
+            w.endObject();
+            w.beginObject("calculated");
+            writeDataPoint(w, "vmg_wind", calc.vmg_wind);
+            writeDataPoint(w, "vmg_waypoint", calc.vmg_waypoint);
+            writeDataPoint(w, "set", calc.set);
+            writeDataPoint(w, "drift", calc.drift);
+            w.endObject();
+            return true;
+        }
+
+        case PART_AUTOPILOT: {
+            const AutopilotData ap = state.getAutopilot();
+            w.beginObject("autopilot");
+            if (ap.valid && !ap.isStale()) {
+                w.add("mode", (const char*)ap.mode);
+                w.add("status", (const char*)ap.status);
+                writeDataPoint(w, "heading_target", ap.heading_target);
+                writeDataPoint(w, "wind_angle_target", ap.wind_angle_target);
+                writeDataPoint(w, "rudder_angle", ap.rudder_angle);
+                writeDataPoint(w, "xte", ap.xte);
+                w.add("alarm", (const char*)ap.alarm);
+                w.add("age", (millis() - ap.timestamp) / 1000.0);
+            } else {
+                w.addNull("mode");
+                w.addNull("status");
+                w.addNull("age");
+            }
+            w.endObject();
+            w.beginObject("ais");
+            w.beginArray("targets");
+            state.listAISTargets(doc.ais);
+            return true;
+        }
+
+        default:
+            break;
+    }
+
+    // One AIS target per part, looked up by MMSI as the stream reaches it
+    AISTarget t;
+    if (!state.nextAISTarget(doc.ais, t)) {
+        w.endArray();
+        w.endObject();
+        w.endObject();
+        return false;
+    }
+
+    unsigned long age = (millis() - t.timestamp) / 1000;
+    w.beginObject();
+    w.add("mmsi", t.mmsi);
+    w.add("name", (const char*)t.name);
+    w.add("callsign", (const char*)t.callsign);
+    w.add("ship_type", t.shipType);
+    w.add("msg_type", t.msgType);
+    w.add("lat", t.lat);
+    w.add("lon", t.lon);
+    w.add("cog", t.cog);
+    w.add("sog", t.sog);
+    w.add("heading", t.heading);
+    w.add("distance", t.distance);
+    w.add("bearing", t.bearing);
+    w.add("cpa", t.cpa);
+    w.add("tcpa", t.tcpa);
+    w.add("age", age);
+    w.endObject();
+    return true;
+}
@@ -1,5 +1,7 @@
 #include "config_manager.h"
 #include "functions.h"
+#include "config.h"
+#include "nmea_router.h"
 #include <Arduino.h>
 
 ConfigManager::ConfigManager() {
@@ -82,38 +84,68 @@ bool ConfigManager::setWiFiConfig(const WiFiConfig& config) {
     return true;
 }
 
-bool ConfigManager::getSerialConfig(UARTConfig& config) {
-    config.baudRate = nvs.getUInt("serial_baud", 38400);
-    config.dataBits = nvs.getUChar("serial_data", 8);
-    config.parity = nvs.getUChar("serial_parity", 0);
-    config.stopBits = nvs.getUChar("serial_stop", 1);
+// Port 0 keeps the original "serial_*" keys so existing settings survive;
+// other ports use "serial<N>_*" (NVS keys are limited to 15 characters).
+static void serialKey(char* out, size_t size, uint8_t port, const char* field) {
+    if (port == 0) snprintf(out, size, "serial_%s", field);
+    else           snprintf(out, size, "serial%u_%s", port, field);
+}
+
+bool ConfigManager::getSerialConfig(UARTConfig& config, uint8_t port) {
+    static const uint32_t defaultBauds[NMEA_PORT_MAX] = NMEA_PORT_DEFAULT_BAUDS;
+    if (port >= NMEA_PORT_MAX) return false;
+
+    char key[16];
+    serialKey(key, sizeof(key), port, "baud");
+    config.baudRate = nvs.getUInt(key, defaultBauds[port]);
+    serialKey(key, sizeof(key), port, "data");
+    config.dataBits = nvs.getUChar(key, 8);
+    serialKey(key, sizeof(key), port, "parity");
+    config.parity = nvs.getUChar(key, 0);
+    serialKey(key, sizeof(key), port, "stop");
+    config.stopBits = nvs.getUChar(key, 1);
+    serialKey(key, sizeof(key), port, "en");
+    config.enabled = (port == 0) || nvs.getBool(key, port < NMEA_PORT_COUNT);
     
     #ifdef DEBUG
-    serialPrintf("[Config] Serial config loaded from NVS\n");
+    serialPrintf("[Config] Serial port %u config loaded from NVS\n", port);
     serialPrintf("[Config]   Baud: %u\n", config.baudRate);
     serialPrintf("[Config]   Data: %u\n", config.dataBits);
     serialPrintf("[Config]   Parity: %u\n", config.parity);
     serialPrintf("[Config]   Stop: %u\n", config.stopBits);
+    serialPrintf("[Config]   Enabled: %s\n", config.enabled ? "yes" : "no");
     #endif
     
     return true;
 }
 
-bool ConfigManager::setSerialConfig(const UARTConfig& config) {
+bool ConfigManager::setSerialConfig(const UARTConfig& config, uint8_t port) {
+    if (port >= NMEA_PORT_MAX) return false;
+
     #ifdef DEBUG
-    serialPrintf("[Config] Saving Serial config to NVS\n");
+    serialPrintf("[Config] Saving Serial port %u config to NVS\n", port);
     #endif
 
-    nvs.putUInt("serial_baud", config.baudRate);
-    nvs.putUChar("serial_data", config.dataBits);
-    nvs.putUChar("serial_parity", config.parity);
-    nvs.putUChar("serial_stop", config.stopBits);
+    char key[16];
+    serialKey(key, sizeof(key), port, "baud");
+    nvs.putUInt(key, config.baudRate);
+    serialKey(key, sizeof(key), port, "data");
+    nvs.putUChar(key, config.dataBits);
+    serialKey(key, sizeof(key), port, "parity");
+    nvs.putUChar(key, config.parity);
+    serialKey(key, sizeof(key), port, "stop");
+    nvs.putUChar(key, config.stopBits);
+    if (port > 0) {
+        serialKey(key, sizeof(key), port, "en");
+        nvs.putBool(key, config.enabled);
+    }
     
     #ifdef DEBUG
     serialPrintf("[Config]   Baud: %u\n", config.baudRate);
     serialPrintf("[Config]   Data: %u\n", config.dataBits);
     serialPrintf("[Config]   Parity: %u\n", config.parity);
     serialPrintf("[Config]   Stop: %u\n", config.stopBits);
+    serialPrintf("[Config]   Enabled: %s\n", config.enabled ? "yes" : "no");
     
     serialPrintf("[Config] ✓ Serial config saved\n");
     #endif
@@ -161,6 +193,72 @@ bool ConfigManager::setBLEConfig(const BLEConfigData& config) {
     return true;
 }
 
+bool ConfigManager::getUDPConfig(UDPConfig& config) {
+    config.enabled     = nvs.getBool("udp_enabled", UDP_DEFAULT_ENABLED);
+    config.mode        = nvs.getUChar("udp_mode", 0);
+    config.port        = nvs.getUShort("udp_port", UDP_DEFAULT_PORT);
+    config.maxDatagram = nvs.getUShort("udp_size", UDP_DEFAULT_DATAGRAM);
+    config.maxDelayMs  = nvs.getUShort("udp_delay", UDP_DEFAULT_DELAY_MS);
+
+    String group = nvs.isKey("udp_group") ? nvs.getString("udp_group", UDP_DEFAULT_GROUP) : UDP_DEFAULT_GROUP;
+    strncpy(config.group, group.c_str(), sizeof(config.group) - 1);
+    config.group[sizeof(config.group) - 1] = '\0';
+
+    #ifdef DEBUG
+    serialPrintf("[Config] UDP config loaded from NVS\n");
+    serialPrintf("[Config]   Enabled: %s\n", config.enabled ? "yes" : "no");
+    serialPrintf("[Config]   Mode: %s\n", config.mode == 0 ? "Broadcast" : config.group);
+    serialPrintf("[Config]   Port: %u\n", config.port);
+    #endif
+
+    return true;
+}
+
+bool ConfigManager::setUDPConfig(const UDPConfig& config) {
+    serialPrintf("[Config] Saving UDP config to NVS\n");
+
+    nvs.putBool("udp_enabled", config.enabled);
+    nvs.putUChar("udp_mode", config.mode);
+    nvs.putUShort("udp_port", config.port);
+    nvs.putString("udp_group", config.group);
+    nvs.putUShort("udp_size", config.maxDatagram);
+    nvs.putUShort("udp_delay", config.maxDelayMs);
+
+    serialPrintf("[Config]   Enabled: %s\n", config.enabled ? "Yes" : "No");
+    serialPrintf("[Config]   Mode: %s  Port: %u\n", config.mode == 0 ? "Broadcast" : config.group, config.port);
+    serialPrintf("[Config]   Datagram: %u B, %u ms\n", config.maxDatagram, config.maxDelayMs);
+
+    serialPrintf("[Config] ✓ UDP config saved\n");
+    return true;
+}
+
+// Keys: route_uart0 … route_uart2, route_tcp
+static void routeKey(char* key, size_t size, uint8_t source) {
+    snprintf(key, size, "route_%s", NMEARouter::sourceName(source));
+}
+
+bool ConfigManager::getRouteConfig(RouteConfig& config) {
+    char key[16];
+    for (uint8_t s = 0; s < NMEA_SOURCE_MAX; s++) {
+        routeKey(key, sizeof(key), s);
+        config.outputs[s] = nvs.getUChar(key, s == NMEA_SOURCE_TCP ? ROUTE_DEFAULT_TCP : ROUTE_DEFAULT_UART);
+    }
+    return true;
+}
+
+bool ConfigManager::setRouteConfig(const RouteConfig& config) {
+    serialPrintf("[Config] Saving routes to NVS\n");
+
+    char key[16];
+    for (uint8_t s = 0; s < NMEA_SOURCE_MAX; s++) {
+        routeKey(key, sizeof(key), s);
+        nvs.putUChar(key, config.outputs[s]);
+    }
+
+    serialPrintf("[Config] ✓ Routes saved\n");
+    return true;
+}
+
 void ConfigManager::factoryReset() {
     serialPrintf("[Config] Performing factory reset...\n");
     
@@ -168,12 +266,22 @@ void ConfigManager::factoryReset() {
     
     // Set default values
     WiFiConfig defaultWiFi;
-    UARTConfig defaultSerial;
     BLEConfigData defaultBLE;
     
     setWiFiConfig(defaultWiFi);
-    setSerialConfig(defaultSerial);
+    // Defaults per port come from getSerialConfig() on the now-empty NVS
+    for (uint8_t port = 0; port < NMEA_PORT_MAX; port++) {
+        UARTConfig defaultSerial;
+        getSerialConfig(defaultSerial, port);
+        setSerialConfig(defaultSerial, port);
+    }
     setBLEConfig(defaultBLE);
+    UDPConfig defaultUDP;
+    getUDPConfig(defaultUDP);
+    setUDPConfig(defaultUDP);
+    RouteConfig defaultRoutes;
+    getRouteConfig(defaultRoutes);
+    setRouteConfig(defaultRoutes);
     
     serialPrintf("[Config] ✓ Factory reset complete\n");
 }
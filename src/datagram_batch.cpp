@@ -0,0 +1,52 @@
+#include "datagram_batch.h"
+#include <string.h>
+
+DatagramBatch::DatagramBatch(DatagramSender s, void* c)
+    : sender(s), ctx(c), used(0), limitBytes(DATAGRAM_MAX), limitMs(50), oldestMs(0),
+      datagramCount(0), sentenceCount(0), oversizeCount(0) {
+}
+
+void DatagramBatch::setSender(DatagramSender s, void* c) {
+    sender = s;
+    ctx    = c;
+}
+
+void DatagramBatch::setLimits(size_t maxBytes, uint32_t maxDelayMs) {
+    limitBytes = maxBytes < DATAGRAM_MAX ? maxBytes : DATAGRAM_MAX;
+    limitMs    = maxDelayMs;
+    used       = 0;
+}
+
+void DatagramBatch::add(const char* line, size_t len, uint32_t nowMs) {
+    if (len + 2 > limitBytes) {
+        oversizeCount++;
+        return;
+    }
+    if (used + len + 2 > limitBytes) flush();
+
+    if (used == 0) oldestMs = nowMs;
+    memcpy(buf + used, line, len);
+    used += len;
+    buf[used++] = '\r';
+    buf[used++] = '\n';
+    sentenceCount++;
+}
+
+bool DatagramBatch::poll(uint32_t nowMs) {
+    if (used == 0 || nowMs - oldestMs < limitMs) return false;
+    flush();
+    return true;
+}
+
+uint32_t DatagramBatch::msUntilDue(uint32_t nowMs) const {
+    if (used == 0) return limitMs;
+    uint32_t waited = nowMs - oldestMs;
+    return waited >= limitMs ? 0 : limitMs - waited;
+}
+
+void DatagramBatch::flush() {
+    if (used == 0) return;
+    if (sender) sender(buf, used, ctx);
+    datagramCount++;
+    used = 0;
+}
@@ -0,0 +1,73 @@
+#include "http_range.h"
+#include <ctype.h>
+#include <string.h>
+#include <strings.h>
+
+namespace {
+
+void skipSpaces(const char*& p) {
+    while (*p == ' ' || *p == '\t') p++;
+}
+
+/** Decimal position; false if no digit or past 2^63. */
+bool parsePosition(const char*& p, uint64_t& out) {
+    if (!isdigit((unsigned char)*p)) return false;
+    out = 0;
+    while (isdigit((unsigned char)*p)) {
+        if (out > (UINT64_MAX >> 1) / 10) return false;
+        out = out * 10 + (uint64_t)(*p++ - '0');
+    }
+    return true;
+}
+
+} // namespace
+
+HttpRangeResult parseHttpRange(const char* header, uint64_t size, uint64_t& first, uint64_t& last) {
+    if (!header) return HTTP_RANGE_NONE;
+
+    const char* p = header;
+    skipSpaces(p);
+    if (strncasecmp(p, "bytes", 5) != 0) return HTTP_RANGE_NONE;
+    p += 5;
+    skipSpaces(p);
+    if (*p++ != '=') return HTTP_RANGE_NONE;
+    if (strchr(p, ',')) return HTTP_RANGE_NONE;   // Multi-range: whole body instead
+    skipSpaces(p);
+
+    uint64_t a = 0, b = 0;
+    bool     hasFirst = parsePosition(p, a);
+    skipSpaces(p);
+    if (*p++ != '-') return HTTP_RANGE_NONE;
+    skipSpaces(p);
+    bool hasLast = parsePosition(p, b);
+    skipSpaces(p);
+    if (*p != '\0') return HTTP_RANGE_NONE;
+
+    if (!hasFirst) {
+        // Suffix: the last b bytes
+        if (!hasLast) return HTTP_RANGE_NONE;
+        if (b == 0 || size == 0) return HTTP_RANGE_UNSATISFIABLE;
+        first = b < size ? size - b : 0;
+        last  = size - 1;
+        return HTTP_RANGE_OK;
+    }
+    if (hasLast && b < a) return HTTP_RANGE_NONE;
+    if (a >= size) return HTTP_RANGE_UNSATISFIABLE;
+
+    first = a;
+    last  = (hasLast && b < size - 1) ? b : size - 1;
+    return HTTP_RANGE_OK;
+}
+
+bool httpIfRangeMatches(const char* ifRange, const char* etag, const char* lastModified) {
+    if (!ifRange) return true;
+
+    const char* p = ifRange;
+    skipSpaces(p);
+    size_t n = strlen(p);
+    while (n > 0 && (p[n - 1] == ' ' || p[n - 1] == '\t')) n--;
+
+    if (n >= 2 && p[0] == 'W' && p[1] == '/') return false;
+    if (n > 0 && p[0] == '"') return etag && strlen(etag) == n && strncmp(p, etag, n) == 0;
+    return lastModified && strlen(lastModified) == n && strncmp(p, lastModified, n) == 0;
+}
@@ -0,0 +1,192 @@
+#include "json_writer.h"
+#include <math.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+// ============================================================
+// JsonWriter
+// ============================================================
+
+JsonWriter::JsonWriter(char* buf, size_t cap)
+    : buf(buf), cap(cap), len(0), overflow(false), depth(0) {
+    first[0] = true;
+}
+
+void JsonWriter::put(char c) {
+    if (len < cap) {
+        buf[len++] = c;
+    } else {
+        overflow = true;
+    }
+}
+
+void JsonWriter::put(const char* s, size_t n) {
+    if (n > cap - len) {
+        n = cap - len;
+        overflow = true;
+    }
+    memcpy(buf + len, s, n);
+    len += n;
+}
+
+void JsonWriter::putString(const char* s) {
+    static const char kHex[] = "0123456789abcdef";
+    put('"');
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            put('\\');
+            put((char)c);
+        } else if (c < 0x20) {
+            char esc[6] = { '\\', 'u', '0', '0', kHex[c >> 4], kHex[c & 0xF] };
+            put(esc, sizeof(esc));
+        } else {
+            put((char)c);
+        }
+    }
+    put('"');
+}
+
+void JsonWriter::putNumber(const char* fmt, ...) {
+    char tmp[32];
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(tmp, sizeof(tmp), fmt, args);
+    va_end(args);
+    if (n > 0) put(tmp, (size_t)n < sizeof(tmp) ? (size_t)n : sizeof(tmp) - 1);
+}
+
+void JsonWriter::prefix(const char* key) {
+    if (!first[depth]) put(',');
+    first[depth] = false;
+    if (key) {
+        putString(key);
+        put(':');
+    }
+}
+
+JsonWriter& JsonWriter::beginObject(const char* key) {
+    prefix(key);
+    put('{');
+    if (depth < JSON_WRITER_MAX_DEPTH) {
+        first[++depth] = true;
+    } else {
+        overflow = true;
+    }
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    if (depth > 0) depth--;
+    put('}');
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray(const char* key) {
+    prefix(key);
+    put('[');
+    if (depth < JSON_WRITER_MAX_DEPTH) {
+        first[++depth] = true;
+    } else {
+        overflow = true;
+    }
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    if (depth > 0) depth--;
+    put(']');
+    return *this;
+}
+
+JsonWriter& JsonWriter::add(const char* key, const char* value) {
+    prefix(key);
+    if (value) {
+        putString(value);
+    } else {
+        put("null", 4);
+    }
+    return *this;
+}
+
+JsonWriter& JsonWriter::add(const char* key, bool value) {
+    prefix(key);
+    if (value) {
+        put("true", 4);
+    } else {
+        put("false", 5);
+    }
+    return *this;
+}
+
+JsonWriter& JsonWriter::add(const char* key, int value)                { prefix(key); putNumber("%d", value);   return *this; }
+JsonWriter& JsonWriter::add(const char* key, unsigned value)           { prefix(key); putNumber("%u", value);   return *this; }
+JsonWriter& JsonWriter::add(const char* key, long value)               { prefix(key); putNumber("%ld", value);  return *this; }
+JsonWriter& JsonWriter::add(const char* key, unsigned long value)      { prefix(key); putNumber("%lu", value);  return *this; }
+JsonWriter& JsonWriter::add(const char* key, long long value)          { prefix(key); putNumber("%lld", value); return *this; }
+JsonWriter& JsonWriter::add(const char* key, unsigned long long value) { prefix(key); putNumber("%llu", value); return *this; }
+
+JsonWriter& JsonWriter::add(const char* key, float value) {
+    prefix(key);
+    if (isnan(value) || isinf(value)) {
+        put("null", 4);
+    } else {
+        putNumber("%.7g", (double)value);
+    }
+    return *this;
+}
+
+JsonWriter& JsonWriter::add(const char* key, double value) {
+    prefix(key);
+    if (isnan(value) || isinf(value)) {
+        put("null", 4);
+    } else {
+        putNumber("%.10g", value);
+    }
+    return *this;
+}
+
+JsonWriter& JsonWriter::addNull(const char* key) {
+    prefix(key);
+    put("null", 4);
+    return *this;
+}
+
+// ============================================================
+// JsonStream
+// ============================================================
+
+JsonStream::JsonStream(JsonProducer fn, void* ctx)
+    : fn(fn), ctx(ctx), writer(staging, sizeof(staging)), pos(0), part(0), done(false), truncated(false) {
+}
+
+size_t JsonStream::read(uint8_t* out, size_t maxLen) {
+    size_t n = 0;
+    while (n < maxLen) {
+        if (pos < writer.length()) {
+            size_t take = writer.length() - pos;
+            if (take > maxLen - n) take = maxLen - n;
+            memcpy(out + n, staging + pos, take);
+            pos += take;
+            n   += take;
+            continue;
+        }
+        if (done) {
+            break;
+        }
+
+        writer.rewind();
+        pos = 0;
+        bool more = fn(writer, part++, ctx);
+        if (writer.overflowed()) {
+            // Sending the cut part would only produce invalid JSON
+            writer.rewind();
+            truncated = true;
+            done = true;
+        } else if (!more) {
+            done = true;
+        }
+    }
+    return n;
+}
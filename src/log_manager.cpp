@@ -12,19 +12,23 @@
 
 #include "log_manager.h"
 #include "functions.h"
+#include "pipeline_stats.h"
+#include "metrics.h"
 #include <ArduinoJson.h>
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
 
+extern PipelineStats pipelineStats;
+
 // ─────────────────────────────────────────────────────────────────────────────
 // Constructor / Destructor
 // ─────────────────────────────────────────────────────────────────────────────
 
-LogManager::LogManager(SDManager* sdMgr, BoatState* bs)
-    : sdManager(sdMgr), boatState(bs),
+LogManager::LogManager(SDManager* sdMgr, BoatState* bs, SentencePool* sp)
+    : sdManager(sdMgr), boatState(bs), pool(sp),
       queue(nullptr), taskHandle(nullptr), statsMutex(nullptr),
-      lastFlushMs(0), lastCsvSnapMs(0),
+      lastFlushMs(0), lastCsvSnapMs(0), fixCache(UINT32_MAX),
       sessionCounter(0), initialized(false), running(false) {
 }
 
@@ -47,8 +51,15 @@ LogManager::~LogManager() {
  */
 bool LogManager::hasGPSFix() const {
     if (!boatState) return false;
+
+    uint32_t gen    = boatState->getGeneration(BOAT_SECTION_GPS) << 1;
+    uint32_t cached = fixCache.load(std::memory_order_relaxed);
+    if ((cached & ~1u) == gen) return cached & 1;
+
     GPSData gps = boatState->getGPS();
-    return gps.datetime.getTimestamp() > 1;
+    bool fix = gps.datetime.getTimestamp() > 1;
+    fixCache.store(gen | (fix ? 1 : 0), std::memory_order_relaxed);
+    return fix;
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
@@ -159,21 +170,15 @@ bool LogManager::tryOpenFiles() {
 // Producer API
 // ─────────────────────────────────────────────────────────────────────────────
 
-void LogManager::logNMEA(const char* sentence) {
-    if (!initialized || !config.nmeaEnabled || !sentence) return;
+void LogManager::logNMEA(SentenceRef ref) {
+    if (!initialized || !config.nmeaEnabled || ref == SENTENCE_NONE) return;
     if (!hasGPSFix()) return;  // No fix yet — discard
 
     LogEntry entry;
     entry.type = LOG_NMEA;
-    strncpy(entry.data, sentence, sizeof(entry.data) - 1);
-    entry.data[sizeof(entry.data) - 1] = '\0';
-
-    if (xQueueSend(queue, &entry, 0) != pdTRUE) {
-        if (xSemaphoreTake(statsMutex, 0) == pdTRUE) {
-            stats.droppedEntries++;
-            xSemaphoreGive(statsMutex);
-        }
-    }
+    entry.ref  = ref;
+    pool->retain(ref);
+    enqueue(entry);
 }
 
 void LogManager::logSeatalk(const uint8_t* data, uint8_t len) {
@@ -182,20 +187,40 @@ void LogManager::logSeatalk(const uint8_t* data, uint8_t len) {
 
     LogEntry entry;
     entry.type = LOG_SEATALK;
+    entry.ref  = pool->acquire();
+    if (entry.ref == SENTENCE_NONE) {
+        countDropped();
+        return;
+    }
 
+    SentenceBuf& buf = pool->at(entry.ref);
     size_t pos = 0;
-    for (uint8_t i = 0; i < len && pos + 3 < sizeof(entry.data); i++) {
-        if (i > 0) entry.data[pos++] = ' ';
-        snprintf(entry.data + pos, 3, "%02X", data[i]);
+    for (uint8_t i = 0; i < len && pos + 3 < sizeof(buf.raw); i++) {
+        if (i > 0) buf.raw[pos++] = ' ';
+        snprintf(buf.raw + pos, 3, "%02X", data[i]);
         pos += 2;
     }
-    entry.data[pos] = '\0';
+    buf.raw[pos] = '\0';
+    buf.len      = (uint8_t)pos;
 
-    if (xQueueSend(queue, &entry, 0) != pdTRUE) {
-        if (xSemaphoreTake(statsMutex, 0) == pdTRUE) {
-            stats.droppedEntries++;
-            xSemaphoreGive(statsMutex);
-        }
+    enqueue(entry);
+}
+
+void LogManager::enqueue(const LogEntry& entry) {
+    if (xQueueSend(queue, &entry, 0) == pdTRUE) {
+        pipelineStats.recordDepth(QUEUE_LOG, (uint16_t)uxQueueMessagesWaiting(queue));
+        return;
+    }
+
+    if (entry.ref != SENTENCE_NONE) pool->release(entry.ref);
+    pipelineStats.recordDrop(DROP_LOG_QUEUE_FULL);
+    countDropped();
+}
+
+void LogManager::countDropped() {
+    if (xSemaphoreTake(statsMutex, 0) == pdTRUE) {
+        stats.droppedEntries++;
+        xSemaphoreGive(statsMutex);
     }
 }
 
@@ -376,7 +401,8 @@ void LogManager::processEntry(const LogEntry& entry) {
     switch (entry.type) {
         case LOG_NMEA:
             if (nmeaFile) {
-                nmeaFile.println(entry.data);
+                nmeaFile.println(pool->text(entry.ref));
+                pipelineStats.recordLatency(STAGE_LOG, micros() - pool->at(entry.ref).arrivalUs);
                 if (xSemaphoreTake(statsMutex, 0) == pdTRUE) {
                     stats.nmeaLines++;
                     xSemaphoreGive(statsMutex);
@@ -392,9 +418,9 @@ void LogManager::processEntry(const LogEntry& entry) {
                     ts = boatState->getGPS().datetime.getTimestamp();
                 }
                 if (ts > 1) {
-                    seatalkFile.printf("%llu %s\n", (unsigned long long)ts, entry.data);
+                    seatalkFile.printf("%llu %s\n", (unsigned long long)ts, pool->text(entry.ref));
                 } else {
-                    seatalkFile.printf("%lu %s\n", (unsigned long)millis(), entry.data);
+                    seatalkFile.printf("%lu %s\n", (unsigned long)millis(), pool->text(entry.ref));
                 }
                 if (xSemaphoreTake(statsMutex, 0) == pdTRUE) {
                     stats.seatalkLines++;
@@ -441,9 +467,9 @@ void LogManager::writeCSVSnapshot() {
         return "";
     };
 
-    auto gpsCoord = [](const DataPoint& dp) -> String {
+    auto gpsCoord = [](const DataPoint& dp, double exact) -> String {
         if (dp.valid && !dp.isStale()) {
-            String v = String(dp.value, 6);
+            String v = String(exact, 7);
             v.replace('.', ',');
             return v;
         }
@@ -452,8 +478,8 @@ void LogManager::writeCSVSnapshot() {
 
     csvFile.printf("%llu;%s;%s;%s;%s;%s;%s;%s;%s;%s;%s;%s;%s;%s;%s\n",
         (unsigned long long)gpsTs,
-        gpsCoord(gps.position.lat).c_str(),
-        gpsCoord(gps.position.lon).c_str(),
+        gpsCoord(gps.position.lat, gps.position.latitude()).c_str(),
+        gpsCoord(gps.position.lon, gps.position.longitude()).c_str(),
         fv(gps.sog).c_str(),
         fv(gps.cog).c_str(),
         fv(speed.stw).c_str(),
@@ -503,6 +529,7 @@ void LogManager::logTask(void* param) {
             // Ensure files are open before processing (fix may have just arrived)
             if (!self->hasOpenFiles()) self->tryOpenFiles();
             if (self->hasOpenFiles()) self->processEntry(entry);
+            if (entry.ref != SENTENCE_NONE) self->pool->release(entry.ref);
         }
 
         now = millis();
@@ -523,4 +550,20 @@ void LogManager::logTask(void* param) {
 
         taskYIELD();
     }
-}
\ No newline at end of file
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Metrics
+// ─────────────────────────────────────────────────────────────────────────────
+
+void LogManager::registerMetrics(MetricsRegistry& reg) const {
+    // Aligned 32-bit reads are atomic on the ESP32, so no statsMutex here
+    reg.addCounter("espnav_log_lines", "Lines written to the SD logbook this session",
+                   &stats.nmeaLines, "kind=\"nmea\"");
+    reg.addCounter("espnav_log_lines", "Lines written to the SD logbook this session",
+                   &stats.seatalkLines, "kind=\"seatalk\"");
+    reg.addCounter("espnav_log_lines", "Lines written to the SD logbook this session",
+                   &stats.csvSnapshots, "kind=\"csv\"");
+    reg.addCounter("espnav_log_dropped", "Log entries dropped this session (queue full)",
+                   &stats.droppedEntries);
+}
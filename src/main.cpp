@@ -2,14 +2,19 @@
  * @file main.cpp
  * @brief Marine Gateway — ESP32-S3 firmware entry point.
  *
- * Initialises all subsystems (WiFi, UART, SeaTalk, TCP, BLE, SD card, Web)
+ * Initialises all subsystems (WiFi, UART, SeaTalk, TCP, UDP, BLE, SD card, Web)
  * and creates the FreeRTOS task set.
  *
  * Task layout:
- *   Core 0 — uartReaderTask  (priority 5): reads NMEA from UART, parses, enqueues
+ *   Core 0 — UART_RX<n>      (priority 5): one per input port; frames lines into the merger
+ *   Core 0 — mergeTask       (priority 4): merges ports by arrival time, parses, enqueues
  *   Core 0 — seatalkTask     (priority 5): drives SeatalkRMT pump
- *   Core 1 — processorTask   (priority 3): dequeues NMEA, broadcasts to TCP + WS
+ *   Core 1 — processorTask   (priority 3): dequeues NMEA, routes it to TCP clients, UDP, WS and UART TX
  *   Core 1 — wifiTask        (priority 2): monitors WiFi state machine
+ *
+ * Each sentence is copied once, into a SentencePool buffer, by the RX task
+ * that framed it.  The merger, nmeaQueue and the logger pass 16-bit
+ * references to that buffer and release them when done.
  */
 
 #include <Arduino.h>
@@ -27,10 +32,17 @@
 #include "config_manager.h"
 #include "wifi_manager.h"
 #include "uart_handler.h"
+#include "nmea_merge.h"
+#include "sentence_pool.h"
+#include "index_ring.h"
+#include "pipeline_stats.h"
+#include "metrics.h"
 #include "seatalk_rmt.h"
 #include "seatalk_manager.h"
 #include "nmea_parser.h"
 #include "tcp_server.h"
+#include "udp_output.h"
+#include "nmea_router.h"
 #include "web_server.h"
 #include "ble_manager.h"
 #include "polar.h"
@@ -41,12 +53,18 @@
 ConfigManager  configManager;
 BoatState      boatState;
 WiFiManager    wifiManager;
-UARTHandler    uartHandler;
+UARTHandler    uartPorts[NMEA_PORT_COUNT];
+SentencePool   sentencePool;
+PipelineStats  pipelineStats;
+MetricsRegistry metrics;
+NMEAMerger     nmeaMerger(sentencePool);
 SDManager      sdManager;
-LogManager     logManager(&sdManager, &boatState);
+LogManager     logManager(&sdManager, &boatState, &sentencePool);
 SeatalkRMT     seatalkHandler(&logManager);
 SeatalkManager seatalkManager(&seatalkHandler, &boatState);
 TCPServer      tcpServer;
+UDPOutput      udpOutput;
+NMEARouter     nmeaRouter;
 BLEManager     bleManager;
 NMEAParser     nmeaParser(&boatState);
 
@@ -55,23 +73,25 @@ Adafruit_NeoPixel strip(NUM_LEDS, LED_PIN, NEO_GRB + NEO_KHZ800);
 char rgb[3] = {100, 100, 100}; // Vert par défaut
 
 // WebServer receives all subsystem pointers including SDManager.
-WebServer webServer(&configManager, &wifiManager, &tcpServer, &uartHandler,
+WebServer webServer(&configManager, &wifiManager, &tcpServer, uartPorts,
                     &nmeaParser, &boatState, &bleManager, &seatalkManager, &logManager,
                     &sdManager);
 
 
 
-// Message queue for NMEA sentences
-QueueHandle_t nmeaQueue;
+// Parsed sentences on their way to the processor task (pool references)
+IndexRing<NMEA_QUEUE_SIZE> nmeaQueue;
 
 // Task handles
-TaskHandle_t uartReaderTaskHandle;
-TaskHandle_t processorTaskHandle;
+TaskHandle_t mergeTaskHandle = NULL;
+TaskHandle_t processorTaskHandle = NULL;
 TaskHandle_t wifiTaskHandle;
 TaskHandle_t seatalkTaskHandle;
 
 // Forward declarations
-void uartReaderTask(void* parameter);
+void onUartLine(char* line, size_t len, void* ctx);
+void onTcpLine(const char* line, size_t len, uint8_t client, void* ctx);
+void mergeTask(void* parameter);
 void processorTask(void* parameter);
 void wifiTask(void* parameter);
 void seatalkTask(void* parameter);
@@ -115,6 +135,34 @@ static void listLittleFSFiles(const char* dirname, uint8_t levels) {
     serialPrintf("[LittleFS] Total: %d files, %zu bytes\n", fileCount, totalSize);
 }
 
+// ── Metrics ───────────────────────────────────────────────────────────────────
+
+static int64_t readFreeHeap(const void*)    { return ESP.getFreeHeap(); }
+static int64_t readMinFreeHeap(const void*) { return ESP.getMinFreeHeap(); }
+static int64_t readUptime(const void*)      { return millis() / 1000; }
+
+/** Everything /metrics exposes; registered once, before the web server starts. */
+static void registerMetrics() {
+    metrics.addGauge("espnav_heap_free_bytes", "Free internal heap", readFreeHeap, &metrics);
+    metrics.addGauge("espnav_heap_min_free_bytes", "Lowest free heap since boot", readMinFreeHeap, &metrics);
+    metrics.addGauge("espnav_uptime_seconds", "Time since boot", readUptime, &metrics);
+    metrics.addCounter("espnav_nmea_queue_overflows", "Parsed sentences dropped on a full nmeaQueue",
+                       &g_nmeaQueueOverflows);
+
+    for (uint8_t port = 0; port < NMEA_PORT_COUNT; port++) uartPorts[port].registerMetrics(metrics);
+    nmeaMerger.registerMetrics(metrics, NMEA_PORT_COUNT);
+    sentencePool.registerMetrics(metrics);
+    nmeaParser.registerMetrics(metrics);
+    pipelineStats.registerMetrics(metrics);
+    tcpServer.registerMetrics(metrics);
+    udpOutput.registerMetrics(metrics);
+    nmeaRouter.registerMetrics(metrics);
+    webServer.registerMetrics(metrics);
+    logManager.registerMetrics(metrics);
+
+    serialPrintf("[Metrics] ✓ %u metrics registered (max %u)\n", metrics.size(), METRICS_MAX);
+}
+
 // ── setup ─────────────────────────────────────────────────────────────────────
 
 void setup() {
@@ -183,6 +231,10 @@ void setup() {
         serialPrintf("[Polar] No polar file at %s\n", POLAR_FILE_PATH);
     }
 
+    // ── Sentence pool ─────────────────────────────────────────
+    // Before anything that produces or logs sentences
+    sentencePool.begin();
+
     // ── SD card ───────────────────────────────────────────────
     // Initialised before WiFi so that the SD status is available immediately
     // in the web dashboard without waiting for network bring-up.
@@ -199,9 +251,27 @@ void setup() {
                   wifiConfig.ssid,
                   wifiConfig.mode == 0 ? "Station" : "AP");
 
-    UARTConfig serialConfig;
-    configManager.getSerialConfig(serialConfig);
-    serialPrintf("[Config] UART: %u baud\n", serialConfig.baudRate);
+    UARTConfig serialConfig[NMEA_PORT_COUNT];
+    for (uint8_t port = 0; port < NMEA_PORT_COUNT; port++) {
+        configManager.getSerialConfig(serialConfig[port], port);
+        serialPrintf("[Config] UART%u: %u baud%s\n", port, serialConfig[port].baudRate,
+                      serialConfig[port].enabled ? "" : " (disabled)");
+    }
+
+    UDPConfig udpConfig;
+    configManager.getUDPConfig(udpConfig);
+    serialPrintf("[Config] UDP: %s port %u (%s)\n",
+                  udpConfig.mode == 0 ? "broadcast" : udpConfig.group, udpConfig.port,
+                  udpConfig.enabled ? "Enabled" : "Disabled");
+
+    RouteConfig routeConfig;
+    configManager.getRouteConfig(routeConfig);
+    for (uint8_t s = 0; s < NMEA_SOURCE_MAX; s++) {
+        nmeaRouter.setRoutes(s, routeConfig.outputs[s]);
+    }
+    serialPrintf("[Config] Routes: uart0=0x%02X uart1=0x%02X uart2=0x%02X tcp=0x%02X\n",
+                  nmeaRouter.routes(0), nmeaRouter.routes(1), nmeaRouter.routes(2),
+                  nmeaRouter.routes(NMEA_SOURCE_TCP));
 
     BLEConfigData bleConfig;
     configManager.getBLEConfig(bleConfig);
@@ -214,9 +284,14 @@ void setup() {
     wifiManager.start();
 
     // ── UART ──────────────────────────────────────────────────
-    serialPrintf("\n[UART] Initializing...\n");
-    uartHandler.init(serialConfig);
-    uartHandler.start();
+    serialPrintf("\n[UART] Initializing %u port(s)...\n", NMEA_PORT_COUNT);
+    for (uint8_t port = 0; port < NMEA_PORT_COUNT; port++) {
+        if (!serialConfig[port].enabled) continue;
+        uartPorts[port].init(port, serialConfig[port]);
+        // The port index rides in ctx so onUartLine() can tag the source
+        uartPorts[port].setLineHandler(onUartLine, (void*)(uintptr_t)port);
+        uartPorts[port].start();
+    }
 
     // ── SeaTalk ───────────────────────────────────────────────
     serialPrintf("\n[SeaTalk] Initializing RMT...\n");
@@ -227,6 +302,11 @@ void setup() {
     // ── TCP server ────────────────────────────────────────────
     serialPrintf("\n[TCP] Initializing...\n");
     tcpServer.init(TCP_PORT);
+    tcpServer.setInputHandler(onTcpLine);
+
+    // ── UDP output ────────────────────────────────────────────
+    serialPrintf("\n[UDP] Initializing...\n");
+    udpOutput.init(udpConfig);
 
     // ── BLE Manager ───────────────────────────────────────────
     serialPrintf("\n[BLE] Initializing...\n");
@@ -244,28 +324,21 @@ void setup() {
     }
 
     // ── Web server ────────────────────────────────────────────
+    registerMetrics();
+
     serialPrintf("\n[Web] Initializing...\n");
     webServer.init();
 
-    // ── NMEA queue ────────────────────────────────────────────
-    serialPrintf("\n[NMEA] Creating queue...\n");
-    nmeaQueue = xQueueCreate(NMEA_QUEUE_SIZE, sizeof(NMEASentence));
-    if (nmeaQueue == NULL) {
-        serialPrintf("[NMEA] ❌ Queue creation failed!\n");
-    } else {
-        serialPrintf("[NMEA] ✓ Queue created (size: %d)\n", NMEA_QUEUE_SIZE);
-    }
-
     // ── FreeRTOS tasks ────────────────────────────────────────
     serialPrintf("\n[Tasks] Creating dual-core FreeRTOS tasks...\n");
 
-    BaseType_t readerResult    = xTaskCreatePinnedToCore(uartReaderTask, "UART_Reader", 4096, NULL, 5, &uartReaderTaskHandle, 0);
+    BaseType_t mergeResult     = xTaskCreatePinnedToCore(mergeTask,      "NMEA_Merge",  TASK_STACK_NMEA, NULL, TASK_PRIORITY_NMEA, &mergeTaskHandle, 0);
     BaseType_t seatalkResult   = xTaskCreatePinnedToCore(seatalkTask,    "SeaTalk",     4096, NULL, 5, &seatalkTaskHandle,    0);
     BaseType_t processorResult = xTaskCreatePinnedToCore(processorTask,  "Processor",   8192, NULL, 3, &processorTaskHandle,  1);
     BaseType_t wifiResult      = xTaskCreatePinnedToCore(wifiTask,       "WiFi",        4096, NULL, 2, &wifiTaskHandle,       1);
 
-    if (readerResult    == pdPASS) serialPrintf("[Tasks] ✓ UART Reader task created (Core 0)\n");
-    else                           serialPrintf("[Tasks] ❌ UART Reader task failed\n");
+    if (mergeResult     == pdPASS) serialPrintf("[Tasks] ✓ NMEA merge task created (Core 0)\n");
+    else                           serialPrintf("[Tasks] ❌ NMEA merge task failed\n");
     if (seatalkResult   == pdPASS) serialPrintf("[Tasks] ✓ SeaTalk task created (Core 0)\n");
     else                           serialPrintf("[Tasks] ❌ SeaTalk task failed\n");
     if (processorResult == pdPASS) serialPrintf("[Tasks] ✓ Processor task created (Core 1)\n");
@@ -279,6 +352,7 @@ void setup() {
 
     serialPrintf("\n[TCP] Starting server...\n");
     tcpServer.start();
+    udpOutput.start();
 
     serialPrintf("\n[Web] Starting server...\n");
     webServer.start();
@@ -291,6 +365,7 @@ void setup() {
         serialPrintf("IP Address: %s\n",   WiFi.localIP().toString().c_str());
         serialPrintf("Web:  http://%s/\n", WiFi.localIP().toString().c_str());
         serialPrintf("TCP:  %s:%d\n",      WiFi.localIP().toString().c_str(), TCP_PORT);
+        if (udpOutput.isRunning()) serialPrintf("UDP:  %s:%u\n", udpConfig.mode == 0 ? "broadcast" : udpConfig.group, udpConfig.port);
     } else {
         serialPrintf("WiFi not connected — check configuration\n");
     }
@@ -312,13 +387,62 @@ void loop() {
     vTaskDelay(pdMS_TO_TICKS(100));
 }
 
-// ── CORE 0: UART Reader Task ──────────────────────────────────────────────────
+// ── CORE 0: UART sentences ────────────────────────────────────────────────────
 
-void uartReaderTask(void* parameter) {
-    char lineBuffer[NMEA_MAX_LENGTH];
-    NMEASentence sentence;
+/**
+ * Called by each UARTHandler on its RX task for every framed sentence.  The
+ * line points into the driver read block: copy it into a pool buffer (the
+ * only copy it will get), hand it to the merger and wake the merge task.
+ */
+void onUartLine(char* line, size_t len, void* ctx) {
+    uint8_t     port = (uint8_t)(uintptr_t)ctx;
+    SentenceRef ref  = sentencePool.acquire(line, len, port, micros());
+    if (ref == SENTENCE_NONE) {
+        pipelineStats.recordDrop(DROP_POOL_EXHAUSTED);
+        return;
+    }
+    pipelineStats.recordDepth(QUEUE_POOL, sentencePool.capacity() - sentencePool.available());
 
-    serialPrintf("[UART Reader] Started on Core 0\n");
+    if (!nmeaMerger.push(port, ref)) {
+        pipelineStats.recordDrop(DROP_MERGE_FULL);
+        return;
+    }
+    pipelineStats.recordDepth((PipelineQueue)(QUEUE_MERGE0 + port), nmeaMerger.pending(port));
+    if (mergeTaskHandle != NULL) xTaskNotifyGive(mergeTaskHandle);
+}
+
+// ── TCP client input ──────────────────────────────────────────────────────────
+
+/**
+ * Called on the AsyncTCP task for each line a TCP client sends (other than
+ * $PMAR,FILTER).  Same path as a UART line, as one more merge source: the
+ * merge task validates the checksum and parses it, the processor routes it.
+ */
+void onTcpLine(const char* line, size_t len, uint8_t client, void* ctx) {
+    SentenceRef ref = sentencePool.acquire(line, len, NMEA_SOURCE_TCP, micros());
+    if (ref == SENTENCE_NONE) {
+        pipelineStats.recordDrop(DROP_POOL_EXHAUSTED);
+        return;
+    }
+    sentencePool.at(ref).origin = client;
+    pipelineStats.recordDepth(QUEUE_POOL, sentencePool.capacity() - sentencePool.available());
+
+    if (!nmeaMerger.push(NMEA_SOURCE_TCP, ref)) {
+        pipelineStats.recordDrop(DROP_MERGE_FULL);
+        return;
+    }
+    pipelineStats.recordDepth((PipelineQueue)(QUEUE_MERGE0 + NMEA_SOURCE_TCP), nmeaMerger.pending(NMEA_SOURCE_TCP));
+    if (mergeTaskHandle != NULL) xTaskNotifyGive(mergeTaskHandle);
+}
+
+// ── CORE 0: Merge Task ────────────────────────────────────────────────────────
+
+/**
+ * Single consumer of all input ports: parses sentences in arrival order,
+ * so BoatState and the parser only ever see one writer.
+ */
+void mergeTask(void* parameter) {
+    serialPrintf("[Merge] Started on Core 0 (%u ports)\n", NMEA_PORT_COUNT);
 
     uint32_t lastStatsTime  = millis();
     uint32_t sentencesRead  = 0;
@@ -326,28 +450,51 @@ void uartReaderTask(void* parameter) {
     uint32_t queueFullCount = 0;
 
     while (true) {
-        if (uartHandler.readLine(lineBuffer, sizeof(lineBuffer), pdMS_TO_TICKS(100))) {
-            if (nmeaParser.parseLine(lineBuffer, sentence)) {
-                logManager.logNMEA(lineBuffer);
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(100));
+
+        SentenceRef ref;
+        while ((ref = nmeaMerger.front()) != SENTENCE_NONE) {
+            SentenceBuf& buf   = sentencePool.at(ref);
+            uint32_t     start = micros();
+            pipelineStats.recordLatency(STAGE_MERGE_WAIT, start - buf.arrivalUs);
+
+            bool valid = nmeaParser.parseLine(buf.raw);
+            buf.queuedUs = micros();
+            pipelineStats.recordLatency(STAGE_PARSE, buf.queuedUs - start);
+
+            if (valid) {
+                logManager.logNMEA(ref);
                 sentencesRead++;
                 g_messagesRead++;
 
-                if (nmeaQueue != NULL) {
-                    if (xQueueSend(nmeaQueue, &sentence, pdMS_TO_TICKS(5)) != pdTRUE) {
-                        queueFullCount++;
-                        g_nmeaQueueOverflows++;
-                        g_nmeaQueueFullEvents = queueFullCount;
-                    }
+                // The processor gets its own reference; the merger's goes with pop()
+                sentencePool.retain(ref);
+                if (nmeaQueue.push(ref)) {
+                    pipelineStats.recordDepth(QUEUE_NMEA, nmeaQueue.size());
+                    if (processorTaskHandle != NULL) xTaskNotifyGive(processorTaskHandle);
+                } else {
+                    sentencePool.release(ref);
+                    pipelineStats.recordDrop(DROP_NMEA_QUEUE_FULL);
+                    queueFullCount++;
+                    g_nmeaQueueOverflows++;
+                    g_nmeaQueueFullEvents = queueFullCount;
                 }
             } else {
+                pipelineStats.recordDrop(DROP_CHECKSUM);
                 parseErrors++;
             }
+            nmeaMerger.pop();
         }
 
 #ifdef DEBUG_CPU
         if (millis() - lastStatsTime > 30000) {
-            serialPrintf("[UART Reader] read=%u errors=%u queueFull=%u\n",
+            serialPrintf("[Merge] read=%u errors=%u queueFull=%u\n",
                          sentencesRead, parseErrors, queueFullCount);
+            for (uint8_t port = 0; port < NMEA_PORT_COUNT; port++) {
+                serialPrintf("[Merge]   UART%u: merged=%u dropped=%u overflows=%u\n", port,
+                             nmeaMerger.merged(port), nmeaMerger.dropped(port),
+                             uartPorts[port].getOverflows());
+            }
             lastStatsTime  = millis();
             sentencesRead  = 0;
             parseErrors    = 0;
@@ -371,24 +518,70 @@ void seatalkTask(void* parameter) {
 // ── CORE 1: Processor Task ────────────────────────────────────────────────────
 
 void processorTask(void* parameter) {
-    NMEASentence sentence;
     serialPrintf("[Processor] Started on Core 1\n");
 
     uint32_t lastStatsTime     = millis();
     uint32_t lastLedTime       = millis();
+    uint32_t lastSweepTime     = millis();
     bool     setLedOff         = true;
     uint32_t messagesProcessed = 0;
 
     while (true) {
-        if (xQueueReceive(nmeaQueue, &sentence, pdMS_TO_TICKS(100)) == pdTRUE) {
+        // Also wakes so partial TCP batches, the UDP datagram and WebSocket frames go out on time
+        uint32_t flushMs = min((uint32_t)TCP_COALESCE_MS, udpOutput.msUntilFlush());
+        flushMs = min(flushMs, webServer.msUntilFlushNMEA());
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(flushMs));
+
+        // Outputs that can take a sentence right now, for the router
+        uint8_t available = ROUTE_WS;
+        if (tcpServer.getClientCount() > 0) available |= ROUTE_TCP;
+        if (udpOutput.isRunning())          available |= ROUTE_UDP;
+        for (uint8_t port = 0; port < NMEA_PORT_COUNT; port++) {
+            if (uartPorts[port].isRunning()) available |= ROUTE_UART_TX(port);
+        }
+
+        SentenceRef ref;
+        while (nmeaQueue.pop(ref)) {
             messagesProcessed++;
             g_messagesProcessed++;
 
-            if (tcpServer.getClientCount() > 0) {
-                tcpServer.broadcast(sentence.raw);
+            const SentenceBuf& buf = sentencePool.at(ref);
+            uint32_t t0 = micros();
+            pipelineStats.recordLatency(STAGE_QUEUE_WAIT, t0 - buf.queuedUs);
+
+            uint8_t outputs = nmeaRouter.route(buf.raw, buf.len, buf.source, buf.origin, available, millis());
+
+            if (outputs & ROUTE_TCP) {
+                tcpServer.broadcast(buf.raw, buf.len, buf.origin);
             }
-            webServer.broadcastNMEA(sentence.raw);
+            uint32_t t1 = micros();
+            if (outputs & ROUTE_WS) webServer.broadcastNMEA(buf.raw, buf.len);
+            uint32_t t2 = micros();
+            if (outputs & ROUTE_UDP) udpOutput.broadcast(buf.raw, buf.len);
+            uint32_t t3 = micros();
+            for (uint8_t port = 0; port < NMEA_PORT_COUNT; port++) {
+                if (outputs & ROUTE_UART_TX(port)) uartPorts[port].send(buf.raw, buf.len);
+            }
+            uint32_t t4 = micros();
+
+            pipelineStats.recordLatency(STAGE_FANOUT_TCP,  t1 - t0);
+            pipelineStats.recordLatency(STAGE_FANOUT_WS,   t2 - t1);
+            pipelineStats.recordLatency(STAGE_FANOUT_UDP,  t3 - t2);
+            pipelineStats.recordLatency(STAGE_FANOUT_UART, t4 - t3);
+            pipelineStats.recordLatency(STAGE_END_TO_END,  t4 - buf.arrivalUs);
+            sentencePool.release(ref);
+        }
+        tcpServer.flush();
+        udpOutput.flush();
+        webServer.flushNMEA();
+
+        // Values that timed out change what the outputs show: bump their
+        // sections before /ws/state and the parked long-polls look
+        if (millis() - lastSweepTime >= BOATSTATE_SWEEP_MS) {
+            boatState.cleanupStaleData();
+            lastSweepTime = millis();
         }
+        webServer.pollState();
 
 #ifdef DEBUG_CPU
         if (millis() - lastStatsTime > 30000) {
@@ -396,7 +589,17 @@ void processorTask(void* parameter) {
             serialPrintf("[Processor]   processed     : %u\n", messagesProcessed);
             serialPrintf("[Processor]   valid total   : %u\n", nmeaParser.getValidSentences());
             serialPrintf("[Processor]   invalid total : %u\n", nmeaParser.getInvalidSentences());
+            serialPrintf("[Processor]   AIS fragments : %u dropped, %u expired of %u\n",
+                         nmeaParser.getAISReassembly().dropped(),
+                         nmeaParser.getAISReassembly().expired(),
+                         nmeaParser.getAISReassembly().fragments());
             serialPrintf("[Processor]   queue overflow: %u\n", (uint32_t)g_nmeaQueueOverflows);
+            const LatencyHistogram& e2e = pipelineStats.stage(STAGE_END_TO_END);
+            serialPrintf("[Processor]   end-to-end    : p50 %u µs, p99 %u µs, max %u µs\n",
+                         e2e.percentile(500), e2e.percentile(990), e2e.max());
+            serialPrintf("[Processor]   pool          : %u/%u free (low %u), %u exhausted\n",
+                         sentencePool.available(), sentencePool.capacity(),
+                         sentencePool.lowWater(), sentencePool.exhausted());
             serialPrintf("[Processor]   free heap     : %u B\n", ESP.getFreeHeap());
             lastStatsTime     = millis();
             messagesProcessed = 0;
@@ -0,0 +1,188 @@
+#include "metrics.h"
+#include "pipeline_stats.h"
+#include <stdio.h>
+#include <string.h>
+
+// Histogram exposition: le = 2^k - 1 for k in [FIRST, LAST], then +Inf
+#define METRICS_HIST_FIRST_SHIFT  4     // le="15"
+#define METRICS_HIST_LAST_SHIFT   20    // le="1048575" (~1 s)
+#define METRICS_HIST_BOUNDS       (METRICS_HIST_LAST_SHIFT - METRICS_HIST_FIRST_SHIFT + 1)
+
+namespace {
+
+int64_t readU32(const void* ctx) {
+    return *static_cast<const volatile uint32_t*>(ctx);
+}
+
+/** Count of values ≤ @p bound; exact when bound + 1 is a bucket edge. */
+uint32_t cumulativeBelow(const LatencyHistogram& h, uint32_t bound) {
+    uint32_t n = 0;
+    for (uint16_t b = 0; b < LATENCY_BUCKETS; b++) {
+        if (LatencyHistogram::bucketUpper(b) > bound) break;
+        n += h.bucketCount(b);
+    }
+    return n;
+}
+
+const char* typeName(MetricType t) {
+    switch (t) {
+        case METRIC_COUNTER:   return "counter";
+        case METRIC_GAUGE:     return "gauge";
+        case METRIC_HISTOGRAM: return "histogram";
+        default:               return "unknown";
+    }
+}
+
+} // namespace
+
+const char* metricsPortLabel(uint8_t port) {
+    static const char* const kLabels[] = {
+        "port=\"0\"", "port=\"1\"", "port=\"2\"", "port=\"tcp\"",
+    };
+    static_assert(NMEA_SOURCE_TCP == 3, "kLabels ends with the TCP input source");
+    return port < sizeof(kLabels) / sizeof(kLabels[0]) ? kLabels[port] : nullptr;
+}
+
+MetricsRegistry::MetricsRegistry() : count(0) {
+}
+
+// ============================================================
+// Registration
+// ============================================================
+
+bool MetricsRegistry::add(const char* name, const char* help, MetricType type, MetricReadFn fn,
+                          const void* ctx, const char* labels) {
+    if (count >= METRICS_MAX || !name || !ctx) return false;
+
+    // Keep each family contiguous: insert after its last sample so far
+    uint16_t at = count;
+    for (uint16_t i = count; i > 0; i--) {
+        if (strcmp(metrics[i - 1].name, name) == 0) {
+            at = i;
+            break;
+        }
+    }
+    for (uint16_t i = count; i > at; i--) metrics[i] = metrics[i - 1];
+    count++;
+
+    Metric& m = metrics[at];
+    m.name   = name;
+    m.help   = help ? help : "";
+    m.labels = (labels && *labels) ? labels : nullptr;
+    m.type   = type;
+    m.fn     = fn;
+    m.ctx    = ctx;
+    return true;
+}
+
+bool MetricsRegistry::addCounter(const char* name, const char* help, MetricReadFn fn,
+                                 const void* ctx, const char* labels) {
+    return fn && add(name, help, METRIC_COUNTER, fn, ctx, labels);
+}
+
+bool MetricsRegistry::addGauge(const char* name, const char* help, MetricReadFn fn,
+                               const void* ctx, const char* labels) {
+    return fn && add(name, help, METRIC_GAUGE, fn, ctx, labels);
+}
+
+bool MetricsRegistry::addCounter(const char* name, const char* help, const volatile uint32_t* value,
+                                 const char* labels) {
+    return add(name, help, METRIC_COUNTER, readU32, (const void*)value, labels);
+}
+
+bool MetricsRegistry::addGauge(const char* name, const char* help, const volatile uint32_t* value,
+                               const char* labels) {
+    return add(name, help, METRIC_GAUGE, readU32, (const void*)value, labels);
+}
+
+bool MetricsRegistry::addHistogram(const char* name, const char* help, const LatencyHistogram* hist,
+                                   const char* labels) {
+    return add(name, help, METRIC_HISTOGRAM, nullptr, hist, labels);
+}
+
+// ============================================================
+// Exposition
+// ============================================================
+
+int MetricsRegistry::formatSample(const Metric& m, const char* suffix, const char* extraLabel,
+                                  int64_t value, char* out, size_t outLen) const {
+    const char* sep = (m.labels && extraLabel) ? "," : "";
+    if (m.labels || extraLabel) {
+        return snprintf(out, outLen, "%s%s{%s%s%s} %lld\n", m.name, suffix,
+                        m.labels ? m.labels : "", sep, extraLabel ? extraLabel : "",
+                        (long long)value);
+    }
+    return snprintf(out, outLen, "%s%s %lld\n", m.name, suffix, (long long)value);
+}
+
+int MetricsRegistry::formatLine(uint16_t index, uint16_t line, char* out, size_t outLen) const {
+    const Metric& m = metrics[index];
+
+    // Family header only on the first sample of a run of equal names
+    bool     first  = index == 0 || strcmp(metrics[index - 1].name, m.name) != 0;
+    uint16_t header = first ? 2 : 0;
+    if (line < header) {
+        if (line == 0) return snprintf(out, outLen, "# TYPE %s %s\n", m.name, typeName(m.type));
+        return snprintf(out, outLen, "# HELP %s %s\n", m.name, m.help);
+    }
+    uint16_t sample = line - header;
+
+    if (m.type != METRIC_HISTOGRAM) {
+        if (sample > 0) return -1;
+        return formatSample(m, m.type == METRIC_COUNTER ? "_total" : "", nullptr,
+                            m.fn(m.ctx), out, outLen);
+    }
+
+    const LatencyHistogram& h = *static_cast<const LatencyHistogram*>(m.ctx);
+    char le[24];
+    if (sample < METRICS_HIST_BOUNDS) {
+        uint32_t bound = (1u << (METRICS_HIST_FIRST_SHIFT + sample)) - 1;
+        snprintf(le, sizeof(le), "le=\"%u\"", bound);
+        return formatSample(m, "_bucket", le, cumulativeBelow(h, bound), out, outLen);
+    }
+    switch (sample - METRICS_HIST_BOUNDS) {
+        case 0:  return formatSample(m, "_bucket", "le=\"+Inf\"", h.count(), out, outLen);
+        case 1:  return formatSample(m, "_count", nullptr, h.count(), out, outLen);
+        case 2:  return formatSample(m, "_sum", nullptr, (int64_t)h.sum(), out, outLen);
+        default: return -1;
+    }
+}
+
+size_t MetricsRegistry::render(MetricsCursor& cursor, char* buf, size_t maxLen) const {
+    if (cursor.done) return 0;
+
+    char   line[METRICS_LINE_MAX];
+    size_t used = 0;
+
+    while (cursor.metric < count) {
+        int n = formatLine(cursor.metric, cursor.line, line, sizeof(line));
+        if (n < 0) {
+            cursor.metric++;
+            cursor.line = 0;
+            continue;
+        }
+        if (n >= (int)sizeof(line)) {
+            cursor.line++;        // Truncated: skip rather than emit a broken line
+            continue;
+        }
+        if (used + (size_t)n > maxLen) {
+            if (used > 0) return used;   // Resume here next chunk
+            cursor.line++;               // Can never fit: skip it rather than stall
+            continue;
+        }
+        memcpy(buf + used, line, n);
+        used += n;
+        cursor.line++;
+    }
+
+    static const char kEOF[] = "# EOF\n";
+    if (used + sizeof(kEOF) - 1 > maxLen && used > 0) return used;
+    if (sizeof(kEOF) - 1 > maxLen) {
+        cursor.done = true;
+        return 0;
+    }
+    memcpy(buf + used, kEOF, sizeof(kEOF) - 1);
+    used += sizeof(kEOF) - 1;
+    cursor.done = true;
+    return used;
+}
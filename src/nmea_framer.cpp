@@ -0,0 +1,96 @@
+#include "nmea_framer.h"
+#include <string.h>
+
+NMEALineFramer::NMEALineFramer(NMEALineHandler h, void* c)
+    : handler(h), ctx(c), carryLen(0), inSentence(false), discarding(false), dirty(false),
+      lineCount(0), overlongCount(0), noiseCount(0) {
+}
+
+void NMEALineFramer::setHandler(NMEALineHandler h, void* c) {
+    handler = h;
+    ctx     = c;
+}
+
+void NMEALineFramer::reset() {
+    carryLen   = 0;
+    inSentence = false;
+    discarding = false;
+    dirty      = false;
+}
+
+void NMEALineFramer::emit(char* line, size_t len) {
+    // len counts everything up to the LF: strip the CR of a CRLF ending
+    if (len > 0 && line[len - 1] == '\r') len--;
+    if (len > NMEA_MAX_LENGTH - 1) {
+        overlongCount++;
+        return;
+    }
+    line[len] = '\0';
+    lineCount++;
+    if (handler) handler(line, len, ctx);
+}
+
+// ============================================================
+// feed
+// ============================================================
+
+void NMEALineFramer::feed(char* data, size_t len) {
+    char* const end = data + len;
+    // Start of the current sentence inside this block; nullptr while the
+    // sentence began in an earlier block and lives in carry[]
+    char* start = nullptr;
+
+    for (char* p = data; p < end; p++) {
+        char c = *p;
+
+        if (c == '$' || c == '!') {
+            // (Re)synchronise: a partial sentence before this is lost
+            start      = p;
+            carryLen   = 0;
+            inSentence = true;
+            discarding = false;
+            dirty      = false;
+            continue;
+        }
+        if (c != '\n') {
+            if (!inSentence && c != '\r') dirty = true;
+            continue;
+        }
+
+        // ── End of line ──────────────────────────────────────────────────────
+        if (inSentence) {
+            if (start) {
+                emit(start, (size_t)(p - start));           // in place, no copy
+            } else {
+                size_t n = (size_t)(p - data);
+                if (discarding || carryLen + n > sizeof(carry) - 1) {
+                    overlongCount++;
+                } else {
+                    memcpy(carry + carryLen, data, n);
+                    emit(carry, carryLen + n);
+                }
+            }
+        } else if (dirty) {
+            noiseCount++;
+        }
+        start      = nullptr;
+        carryLen   = 0;
+        inSentence = false;
+        discarding = false;
+        dirty      = false;
+    }
+
+    // ── Keep a trailing partial sentence for the next block ──────────────────
+    if (!inSentence || discarding) return;
+
+    char*  from = start ? start : data;
+    size_t n    = (size_t)(end - from);
+    if (carryLen + n > sizeof(carry) - 1) {
+        // Cannot be a valid sentence any more: wait for its LF, count it then
+        discarding = true;
+        carryLen   = 0;
+        return;
+    }
+    memcpy(carry + carryLen, from, n);
+    carryLen += n;
+}
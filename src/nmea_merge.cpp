@@ -0,0 +1,93 @@
+#include "nmea_merge.h"
+#include "metrics.h"
+
+#define MERGE_MASK  (NMEA_MERGE_DEPTH - 1)
+
+static_assert((NMEA_MERGE_DEPTH & MERGE_MASK) == 0, "NMEA_MERGE_DEPTH must be a power of two");
+
+NMEAMerger::NMEAMerger(SentencePool& p) : pool(p), current(-1), rrNext(0) {
+    for (int i = 0; i < NMEA_SOURCE_MAX; i++) {
+        rings[i].head.store(0, std::memory_order_relaxed);
+        rings[i].tail.store(0, std::memory_order_relaxed);
+        rings[i].merged  = 0;
+        rings[i].dropped = 0;
+    }
+}
+
+uint8_t NMEAMerger::pending(uint8_t source) const {
+    if (source >= NMEA_SOURCE_MAX) return 0;
+    const Ring& r = rings[source];
+    return (uint8_t)(r.head.load(std::memory_order_acquire) - r.tail.load(std::memory_order_acquire));
+}
+
+// ============================================================
+// Producer
+// ============================================================
+
+bool NMEAMerger::push(uint8_t source, SentenceRef ref) {
+    if (ref == SENTENCE_NONE) return false;
+    if (source >= NMEA_SOURCE_MAX) {
+        pool.release(ref);
+        return false;
+    }
+    Ring& r = rings[source];
+
+    uint32_t head = r.head.load(std::memory_order_relaxed);
+    if (head - r.tail.load(std::memory_order_acquire) >= NMEA_MERGE_DEPTH) {
+        r.dropped++;
+        pool.release(ref);
+        return false;
+    }
+
+    r.slot[head & MERGE_MASK] = ref;
+    r.head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+// ============================================================
+// Consumer
+// ============================================================
+
+SentenceRef NMEAMerger::front() {
+    SentenceRef best        = SENTENCE_NONE;
+    uint32_t    bestArrival = 0;
+    current = -1;
+
+    // Start the scan at the round-robin position so that equal arrival
+    // times alternate between sources instead of favouring port 0
+    for (uint8_t k = 0; k < NMEA_SOURCE_MAX; k++) {
+        uint8_t src = (uint8_t)((rrNext + k) % NMEA_SOURCE_MAX);
+        Ring&   r   = rings[src];
+        uint32_t tail = r.tail.load(std::memory_order_relaxed);
+        if (r.head.load(std::memory_order_acquire) == tail) continue;
+
+        SentenceRef cand    = r.slot[tail & MERGE_MASK];
+        uint32_t    arrival = pool.at(cand).arrivalUs;
+        // Wrap-safe: micros() rolls over every ~71 minutes
+        if (best == SENTENCE_NONE || (int32_t)(arrival - bestArrival) < 0) {
+            best        = cand;
+            bestArrival = arrival;
+            current     = (int8_t)src;
+        }
+    }
+    return best;
+}
+
+void NMEAMerger::pop() {
+    if (current < 0) return;
+    Ring& r = rings[current];
+    pool.release(r.slot[r.tail.load(std::memory_order_relaxed) & MERGE_MASK]);
+    r.merged++;
+    r.tail.store(r.tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    rrNext  = (uint8_t)((current + 1) % NMEA_SOURCE_MAX);
+    current = -1;
+}
+
+void NMEAMerger::registerMetrics(MetricsRegistry& reg, uint8_t ports) const {
+    for (uint8_t p = 0; p < NMEA_SOURCE_MAX; p++) {
+        if (p >= ports && p != NMEA_SOURCE_TCP) continue;
+        const char* label = metricsPortLabel(p);
+        reg.addCounter("espnav_merge_sentences", "Sentences merged per input port", &rings[p].merged, label);
+        reg.addCounter("espnav_merge_dropped", "Sentences dropped on a full merge ring", &rings[p].dropped, label);
+    }
+}
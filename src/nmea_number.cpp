@@ -0,0 +1,166 @@
+/**
+ * @file nmea_number.cpp
+ * @brief Allocation-free, locale-free numeric field parsing for NMEA 0183.
+ *
+ * Conversion to float follows the exact fast path: a mantissa that fits
+ * the significand, divided or multiplied by an exactly representable power
+ * of ten, rounds once.  Float is used when the mantissa fits 24 bits (the
+ * S3 has a single-precision FPU); anything wider goes through double.
+ */
+
+#include "nmea_number.h"
+
+// 10^0 … 10^10 are exact in float (5^10 < 2^24)
+static const float kPow10f[] = {
+    1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+
+// 10^0 … 10^22 are exact in double
+static const double kPow10d[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+#define NMEA_MAX_DIGITS  9   // 999 999 999 < 2^31
+
+// ============================================================
+// NMEADecimal
+// ============================================================
+
+double NMEADecimal::toDouble() const {
+    if (exponent < 0)  return (double)mantissa / kPow10d[-exponent];
+    return (double)mantissa * kPow10d[exponent];
+}
+
+float NMEADecimal::toFloat() const {
+    int32_t m = mantissa < 0 ? -mantissa : mantissa;
+    if (m < (1 << 24)) {
+        if (exponent < 0 && -exponent <= 10) return (float)mantissa / kPow10f[-exponent];
+        if (exponent >= 0 && exponent <= 10) return (float)mantissa * kPow10f[exponent];
+    }
+    return (float)toDouble();
+}
+
+// ============================================================
+// Parsers
+// ============================================================
+
+bool nmeaParseDecimal(const char* s, size_t len, NMEADecimal& out) {
+    size_t i = 0;
+    bool negative = false;
+    if (i < len && (s[i] == '-' || s[i] == '+')) {
+        negative = s[i] == '-';
+        i++;
+    }
+
+    uint32_t mantissa = 0;
+    int      digits   = 0;      // significant digits kept
+    int      exponent = 0;
+    bool     seenDigit = false;
+    bool     seenPoint = false;
+
+    for (; i < len; i++) {
+        char c = s[i];
+        if (c == '.') {
+            if (seenPoint) return false;
+            seenPoint = true;
+            continue;
+        }
+        if (c < '0' || c > '9') return false;
+        seenDigit = true;
+
+        if (digits < NMEA_MAX_DIGITS) {
+            if (mantissa != 0 || c != '0') digits++;   // leading zeros are free
+            mantissa = mantissa * 10 + (uint32_t)(c - '0');
+            if (seenPoint) exponent--;
+        } else if (!seenPoint) {
+            exponent++;                                // drop low integer digit
+        }
+    }
+    if (!seenDigit) return false;
+    if (exponent < -22 || exponent > 22) return false;  // outside exact pow10 tables
+
+    out.mantissa = negative ? -(int32_t)mantissa : (int32_t)mantissa;
+    out.exponent = (int8_t)exponent;
+    return true;
+}
+
+bool nmeaParseFloat(const char* s, size_t len, float& out) {
+    NMEADecimal d;
+    if (!nmeaParseDecimal(s, len, d)) return false;
+    out = d.toFloat();
+    return true;
+}
+
+bool nmeaParseInt(const char* s, size_t len, int32_t& out) {
+    size_t i = 0;
+    bool negative = false;
+    if (i < len && (s[i] == '-' || s[i] == '+')) {
+        negative = s[i] == '-';
+        i++;
+    }
+    if (i == len || len - i > NMEA_MAX_DIGITS) return false;
+
+    int32_t v = 0;
+    for (; i < len; i++) {
+        char c = s[i];
+        if (c < '0' || c > '9') return false;
+        v = v * 10 + (c - '0');
+    }
+    out = negative ? -v : v;
+    return true;
+}
+
+static inline int hexNibble(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+bool nmeaParseHexByte(const char* s, uint8_t& out) {
+    int hi = hexNibble(s[0]);
+    if (hi < 0) return false;
+    int lo = hexNibble(s[1]);
+    if (lo < 0) return false;
+    out = (uint8_t)((hi << 4) | lo);
+    return true;
+}
+
+bool nmeaParseCoordE7(const char* s, size_t len, char hemi, int32_t& outE7) {
+    // Locate the decimal point; degrees are everything left of the two
+    // minute digits that precede it.
+    size_t point = 0;
+    while (point < len && s[point] != '.') point++;
+    if (point < 3 || point > 5) return false;          // d?dmm at minimum
+
+    int32_t degrees = 0;
+    for (size_t i = 0; i < point - 2; i++) {
+        char c = s[i];
+        if (c < '0' || c > '9') return false;
+        degrees = degrees * 10 + (c - '0');
+    }
+
+    // Whole minutes followed by up to 6 fraction digits → micro-minutes
+    char m1 = s[point - 2], m2 = s[point - 1];
+    if (m1 < '0' || m1 > '5' || m2 < '0' || m2 > '9') return false;
+    int32_t microMin = ((m1 - '0') * 10 + (m2 - '0')) * 1000000;
+
+    int32_t scale = 100000;
+    for (size_t i = point + 1; i < len; i++) {
+        char c = s[i];
+        if (c < '0' || c > '9') return false;
+        if (scale > 0) {
+            microMin += (c - '0') * scale;
+            scale /= 10;
+        }
+    }
+
+    // 1e-7° = 6e-6 min, so E7 = µmin / 6 (rounded half up)
+    int32_t e7 = degrees * 10000000 + (microMin + 3) / 6;
+    int32_t limit = (point - 2 == 2) ? 900000000 : 1800000000;
+    if (e7 > limit) return false;
+
+    outE7 = (hemi == 'S' || hemi == 'W') ? -e7 : e7;
+    return true;
+}
@@ -3,18 +3,106 @@
  * @brief NMEA 0183 sentence parser and AIS decoder
  *
  * Parses standard NMEA 0183 sentences and AIS VDM/VDO messages.
- * AIS decoding covers:
- *   - Type 1/2/3 : Position Report Class A
- *   - Type 5     : Static and Voyage Related Data (2-sentence reassembly)
- *   - Type 18    : Standard Class B Position Report
- *   - Type 24    : Static Data Report (Class B name)
+ * AIS payloads are reassembled by ais_reassembly.cpp and decoded by ais_decoder.cpp
+ * (types 1-5, 9, 11, 14, 18, 19, 21, 24 A/B and 27).
  */
 
 #include "nmea_parser.h"
 #include "functions.h"
+#include "metrics.h"
 #include <stdlib.h>
 
-NMEAParser::NMEAParser(BoatState* bs) : validSentences(0), invalidSentences(0), boatState(bs) {}
+// ============================================================
+// Sentence dispatch table
+// ============================================================
+
+namespace {
+struct BuiltinRoute {
+    uint32_t key;
+    void (NMEAParser::*handler)(const NMEAFields& f);
+};
+}
+
+NMEAParser::NMEAParser(BoatState* bs)
+    : validSentences(0), invalidSentences(0), boatState(bs),
+      aisHandler(nullptr), aisHandlerCtx(nullptr) {
+    memset(dispatchTable, 0, sizeof(dispatchTable));
+    memset(aisDecoded, 0, sizeof(aisDecoded));
+
+    static const BuiltinRoute routes[] = {
+        { nmeaFormatterKey('G','G','A'), &NMEAParser::parseGGA },
+        { nmeaFormatterKey('R','M','C'), &NMEAParser::parseRMC },
+        { nmeaFormatterKey('Z','D','A'), &NMEAParser::parseZDA },
+        { nmeaFormatterKey('G','L','L'), &NMEAParser::parseGLL },
+        { nmeaFormatterKey('V','T','G'), &NMEAParser::parseVTG },
+        { nmeaFormatterKey('H','D','T'), &NMEAParser::parseHDT },
+        { nmeaFormatterKey('H','D','M'), &NMEAParser::parseHDM },
+        { nmeaFormatterKey('D','P','T'), &NMEAParser::parseDPT },
+        { nmeaFormatterKey('D','B','T'), &NMEAParser::parseDBT },
+        { nmeaFormatterKey('M','W','V'), &NMEAParser::parseMWV },
+        { nmeaFormatterKey('M','W','D'), &NMEAParser::parseMWD },
+        { nmeaFormatterKey('M','T','W'), &NMEAParser::parseMTW },
+        { nmeaFormatterKey('V','H','W'), &NMEAParser::parseVHW },
+        { nmeaFormatterKey('V','L','W'), &NMEAParser::parseVLW },
+        { nmeaFormatterKey('V','D','M'), &NMEAParser::parseAIVDM },
+        { nmeaFormatterKey('V','D','O'), &NMEAParser::parseAIVDM },
+    };
+    static_assert(sizeof(routes) / sizeof(routes[0]) < NMEA_DISPATCH_SLOTS,
+                  "built-in routes must leave dispatch slots free");
+    for (size_t i = 0; i < sizeof(routes) / sizeof(routes[0]); i++) {
+        DispatchEntry* e = dispatchSlot(routes[i].key);
+        e->key     = routes[i].key;
+        e->builtin = routes[i].handler;
+    }
+}
+
+/**
+ * Find the slot holding key, or the free slot where it would be inserted.
+ * Returns nullptr only when the key is absent and the table is full.
+ */
+NMEAParser::DispatchEntry* NMEAParser::dispatchSlot(uint32_t key) {
+    uint32_t idx = (key * 2654435761u) >> (32 - NMEA_DISPATCH_BITS);  // Fibonacci hash → slot
+    for (int probe = 0; probe < NMEA_DISPATCH_SLOTS; probe++) {
+        DispatchEntry* e = &dispatchTable[(idx + probe) & (NMEA_DISPATCH_SLOTS - 1)];
+        if (e->key == key || e->key == 0) return e;
+    }
+    return nullptr;
+}
+
+bool NMEAParser::registerHandler(const char* formatter, NMEASentenceHandler handler, void* ctx) {
+    if (!formatter || !handler || strlen(formatter) != 3) return false;
+
+    uint32_t key = nmeaFormatterKey(formatter[0], formatter[1], formatter[2]);
+    DispatchEntry* e = dispatchSlot(key);
+    if (!e) {
+        serialPrintf("[NMEA] ❌ Dispatch table full, cannot register %s\n", formatter);
+        return false;
+    }
+    e->key     = key;
+    e->builtin = nullptr;
+    e->custom  = handler;
+    e->ctx     = ctx;
+    return true;
+}
+
+void NMEAParser::dispatch(const NMEAFields& f) {
+    // Standard address = 2-char talker + 3-char formatter.  Proprietary
+    // sentences ($P...) carry a manufacturer code instead and are skipped.
+    const NMEAField& addr = f[0];
+    if (addr.len != 5 || addr.ptr[0] == 'P') return;
+
+    uint32_t key = nmeaFormatterKey(addr.ptr[2], addr.ptr[3], addr.ptr[4]);
+    DispatchEntry* e = dispatchSlot(key);
+    if (!e || e->key == 0) return;
+
+    if (e->builtin) (this->*(e->builtin))(f);
+    else            e->custom(f, boatState, e->ctx);
+}
+
+// ============================================================
+// parseLine
+// ============================================================
+
 
 bool NMEAParser::parseLine(const char* line, NMEASentence& out) {
     // Accept '$' (NMEA standard) and '!' (AIS)
@@ -30,35 +118,31 @@ bool NMEAParser::parseLine(const char* line, NMEASentence& out) {
     // Extract sentence type
     extractSentenceType(line, out.type, sizeof(out.type));
 
-    // Validate checksum
-    out.valid = validateChecksum(line);
     out.timestamp = millis();
+    out.valid     = parseLine(line);
+    return out.valid;
+}
 
-    if (out.valid) {
-        validSentences++;
-
-        if (boatState != nullptr) {
-            if      (strstr(out.type, "GGA"))                          parseGGA(line);
-            else if (strstr(out.type, "RMC"))                          parseRMC(line);
-            else if (strcmp(out.type, "GNZDA") == 0)                   parseZDA(line);
-            else if (strstr(out.type, "GLL"))                          parseGLL(line);
-            else if (strstr(out.type, "VTG"))                          parseVTG(line);
-            else if (strstr(out.type, "HDT"))                          parseHDT(line);
-            else if (strstr(out.type, "HDM"))                          parseHDM(line);
-            else if (strstr(out.type, "DPT"))                          parseDPT(line);
-            else if (strstr(out.type, "DBT"))                          parseDBT(line);
-            else if (strstr(out.type, "MWV"))                          parseMWV(line);
-            else if (strstr(out.type, "MWD"))                          parseMWD(line);
-            else if (strstr(out.type, "MTW"))                          parseMTW(line);
-            else if (strstr(out.type, "VHW"))                          parseVHW(line);
-            else if (strstr(out.type, "VLW"))                          parseVLW(line);
-            else if (strstr(out.type, "AIVDM") || strstr(out.type, "AIVDO")) parseAIVDM(line);
-        }
-    } else {
+bool NMEAParser::parseLine(const char* line) {
+    // Accept '$' (NMEA standard) and '!' (AIS)
+    if (!line || (line[0] != '$' && line[0] != '!')) {
         invalidSentences++;
+        return false;
     }
 
-    return out.valid;
+    if (!validateChecksum(line)) {
+        invalidSentences++;
+        return false;
+    }
+
+    validSentences++;
+    if (boatState != nullptr) {
+        // Split once; every handler reads the same field views
+        NMEAFields f;
+        tokenize(line, f);
+        dispatch(f);
+    }
+    return true;
 }
 
 bool NMEAParser::validateChecksum(const char* line) {
@@ -68,7 +152,7 @@ bool NMEAParser::validateChecksum(const char* line) {
     uint8_t calculated = calculateChecksum(line + 1, asterisk - line - 1);
 
     uint8_t provided = 0;
-    if (sscanf(asterisk + 1, "%02hhx", &provided) != 1) return false;
+    if (!nmeaParseHexByte(asterisk + 1, provided)) return false;
 
     return calculated == provided;
 }
@@ -92,200 +176,143 @@ void NMEAParser::extractSentenceType(const char* line, char* type, size_t maxLen
 // Utility Functions
 // ============================================================
 
-int NMEAParser::parseField(const char* line, int fieldIndex, char* buffer, size_t bufferSize) {
-    const char* ptr = line;
-    int currentField = 0;
-
-    while (*ptr && currentField < fieldIndex) {
-        if (*ptr == ',') currentField++;
-        ptr++;
-    }
-
-    if (currentField != fieldIndex) {
-        buffer[0] = '\0';
-        return 0;
-    }
-
-    size_t i = 0;
-    while (*ptr && *ptr != ',' && *ptr != '*' && i < bufferSize - 1) {
-        buffer[i++] = *ptr++;
+uint8_t NMEAParser::tokenize(const char* line, NMEAFields& out) {
+    out.count = 0;
+    if (!line || !*line) return 0;
+
+    const char* p     = line + 1;  // Skip '$' or '!'
+    const char* start = p;
+    for (;;) {
+        char c = *p;
+        if (c == ',' || c == '*' || c == '\0' || c == '\r' || c == '\n') {
+            if (out.count < NMEA_MAX_FIELDS) {
+                size_t len = p - start;
+                out.field[out.count].ptr = start;
+                out.field[out.count].len = (uint8_t)(len > 255 ? 255 : len);
+                out.count++;
+            }
+            if (c != ',') break;
+            start = p + 1;
+        }
+        p++;
     }
-    buffer[i] = '\0';
-    return i;
-}
-
-float NMEAParser::parseLatitude(const char* lat, const char* ns) {
-    if (!lat || !ns || strlen(lat) < 4) return 0.0;
-    char degrees[3] = {lat[0], lat[1], 0};
-    float result = atof(degrees) + atof(lat + 2) / 60.0;
-    if (ns[0] == 'S') result = -result;
-    return result;
+    return out.count;
 }
 
-float NMEAParser::parseLongitude(const char* lon, const char* ew) {
-    if (!lon || !ew || strlen(lon) < 5) return 0.0;
-    char degrees[4] = {lon[0], lon[1], lon[2], 0};
-    float result = atof(degrees) + atof(lon + 3) / 60.0;
-    if (ew[0] == 'W') result = -result;
-    return result;
+float NMEAParser::fieldFloat(const NMEAField& f) {
+    float v = 0.0f;
+    nmeaParseFloat(f.ptr, f.len, v);
+    return v;
 }
 
-float NMEAParser::parseKnots(const char* speed) {
-    if (!speed || strlen(speed) == 0) return 0.0;
-    return atof(speed);
+int32_t NMEAParser::fieldInt(const NMEAField& f) {
+    int32_t v = 0;
+    nmeaParseInt(f.ptr, f.len, v);
+    return v;
 }
 
-float NMEAParser::parseDegrees(const char* degrees) {
-    if (!degrees || strlen(degrees) == 0) return 0.0;
-    return atof(degrees);
+/** Position goes to BoatState in exact 1e-7° units, not via float. */
+void NMEAParser::updatePosition(BoatState::Writer& w,
+                                const NMEAField& lat, const NMEAField& ns,
+                                const NMEAField& lon, const NMEAField& ew) {
+    int32_t latE7, lonE7;
+    if (!nmeaParseCoordE7(lat.ptr, lat.len, ns.first(), latE7)) return;
+    if (!nmeaParseCoordE7(lon.ptr, lon.len, ew.first(), lonE7)) return;
+    if (latE7 > 900000000 || latE7 < -900000000) return;
+    w.setGPSPositionE7(latE7, lonE7);
 }
 
 // ============================================================
 // NMEA 0183 Sentence Parsers
+// Field indices follow the sentence layout; f[0] is the address.
 // ============================================================
 
 // $GPGGA - GPS Fix Data
-void NMEAParser::parseGGA(const char* line) {
-    char buffer[32];
-    char lat[16], ns[2], lon[16], ew[2];
-
-    parseField(line, 2, lat, sizeof(lat));
-    parseField(line, 3, ns,  sizeof(ns));
-    parseField(line, 4, lon, sizeof(lon));
-    parseField(line, 5, ew,  sizeof(ew));
-
-    parseField(line, 6, buffer, sizeof(buffer));
-    int fixQuality = atoi(buffer);
-
-    parseField(line, 7, buffer, sizeof(buffer));
-    int satellites = atoi(buffer);
-
-    parseField(line, 8, buffer, sizeof(buffer));
-    float hdop = atof(buffer);
-
-    if (fixQuality > 0 && strlen(lat) > 0 && strlen(lon) > 0) {
-        boatState->setGPSPosition(parseLatitude(lat, ns), parseLongitude(lon, ew));
-        boatState->setGPSSatellites(satellites);
-        boatState->setGPSFixQuality(fixQuality);
-        boatState->setGPSHDOP(hdop);
-        
+void NMEAParser::parseGGA(const NMEAFields& f) {
+    int   fixQuality = fieldInt(f[6]);
+    int   satellites = fieldInt(f[7]);
+    float hdop       = fieldFloat(f[8]);
+
+    if (fixQuality > 0 && !f[2].empty() && !f[4].empty()) {
+        BoatState::Writer w(*boatState);
+        updatePosition(w, f[2], f[3], f[4], f[5]);
+        w.setGPSSatellites(satellites);
+        w.setGPSFixQuality(fixQuality);
+        w.setGPSHDOP(hdop);
     }
 }
 
 // $GPRMC - Recommended Minimum
-void NMEAParser::parseRMC(const char* line) {
-    char buffer[32];
+void NMEAParser::parseRMC(const NMEAFields& f) {
+    if (f[2].first() != 'A') return;
 
-    parseField(line, 2, buffer, sizeof(buffer));
-    if (buffer[0] != 'A') return;
+    float sog = fieldFloat(f[7]);
+    float cog = fieldFloat(f[8]);
 
-    char lat[16], ns[2], lon[16], ew[2];
-    parseField(line, 3, lat, sizeof(lat));
-    parseField(line, 4, ns,  sizeof(ns));
-    parseField(line, 5, lon, sizeof(lon));
-    parseField(line, 6, ew,  sizeof(ew));
-
-    parseField(line, 7, buffer, sizeof(buffer));
-    float sog = parseKnots(buffer);
-
-    parseField(line, 8, buffer, sizeof(buffer));
-    float cog = parseDegrees(buffer);
-
-    if (strlen(lat) > 0 && strlen(lon) > 0) {
-        boatState->setGPSPosition(parseLatitude(lat, ns), parseLongitude(lon, ew));
+    BoatState::Writer w(*boatState);
+    if (!f[3].empty() && !f[5].empty()) {
+        updatePosition(w, f[3], f[4], f[5], f[6]);
     }
-    if (sog >= 0)            boatState->setGPSSOG(sog);
-    if (cog >= 0 && cog < 360) boatState->setGPSCOG(cog);
+    if (sog >= 0)            w.setGPSSOG(sog);
+    if (cog >= 0 && cog < 360) w.setGPSCOG(cog);
 }
 
 // $GPGLL - Geographic Position
-void NMEAParser::parseGLL(const char* line) {
-    char buffer[32];
-
-    parseField(line, 6, buffer, sizeof(buffer));
-    if (buffer[0] != 'A') return;
-
-    char lat[16], ns[2], lon[16], ew[2];
-    parseField(line, 1, lat, sizeof(lat));
-    parseField(line, 2, ns,  sizeof(ns));
-    parseField(line, 3, lon, sizeof(lon));
-    parseField(line, 4, ew,  sizeof(ew));
+void NMEAParser::parseGLL(const NMEAFields& f) {
+    if (f[6].first() != 'A') return;
 
-    if (strlen(lat) > 0 && strlen(lon) > 0) {
-        boatState->setGPSPosition(parseLatitude(lat, ns), parseLongitude(lon, ew));
+    if (!f[1].empty() && !f[3].empty()) {
+        BoatState::Writer w(*boatState);
+        updatePosition(w, f[1], f[2], f[3], f[4]);
     }
 }
 
 // $GPVTG - Track Made Good and Ground Speed
-void NMEAParser::parseVTG(const char* line) {
-    char buffer[32];
+void NMEAParser::parseVTG(const NMEAFields& f) {
+    float cog = fieldFloat(f[1]);
+    float sog = fieldFloat(f[5]);
 
-    parseField(line, 1, buffer, sizeof(buffer));
-    float cog = parseDegrees(buffer);
-
-    parseField(line, 5, buffer, sizeof(buffer));
-    float sog = parseKnots(buffer);
-
-    if (cog >= 0 && cog < 360) boatState->setGPSCOG(cog);
-    if (sog >= 0)               boatState->setGPSSOG(sog);
+    BoatState::Writer w(*boatState);
+    if (cog >= 0 && cog < 360) w.setGPSCOG(cog);
+    if (sog >= 0)               w.setGPSSOG(sog);
 }
 
 // $HCHDT - True Heading
-void NMEAParser::parseHDT(const char* line) {
-    char buffer[32];
-    parseField(line, 1, buffer, sizeof(buffer));
-    float heading = parseDegrees(buffer);
+void NMEAParser::parseHDT(const NMEAFields& f) {
+    float heading = fieldFloat(f[1]);
     if (heading >= 0 && heading < 360) boatState->setTrueHeading(heading);
 }
 
 // $HCHDM - Magnetic Heading
-void NMEAParser::parseHDM(const char* line) {
-    char buffer[32];
-    parseField(line, 1, buffer, sizeof(buffer));
-    float heading = parseDegrees(buffer);
+void NMEAParser::parseHDM(const NMEAFields& f) {
+    float heading = fieldFloat(f[1]);
     if (heading >= 0 && heading < 360) boatState->setMagneticHeading(heading);
 }
 
 // $SDDPT - Depth
-void NMEAParser::parseDPT(const char* line) {
-    char buffer[32];
-
-    parseField(line, 1, buffer, sizeof(buffer));
-    float depth = atof(buffer);
+void NMEAParser::parseDPT(const NMEAFields& f) {
+    float depth  = fieldFloat(f[1]);
+    float offset = fieldFloat(f[2]);
 
-    parseField(line, 2, buffer, sizeof(buffer));
-    float offset = atof(buffer);
-
-    if (depth > 0)   boatState->setDepth(depth);
-    if (offset != 0) boatState->setDepthOffset(offset);
+    BoatState::Writer w(*boatState);
+    if (depth > 0)   w.setDepth(depth);
+    if (offset != 0) w.setDepthOffset(offset);
 }
 
 // $SDDBT - Depth Below Transducer
-void NMEAParser::parseDBT(const char* line) {
-    char buffer[32];
-    parseField(line, 3, buffer, sizeof(buffer));
-    float depth = atof(buffer);
+void NMEAParser::parseDBT(const NMEAFields& f) {
+    float depth = fieldFloat(f[3]);
     if (depth > 0) boatState->setDepth(depth);
 }
 
 // $WIMWV - Wind Speed and Angle
-void NMEAParser::parseMWV(const char* line) {
-    char buffer[32];
-
-    parseField(line, 1, buffer, sizeof(buffer));
-    float angle = parseDegrees(buffer);
+void NMEAParser::parseMWV(const NMEAFields& f) {
+    float angle     = fieldFloat(f[1]);
+    char  reference = f[2].first();  // R=Relative(apparent), T=True
+    float speed     = fieldFloat(f[3]);
+    char  unit      = f[4].first();  // N=knots, M=m/s, K=km/h
 
-    parseField(line, 2, buffer, sizeof(buffer));
-    char reference = buffer[0];  // R=Relative(apparent), T=True
-
-    parseField(line, 3, buffer, sizeof(buffer));
-    float speed = parseKnots(buffer);
-
-    parseField(line, 4, buffer, sizeof(buffer));
-    char unit = buffer[0];  // N=knots, M=m/s, K=km/h
-
-    parseField(line, 5, buffer, sizeof(buffer));
-    if (buffer[0] != 'A') return;  // V=invalid
+    if (f[5].first() != 'A') return;  // V=invalid
 
     if (reference == 'R') {
         boatState->setApparentWind(speed, angle);
@@ -295,188 +322,60 @@ void NMEAParser::parseMWV(const char* line) {
 }
 
 // $WIMWD - Wind Direction & Speed
-void NMEAParser::parseMWD(const char* line) {
-    char buffer[32];
-
-    parseField(line, 1, buffer, sizeof(buffer));
-    float trueDir = parseDegrees(buffer);
-
-    parseField(line, 5, buffer, sizeof(buffer));
-    float speed = parseKnots(buffer);
+void NMEAParser::parseMWD(const NMEAFields& f) {
+    float trueDir = fieldFloat(f[1]);
+    float speed   = fieldFloat(f[5]);
 
     if (trueDir >= 0 && trueDir < 360) boatState->setTrueWind(speed, 0.0f, trueDir);
 }
 
 // $YXMTW - Water Temperature
-void NMEAParser::parseMTW(const char* line) {
-    char buffer[32];
-    parseField(line, 1, buffer, sizeof(buffer));
-    float temp = atof(buffer);
+void NMEAParser::parseMTW(const NMEAFields& f) {
+    float temp = fieldFloat(f[1]);
     if (temp != 0) boatState->setWaterTemp(temp);
 }
 
 // $VWVHW - Water Speed and Heading
-void NMEAParser::parseVHW(const char* line) {
-    char buffer[32];
+void NMEAParser::parseVHW(const NMEAFields& f) {
+    float trueHeading = fieldFloat(f[1]);
+    float magHeading  = fieldFloat(f[3]);
+    float stw         = fieldFloat(f[5]);
 
-    parseField(line, 1, buffer, sizeof(buffer));
-    float trueHeading = parseDegrees(buffer);
-
-    parseField(line, 3, buffer, sizeof(buffer));
-    float magHeading = parseDegrees(buffer);
-
-    parseField(line, 5, buffer, sizeof(buffer));
-    float stw = parseKnots(buffer);
-
-    if (trueHeading >= 0 && trueHeading < 360) boatState->setTrueHeading(trueHeading);
-    if (magHeading  >= 0 && magHeading  < 360) boatState->setMagneticHeading(magHeading);
-    if (stw >= 0)                               boatState->setSTW(stw);
+    BoatState::Writer w(*boatState);
+    if (trueHeading >= 0 && trueHeading < 360) w.setTrueHeading(trueHeading);
+    if (magHeading  >= 0 && magHeading  < 360) w.setMagneticHeading(magHeading);
+    if (stw >= 0)                               w.setSTW(stw);
 }
 
 // $VWVLW - Distance Traveled through Water
-void NMEAParser::parseVLW(const char* line) {
-    char buffer[32];
-
-    parseField(line, 1, buffer, sizeof(buffer));
-    float total = atof(buffer);
-
-    parseField(line, 3, buffer, sizeof(buffer));
-    float trip = atof(buffer);
+void NMEAParser::parseVLW(const NMEAFields& f) {
+    float total = fieldFloat(f[1]);
+    float trip  = fieldFloat(f[3]);
 
-    if (total >= 0) boatState->setTotal(total);
-    if (trip  >= 0) boatState->setTrip(trip);
+    BoatState::Writer w(*boatState);
+    if (total >= 0) w.setTotal(total);
+    if (trip  >= 0) w.setTrip(trip);
 }
 
 // $GPZDA - UTC Date and Time
-void NMEAParser::parseZDA(const char* line) {
-    char buffer[32];
+void NMEAParser::parseZDA(const NMEAFields& f) {
+    int day   = fieldInt(f[2]);
+    int month = fieldInt(f[3]);
+    int year  = fieldInt(f[4]);
 
-    parseField(line, 2, buffer, sizeof(buffer));
-    int day = atoi(buffer);
-
-    parseField(line, 3, buffer, sizeof(buffer));
-    int month = atoi(buffer);
-
-    parseField(line, 4, buffer, sizeof(buffer));
-    int year = atoi(buffer);
-
-    parseField(line, 1, buffer, sizeof(buffer));
     int hour = 0, minute = 0, second = 0;
+    const NMEAField& t = f[1];
 
-    if (strlen(buffer) >= 6) {
-        hour =   (buffer[0] - '0') * 10 + (buffer[1] - '0');
-        minute = (buffer[2] - '0') * 10 + (buffer[3] - '0');
-        second = (buffer[4] - '0') * 10 + (buffer[5] - '0');
+    if (t.len >= 6) {
+        hour =   (t.ptr[0] - '0') * 10 + (t.ptr[1] - '0');
+        minute = (t.ptr[2] - '0') * 10 + (t.ptr[3] - '0');
+        second = (t.ptr[4] - '0') * 10 + (t.ptr[5] - '0');
     }
     
     boatState->setGPSDateTime(year, month, day, hour, minute, second);
 }
 
 
-// ============================================================
-// AIS Decoder
-// ============================================================
-
-/**
- * Convert an AIS 6-bit ASCII payload character to its 6-bit binary value.
- * Per ITU-R M.1371: subtract 48; if >= 40 subtract another 8.
- */
-uint8_t NMEAParser::aisCharTo6Bit(char c) {
-    uint8_t v = (uint8_t)c - 48;
-    if (v >= 40) v -= 8;
-    return v & 0x3F;
-}
-
-/**
- * Convert a 6-bit AIS value to its ASCII character representation.
- * AIS 6-bit ASCII table (ITU-R M.1371):
- *   0       -> '@'
- *   1..26   -> 'A'..'Z'
- *   32..63  -> ' '..'?' (space and punctuation)
- *   others  -> ' '
- */
-static char ais6BitToChar(uint8_t v) {
-    if (v == 0)             return '@';
-    if (v >= 1 && v <= 26) return 'A' + v - 1;
-    if (v >= 32)            return (char)v;
-    return ' ';
-}
-
-/**
- * Extract an unsigned integer from the AIS binary payload.
- * Bits are numbered from 0 at the MSB of the first byte (big-endian / MSB-first).
- *
- * @param payload   Packed binary buffer produced by decodeAISPayload()
- * @param start     First bit index (0-based, MSB of payload = bit 0)
- * @param length    Number of bits to extract (max 32)
- * @return          Unsigned integer value
- */
-uint32_t NMEAParser::extractBits(const uint8_t* payload, int start, int length) {
-    uint32_t result = 0;
-    for (int i = 0; i < length; i++) {
-        int bitIndex  = start + i;
-        int byteIndex = bitIndex / 8;
-        int bitInByte = 7 - (bitIndex % 8);  // MSB-first within each byte
-        if (payload[byteIndex] & (1 << bitInByte)) {
-            result |= (1u << (length - 1 - i));
-        }
-    }
-    return result;
-}
-
-/**
- * Decode an AIS payload string (6-bit ASCII) into a packed binary buffer.
- * Each ASCII character encodes 6 bits; bits are placed MSB-first across bytes.
- *
- * @param payload   Null-terminated payload string from NMEA field 5
- * @param out       Output buffer (must be zeroed before call)
- * @param outSize   Size of output buffer in bytes
- * @return          Number of bits decoded
- */
-static int decodeAISPayload(const char* payload, uint8_t* out, int outSize) {
-    int payloadLen = strlen(payload);
-    memset(out, 0, outSize);
-
-    for (int i = 0; i < payloadLen; i++) {
-        char c = payload[i];
-        uint8_t value = 0;
-        if (c >= '0' && c <= 'W')      value = c - 48;
-        else if (c >= '`' && c <= 'w') value = c - 56;
-        // else value stays 0
-
-        // Place 6 bits MSB-first into output buffer
-        int bitOffset = i * 6;
-        int byteIndex = bitOffset / 8;
-        int bitShift  = 2 - (bitOffset % 8);  // positive = shift left, negative = shift right
-
-        if (byteIndex < outSize) {
-            if (bitShift >= 0) {
-                out[byteIndex] |= (value << bitShift);
-            } else {
-                out[byteIndex] |= (value >> (-bitShift));
-                if (byteIndex + 1 < outSize) {
-                    out[byteIndex + 1] |= (value << (8 + bitShift));
-                }
-            }
-        }
-    }
-    return payloadLen * 6;
-}
-
-// ============================================================
-// Multi-sentence reassembly buffer (for AIS type 5, 2 sentences)
-// ============================================================
-#define AIS_MULTIPART_MAX_PARTS  2
-#define AIS_MULTIPART_MAX_LEN    84  // max chars per AIVDM payload part
-
-static struct {
-    bool active;
-    char seqId;
-    int  totalParts;
-    int  receivedParts;
-    char parts[AIS_MULTIPART_MAX_PARTS][AIS_MULTIPART_MAX_LEN];
-} aisMsgBuffer = {false, 0, 0, 0, {}};
-
 // ============================================================
 // Helper: compute CPA/TCPA and distance/bearing for a target
 // ============================================================
@@ -503,6 +402,7 @@ static void computeProximity(AISTarget& target, const GPSData& ownGPS) {
     float x = cosf(lat1) * sinf(lat2) - sinf(lat1) * cosf(lat2) * cosf(dlon);
     target.bearing = atan2f(y, x) * 180.0f / PI;
     if (target.bearing < 0) target.bearing += 360.0f;
+    target.hasProximity = true;
 
     // CPA / TCPA
     if (ownGPS.sog.valid && ownGPS.cog.valid && target.sog > 0) {
@@ -532,259 +432,125 @@ static void computeProximity(AISTarget& target, const GPSData& ownGPS) {
     }
 }
 
-// ============================================================
-// Helper: update or create a stub AIS target with a name
-// ============================================================
-static void updateOrCreateNamedTarget(BoatState* boatState, uint32_t mmsi, const char* name) {
-    if (!boatState || mmsi == 0 || name[0] == '\0') return;
-
-    AISData ais = boatState->getAIS();
-    for (int i = 0; i < ais.targetCount; i++) {
-        if (ais.targets[i].mmsi == mmsi) {
-            ais.targets[i].name      = String(name);
-            ais.targets[i].timestamp = millis();
-            boatState->addOrUpdateAISTarget(ais.targets[i]);
-            return;
-        }
-    }
-    // Target not yet known — create a stub so the name is preserved
-    AISTarget stub;
-    stub.mmsi      = mmsi;
-    stub.name      = String(name);
-    stub.timestamp = millis();
-    boatState->addOrUpdateAISTarget(stub);
-}
-
 // ============================================================
 // !AIVDM / !AIVDO — AIS VHF Data-link Message
 // Format: !AIVDM,totalSentences,sentenceNum,seqId,channel,payload,fillBits*hh
 // ============================================================
-void NMEAParser::parseAIVDM(const char* line) {
-    char buffer[8];
-
+void NMEAParser::parseAIVDM(const NMEAFields& f) {
     // Field 1: total sentences in this message
-    parseField(line, 1, buffer, sizeof(buffer));
-    int totalSentences = atoi(buffer);
+    int totalSentences = fieldInt(f[1]);
 
     // Field 2: sentence number (1-based)
-    parseField(line, 2, buffer, sizeof(buffer));
-    int sentenceNum = atoi(buffer);
-
-    // Field 3: sequential message identifier (single char or empty)
-    char seqIdBuf[4];
-    parseField(line, 3, seqIdBuf, sizeof(seqIdBuf));
-    char seqId = seqIdBuf[0];
+    int sentenceNum = fieldInt(f[2]);
 
-    // Field 5: encoded payload
-    char payloadPart[AIS_MULTIPART_MAX_LEN];
-    parseField(line, 5, payloadPart, sizeof(payloadPart));
-    if (strlen(payloadPart) == 0) return;
+    // Field 5: encoded payload; field 6: fill bits in the last character
+    const NMEAField& payloadPart = f[5];
+    if (payloadPart.empty()) return;
+    int fillBits = fieldInt(f[6]) & 7;
 
-    // ----------------------------------------------------------
-    // Multi-sentence reassembly (type 5 always spans 2 sentences)
-    // ----------------------------------------------------------
-    if (totalSentences > 1) {
-        if (sentenceNum == 1) {
-            aisMsgBuffer.active        = true;
-            aisMsgBuffer.seqId         = seqId;
-            aisMsgBuffer.totalParts    = totalSentences;
-            aisMsgBuffer.receivedParts = 1;
-            strncpy(aisMsgBuffer.parts[0], payloadPart, AIS_MULTIPART_MAX_LEN - 1);
-            aisMsgBuffer.parts[0][AIS_MULTIPART_MAX_LEN - 1] = '\0';
-        } else if (aisMsgBuffer.active &&
-                   aisMsgBuffer.seqId == seqId &&
-                   sentenceNum <= AIS_MULTIPART_MAX_PARTS) {
-            strncpy(aisMsgBuffer.parts[sentenceNum - 1], payloadPart, AIS_MULTIPART_MAX_LEN - 1);
-            aisMsgBuffer.parts[sentenceNum - 1][AIS_MULTIPART_MAX_LEN - 1] = '\0';
-            aisMsgBuffer.receivedParts++;
-
-            if (aisMsgBuffer.receivedParts == aisMsgBuffer.totalParts) {
-                // Reassemble full payload
-                char fullPayload[AIS_MULTIPART_MAX_PARTS * AIS_MULTIPART_MAX_LEN] = {0};
-                for (int p = 0; p < aisMsgBuffer.totalParts; p++) {
-                    strncat(fullPayload, aisMsgBuffer.parts[p],
-                            sizeof(fullPayload) - strlen(fullPayload) - 1);
-                }
-                aisMsgBuffer.active = false;
-
-                uint8_t binaryPayload[96] = {0};
-                decodeAISPayload(fullPayload, binaryPayload, sizeof(binaryPayload));
-
-                uint8_t messageType = (uint8_t)extractBits(binaryPayload, 0, 6);
-                if (messageType == 5) {
-                    decodeAISType5(binaryPayload, strlen(fullPayload));
-                }
-            }
-        } else {
-            // Out-of-sequence or unsupported multi-part — discard
-            aisMsgBuffer.active = false;
-        }
+    if (totalSentences <= 1) {
+        decodeAIS(payloadPart.ptr, payloadPart.len, fillBits);
         return;
     }
 
     // ----------------------------------------------------------
-    // Single-sentence message
+    // Multi-sentence message (type 5 spans 2 sentences): pool keyed by
+    // talker, field 3 (sequential message id) and field 4 (channel)
     // ----------------------------------------------------------
-    uint8_t binaryPayload[64] = {0};
-    decodeAISPayload(payloadPart, binaryPayload, sizeof(binaryPayload));
-
-    uint8_t messageType = (uint8_t)extractBits(binaryPayload, 0, 6);
-    switch (messageType) {
-        case 1: case 2: case 3:
-            decodeAISType1(binaryPayload, strlen(payloadPart));
-            break;
-        case 18:
-            decodeAISType18(binaryPayload, strlen(payloadPart));
-            break;
-        case 24:
-            decodeAISType24(binaryPayload, strlen(payloadPart));
-            break;
-        default:
-            break;
+    AISFragment frag;
+    frag.talker[0] = f[0].len >= 2 ? f[0].ptr[0] : '\0';
+    frag.talker[1] = f[0].len >= 2 ? f[0].ptr[1] : '\0';
+    frag.seqId     = f[3].first();
+    frag.channel   = f[4].first();
+    frag.total     = (uint8_t)(totalSentences > 255 ? 255 : totalSentences);
+    frag.num       = (uint8_t)(sentenceNum < 0 || sentenceNum > 255 ? 0 : sentenceNum);
+    frag.payload   = payloadPart.ptr;
+    frag.len       = payloadPart.len;
+    frag.fillBits  = (uint8_t)fillBits;
+
+    if (aisReassembly.add(frag, millis())) {
+        decodeAIS(aisReassembly.message(), (int)aisReassembly.messageLen(),
+                  aisReassembly.messageFillBits());
     }
 }
 
 // ============================================================
-// Decode AIS Type 1/2/3 — Position Report Class A
+// Decode a complete payload and apply it (see ais_decoder.h)
 // ============================================================
-void NMEAParser::decodeAISType1(const uint8_t* payload, int payloadLen) {
-    AISTarget target;
+void NMEAParser::decodeAIS(const char* payload, int len, int fillBits) {
+    uint8_t bits[AIS_BITBUF_BYTES(AIS_MAX_PAYLOAD_BITS)];
+    size_t bitLen = aisUnarmor(payload, len, bits, sizeof(bits));
+    bitLen = bitLen > (size_t)fillBits ? bitLen - fillBits : 0;
 
-    // MMSI (bits 8–37)
-    target.mmsi = extractBits(payload, 8, 30);
+    AISMessage msg;
+    if (!aisDecode(bits, bitLen, msg) || msg.mmsi == 0) return;
+    aisDecoded[msg.type]++;
 
-    // SOG (bits 50–59) in 1/10 knots; 1023 = not available
-    uint32_t sogRaw = extractBits(payload, 50, 10);
-    if (sogRaw != 1023) target.sog = sogRaw / 10.0f;
-
-    // Longitude (bits 61–88) in 1/10000 minutes, signed 28-bit
-    int32_t lonRaw = (int32_t)extractBits(payload, 61, 28);
-    if (lonRaw & 0x08000000) lonRaw |= 0xF0000000;  // sign-extend
-    if (lonRaw != 0x6791AC0) target.lon = lonRaw / 600000.0f;  // 181° = not available
-
-    // Latitude (bits 89–115) in 1/10000 minutes, signed 27-bit
-    int32_t latRaw = (int32_t)extractBits(payload, 89, 27);
-    if (latRaw & 0x04000000) latRaw |= 0xF8000000;  // sign-extend
-    if (latRaw != 0x3412140) target.lat = latRaw / 600000.0f;  // 91° = not available
-
-    // COG (bits 116–127) in 1/10 degrees; 3600 = not available
-    uint32_t cogRaw = extractBits(payload, 116, 12);
-    if (cogRaw != 3600) target.cog = cogRaw / 10.0f;
-
-    // True Heading (bits 128–136); 511 = not available
-    uint32_t headingRaw = extractBits(payload, 128, 9);
-    if (headingRaw != 511) target.heading = headingRaw;
-
-    target.timestamp = millis();
-
-    computeProximity(target, boatState->getGPS());
-
-    if (target.mmsi != 0) {
-        // Preserve existing name if present
-        AISData ais = boatState->getAIS();
-        for (int i = 0; i < ais.targetCount; i++) {
-            if (ais.targets[i].mmsi == target.mmsi && ais.targets[i].name.length() > 0) {
-                target.name = ais.targets[i].name;
-                break;
-            }
-        }
-        boatState->addOrUpdateAISTarget(target);
-    }
+    if (aisHandler) aisHandler(msg, aisHandlerCtx);
+    applyAISMessage(msg);
 }
 
-// ============================================================
-// Decode AIS Type 5 — Static and Voyage Related Data (Class A)
-// Always 2 sentences; reassembled before this function is called.
-// ============================================================
-void NMEAParser::decodeAISType5(const uint8_t* payload, int payloadLen) {
-    // MMSI (bits 8–37)
-    uint32_t mmsi = extractBits(payload, 8, 30);
-
-    // Ship name (bits 112–231) — 20 × 6-bit characters
-    char name[21] = {0};
-    for (int i = 0; i < 20; i++) {
-        name[i] = ais6BitToChar((uint8_t)extractBits(payload, 112 + i * 6, 6));
-    }
-    // Trim trailing spaces and '@' padding
-    for (int i = 19; i >= 0; i--) {
-        if (name[i] != ' ' && name[i] != '@') break;
-        name[i] = '\0';
-    }
+void NMEAParser::applyAISMessage(const AISMessage& msg) {
+    if (!boatState) return;
 
-    updateOrCreateNamedTarget(boatState, mmsi, name);
-}
+    switch (msg.type) {
+        case 5:
+        case 24:
+            // Static data: name, call sign and ship type (24 A or B)
+            boatState->setAISTargetStatic(msg.mmsi, msg.name, msg.callsign,
+                                          (uint8_t)msg.get(AIS_SHIP_TYPE));
+            return;
+        case 14:
+            // Safety text has no target data; the AIS handler sees it
+            return;
+        default:
+            break;
+    }
 
-// ============================================================
-// Decode AIS Type 18 — Standard Class B Position Report
-// ============================================================
-void NMEAParser::decodeAISType18(const uint8_t* payload, int payloadLen) {
+    // Position reports: 1/2/3, 4/11, 9, 18, 19, 21, 27
     AISTarget target;
-
-    // MMSI (bits 8–37)
-    target.mmsi = extractBits(payload, 8, 30);
-
-    // SOG (bits 46–55) in 1/10 knots; 1023 = not available
-    uint32_t sogRaw = extractBits(payload, 46, 10);
-    if (sogRaw != 1023) target.sog = sogRaw / 10.0f;
-
-    // Longitude (bits 57–84) in 1/10000 minutes, signed 28-bit
-    int32_t lonRaw = (int32_t)extractBits(payload, 57, 28);
-    if (lonRaw & 0x08000000) lonRaw |= 0xF0000000;
-    if (lonRaw != 0x6791AC0) target.lon = lonRaw / 600000.0f;
-
-    // Latitude (bits 85–111) in 1/10000 minutes, signed 27-bit
-    int32_t latRaw = (int32_t)extractBits(payload, 85, 27);
-    if (latRaw & 0x04000000) latRaw |= 0xF8000000;
-    if (latRaw != 0x3412140) target.lat = latRaw / 600000.0f;
-
-    // COG (bits 112–123) in 1/10 degrees; 3600 = not available
-    uint32_t cogRaw = extractBits(payload, 112, 12);
-    if (cogRaw != 3600) target.cog = cogRaw / 10.0f;
-
-    // True Heading (bits 124–132); 511 = not available
-    uint32_t headingRaw = extractBits(payload, 124, 9);
-    if (headingRaw != 511) target.heading = headingRaw;
-
+    target.mmsi     = msg.mmsi;
+    target.msgType  = msg.type;
+    target.sog      = msg.get(AIS_SOG);
+    target.cog      = msg.get(AIS_COG);
+    target.heading  = msg.get(AIS_HEADING);
+    target.lat      = msg.get(AIS_LAT);
+    target.lon      = msg.get(AIS_LON);
+    target.shipType = (uint8_t)msg.get(AIS_SHIP_TYPE);
+    // 19 and 21 carry the name inline; addOrUpdate() keeps it otherwise
+    memcpy(target.name, msg.name, sizeof(target.name));
     target.timestamp = millis();
 
     computeProximity(target, boatState->getGPS());
 
-    if (target.mmsi != 0) {
-        // Preserve existing name if present
-        AISData ais = boatState->getAIS();
-        for (int i = 0; i < ais.targetCount; i++) {
-            if (ais.targets[i].mmsi == target.mmsi && ais.targets[i].name.length() > 0) {
-                target.name = ais.targets[i].name;
-                break;
-            }
-        }
-        boatState->addOrUpdateAISTarget(target);
-    }
+    boatState->addOrUpdateAISTarget(target);
 }
 
 // ============================================================
-// Decode AIS Type 24 — Static Data Report (Class B)
-// Part A carries the ship name; Part B carries call sign / dimensions.
+// Metrics
 // ============================================================
-void NMEAParser::decodeAISType24(const uint8_t* payload, int payloadLen) {
-    // Part Number (bits 38–39)
-    uint8_t partNum = (uint8_t)extractBits(payload, 38, 2);
 
-    if (partNum == 0) {
-        // Part A — Ship Name (bits 40–159, 20 × 6-bit chars)
-        uint32_t mmsi = extractBits(payload, 8, 30);
-
-        char name[21] = {0};
-        for (int i = 0; i < 20; i++) {
-            name[i] = ais6BitToChar((uint8_t)extractBits(payload, 40 + i * 6, 6));
-        }
-        // Trim trailing spaces and '@' padding
-        for (int i = 19; i >= 0; i--) {
-            if (name[i] != ' ' && name[i] != '@') break;
-            name[i] = '\0';
-        }
-
-        updateOrCreateNamedTarget(boatState, mmsi, name);
-    }
-    // Part B (call sign, dimensions) — not needed for display
+namespace {
+
+int64_t readAISFragments(const void* ctx) { return static_cast<const AISReassembler*>(ctx)->fragments(); }
+int64_t readAISCompleted(const void* ctx) { return static_cast<const AISReassembler*>(ctx)->completed(); }
+int64_t readAISDropped(const void* ctx)   { return static_cast<const AISReassembler*>(ctx)->dropped(); }
+int64_t readAISExpired(const void* ctx)   { return static_cast<const AISReassembler*>(ctx)->expired(); }
+
+} // namespace
+
+void NMEAParser::registerMetrics(MetricsRegistry& reg) const {
+    reg.addCounter("espnav_nmea_sentences", "Sentences parsed, by checksum result",
+                   &validSentences, "result=\"valid\"");
+    reg.addCounter("espnav_nmea_sentences", "Sentences parsed, by checksum result",
+                   &invalidSentences, "result=\"invalid\"");
+
+    reg.addCounter("espnav_ais_fragments", "AIS fragments offered to reassembly",
+                   readAISFragments, &aisReassembly);
+    reg.addCounter("espnav_ais_reassembled", "Multi-sentence AIS messages reassembled",
+                   readAISCompleted, &aisReassembly);
+    reg.addCounter("espnav_ais_fragments_discarded", "AIS fragments discarded, by cause",
+                   readAISDropped, &aisReassembly, "cause=\"dropped\"");
+    reg.addCounter("espnav_ais_fragments_discarded", "AIS fragments discarded, by cause",
+                   readAISExpired, &aisReassembly, "cause=\"expired\"");
 }
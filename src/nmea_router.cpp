@@ -0,0 +1,70 @@
+#include "nmea_router.h"
+#include "metrics.h"
+
+NMEARouter::NMEARouter() {
+    for (uint8_t s = 0; s < NMEA_SOURCE_MAX; s++) {
+        echoes[s] = 0;
+        setRoutes(s, s == NMEA_SOURCE_TCP ? ROUTE_DEFAULT_TCP : ROUTE_DEFAULT_UART);
+    }
+}
+
+void NMEARouter::setRoutes(uint8_t source, uint8_t outputs) {
+    if (source >= NMEA_SOURCE_MAX) return;
+    outputs &= ROUTE_ALL;
+    if (source < NMEA_PORT_MAX) outputs &= (uint8_t)~ROUTE_UART_TX(source);
+    table[source] = outputs;
+}
+
+uint8_t NMEARouter::route(const char* text, size_t len, uint8_t source, uint8_t client,
+                          uint8_t available, uint32_t nowMs) {
+    if (source >= NMEA_SOURCE_MAX) return 0;
+    uint8_t outputs = table[source] & available;
+
+    // Only hash when there is something to check or remember: the source's
+    // return path carried sentences lately, or this one goes out a guarded output
+    const uint8_t guarded = ROUTE_TCP | ROUTE_UART_TX(0) | ROUTE_UART_TX(1) | ROUTE_UART_TX(2);
+    static_assert(NMEA_PORT_MAX == 3, "guarded lists every UART TX");
+    bool check = source == NMEA_SOURCE_TCP ? tcpSent.recent(nowMs) : uartSent[source].recent(nowMs);
+    if (!check && !(outputs & guarded)) return outputs;
+    uint32_t h = hash(text, len);
+
+    bool echo = check && (source == NMEA_SOURCE_TCP ? tcpSent.seen(h, nowMs, client)
+                                                    : uartSent[source].seen(h, nowMs));
+    if (echo) {
+        echoes[source]++;
+        return 0;
+    }
+
+    if (outputs & ROUTE_TCP) tcpSent.record(h, nowMs, source == NMEA_SOURCE_TCP ? client : NMEA_NO_CLIENT);
+    for (uint8_t p = 0; p < NMEA_PORT_MAX; p++) {
+        if (outputs & ROUTE_UART_TX(p)) uartSent[p].record(h, nowMs);
+    }
+    return outputs;
+}
+
+const char* NMEARouter::outputName(uint8_t output) {
+    static const char* const kNames[ROUTE_OUTPUT_COUNT] = { "uart0", "uart1", "uart2", "tcp", "udp", "ws" };
+    static_assert(ROUTE_OUTPUT_COUNT == 6, "kNames lists every output");
+    return output < ROUTE_OUTPUT_COUNT ? kNames[output] : "";
+}
+
+const char* NMEARouter::sourceName(uint8_t source) {
+    // Same names as the outputs a source shares a link with
+    return source < NMEA_SOURCE_MAX ? outputName(source) : "";
+}
+
+uint32_t NMEARouter::hash(const char* text, size_t len) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (uint8_t)text[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+void NMEARouter::registerMetrics(MetricsRegistry& reg) const {
+    for (uint8_t s = 0; s < NMEA_SOURCE_MAX; s++) {
+        reg.addCounter("espnav_route_echoes", "Sentences dropped as echoes of what was sent back to their source",
+                       &echoes[s], metricsPortLabel(s));
+    }
+}
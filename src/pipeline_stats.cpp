@@ -0,0 +1,147 @@
+#include "pipeline_stats.h"
+#include "metrics.h"
+#include <string.h>
+
+// ============================================================
+// LatencyHistogram
+// ============================================================
+
+void LatencyHistogram::reset() {
+    memset(counts, 0, sizeof(counts));
+    total = 0;
+    maxUs = 0;
+    sumUs = 0;
+}
+
+uint16_t LatencyHistogram::bucketOf(uint32_t us) {
+    if (us < LATENCY_LINEAR) return (uint16_t)us;
+
+    uint32_t msb = 31 - (uint32_t)__builtin_clz(us);
+    if (msb > LATENCY_MAX_MSB) return LATENCY_BUCKETS - 1;
+
+    uint32_t sub = (us >> (msb - LATENCY_SUB_BITS)) & ((1u << LATENCY_SUB_BITS) - 1);
+    return (uint16_t)(LATENCY_LINEAR + ((msb - 4) << LATENCY_SUB_BITS) + sub);
+}
+
+uint32_t LatencyHistogram::bucketUpper(uint16_t b) {
+    if (b < LATENCY_LINEAR) return b;
+    if (b >= LATENCY_BUCKETS - 1) return UINT32_MAX;
+
+    uint32_t k     = b - LATENCY_LINEAR;
+    uint32_t msb   = 4 + (k >> LATENCY_SUB_BITS);
+    uint32_t sub   = k & ((1u << LATENCY_SUB_BITS) - 1);
+    uint32_t shift = msb - LATENCY_SUB_BITS;
+    return (((1u << LATENCY_SUB_BITS) + sub) << shift) + (1u << shift) - 1;
+}
+
+uint32_t LatencyHistogram::percentile(uint16_t permille) const {
+    uint32_t n = total;
+    if (n == 0) return 0;
+
+    // Rank of the wanted value, 1-based, rounded up
+    uint64_t rank = ((uint64_t)n * permille + 999) / 1000;
+    if (rank == 0) rank = 1;
+
+    uint64_t seen = 0;
+    for (uint16_t b = 0; b < LATENCY_BUCKETS; b++) {
+        seen += counts[b];
+        if (seen >= rank) {
+            uint32_t upper = bucketUpper(b);
+            return upper < maxUs ? upper : maxUs;
+        }
+    }
+    return maxUs;
+}
+
+// ============================================================
+// PipelineStats
+// ============================================================
+
+PipelineStats::PipelineStats() {
+    for (int i = 0; i < DROP_REASON_COUNT; i++) drops[i].store(0, std::memory_order_relaxed);
+    reset();
+}
+
+void PipelineStats::reset() {
+    for (int i = 0; i < STAGE_COUNT; i++) stages[i].reset();
+    for (int i = 0; i < QUEUE_COUNT; i++) {
+        queues[i].depth     = 0;
+        queues[i].highWater.store(0, std::memory_order_relaxed);
+    }
+}
+
+const char* PipelineStats::stageName(PipelineStage s) {
+    switch (s) {
+        case STAGE_MERGE_WAIT: return "merge_wait";
+        case STAGE_PARSE:      return "parse";
+        case STAGE_QUEUE_WAIT: return "queue_wait";
+        case STAGE_FANOUT_TCP: return "fanout_tcp";
+        case STAGE_FANOUT_WS:  return "fanout_ws";
+        case STAGE_FANOUT_UDP: return "fanout_udp";
+        case STAGE_FANOUT_UART: return "fanout_uart";
+        case STAGE_END_TO_END: return "end_to_end";
+        case STAGE_LOG:        return "log";
+        default:               return "unknown";
+    }
+}
+
+const char* PipelineStats::dropName(DropReason r) {
+    switch (r) {
+        case DROP_POOL_EXHAUSTED:  return "pool_exhausted";
+        case DROP_MERGE_FULL:      return "merge_full";
+        case DROP_CHECKSUM:        return "checksum";
+        case DROP_NMEA_QUEUE_FULL: return "nmea_queue_full";
+        case DROP_LOG_QUEUE_FULL:  return "log_queue_full";
+        default:                   return "unknown";
+    }
+}
+
+// ============================================================
+// Metrics
+// ============================================================
+
+namespace {
+
+// Label sets must outlive the registry, hence the literal tables
+const char* const kStageLabels[STAGE_COUNT] = {
+    "stage=\"merge_wait\"", "stage=\"parse\"",     "stage=\"queue_wait\"",
+    "stage=\"fanout_tcp\"", "stage=\"fanout_ws\"", "stage=\"fanout_udp\"",
+    "stage=\"fanout_uart\"", "stage=\"end_to_end\"", "stage=\"log\"",
+};
+
+const char* const kDropLabels[DROP_REASON_COUNT] = {
+    "reason=\"pool_exhausted\"",  "reason=\"merge_full\"", "reason=\"checksum\"",
+    "reason=\"nmea_queue_full\"", "reason=\"log_queue_full\"",
+};
+
+const char* const kQueueLabels[QUEUE_COUNT] = {
+    "queue=\"merge0\"", "queue=\"merge1\"", "queue=\"merge2\"", "queue=\"merge_tcp\"",
+    "queue=\"nmea\"",   "queue=\"log\"",    "queue=\"pool\"",
+};
+static_assert(NMEA_SOURCE_MAX == 4, "kQueueLabels lists one merge ring per source");
+
+int64_t readDrops(const void* ctx) {
+    return static_cast<const std::atomic<uint32_t>*>(ctx)->load(std::memory_order_relaxed);
+}
+
+int64_t readHighWater(const void* ctx) {
+    return static_cast<const std::atomic<uint16_t>*>(ctx)->load(std::memory_order_relaxed);
+}
+
+} // namespace
+
+void PipelineStats::registerMetrics(MetricsRegistry& reg) const {
+    for (int s = 0; s < STAGE_COUNT; s++) {
+        reg.addHistogram("espnav_pipeline_latency_microseconds",
+                         "NMEA pipeline latency per stage (reset by /api/metrics?reset=1)",
+                         &stages[s], kStageLabels[s]);
+    }
+    for (int r = 0; r < DROP_REASON_COUNT; r++) {
+        reg.addCounter("espnav_pipeline_drops", "Sentences dropped, by reason",
+                       readDrops, &drops[r], kDropLabels[r]);
+    }
+    for (int q = 0; q < QUEUE_COUNT; q++) {
+        reg.addGauge("espnav_queue_high_water", "Highest depth seen per queue since the last reset",
+                     readHighWater, &queues[q].highWater, kQueueLabels[q]);
+    }
+}
@@ -0,0 +1,88 @@
+#include "response_cache.h"
+#include "metrics.h"
+#include <stdlib.h>
+#include <string.h>
+
+ResponseCache::ResponseCache(uint32_t maxAgeMs)
+    : maxAgeMs(maxAgeMs), hits(0), misses(0), invalidations(0) {
+    memset(entries, 0, sizeof(entries));
+    for (int i = 0; i < CACHE_SOURCE_COUNT; i++) generation[i].store(0, std::memory_order_relaxed);
+}
+
+ResponseCache::~ResponseCache() {
+    for (size_t i = 0; i < RESPONSE_CACHE_SLOTS; i++) free(entries[i].body);
+}
+
+void ResponseCache::invalidate(uint32_t sources) {
+    for (int i = 0; i < CACHE_SOURCE_COUNT; i++) {
+        if (sources & CACHE_MASK(i)) generation[i].fetch_add(1, std::memory_order_release);
+    }
+    invalidations.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint32_t ResponseCache::stamp(uint32_t sources) const {
+    uint32_t s = 0;
+    for (int i = 0; i < CACHE_SOURCE_COUNT; i++) {
+        if (sources & CACHE_MASK(i)) s += generation[i].load(std::memory_order_acquire);
+    }
+    return s;
+}
+
+const char* ResponseCache::get(uint8_t key, uint32_t now, size_t* len) {
+    if (key >= RESPONSE_CACHE_SLOTS) {
+        return nullptr;
+    }
+    Entry& e = entries[key];
+    if (e.valid && stamp(e.sources) != e.stamp) {
+        e.valid = false;
+    }
+    if (!e.valid || (maxAgeMs && now - e.builtAt >= maxAgeMs)) {
+        misses++;
+        return nullptr;
+    }
+    hits++;
+    if (len) *len = e.len;
+    return e.body;
+}
+
+bool ResponseCache::put(uint8_t key, uint32_t sources, uint32_t stamp, uint32_t now,
+                        const char* body, size_t len) {
+    if (key >= RESPONSE_CACHE_SLOTS) {
+        return false;
+    }
+    Entry& e = entries[key];
+    if (len + 1 > e.cap) {
+        free(e.body);
+        e.body  = static_cast<char*>(malloc(len + 1));
+        e.cap   = e.body ? len + 1 : 0;
+        e.valid = false;
+        if (!e.body) return false;
+    }
+    memcpy(e.body, body, len);
+    e.body[len] = '\0';
+    e.len       = len;
+    e.sources   = sources;
+    e.stamp     = stamp;
+    e.builtAt   = now;
+    e.valid     = true;
+    return true;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Metrics
+// ═══════════════════════════════════════════════════════════════
+
+namespace {
+
+int64_t readInvalidations(const void* ctx) {
+    return static_cast<const ResponseCache*>(ctx)->getInvalidations();
+}
+
+} // namespace
+
+void ResponseCache::registerMetrics(MetricsRegistry& reg) {
+    reg.addCounter("espnav_http_cache_lookups", "Cached REST responses looked up", &hits, "result=\"hit\"");
+    reg.addCounter("espnav_http_cache_lookups", "Cached REST responses looked up", &misses, "result=\"miss\"");
+    reg.addCounter("espnav_http_cache_invalidations", "Cached REST responses invalidated by a write, delete or mount",
+                   readInvalidations, this);
+}
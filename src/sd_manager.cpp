@@ -29,7 +29,7 @@
 // ─────────────────────────────────────────────────────────────────────────────
 
 SDManager::SDManager()
-    : mounted(false), spi(nullptr) {
+    : mounted(false), mountEpoch(0), spi(nullptr), changeListener(nullptr), changeCtx(nullptr) {
     mutex = xSemaphoreCreateMutex();
 }
 
@@ -86,6 +86,7 @@ bool SDManager::mount() {
 
     if (ok) {
         mounted = true;
+        mountEpoch++;
         serialPrintf("[SD] Card type: %s  total: %llu MB\n",
                       SD.cardType() == CARD_SDHC ? "SDHC/SDXC" :
                       SD.cardType() == CARD_SD   ? "SDSC"       : "Unknown",
@@ -112,11 +113,13 @@ bool SDManager::mount() {
     }
 
     unlock();
+    if (ok) notifyChange();
     return ok;
 }
 
 void SDManager::unmount() {
     if (!lock()) return;
+    bool wasMounted = mounted;
     if (mounted) {
         SD.end();
         mounted = false;
@@ -128,12 +131,18 @@ void SDManager::unmount() {
         serialPrintf("[SD] Card unmounted\n");
     }
     unlock();
+    if (wasMounted) notifyChange();
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
 // State
 // ─────────────────────────────────────────────────────────────────────────────
 
+void SDManager::setChangeListener(SDChangeListener fn, void* ctx) {
+    changeCtx      = ctx;
+    changeListener = fn;
+}
+
 SDStorageInfo SDManager::getStorageInfo() {
     SDStorageInfo info;
     info.mounted = mounted;
@@ -183,6 +192,66 @@ std::vector<SDFileInfo> SDManager::listFiles(const char* dirPath,
     return result;
 }
 
+bool SDManager::openDir(SDDirCursor& cursor, const char* dirPath, uint8_t maxDepth) {
+    closeDir(cursor);
+    if (!mounted || !lock()) return false;
+
+    File root = SD.open(dirPath);
+    bool ok = root && root.isDirectory();
+    if (ok) {
+        cursor.dirs[0]    = root;
+        cursor.depth      = 0;
+        cursor.maxDepth   = maxDepth < SD_LIST_MAX_DEPTH ? maxDepth : SD_LIST_MAX_DEPTH;
+        cursor.mountEpoch = mountEpoch;
+    } else {
+        serialPrintf("[SD] openDir: cannot open dir '%s'\n", dirPath);
+    }
+
+    unlock();
+    return ok;
+}
+
+bool SDManager::nextEntry(SDDirCursor& cursor, SDFileInfo& out) {
+    if (cursor.depth < 0) return false;
+    if (!lock()) {
+        closeDir(cursor);
+        return false;
+    }
+
+    bool found = false;
+    if (mounted && cursor.mountEpoch == mountEpoch) {
+        while (!found && cursor.depth >= 0) {
+            File entry = cursor.dirs[cursor.depth].openNextFile();
+            if (!entry) {
+                cursor.dirs[cursor.depth--].close();
+                continue;
+            }
+            out.path  = entry.path();
+            out.size  = entry.isDirectory() ? 0 : entry.size();
+            out.isDir = entry.isDirectory();
+            found = true;
+
+            if (entry.isDirectory() && cursor.depth < cursor.maxDepth) {
+                cursor.dirs[++cursor.depth] = entry;
+            } else {
+                entry.close();
+            }
+        }
+    }
+
+    unlock();
+    if (!found) closeDir(cursor);
+    return found;
+}
+
+void SDManager::closeDir(SDDirCursor& cursor) {
+    // Directory handles only: closing them does no card I/O, no lock needed
+    for (int8_t d = cursor.depth; d >= 0; d--) {
+        cursor.dirs[d].close();
+    }
+    cursor.depth = -1;
+}
+
 void SDManager::listDir(File& dir, std::vector<SDFileInfo>& out,
                          uint8_t depth, uint8_t maxDepth) {
     File entry = dir.openNextFile();
@@ -213,6 +282,7 @@ bool SDManager::deleteFile(const char* path) {
     }
 
     unlock();
+    if (ok) notifyChange();
     return ok;
 }
 
@@ -248,6 +318,7 @@ bool SDManager::deleteDir(const char* path) {
     serialPrintf("[SD] deleteDir '%s' → %s\n", path, ok ? "OK" : "FAILED");
 
     unlock();
+    notifyChange();     // Entries may be gone even if rmdir failed
     return ok;
 }
 
@@ -261,7 +332,9 @@ File SDManager::openForRead(const char* path) {
 
 File SDManager::openForWrite(const char* path, bool append) {
     if (!mounted) return File();
-    return SD.open(path, append ? FILE_APPEND : FILE_WRITE);
+    File f = SD.open(path, append ? FILE_APPEND : FILE_WRITE);
+    if (f) notifyChange();   // Created or truncated: listings and usage move
+    return f;
 }
 
 bool SDManager::format() {
@@ -311,6 +384,7 @@ bool SDManager::format() {
 
     serialPrintf("[SD] ✓ SD card formatted (all files removed)\n");
     unlock();
+    notifyChange();
     return true;
 }
 
@@ -326,6 +400,7 @@ bool SDManager::mkdir(const char* path) {
     bool ok = SD.mkdir(path);
     serialPrintf("[SD] mkdir '%s' → %s\n", path, ok ? "OK" : "FAILED");
     unlock();
+    if (ok) notifyChange();
     return ok;
 }
 
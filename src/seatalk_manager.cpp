@@ -202,18 +202,19 @@ void SeatalkManager::parseFrame(const uint8_t* frame, uint8_t len) {
             else if (am & 0x04) mode = "wind";
             else if (am & 0x02) mode = "auto";
 
-            boatState->setAutopilotMode(String(mode));
-
             uint16_t thRaw = ((uint16_t)(frame[9] & 0x03) << 8) | frame[10];
             float targetHeading = thRaw / 10.0f;
-            boatState->setAutopilotHeadingTarget(targetHeading);
 
             int8_t rudder = (int8_t)frame[4];
-            boatState->setAutopilotRudderAngle((float)rudder);
 
             uint8_t ar = frame[3];
             bool offCourse = (ar & 0x10) != 0;
-            boatState->setAutopilotStatus(offCourse ? String("alarm") : String("engaged"));
+
+            BoatState::Writer w(*boatState);
+            w.setAutopilotMode(String(mode));
+            w.setAutopilotHeadingTarget(targetHeading);
+            w.setAutopilotRudderAngle((float)rudder);
+            w.setAutopilotStatus(offCourse ? String("alarm") : String("engaged"));
             break;
         }
 
@@ -223,12 +224,13 @@ void SeatalkManager::parseFrame(const uint8_t* frame, uint8_t len) {
 
             uint16_t headingRaw = ((uint16_t)(frame[2] & 0x03) << 8) | frame[3];
             float heading = headingRaw / 2.0f;
+            int8_t rudder = (int8_t)frame[4];
+
+            BoatState::Writer w(*boatState);
             if (heading >= 0.0f && heading < 360.0f) {
-                boatState->setMagneticHeading(heading);
+                w.setMagneticHeading(heading);
             }
-
-            int8_t rudder = (int8_t)frame[4];
-            boatState->setAutopilotRudderAngle((float)rudder);
+            w.setAutopilotRudderAngle((float)rudder);
             break;
         }
 
@@ -249,9 +251,10 @@ void SeatalkManager::parseFrame(const uint8_t* frame, uint8_t len) {
             uint16_t awaRaw = ((uint16_t)(frame[2] & 0x03) << 8) | frame[3];
             float awa = awaRaw / 2.0f;
             if (awa > 180.0f) awa -= 360.0f;
-            WindData w = boatState->getWind();
-            float aws = w.aws.valid ? w.aws.value : 0.0f;
-            boatState->setApparentWind(aws, awa);
+            // Read-modify-write under one lock so a concurrent AWS update is not lost
+            BoatState::Writer w(*boatState);
+            float aws = w.wind().aws.valid ? w.wind().aws.value : 0.0f;
+            w.setApparentWind(aws, awa);
             break;
         }
 
@@ -261,9 +264,9 @@ void SeatalkManager::parseFrame(const uint8_t* frame, uint8_t len) {
             float aws = (float)frame[2];
             uint8_t frac = (frame[3] >> 4) & 0x0F;
             aws += frac * 0.1f;
-            WindData w = boatState->getWind();
-            float awa = w.awa.valid ? w.awa.value : 0.0f;
-            boatState->setApparentWind(aws, awa);
+            BoatState::Writer w(*boatState);
+            float awa = w.wind().awa.valid ? w.wind().awa.value : 0.0f;
+            w.setApparentWind(aws, awa);
             break;
         }
 
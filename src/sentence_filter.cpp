@@ -0,0 +1,332 @@
+#include "sentence_filter.h"
+#include <ctype.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+
+// ============================================================
+// SentenceKey
+// ============================================================
+
+namespace {
+
+/** Field @p n (0 = address) of @p line, bounded by @p end.  Length via @p len. */
+const char* field(const char* line, const char* end, uint8_t n, size_t& len) {
+    const char* p = line + 1;
+    for (uint8_t i = 0; i < n; i++) {
+        while (p < end && *p != ',' && *p != '*') p++;
+        if (p >= end || *p != ',') {
+            len = 0;
+            return nullptr;
+        }
+        p++;
+    }
+    const char* q = p;
+    while (q < end && *q != ',' && *q != '*') q++;
+    len = (size_t)(q - p);
+    return p;
+}
+
+bool patternChar(char c) {
+    return (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+}
+
+} // namespace
+
+bool SentenceKey::parse(const char* line, size_t len) {
+    addressLen = 0;
+    address[0] = '\0';
+    fragments  = 0;
+    fragment   = 0;
+    seqId      = '\0';
+    channel    = '\0';
+    if (!line || len < 2 || (line[0] != '$' && line[0] != '!')) return false;
+
+    const char* end = line + len;
+    size_t n;
+    const char* a = field(line, end, 0, n);
+    if (!a || n == 0) return false;
+    if (n > FILTER_ADDRESS_MAX - 1) n = FILTER_ADDRESS_MAX - 1;
+    memcpy(address, a, n);
+    address[n] = '\0';
+    addressLen = (uint8_t)n;
+
+    // !xxVDM,<count>,<number>,<seq id>,<channel>,...
+    if (n == 5 && address[2] == 'V' && address[3] == 'D' && (address[4] == 'M' || address[4] == 'O')) {
+        size_t cl, nl, sl, chl;
+        const char* c  = field(line, end, 1, cl);
+        const char* nu = field(line, end, 2, nl);
+        const char* s  = field(line, end, 3, sl);
+        const char* ch = field(line, end, 4, chl);
+        if (c && cl == 1 && nu && nl == 1 && c[0] >= '1' && c[0] <= '9' && nu[0] >= '1' && nu[0] <= '9') {
+            fragments = (uint8_t)(c[0] - '0');
+            fragment  = (uint8_t)(nu[0] - '0');
+            seqId     = (s && sl == 1) ? s[0] : '\0';
+            channel   = (ch && chl == 1) ? ch[0] : '\0';
+        }
+    }
+    return true;
+}
+
+// ============================================================
+// Filtering
+// ============================================================
+
+SentenceFilter::SentenceFilter() {
+    clear();
+}
+
+void SentenceFilter::clear() {
+    ruleCount = 0;
+    memset(rate, 0, sizeof(rate));
+    rateClock = 0;
+    memset(ais, 0, sizeof(ais));
+    aisClock  = 0;
+}
+
+const SentenceFilter::Rule* SentenceFilter::match(const SentenceKey& key) const {
+    for (uint8_t i = 0; i < ruleCount; i++) {
+        const Rule& r = ruleList[i];
+        if (r.prefix) {
+            if (key.addressLen >= r.len && memcmp(key.address, r.pattern, r.len) == 0) return &r;
+        } else if (r.len == key.addressLen) {
+            if (memcmp(key.address, r.pattern, r.len) == 0) return &r;
+        } else if (r.len == 3 && key.addressLen == 5) {
+            // Sentence type from any talker
+            if (memcmp(key.address + 2, r.pattern, 3) == 0) return &r;
+        }
+    }
+    return nullptr;
+}
+
+bool SentenceFilter::allowRate(const Rule& rule, const SentenceKey& key, uint32_t nowMs) {
+    RateSlot* slot   = nullptr;
+    RateSlot* oldest = &rate[0];
+    for (uint8_t i = 0; i < FILTER_RATE_SLOTS; i++) {
+        if (rate[i].used && strcmp(rate[i].address, key.address) == 0) {
+            slot = &rate[i];
+            break;
+        }
+        if (rate[i].used < oldest->used) oldest = &rate[i];
+    }
+
+    if (slot) {
+        if (nowMs - slot->lastMs < rule.minIntervalMs) return false;
+    } else {
+        // New address: recycle the least recently passed one
+        slot = oldest;
+        memcpy(slot->address, key.address, sizeof(slot->address));
+    }
+    slot->lastMs = nowMs;
+    slot->used   = ++rateClock;
+    return true;
+}
+
+SentenceFilter::AISGroup* SentenceFilter::findGroup(const SentenceKey& key) {
+    for (uint8_t i = 0; i < FILTER_AIS_GROUPS; i++) {
+        AISGroup& g = ais[i];
+        if (g.next && g.seqId == key.seqId && g.channel == key.channel &&
+            g.talker[0] == key.address[0] && g.talker[1] == key.address[1]) {
+            return &g;
+        }
+    }
+    return nullptr;
+}
+
+bool SentenceFilter::accept(const SentenceKey& key, uint32_t nowMs) {
+    if (ruleCount == 0) return true;
+
+    // Later fragments of a multi-part AIS message follow the first one
+    if (key.fragments > 1 && key.fragment > 1) {
+        AISGroup* g = findGroup(key);
+        if (g && g->next == key.fragment) {
+            g->next = key.fragment < key.fragments ? key.fragment + 1 : 0;
+            return g->pass;
+        }
+        // First fragment not seen: pass only if nothing could have rate-limited it
+        const Rule* r = match(key);
+        return r && r->minIntervalMs == 0;
+    }
+
+    const Rule* r = match(key);
+    bool pass = r && (r->minIntervalMs == 0 || allowRate(*r, key, nowMs));
+
+    if (key.fragments > 1) {
+        // A group with the same key was never finished: reuse it, else a free or the oldest one
+        AISGroup* g = findGroup(key);
+        for (uint8_t i = 0; !g && i < FILTER_AIS_GROUPS; i++) {
+            if (!ais[i].next) g = &ais[i];
+        }
+        if (!g) {
+            g = &ais[0];
+            for (uint8_t i = 1; i < FILTER_AIS_GROUPS; i++) {
+                if (ais[i].used < g->used) g = &ais[i];
+            }
+        }
+        g->talker[0] = key.address[0];
+        g->talker[1] = key.address[1];
+        g->seqId     = key.seqId;
+        g->channel   = key.channel;
+        g->next      = 2;
+        g->pass      = pass;
+        g->used      = ++aisClock;
+    }
+    return pass;
+}
+
+// ============================================================
+// $PMAR,FILTER command
+// ============================================================
+
+bool SentenceFilter::parseRule(const char* text, size_t len, Rule& rule) const {
+    memset(&rule, 0, sizeof(rule));
+
+    const char* slash = (const char*)memchr(text, '/', len);
+    size_t patLen = slash ? (size_t)(slash - text) : len;
+
+    if (patLen > 0 && text[patLen - 1] == '*') {
+        rule.prefix = true;
+        patLen--;
+    }
+    if (patLen == 0 && !rule.prefix) return false;
+    if (patLen > FILTER_ADDRESS_MAX - 1) return false;
+    for (size_t i = 0; i < patLen; i++) {
+        if (!patternChar(text[i])) return false;
+    }
+    memcpy(rule.pattern, text, patLen);
+    rule.len = (uint8_t)patLen;
+
+    if (!slash) return true;
+
+    // Rate in Hz with at most one decimal: "2", "0.5", "10"
+    const char* p   = slash + 1;
+    const char* end = text + len;
+    uint32_t tenths = 0;
+    bool     digits = false;
+    while (p < end && *p >= '0' && *p <= '9' && tenths <= 10000) {
+        tenths = tenths * 10 + (uint32_t)(*p++ - '0');
+        digits = true;
+    }
+    tenths *= 10;
+    if (p < end && *p == '.') {
+        p++;
+        if (p < end && *p >= '0' && *p <= '9') {
+            tenths += (uint32_t)(*p++ - '0');
+            digits = true;
+        }
+        while (p < end && *p >= '0' && *p <= '9') p++;   // Finer than 0.1 Hz is ignored
+    }
+    if (!digits || p != end || tenths == 0 || tenths > 1000) return false;
+
+    rule.rateTenthsHz  = (uint16_t)tenths;
+    rule.minIntervalMs = 10000 / tenths;
+    return true;
+}
+
+bool SentenceFilter::command(const char* line, size_t len, char* reply, size_t replyLen) {
+    static const char kPrefix[] = "$PMAR,FILTER";
+    const size_t prefixLen = sizeof(kPrefix) - 1;
+    if (!line || len < prefixLen || memcmp(line, kPrefix, prefixLen) != 0) return false;
+    if (len > prefixLen && line[prefixLen] != ',' && line[prefixLen] != '*' &&
+        line[prefixLen] != '\r' && line[prefixLen] != '\n') return false;
+
+    // Strip line end and the optional checksum (validated when present)
+    const char* end = line + len;
+    while (end > line && (end[-1] == '\r' || end[-1] == '\n')) end--;
+    // Rules may contain '*' themselves: only a trailing "*hh" is a checksum
+    const char* star = (end - line > (ptrdiff_t)prefixLen + 2 && end[-3] == '*' &&
+                        isxdigit((unsigned char)end[-2]) && isxdigit((unsigned char)end[-1])) ? end - 3 : nullptr;
+    if (star) {
+        uint8_t sum = 0;
+        for (const char* p = line + 1; p < star; p++) sum ^= (uint8_t)*p;
+        char hex[3];
+        snprintf(hex, sizeof(hex), "%02X", sum);
+        if (strncasecmp(star + 1, hex, 2) != 0) {
+            formatSentence(reply, replyLen, "PMAR,ERR,FILTER,checksum");
+            return true;
+        }
+        end = star;
+    }
+
+    const char* p = line + prefixLen;
+    char body[FILTER_REPLY_MAX];
+
+    if (p + 2 == end && p[0] == ',' && p[1] == '?') {
+        replyRules(reply, replyLen);
+        return true;
+    }
+
+    // Parse every rule first: a bad list leaves the current one in force
+    Rule   parsed[FILTER_MAX_RULES];
+    uint8_t count = 0;
+    while (p < end) {
+        p++;                                   // ','
+        const char* e = p;
+        while (e < end && *e != ',') e++;
+        if (e > p) {
+            if (count >= FILTER_MAX_RULES) {
+                snprintf(body, sizeof(body), "PMAR,ERR,FILTER,max %u rules", FILTER_MAX_RULES);
+                formatSentence(reply, replyLen, body);
+                return true;
+            }
+            if (!parseRule(p, (size_t)(e - p), parsed[count])) {
+                // By position: echoing client text could break the reply's framing
+                snprintf(body, sizeof(body), "PMAR,ERR,FILTER,bad rule %u", count + 1);
+                formatSentence(reply, replyLen, body);
+                return true;
+            }
+            count++;
+        }
+        p = e;
+    }
+
+    clear();
+    memcpy(ruleList, parsed, count * sizeof(Rule));
+    ruleCount = count;
+    replyRules(reply, replyLen);
+    return true;
+}
+
+void SentenceFilter::replyRules(char* reply, size_t replyLen) const {
+    char   body[FILTER_REPLY_MAX];
+    size_t n = (size_t)snprintf(body, sizeof(body), "PMAR,OK,FILTER");
+    if (ruleCount) {
+        body[n++] = ',';
+        describe(body + n, sizeof(body) - n);
+    }
+    formatSentence(reply, replyLen, body);
+}
+
+size_t SentenceFilter::describe(char* out, size_t outLen) const {
+    size_t used = 0;
+    if (outLen) out[0] = '\0';
+    for (uint8_t i = 0; i < ruleCount; i++) {
+        const Rule& r = ruleList[i];
+        char item[24];
+        int  n = snprintf(item, sizeof(item), "%s%.*s%s", i ? "," : "", (int)r.len, r.pattern,
+                          r.prefix ? "*" : "");
+        if (r.rateTenthsHz) {
+            if (r.rateTenthsHz % 10) {
+                n += snprintf(item + n, sizeof(item) - n, "/%u.%u", r.rateTenthsHz / 10, r.rateTenthsHz % 10);
+            } else {
+                n += snprintf(item + n, sizeof(item) - n, "/%u", r.rateTenthsHz / 10);
+            }
+        }
+        if (used + (size_t)n + 1 > outLen) break;
+        memcpy(out + used, item, (size_t)n + 1);
+        used += (size_t)n;
+    }
+    return used;
+}
+
+size_t SentenceFilter::formatSentence(char* out, size_t outLen, const char* body) {
+    uint8_t sum = 0;
+    for (const char* p = body; *p; p++) sum ^= (uint8_t)*p;
+    int n = snprintf(out, outLen, "$%s*%02X\r\n", body, sum);
+    if (n < 0 || (size_t)n >= outLen) {
+        if (outLen) out[0] = '\0';
+        return 0;
+    }
+    return (size_t)n;
+}
@@ -0,0 +1,118 @@
+#include "sentence_pool.h"
+#include "functions.h"
+#include "metrics.h"
+#include <new>
+#include <stdlib.h>
+#include <string.h>
+
+SentencePool::SentencePool() : bufs(nullptr), freeCount(0), hint(0), lowMark(0), exhaustedCount(0) {
+    for (int w = 0; w < FREE_WORDS; w++) freeMap[w].store(0, std::memory_order_relaxed);
+}
+
+SentencePool::~SentencePool() {
+    free(bufs);
+}
+
+bool SentencePool::begin() {
+    if (bufs) return true;
+
+    size_t bytes = (size_t)SENTENCE_POOL_SIZE * sizeof(SentenceBuf);
+#ifdef BOARD_HAS_PSRAM
+    // Buffers are written once and read a handful of times: PSRAM is fine.
+    // The free bitmap and stage rings stay in internal RAM.
+    bufs = (SentenceBuf*)ps_malloc(bytes);
+#endif
+    if (!bufs) bufs = (SentenceBuf*)malloc(bytes);
+    if (!bufs) {
+        serialPrintf("[Pool] ❌ Cannot allocate %u sentence buffers\n", SENTENCE_POOL_SIZE);
+        return false;
+    }
+
+    for (uint16_t i = 0; i < SENTENCE_POOL_SIZE; i++) {
+        new (&bufs[i]) SentenceBuf();
+        bufs[i].refs.store(0, std::memory_order_relaxed);
+        bufs[i].raw[0] = '\0';
+        freeMap[i / 32].fetch_or(1u << (i % 32), std::memory_order_relaxed);
+    }
+    freeCount.store(SENTENCE_POOL_SIZE, std::memory_order_release);
+    lowMark.store(SENTENCE_POOL_SIZE, std::memory_order_relaxed);
+
+    serialPrintf("[Pool] ✓ %u sentence buffers (%u bytes)\n", SENTENCE_POOL_SIZE, (unsigned)bytes);
+    return true;
+}
+
+SentenceRef SentencePool::acquire() {
+    if (bufs) {
+        // Start where the last search ended so producers rarely contend on a word
+        uint32_t start = hint.load(std::memory_order_relaxed);
+        for (uint32_t k = 0; k < FREE_WORDS; k++) {
+            uint32_t w    = (start + k) % FREE_WORDS;
+            uint32_t bits = freeMap[w].load(std::memory_order_relaxed);
+            while (bits) {
+                uint32_t bit = (uint32_t)__builtin_ctz(bits);
+                if (freeMap[w].compare_exchange_weak(bits, bits & ~(1u << bit),
+                                                     std::memory_order_acquire,
+                                                     std::memory_order_relaxed)) {
+                    SentenceRef ref = (SentenceRef)(w * 32 + bit);
+                    bufs[ref].refs.store(1, std::memory_order_relaxed);
+                    hint.store(w, std::memory_order_relaxed);
+
+                    uint32_t avail = freeCount.fetch_sub(1, std::memory_order_relaxed) - 1;
+                    uint32_t low   = lowMark.load(std::memory_order_relaxed);
+                    while (avail < low &&
+                           !lowMark.compare_exchange_weak(low, avail, std::memory_order_relaxed)) {
+                    }
+                    return ref;
+                }
+            }
+        }
+    }
+    exhaustedCount.fetch_add(1, std::memory_order_relaxed);
+    return SENTENCE_NONE;
+}
+
+SentenceRef SentencePool::acquire(const char* text, size_t len, uint8_t source, uint32_t arrivalUs) {
+    SentenceRef ref = acquire();
+    if (ref == SENTENCE_NONE) return ref;
+
+    if (len > NMEA_MAX_LENGTH - 1) len = NMEA_MAX_LENGTH - 1;
+    SentenceBuf& b = bufs[ref];
+    b.arrivalUs = arrivalUs;
+    b.queuedUs  = arrivalUs;
+    b.source    = source;
+    b.origin    = NMEA_NO_CLIENT;
+    b.len       = (uint8_t)len;
+    memcpy(b.raw, text, len);
+    b.raw[len] = '\0';
+    return ref;
+}
+
+void SentencePool::release(SentenceRef ref) {
+    if (ref >= SENTENCE_POOL_SIZE || !bufs) return;
+    // acq_rel: the holder's reads of the buffer happen before it is recycled
+    if (bufs[ref].refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        freeCount.fetch_add(1, std::memory_order_relaxed);
+        freeMap[ref / 32].fetch_or(1u << (ref % 32), std::memory_order_release);
+    }
+}
+
+// ============================================================
+// Metrics
+// ============================================================
+
+namespace {
+
+int64_t readPoolCapacity(const void* ctx)  { return static_cast<const SentencePool*>(ctx)->capacity(); }
+int64_t readPoolAvailable(const void* ctx) { return static_cast<const SentencePool*>(ctx)->available(); }
+int64_t readPoolLowWater(const void* ctx)  { return static_cast<const SentencePool*>(ctx)->lowWater(); }
+int64_t readPoolExhausted(const void* ctx) { return static_cast<const SentencePool*>(ctx)->exhausted(); }
+
+} // namespace
+
+void SentencePool::registerMetrics(MetricsRegistry& reg) const {
+    reg.addGauge("espnav_sentence_pool_buffers", "Sentence buffers in the pool", readPoolCapacity, this);
+    reg.addGauge("espnav_sentence_pool_free", "Sentence buffers currently free", readPoolAvailable, this);
+    reg.addGauge("espnav_sentence_pool_low_water", "Fewest free sentence buffers since boot", readPoolLowWater, this);
+    reg.addCounter("espnav_sentence_pool_exhausted", "Acquires that found the pool empty",
+                   readPoolExhausted, this);
+}
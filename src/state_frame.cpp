@@ -0,0 +1,147 @@
+#include "state_frame.h"
+#include "boat_state.h"
+#include "config.h"
+#include <math.h>
+
+namespace {
+
+const int32_t kScale[STATE_FIELD_COUNT] = {
+    10000000, 10000000,     // lat, lon
+    100, 10, 1, 100,        // sog, cog, satellites, hdop
+    100, 100, 10,           // stw, trip, total
+    10, 10,                 // heading magnetic, true
+    100,                    // depth
+    100, 10, 100, 10, 10,   // aws, awa, tws, twa, twd
+    10,                     // water temp
+    100, 10, 1              // vmg, polar %, polar loaded
+};
+static_assert(STATE_FIELD_COUNT == 21, "kScale lists every field");
+
+int32_t fixed(const DataPoint& dp, uint8_t field) {
+    if (dp.isStale()) return STATE_NO_VALUE;
+    float v = dp.value * (float)kScale[field];
+    // Clamp clear of the sentinel rather than wrap
+    if (isnan(v)) return STATE_NO_VALUE;
+    if (v < -2.0e9f) return -2000000000;
+    if (v >  2.0e9f) return  2000000000;
+    return (int32_t)lroundf(v);
+}
+
+void putEntry(uint8_t* p, uint8_t field, int32_t value) {
+    uint32_t u = (uint32_t)value;
+    p[0] = field;
+    p[1] = (uint8_t)u;
+    p[2] = (uint8_t)(u >> 8);
+    p[3] = (uint8_t)(u >> 16);
+    p[4] = (uint8_t)(u >> 24);
+}
+
+} // namespace
+
+// ============================================================
+// StateSnapshot
+// ============================================================
+
+void StateSnapshot::clear() {
+    for (uint8_t f = 0; f < STATE_FIELD_COUNT; f++) values[f] = STATE_NO_VALUE;
+}
+
+int32_t StateSnapshot::scale(uint8_t field) {
+    return field < STATE_FIELD_COUNT ? kScale[field] : 1;
+}
+
+void StateSnapshot::capture(BoatState& state) {
+    const GPSData         gps  = state.getGPS();
+    const SpeedData       spd  = state.getSpeed();
+    const HeadingData     hdg  = state.getHeading();
+    const DepthData       dpt  = state.getDepth();
+    const WindData        wind = state.getWind();
+    const EnvironmentData env  = state.getEnvironment();
+    const PerformanceData perf = state.getPerformance();
+
+    // Position keeps its full 1e-7 resolution: latE7/lonE7 are the wire values
+    bool fix = !gps.position.lat.isStale() && !gps.position.lon.isStale();
+    values[SF_LAT] = fix ? gps.position.latE7 : STATE_NO_VALUE;
+    values[SF_LON] = fix ? gps.position.lonE7 : STATE_NO_VALUE;
+
+    values[SF_SOG]          = fixed(gps.sog, SF_SOG);
+    values[SF_COG]          = fixed(gps.cog, SF_COG);
+    values[SF_SATELLITES]   = fixed(gps.satellites, SF_SATELLITES);
+    values[SF_HDOP]         = fixed(gps.hdop, SF_HDOP);
+    values[SF_STW]          = fixed(spd.stw, SF_STW);
+    values[SF_TRIP]         = fixed(spd.trip, SF_TRIP);
+    values[SF_TOTAL]        = fixed(spd.total, SF_TOTAL);
+    values[SF_HEADING_MAG]  = fixed(hdg.magnetic, SF_HEADING_MAG);
+    values[SF_HEADING_TRUE] = fixed(hdg.true_heading, SF_HEADING_TRUE);
+    values[SF_DEPTH]        = fixed(dpt.below_transducer, SF_DEPTH);
+    values[SF_AWS]          = fixed(wind.aws, SF_AWS);
+    values[SF_AWA]          = fixed(wind.awa, SF_AWA);
+    values[SF_TWS]          = fixed(wind.tws, SF_TWS);
+    values[SF_TWA]          = fixed(wind.twa, SF_TWA);
+    values[SF_TWD]          = fixed(wind.twd, SF_TWD);
+    values[SF_WATER_TEMP]   = fixed(env.water_temp, SF_WATER_TEMP);
+    values[SF_VMG]          = fixed(perf.vmg, SF_VMG);
+    values[SF_POLAR_PCT]    = fixed(perf.polarPct, SF_POLAR_PCT);
+    values[SF_POLAR_LOADED] = state.polar.isLoaded() ? 1 : 0;
+}
+
+// ============================================================
+// StateFrameEncoder
+// ============================================================
+
+StateFrameEncoder::StateFrameEncoder() : lastKeyMs(0), primed(false), keyframes(0), deltas(0) {
+    reset();
+}
+
+void StateFrameEncoder::reset() {
+    for (uint8_t f = 0; f < STATE_FIELD_COUNT; f++) sent[f] = STATE_NO_VALUE;
+    primed = false;
+}
+
+size_t StateFrameEncoder::encode(const StateSnapshot& now, uint32_t nowMs, uint8_t* out) {
+    bool key = !primed || nowMs - lastKeyMs >= WS_STATE_KEYFRAME_MS;
+
+    uint8_t* p = out + STATE_FRAME_HEADER;
+    uint8_t  count = 0;
+    for (uint8_t f = 0; f < STATE_FIELD_COUNT; f++) {
+        int32_t v = now.values[f];
+        if (!key && v == sent[f]) continue;
+        putEntry(p, f, v);
+        p += STATE_FRAME_ENTRY;
+        sent[f] = v;
+        count++;
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    out[0] = key ? STATE_FRAME_KEY : 0;
+    out[1] = count;
+    if (key) {
+        primed    = true;
+        lastKeyMs = nowMs;
+        keyframes++;
+    } else {
+        deltas++;
+    }
+    return (size_t)(p - out);
+}
+
+// ============================================================
+// Decoding (what the dashboard does)
+// ============================================================
+
+bool applyStateFrame(const uint8_t* frame, size_t len, StateSnapshot& into) {
+    if (!frame || len < STATE_FRAME_HEADER) return false;
+    uint8_t count = frame[1];
+    if (len != STATE_FRAME_HEADER + (size_t)count * STATE_FRAME_ENTRY) return false;
+
+    if (frame[0] & STATE_FRAME_KEY) into.clear();
+    const uint8_t* p = frame + STATE_FRAME_HEADER;
+    for (uint8_t i = 0; i < count; i++, p += STATE_FRAME_ENTRY) {
+        if (p[0] >= STATE_FIELD_COUNT) continue;   // Newer firmware: unknown fields are skipped
+        into.values[p[0]] = (int32_t)((uint32_t)p[1] | ((uint32_t)p[2] << 8) |
+                                      ((uint32_t)p[3] << 16) | ((uint32_t)p[4] << 24));
+    }
+    return true;
+}
@@ -0,0 +1,116 @@
+#include "stream_ring.h"
+#include <Arduino.h>
+#include <stdlib.h>
+#include <string.h>
+
+StreamRing::StreamRing()
+    : buf(nullptr), size(0), head(0), used(0), pendingSince(0), overflowSince(0),
+      overflowing(false), refusedAt(0), refused(false), overflowCount(0), appendCount(0) {
+}
+
+StreamRing::~StreamRing() {
+    free(buf);
+}
+
+bool StreamRing::begin(size_t capacity) {
+    if (buf) return true;
+    if (capacity == 0) return false;
+
+#ifdef BOARD_HAS_PSRAM
+    // Written once per sentence and read once per segment: PSRAM is fine
+    buf = (char*)ps_malloc(capacity);
+#endif
+    if (!buf) buf = (char*)malloc(capacity);
+    if (!buf) return false;
+
+    size = capacity;
+    clear();
+    return true;
+}
+
+void StreamRing::clear() {
+    head          = 0;
+    used          = 0;
+    pendingSince  = 0;
+    overflowSince = 0;
+    overflowing   = false;
+    refusedAt     = 0;
+    refused       = false;
+    overflowCount = 0;
+    appendCount   = 0;
+}
+
+void StreamRing::put(const char* data, size_t len) {
+    size_t tail  = (head + used) % size;
+    size_t first = size - tail;
+    if (first > len) first = len;
+    memcpy(buf + tail, data, first);
+    memcpy(buf, data + first, len - first);
+    used += len;
+}
+
+bool StreamRing::refuse(uint32_t nowMs) {
+    if (!overflowing) {
+        overflowing   = true;
+        overflowSince = nowMs;
+    }
+    overflowCount++;
+    return false;
+}
+
+bool StreamRing::append(const char* data, size_t len, uint32_t nowMs) {
+    if (len == 0) return true;
+    if (!buf || len > size - used) return refuse(nowMs);
+    if (used == 0) pendingSince = nowMs;
+    put(data, len);
+    appendCount++;
+    return true;
+}
+
+bool StreamRing::appendLine(const char* data, size_t len, uint32_t nowMs) {
+    bool hasCRLF = len >= 2 && data[len - 2] == '\r' && data[len - 1] == '\n';
+    if (hasCRLF) return append(data, len, nowMs);
+
+    // Reserve room for the CR LF too, so the line goes in whole or not at all
+    if (!buf || len + 2 > size - used) return refuse(nowMs);
+    if (used == 0) pendingSince = nowMs;
+    put(data, len);
+    put("\r\n", 2);
+    appendCount++;
+    return true;
+}
+
+size_t StreamRing::peek(const char*& data) const {
+    data = buf + head;
+    if (used == 0) return 0;
+    size_t contiguous = size - head;
+    return used < contiguous ? used : contiguous;
+}
+
+void StreamRing::consume(size_t n) {
+    if (n > used) n = used;
+    if (n == 0) return;
+    head  = (head + n) % size;
+    used -= n;
+    overflowing = false;
+    refused     = false;
+    // The remainder keeps its (older) stamp: it is already overdue, if anything
+}
+
+bool StreamRing::due(uint32_t nowMs, size_t batchBytes, uint32_t maxDelayMs) const {
+    if (used == 0) return false;
+    return used >= batchBytes || (uint32_t)(nowMs - pendingSince) >= maxDelayMs;
+}
+
+uint32_t StreamRing::msUntilDue(uint32_t nowMs, uint32_t maxDelayMs) const {
+    if (used == 0) return maxDelayMs;
+    uint32_t since  = refused ? refusedAt : pendingSince;
+    uint32_t waited = nowMs - since;
+    return waited >= maxDelayMs ? 0 : maxDelayMs - waited;
+}
+
+uint32_t StreamRing::overflowingFor(uint32_t nowMs) const {
+    if (!overflowing) return 0;
+    uint32_t d = nowMs - overflowSince;
+    return d ? d : 1;
+}
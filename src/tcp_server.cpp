@@ -1,9 +1,18 @@
 #include "tcp_server.h"
 #include "functions.h"
+#include "metrics.h"
 
 TCPServer::TCPServer() 
-    : server(NULL), clientsMutex(NULL), port(0), 
-      initialized(false), running(false) {
+    : server(NULL), clientCount(0), clientsMutex(NULL), port(0), 
+      initialized(false), running(false),
+      bytesSent(0), segmentsSent(0), sentencesDropped(0), sentencesFiltered(0), evictions(0),
+      linesReceived(0), lastStatsLog(0), rxSlot(NULL), inputHandler(NULL), inputCtx(NULL) {
+    for (size_t i = 0; i < TCP_MAX_CLIENTS; i++) {
+        slots[i].client = NULL;
+        slots[i].mss    = TCP_DEFAULT_MSS;
+        memset(&slots[i].stats, 0, sizeof(slots[i].stats));
+        slots[i].framer.setHandler(onClientLine, this);
+    }
 }
 
 TCPServer::~TCPServer() {
@@ -31,9 +40,18 @@ void TCPServer::init(uint16_t p) {
         return;
     }
     
+    // Output rings are allocated once for every slot, not per connection
+    for (size_t i = 0; i < TCP_MAX_CLIENTS; i++) {
+        if (!slots[i].ring.begin(TCP_CLIENT_BUFFER)) {
+            serialPrintf("[TCP] ❌ Cannot allocate output ring %u (%u bytes)\n", i, TCP_CLIENT_BUFFER);
+            return;
+        }
+    }
+    
     initialized = true;
     
-    serialPrintf("[TCP] Initialized on port %u with intelligent throttling\n", port);
+    serialPrintf("[TCP] Initialized on port %u: %u clients × %u B rings, coalescing ≤ %u ms\n",
+                 port, TCP_MAX_CLIENTS, TCP_CLIENT_BUFFER, TCP_COALESCE_MS);
 }
 
 void TCPServer::start() {
@@ -71,17 +89,26 @@ void TCPServer::stop() {
         server->end();
     }
     
-    // Close all clients
+    // Close all clients (outside the mutex: close() may call onDisconnect)
+    AsyncClient* toClose[TCP_MAX_CLIENTS];
+    size_t n = 0;
     xSemaphoreTake(clientsMutex, portMAX_DELAY);
-    for (auto client : clients) {
-        if (client && client->connected()) {
-            client->close();
+    for (size_t i = 0; i < TCP_MAX_CLIENTS; i++) {
+        if (slots[i].client) {
+            toClose[n++] = slots[i].client;
+            slots[i].client = NULL;
+            slots[i].ring.clear();
         }
     }
-    clients.clear();
-    clientStats.clear();  // Clear stats map
+    clientCount = 0;
     xSemaphoreGive(clientsMutex);
     
+    for (size_t i = 0; i < n; i++) {
+        if (toClose[i]->connected()) {
+            toClose[i]->close();
+        }
+    }
+    
     serialPrintf("[TCP] Server stopped\n");
 }
 
@@ -94,6 +121,9 @@ void TCPServer::onConnect(AsyncClient* client) {
                   client->remoteIP().toString().c_str(),
                   client->remotePort());
     
+    // We batch ourselves; Nagle would only hold the latency-bound flushes back
+    client->setNoDelay(true);
+    
     // Set up client callbacks
     client->onDisconnect([](void* arg, AsyncClient* c) {
         TCPServer* srv = static_cast<TCPServer*>(arg);
@@ -115,13 +145,19 @@ void TCPServer::onConnect(AsyncClient* client) {
                      c->remoteIP().toString().c_str(), time);
     }, this);
     
-    addClient(client);
+    // Send window reopened: push what is waiting
+    client->onAck([](void* arg, AsyncClient* c, size_t len, uint32_t time) {
+        TCPServer* srv = static_cast<TCPServer*>(arg);
+        srv->onAck(c);
+    }, this);
     
-    // Send welcome message
-    const char* welcome = "$PMAR,Marine Gateway Connected*00\r\n";
-    if (client->canSend()) {
-        client->write(welcome, strlen(welcome));
-    }
+    // lwIP poll (~0.5 s): backstop for flushes and stall eviction
+    client->onPoll([](void* arg, AsyncClient* c) {
+        TCPServer* srv = static_cast<TCPServer*>(arg);
+        srv->onPoll(c);
+    }, this);
+    
+    addClient(client);
 }
 
 void TCPServer::onDisconnect(AsyncClient* client) {
@@ -136,10 +172,50 @@ void TCPServer::onDisconnect(AsyncClient* client) {
 }
 
 void TCPServer::onData(AsyncClient* client, void* data, size_t len) {
-    // TCP server is transmit-only for NMEA data
-    // Ignore any incoming data (could log it if needed)
-    serialPrintf("[TCP] Received %u bytes from %s (ignored)\n", 
-                  len, client->remoteIP().toString().c_str());
+    if (!data || len == 0) {
+        return;
+    }
+    
+    xSemaphoreTake(clientsMutex, portMAX_DELAY);
+    Slot* s = findSlot(client);
+    if (s) {
+        // The pbuf is ours for the duration of the callback: frame in place
+        rxSlot = s;
+        s->framer.feed(static_cast<char*>(data), len);
+        rxSlot = NULL;
+    }
+    xSemaphoreGive(clientsMutex);
+}
+
+void TCPServer::onClientLine(char* line, size_t len, void* ctx) {
+    TCPServer* srv = static_cast<TCPServer*>(ctx);
+    if (srv->rxSlot) {
+        srv->handleClientLine(*srv->rxSlot, line, len);
+    }
+}
+
+void TCPServer::handleClientLine(Slot& s, const char* line, size_t len) {
+    char reply[FILTER_REPLY_MAX];
+    if (s.filter.command(line, len, reply, sizeof(reply))) {
+        uint32_t now = millis();
+        serialPrintf("[TCP] %s → %s", s.client->remoteIP().toString().c_str(), reply);
+        // Answer right away, ahead of the next batch
+        s.ring.append(reply, strlen(reply), now);
+        drain(s, now);
+        return;
+    }
+    
+    if (inputHandler) {
+        linesReceived++;
+        inputHandler(line, len, (uint8_t)(&s - slots), inputCtx);
+        return;
+    }
+    serialPrintf("[TCP] Ignored from %s: %s\n", s.client->remoteIP().toString().c_str(), line);
+}
+
+void TCPServer::setInputHandler(TCPInputHandler handler, void* ctx) {
+    inputHandler = handler;
+    inputCtx     = ctx;
 }
 
 void TCPServer::onError(AsyncClient* client, int8_t error) {
@@ -152,6 +228,44 @@ void TCPServer::onError(AsyncClient* client, int8_t error) {
     removeClient(client);
 }
 
+void TCPServer::onAck(AsyncClient* client) {
+    xSemaphoreTake(clientsMutex, portMAX_DELAY);
+    Slot* s = findSlot(client);
+    uint32_t now = millis();
+    if (s && s->ring.due(now, s->mss, TCP_COALESCE_MS)) {
+        drain(*s, now);
+    }
+    xSemaphoreGive(clientsMutex);
+}
+
+void TCPServer::onPoll(AsyncClient* client) {
+    xSemaphoreTake(clientsMutex, portMAX_DELAY);
+    Slot* s = findSlot(client);
+    uint32_t now = millis();
+    AsyncClient* victim = NULL;
+    if (s) {
+        drain(*s, now);
+        victim = evictIfStalled(*s, now);
+    }
+    xSemaphoreGive(clientsMutex);
+    
+    if (victim) {
+        victim->close();
+    }
+}
+
+TCPServer::Slot* TCPServer::findSlot(AsyncClient* client) {
+    if (!client) {
+        return NULL;
+    }
+    for (size_t i = 0; i < TCP_MAX_CLIENTS; i++) {
+        if (slots[i].client == client) {
+            return &slots[i];
+        }
+    }
+    return NULL;
+}
+
 void TCPServer::addClient(AsyncClient* client) {
     if (!client) {
         return;
@@ -159,35 +273,47 @@ void TCPServer::addClient(AsyncClient* client) {
     
     xSemaphoreTake(clientsMutex, portMAX_DELAY);
     
-    if (clients.size() < TCP_MAX_CLIENTS) {
-        clients.push_back(client);
-        
-        // ═══════════════════════════════════════════════════════════════
-        // NOUVEAU: Initialiser les stats pour ce client
-        // ═══════════════════════════════════════════════════════════════
-        ClientStats stats;
-        stats.lastSend = millis();
-        stats.failedSends = 0;
-        stats.totalSent = 0;
-        stats.totalSkipped = 0;
-        clientStats[client] = stats;
-        
-        serialPrintf("[TCP] Client added, total clients: %d/%d\n", 
-                     clients.size(), TCP_MAX_CLIENTS);
-    } else {
-        serialPrintf("[TCP] ⚠️  Max clients reached (%d), rejecting connection from %s\n", 
-                     TCP_MAX_CLIENTS, client->remoteIP().toString().c_str());
-        
-        // Send rejection message before closing
-        const char* msg = "$PMAR,Server Full*00\r\n";
-        if (client->canSend()) {
-            client->write(msg, strlen(msg));
+    Slot* slot = NULL;
+    for (size_t i = 0; !slot && i < TCP_MAX_CLIENTS; i++) {
+        if (!slots[i].client) {
+            slot = &slots[i];
         }
+    }
+    
+    if (slot && initialized) {
+        uint32_t now = millis();
+        slot->client = client;
+        slot->mss    = client->getMss() ? client->getMss() : TCP_DEFAULT_MSS;
+        slot->ring.clear();
+        slot->filter.clear();
+        slot->framer.reset();
+        memset(&slot->stats, 0, sizeof(slot->stats));
+        slot->stats.lastSend = now;
+        clientCount++;
         
-        client->close();
+        serialPrintf("[TCP] Client added, total clients: %u/%u (MSS %u)\n", 
+                     clientCount, TCP_MAX_CLIENTS, slot->mss);
+        
+        // Welcome message goes out ahead of the first batch
+        const char* welcome = "$PMAR,Marine Gateway Connected*00";
+        slot->ring.appendLine(welcome, strlen(welcome), now);
+        drain(*slot, now);
+        xSemaphoreGive(clientsMutex);
+        return;
     }
     
     xSemaphoreGive(clientsMutex);
+    
+    serialPrintf("[TCP] ⚠️  Max clients reached (%d), rejecting connection from %s\n", 
+                 TCP_MAX_CLIENTS, client->remoteIP().toString().c_str());
+    
+    // Send rejection message before closing
+    const char* msg = "$PMAR,Server Full*00\r\n";
+    if (client->canSend()) {
+        client->write(msg, strlen(msg));
+    }
+    
+    client->close();
 }
 
 void TCPServer::removeClient(AsyncClient* client) {
@@ -197,27 +323,78 @@ void TCPServer::removeClient(AsyncClient* client) {
     
     xSemaphoreTake(clientsMutex, portMAX_DELAY);
     
-    auto it = std::find(clients.begin(), clients.end(), client);
-    if (it != clients.end()) {
-        // ═══════════════════════════════════════════════════════════════
-        // NOUVEAU: Afficher les stats avant de retirer le client
-        // ═══════════════════════════════════════════════════════════════
-        auto statsIt = clientStats.find(client);
-        if (statsIt != clientStats.end()) {
-            const ClientStats& stats = statsIt->second;
-            serialPrintf("[TCP] Client %s stats: sent=%u, skipped=%u, fails=%u\n",
-                         client->remoteIP().toString().c_str(),
-                         stats.totalSent, stats.totalSkipped, stats.failedSends);
-            clientStats.erase(statsIt);
-        }
-        
-        clients.erase(it);
-        serialPrintf("[TCP] Client removed, remaining clients: %d\n", clients.size());
+    Slot* s = findSlot(client);
+    if (s) {
+        const ClientStats& stats = s->stats;
+        serialPrintf("[TCP] Client %s stats: sent=%u, skipped=%u, %u bytes in %u segments\n",
+                     client->remoteIP().toString().c_str(),
+                     stats.totalSent, stats.totalSkipped, stats.bytesSent, stats.segments);
+        s->client = NULL;
+        s->ring.clear();
+        clientCount--;
+        serialPrintf("[TCP] Client removed, remaining clients: %u\n", clientCount);
     }
     
     xSemaphoreGive(clientsMutex);
 }
 
+// ═══════════════════════════════════════════════════════════════
+// Batching: ring → AsyncTCP
+// ═══════════════════════════════════════════════════════════════
+
+size_t TCPServer::drain(Slot& s, uint32_t now) {
+    AsyncClient* client = s.client;
+    if (!client || !client->connected()) {
+        return 0;
+    }
+    
+    // Hand over as much as the send buffer takes (two add()s when the ring
+    // wraps), then one send(): lwIP cuts it into MSS-sized segments
+    size_t total = 0;
+    while (s.ring.pending() > 0) {
+        size_t room = client->space();
+        if (room == 0) {
+            break;
+        }
+        const char* data;
+        size_t len = s.ring.peek(data);
+        if (len > room) {
+            len = room;
+        }
+        size_t added = client->add(data, len, ASYNC_WRITE_FLAG_COPY);
+        if (added == 0) {
+            break;
+        }
+        s.ring.consume(added);
+        total += added;
+    }
+    
+    if (total > 0 && client->send()) {
+        s.stats.lastSend = now;
+        s.stats.bytesSent += total;
+        s.stats.segments++;
+        bytesSent    += total;
+        segmentsSent++;
+    }
+    return total;
+}
+
+AsyncClient* TCPServer::evictIfStalled(Slot& s, uint32_t now) {
+    uint32_t stalled = s.ring.overflowingFor(now);
+    if (!s.client || stalled < TCP_CLIENT_STALL_MS) {
+        return NULL;
+    }
+    
+    AsyncClient* client = s.client;
+    serialPrintf("[TCP] Disconnecting %s: output ring full for %u ms (%u sentences dropped)\n",
+                 client->remoteIP().toString().c_str(), stalled, s.stats.totalSkipped);
+    s.client = NULL;
+    s.ring.clear();
+    clientCount--;
+    evictions++;
+    return client;
+}
+
 void TCPServer::broadcast(const char* data) {
     if (!data) {
         return;
@@ -225,226 +402,154 @@ void TCPServer::broadcast(const char* data) {
     broadcast(data, strlen(data));
 }
 
-void TCPServer::broadcast(const char* data, size_t len) {
+void TCPServer::broadcast(const char* data, size_t len, uint8_t except) {
     if (!running || !data || len == 0) {
         return;
     }
-    
-    xSemaphoreTake(clientsMutex, portMAX_DELAY);
-    
-    if (clients.empty()) {
-        xSemaphoreGive(clientsMutex);
-        return;
+    if (len > NMEA_MAX_LENGTH + 2) {
+        len = NMEA_MAX_LENGTH + 2;   // Never a valid sentence; keep the ring sane
     }
     
-    // ═══════════════════════════════════════════════════════════════
-    // Prepare data with CRLF if not already present
-    // ═══════════════════════════════════════════════════════════════
-    char buffer[NMEA_MAX_LENGTH + 3];  // +3 for \r\n\0
-    size_t sendLen = len;
+    AsyncClient* victims[TCP_MAX_CLIENTS];
+    size_t victimCount = 0;
+    uint32_t now = millis();
     
-    // Check if data already has CRLF
-    bool hasCRLF = (len >= 2 && data[len-2] == '\r' && data[len-1] == '\n');
+    // Address and AIS fragment info, parsed once for every client's filter
+    SentenceKey key;
+    bool keyed = key.parse(data, len);
     
-    if (len < sizeof(buffer) - 2) {
-        memcpy(buffer, data, len);
-        
-        if (!hasCRLF) {
-            buffer[len++] = '\r';
-            buffer[len++] = '\n';
-        }
-        buffer[len] = '\0';
-        sendLen = len;
-    } else {
-        // Data too long, just use as-is
-        memcpy(buffer, data, sizeof(buffer) - 1);
-        buffer[sizeof(buffer) - 1] = '\0';
-        sendLen = sizeof(buffer) - 1;
-    }
-    
-    // ═══════════════════════════════════════════════════════════════
-    // NOUVEAU: Système de throttling intelligent
-    // ═══════════════════════════════════════════════════════════════
-    uint32_t now = millis();
-    size_t sentCount = 0;
-    size_t skippedCount = 0;
-    size_t errorCount = 0;
+    xSemaphoreTake(clientsMutex, portMAX_DELAY);
     
-    for (auto it = clients.begin(); it != clients.end(); ) {
-        AsyncClient* client = *it;
-        
-        // Check if client is still connected
-        if (!client || !client->connected()) {
-            serialPrintf("[TCP] Removing disconnected client during broadcast\n");
-            
-            // Clean up stats
-            auto statsIt = clientStats.find(client);
-            if (statsIt != clientStats.end()) {
-                clientStats.erase(statsIt);
-            }
-            
-            it = clients.erase(it);
+    for (size_t i = 0; i < TCP_MAX_CLIENTS; i++) {
+        Slot& s = slots[i];
+        if (!s.client || i == except) {
             continue;
         }
         
-        // Get client stats
-        auto& stats = clientStats[client];
-        
-        // ═══════════════════════════════════════════════════════════════
-        // NOUVEAU: Vérifier si le client peut recevoir
-        // ═══════════════════════════════════════════════════════════════
-        if (!client->canSend()) {
-            stats.failedSends++;
-            stats.totalSkipped++;
-            skippedCount++;
-            
-            // ═══════════════════════════════════════════════════════════════
-            // Politique de déconnexion intelligente:
-            // 1. Plus de 100 échecs consécutifs → déconnexion
-            // 2. Plus de 10 secondes bloqué ET > 10 échecs → déconnexion
-            // 3. Plus de 30 secondes bloqué → déconnexion inconditionnelle
-            // ═══════════════════════════════════════════════════════════════
-            uint32_t timeSinceLastSend = now - stats.lastSend;
-            
-            bool shouldDisconnect = false;
-            const char* reason = "";
-            
-            if (stats.failedSends > 100) {
-                shouldDisconnect = true;
-                reason = "too many consecutive failures (>100)";
-            } else if (timeSinceLastSend > 30000) {
-                shouldDisconnect = true;
-                reason = "blocked for >30 seconds";
-            } else if (timeSinceLastSend > 10000 && stats.failedSends > 10) {
-                shouldDisconnect = true;
-                reason = "blocked for >10s with failures";
-            }
-            
-            if (shouldDisconnect) {
-                serialPrintf("[TCP] Disconnecting %s: %s (fails=%u, blocked=%ums)\n", 
-                             client->remoteIP().toString().c_str(),
-                             reason,
-                             stats.failedSends,
-                             timeSinceLastSend);
-                
-                client->close();
-                clientStats.erase(client);
-                it = clients.erase(it);
-                errorCount++;
-                continue;
-            }
-            
-            // Sinon, skip ce message pour ce client
-            ++it;
+        if (keyed && s.filter.active() && !s.filter.accept(key, now)) {
+            s.stats.totalFiltered++;
+            sentencesFiltered++;
             continue;
         }
         
-        // ═══════════════════════════════════════════════════════════════
-        // Client prêt - envoyer les données
-        // ═══════════════════════════════════════════════════════════════
-        size_t written = client->write(buffer, sendLen);
-        
-        if (written == sendLen) {
-            // Succès complet
-            stats.failedSends = 0;  // Reset compteur d'échecs
-            stats.lastSend = now;
-            stats.totalSent++;
-            sentCount++;
+        if (s.ring.appendLine(data, len, now)) {
+            s.stats.totalSent++;
         } else {
-            // Écriture partielle ou échec
-            serialPrintf("[TCP] ⚠️  Partial write to %s (%u/%u bytes)\n", 
-                         client->remoteIP().toString().c_str(), written, sendLen);
-            stats.failedSends++;
-            errorCount++;
-        }
-        
-        ++it;
-    }
-    
-    // ═══════════════════════════════════════════════════════════════
-    // NOUVEAU: Logging périodique intelligent (évite le spam)
-    // ═══════════════════════════════════════════════════════════════
-    static uint32_t lastLog = 0;
-    static uint32_t broadcastCount = 0;
-    static uint32_t totalSent = 0;
-    static uint32_t totalSkipped = 0;
-    static uint32_t totalErrors = 0;
-    
-    broadcastCount++;
-    totalSent += sentCount;
-    totalSkipped += skippedCount;
-    totalErrors += errorCount;
-    
-    // Log toutes les 30 secondes
-    if (now - lastLog > 30000) {
-        if (clients.size() > 0) {
-            serialPrintf("\n[TCP] ═══════ Broadcast Stats (30s) ═══════\n");
-            serialPrintf("[TCP] Messages: %u broadcasts to %d clients\n", 
-                         broadcastCount, clients.size());
-            serialPrintf("[TCP] Sent: %u (%.1f%%)\n", 
-                         totalSent, 
-                         (float)totalSent / (broadcastCount * clients.size()) * 100.0f);
-            
-            if (totalSkipped > 0) {
-                serialPrintf("[TCP] ⚠️  Skipped: %u (%.1f%%) - clients too slow\n", 
-                             totalSkipped,
-                             (float)totalSkipped / (broadcastCount * clients.size()) * 100.0f);
-            }
-            
-            if (totalErrors > 0) {
-                serialPrintf("[TCP] ❌ Errors: %u\n", totalErrors);
-            }
-            
-            // Stats détaillées par client
-            for (auto client : clients) {
-                auto& stats = clientStats[client];
-                uint32_t age = now - stats.lastSend;
-                
-                if (stats.totalSkipped > 0 || age > 5000) {
-                    serialPrintf("[TCP]   Client %s: sent=%u, skipped=%u, age=%ums",
-                                 client->remoteIP().toString().c_str(),
-                                 stats.totalSent, stats.totalSkipped, age);
-                    
-                    if (stats.failedSends > 0) {
-                        serialPrintf(", current_fails=%u", stats.failedSends);
-                    }
-                    
-                }
+            s.stats.totalSkipped++;
+            sentencesDropped++;
+            AsyncClient* victim = evictIfStalled(s, now);
+            if (victim) {
+                victims[victimCount++] = victim;
+                continue;
             }
-            
-            serialPrintf("[TCP] ════════════════════════════════════\n");
         }
         
-        lastLog = now;
-        broadcastCount = 0;
-        totalSent = 0;
-        totalSkipped = 0;
-        totalErrors = 0;
+        if (s.ring.due(now, s.mss, TCP_COALESCE_MS)) {
+            drain(s, now);
+        }
     }
     
+    logStats(now);
+    
     xSemaphoreGive(clientsMutex);
+    
+    for (size_t i = 0; i < victimCount; i++) {
+        victims[i]->close();
+    }
 }
 
-size_t TCPServer::getClientCount() {
+void TCPServer::flush() {
+    if (!running || clientCount == 0) {
+        return;
+    }
+    
+    AsyncClient* victims[TCP_MAX_CLIENTS];
+    size_t victimCount = 0;
+    uint32_t now = millis();
+    
     xSemaphoreTake(clientsMutex, portMAX_DELAY);
-    size_t count = clients.size();
+    for (size_t i = 0; i < TCP_MAX_CLIENTS; i++) {
+        Slot& s = slots[i];
+        if (!s.client) {
+            continue;
+        }
+        if (s.ring.due(now, s.mss, TCP_COALESCE_MS)) {
+            drain(s, now);
+        }
+        AsyncClient* victim = evictIfStalled(s, now);
+        if (victim) {
+            victims[victimCount++] = victim;
+        }
+    }
     xSemaphoreGive(clientsMutex);
-    return count;
+    
+    for (size_t i = 0; i < victimCount; i++) {
+        victims[i]->close();
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Logging périodique (évite le spam)
+// ═══════════════════════════════════════════════════════════════
+void TCPServer::logStats(uint32_t now) {
+    if (now - lastStatsLog <= 30000) {
+        return;
+    }
+    lastStatsLog = now;
+    if (clientCount == 0) {
+        return;
+    }
+    
+    serialPrintf("\n[TCP] ═══════ Client Stats ═══════\n");
+    for (size_t i = 0; i < TCP_MAX_CLIENTS; i++) {
+        const Slot& s = slots[i];
+        if (!s.client) {
+            continue;
+        }
+        const ClientStats& st = s.stats;
+        serialPrintf("[TCP]   Client %s: sent=%u, skipped=%u, filtered=%u (%u rules), %u segments (%.1f sentences/segment), pending=%u B\n",
+                     s.client->remoteIP().toString().c_str(),
+                     st.totalSent, st.totalSkipped, st.totalFiltered, s.filter.rules(), st.segments,
+                     st.segments ? (float)st.totalSent / st.segments : 0.0f,
+                     s.ring.pending());
+    }
+    serialPrintf("[TCP] ════════════════════════════════════\n");
 }
 
 // ═══════════════════════════════════════════════════════════════
-// NOUVEAU: Méthode pour obtenir les stats d'un client
+// Stats d'un client
 // ═══════════════════════════════════════════════════════════════
 bool TCPServer::getClientStats(AsyncClient* client, ClientStats& stats) {
     xSemaphoreTake(clientsMutex, portMAX_DELAY);
     
-    auto it = clientStats.find(client);
-    if (it != clientStats.end()) {
-        stats = it->second;
+    Slot* s = findSlot(client);
+    if (s) {
+        stats = s->stats;
         xSemaphoreGive(clientsMutex);
         return true;
     }
     
     xSemaphoreGive(clientsMutex);
     return false;
-}
\ No newline at end of file
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Métriques /metrics
+// ═══════════════════════════════════════════════════════════════
+namespace {
+
+int64_t readTcpClients(const void* ctx) {
+    return (int64_t)static_cast<const TCPServer*>(ctx)->getClientCount();
+}
+
+} // namespace
+
+void TCPServer::registerMetrics(MetricsRegistry& reg) {
+    reg.addGauge("espnav_tcp_clients", "Clients connected to the NMEA TCP server", readTcpClients, this);
+    reg.addCounter("espnav_tcp_bytes", "Bytes handed to lwIP for TCP clients", &bytesSent);
+    reg.addCounter("espnav_tcp_batches", "Coalesced writes to TCP clients", &segmentsSent);
+    reg.addCounter("espnav_tcp_dropped", "Sentences dropped on a full client ring", &sentencesDropped);
+    reg.addCounter("espnav_tcp_filtered", "Sentences withheld by client $PMAR,FILTER rules", &sentencesFiltered);
+    reg.addCounter("espnav_tcp_evictions", "Clients disconnected for a stalled ring", &evictions);
+    reg.addCounter("espnav_tcp_input", "Sentences received from TCP clients", &linesReceived);
+}
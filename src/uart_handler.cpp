@@ -1,29 +1,47 @@
 #include "uart_handler.h"
 #include "functions.h"
+#include "metrics.h"
 #include <driver/uart.h>
 
-UARTHandler::UARTHandler() 
-    : streamBuffer(NULL), taskHandle(NULL), initialized(false), running(false),
-      sentencesReceived(0), errors(0), linePos(0) {
-    memset(lineBuffer, 0, sizeof(lineBuffer));
+namespace {
+struct PortPins {
+    uart_port_t uart;
+    gpio_num_t  rx;
+    gpio_num_t  tx;
+};
+
+const PortPins kPorts[NMEA_PORT_MAX] = {
+    { UART_NUM,  UART_RX_PIN,  UART_TX_PIN  },
+    { UART2_NUM, UART2_RX_PIN, UART2_TX_PIN },
+    { UART3_NUM, UART3_RX_PIN, UART3_TX_PIN },
+};
+}
+
+UARTHandler::UARTHandler()
+    : port(0), uartNum(UART_NUM), eventQueue(NULL), taskHandle(NULL),
+      initialized(false), running(false), errors(0), overflows(0),
+      txUsPerByte(0), txIdleUs(0), txSentences(0), txDropped(0) {
 }
 
 UARTHandler::~UARTHandler() {
     stop();
-    if (streamBuffer) {
-        vStreamBufferDelete(streamBuffer);
+    if (initialized) {
+        uart_driver_delete((uart_port_t)uartNum);
     }
 }
 
-void UARTHandler::init(const UARTConfig& cfg) {
-    if (initialized) {
+void UARTHandler::init(uint8_t portIndex, const UARTConfig& cfg) {
+    if (initialized || portIndex >= NMEA_PORT_MAX) {
         return;
     }
-    
-    config = cfg;
-    
+
+    port    = portIndex;
+    config  = cfg;
+    uartNum = kPorts[port].uart;
+    const uart_port_t uart = kPorts[port].uart;
+
     // Configure GPIO with pull-up
-    gpio_set_pull_mode(UART_RX_PIN, GPIO_PULLUP_ONLY);
+    gpio_set_pull_mode(kPorts[port].rx, GPIO_PULLUP_ONLY);
 
     // Configure UART
     uart_config_t uart_config = {
@@ -35,152 +53,183 @@ void UARTHandler::init(const UARTConfig& cfg) {
         .rx_flow_ctrl_thresh = 122,
         .source_clk = UART_SCLK_APB,
     };
-    
-    uart_param_config(UART_NUM, &uart_config);
-    uart_set_pin(UART_NUM, UART_TX_PIN, UART_RX_PIN, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
-    uart_driver_install(UART_NUM, UART_BUFFER_SIZE, 0, 0, NULL, 0);
-    
+
+    uart_param_config(uart, &uart_config);
+    uart_set_pin(uart, kPorts[port].tx, kPorts[port].rx, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE);
+    uart_driver_install(uart, UART_BUFFER_SIZE, UART_TX_BUFFER_SIZE, UART_EVENT_QUEUE_SIZE, &eventQueue, 0);
+
+    uint32_t bits = 1 + config.dataBits + (config.parity ? 1 : 0) + (config.stopBits >= 2 ? 2 : 1);
+    txUsPerByte   = (bits * 1000000UL + config.baudRate - 1) / config.baudRate;
+
+    // Wake the RX task at each end of sentence rather than polling.  The
+    // RX FIFO threshold / timeout events still deliver partial data.
+    uart_enable_pattern_det_baud_intr(uart, '\n', 1, 9, 0, 0);
+    uart_pattern_queue_reset(uart, UART_PATTERN_QUEUE_SIZE);
+
     // Flush any existing data in UART buffer
-    uart_flush(UART_NUM);
-    
-    // Create stream buffer (AUGMENTÉ: 4096 au lieu de 1024)
-    streamBuffer = xStreamBufferCreate(UART_BUFFER_SIZE, 1);
-    
+    uart_flush_input(uart);
+
     initialized = true;
-    
-    serialPrintf("[UART] Initialized: Baud=%u, Data=%u, Parity=%u, Stop=%u, RX=GPIO%u, TX=GPIO%u\n",
-                  config.baudRate, config.dataBits, config.parity, config.stopBits, 
-                  UART_RX_PIN, UART_TX_PIN);
-    serialPrintf("[UART] Stream buffer size: %u bytes\n", UART_BUFFER_SIZE);
+
+    serialPrintf("[UART%u] Initialized: UART%d, Baud=%u, Data=%u, Parity=%u, Stop=%u, RX=GPIO%u, TX=GPIO%u\n",
+                  port, uartNum, config.baudRate, config.dataBits, config.parity, config.stopBits,
+                  kPorts[port].rx, kPorts[port].tx);
+    serialPrintf("[UART%u] Driver buffer: %u bytes, event queue: %u, read block: %u bytes\n",
+                  port, UART_BUFFER_SIZE, UART_EVENT_QUEUE_SIZE, UART_READ_BLOCK);
+}
+
+void UARTHandler::setLineHandler(NMEALineHandler handler, void* ctx) {
+    framer.setHandler(handler, ctx);
 }
 
 void UARTHandler::start() {
     if (!initialized || running) {
         return;
     }
-    
+
     running = true;
-    xTaskCreate(uartTask, "UART_RX", TASK_STACK_UART, this, TASK_PRIORITY_UART, &taskHandle);
-    
-    serialPrintf("[UART] Started\n");
+    // Core 0, next to the SeaTalk task; the web / TCP side runs on core 1
+    char name[configMAX_TASK_NAME_LEN];
+    snprintf(name, sizeof(name), "UART_RX%u", port);
+    xTaskCreatePinnedToCore(uartTask, name, TASK_STACK_UART, this, TASK_PRIORITY_UART,
+                            &taskHandle, 0);
+
+    serialPrintf("[UART%u] Started\n", port);
 }
 
 void UARTHandler::stop() {
     if (!running) {
         return;
     }
-    
+
     running = false;
-    
+
     if (taskHandle) {
         vTaskDelete(taskHandle);
         taskHandle = NULL;
     }
-    
-    serialPrintf("[UART] Stopped\n");
+
+    serialPrintf("[UART%u] Stopped\n", port);
 }
 
 void UARTHandler::uartTask(void* parameter) {
     UARTHandler* handler = static_cast<UARTHandler*>(parameter);
-    
-    uint8_t data[128];
-    
-    while (handler->running) {
-        int len = uart_read_bytes(UART_NUM, data, sizeof(data), pdMS_TO_TICKS(100));
-        
-        if (len > 0) {
-            // Send to stream buffer
-            xStreamBufferSend(handler->streamBuffer, data, len, 0);
-        }
-    }
-    
+    handler->handleEvents();
     vTaskDelete(NULL);
 }
 
-bool UARTHandler::readLine(char* buffer, size_t maxLen, TickType_t timeout) {
-    if (!initialized || !streamBuffer) {
-        return false;
-    }
-    
-    uint32_t startTime = millis();
-    uint32_t timeoutMs = pdTICKS_TO_MS(timeout);
-    
-    while (millis() - startTime < timeoutMs) {
-        uint8_t byte;
-        size_t received = xStreamBufferReceive(streamBuffer, &byte, 1, pdMS_TO_TICKS(10));
-        
-        if (received == 0) {
-            continue;
-        }
-        
-        // ═══════════════════════════════════════════════════════════════
-        // CORRECTION 1: Détection de début de message NMEA/AIS
-        // ═══════════════════════════════════════════════════════════════
-        if (byte == '$' || byte == '!') {
-            // Nouveau message détecté - reset buffer
-            linePos = 0;
-            lineBuffer[linePos++] = byte;
-            continue;
-        }
-        
-        // ═══════════════════════════════════════════════════════════════
-        // CORRECTION 2: Protection améliorée contre buffer overflow
-        // ═══════════════════════════════════════════════════════════════
-        if (linePos < sizeof(lineBuffer) - 1) {
-            // Espace disponible - ajouter le caractère
-            lineBuffer[linePos++] = byte;
-        } else {
-            // Buffer plein - comportement selon le caractère
-            if (byte == '\n' || byte == '\r') {
-                // Fin de ligne sur un message trop long
-                // On reset et on compte comme erreur
-                linePos = 0;
-                errors++;
-                serialPrintf("[UART] ⚠️  Line too long, dropped\n");
-                continue;
-            }
-            // Sinon, ignorer le caractère et continuer
-            // (attendre le prochain $ ou fin de ligne)
+// ============================================================
+// Event loop
+// ============================================================
+
+void UARTHandler::handleEvents() {
+    uart_event_t event;
+
+    while (running) {
+        if (xQueueReceive(eventQueue, &event, pdMS_TO_TICKS(100)) != pdTRUE) {
             continue;
         }
-        
-        // ═══════════════════════════════════════════════════════════════
-        // Détection de fin de ligne
-        // ═══════════════════════════════════════════════════════════════
-        if (byte == '\n') {
-            // Remove line ending
-            if (linePos > 1 && lineBuffer[linePos - 2] == '\r') {
-                // CRLF ending
-                lineBuffer[linePos - 2] = '\0';
-                size_t copyLen = min(linePos - 2, maxLen - 1);
-                strncpy(buffer, lineBuffer, copyLen);
-                buffer[copyLen] = '\0';
-            } else {
-                // LF only ending
-                lineBuffer[linePos - 1] = '\0';
-                size_t copyLen = min(linePos - 1, maxLen - 1);
-                strncpy(buffer, lineBuffer, copyLen);
-                buffer[copyLen] = '\0';
-            }
-            
-            linePos = 0;
-            
-            // ═══════════════════════════════════════════════════════════════
-            // CORRECTION 3: Validation basique avant de retourner
-            // Vérifier que le message commence bien par $ ou !
-            // ═══════════════════════════════════════════════════════════════
-            if (buffer[0] == '$' || buffer[0] == '!') {
-                sentencesReceived++;
-                return true;
-            } else {
-                // Message invalide (ne commence pas par $ ou !)
-                // Probablement dû à une synchronisation perdue
+
+        switch (event.type) {
+            case UART_DATA:
+            case UART_PATTERN_DET:
+                drainRx();
+                break;
+
+            case UART_BUFFER_FULL:
+                // We fell behind but nothing is lost yet: catch up
+                overflows++;
+                drainRx();
+                break;
+
+            case UART_FIFO_OVF:
+                // Bytes were dropped in hardware: the partial sentence is garbage
+                overflows++;
+                uart_flush_input((uart_port_t)uartNum);
+                xQueueReset(eventQueue);
+                framer.reset();
+                serialPrintf("[UART%u] ⚠️  RX FIFO overflow, input flushed\n", port);
+                break;
+
+            case UART_FRAME_ERR:
+            case UART_PARITY_ERR:
                 errors++;
-                serialPrintf("[UART] ⚠️  Invalid message start: '%c' (expected $ or !)\n", buffer[0]);
-                continue;
-            }
+                break;
+
+            default:
+                break;
         }
     }
-    
-    return false;
-}
\ No newline at end of file
+}
+
+void UARTHandler::drainRx() {
+    const uart_port_t uart = (uart_port_t)uartNum;
+    size_t available = 0;
+    uart_get_buffered_data_len(uart, &available);
+
+    while (available > 0) {
+        size_t want = available < sizeof(block) ? available : sizeof(block);
+        int n = uart_read_bytes(uart, (uint8_t*)block, want, 0);
+        if (n <= 0) break;
+        framer.feed(block, (size_t)n);
+        available -= (size_t)n;
+    }
+
+    // The framer finds line ends itself: discard the driver's '\n'
+    // positions so its pattern queue never fills up
+    while (uart_pattern_pop_pos(uart) >= 0) {
+    }
+}
+
+// ============================================================
+// TX
+// ============================================================
+
+bool UARTHandler::send(const char* line, size_t len) {
+    if (!running || len > NMEA_MAX_LENGTH) {
+        txDropped++;
+        return false;
+    }
+
+    // What is still queued drains at the line rate; never wait for room
+    uint32_t now = micros();
+    if ((int32_t)(txIdleUs - now) < 0) txIdleUs = now;
+    uint32_t queued = (txIdleUs - now) / txUsPerByte;
+    if (queued + len + 2 > UART_TX_BUFFER_SIZE) {
+        txDropped++;
+        return false;
+    }
+
+    char out[NMEA_MAX_LENGTH + 2];
+    memcpy(out, line, len);
+    out[len]     = '\r';
+    out[len + 1] = '\n';
+    uart_write_bytes((uart_port_t)uartNum, out, len + 2);
+
+    txIdleUs += (uint32_t)(len + 2) * txUsPerByte;
+    txSentences++;
+    return true;
+}
+
+// ============================================================
+// Metrics
+// ============================================================
+
+namespace {
+
+int64_t readUartSentences(const void* ctx) { return static_cast<const UARTHandler*>(ctx)->getSentencesReceived(); }
+int64_t readUartErrors(const void* ctx)    { return static_cast<const UARTHandler*>(ctx)->getErrors(); }
+int64_t readUartOverflows(const void* ctx) { return static_cast<const UARTHandler*>(ctx)->getOverflows(); }
+int64_t readUartTxSent(const void* ctx)    { return static_cast<const UARTHandler*>(ctx)->getTxSentences(); }
+int64_t readUartTxDropped(const void* ctx) { return static_cast<const UARTHandler*>(ctx)->getTxDropped(); }
+
+} // namespace
+
+void UARTHandler::registerMetrics(MetricsRegistry& reg) const {
+    const char* label = metricsPortLabel(port);
+    reg.addCounter("espnav_uart_sentences", "Sentences framed per input port", readUartSentences, this, label);
+    reg.addCounter("espnav_uart_errors", "Line, frame and parity errors per input port", readUartErrors, this, label);
+    reg.addCounter("espnav_uart_overflows", "RX FIFO / driver buffer overflows per input port", readUartOverflows, this, label);
+    reg.addCounter("espnav_uart_tx_sentences", "Routed sentences written out of the port's TX pin", readUartTxSent, this, label);
+    reg.addCounter("espnav_uart_tx_dropped", "Routed sentences dropped because the TX line was full", readUartTxDropped, this, label);
+}
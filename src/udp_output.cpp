@@ -0,0 +1,114 @@
+#include "udp_output.h"
+#include "functions.h"
+#include "metrics.h"
+#include <WiFi.h>
+
+UDPOutput::UDPOutput()
+    : target(255, 255, 255, 255), batch(onDatagram, this),
+      initialized(false), running(false), bytesSent(0), sendErrors(0) {
+}
+
+void UDPOutput::init(const UDPConfig& c) {
+    if (initialized) {
+        return;
+    }
+
+    config = c;
+    if (config.mode == 1) {
+        if (!target.fromString(config.group) || target[0] < 224 || target[0] > 239) {
+            serialPrintf("[UDP] ⚠️  Invalid multicast group %s, broadcasting instead\n", config.group);
+            config.mode = 0;
+            target = IPAddress(255, 255, 255, 255);
+        }
+    }
+
+    uint16_t size   = constrain(config.maxDatagram, UDP_MIN_DATAGRAM, DATAGRAM_MAX);
+    uint16_t waitMs = constrain(config.maxDelayMs, UDP_MIN_DELAY_MS, UDP_MAX_DELAY_MS);
+    batch.setLimits(size, waitMs);
+
+    initialized = true;
+
+    serialPrintf("[UDP] Initialized: %s port %u, datagrams ≤ %u B / %u ms%s\n",
+                 config.mode == 0 ? "broadcast" : config.group, config.port, size, waitMs,
+                 config.enabled ? "" : " (disabled)");
+}
+
+void UDPOutput::start() {
+    if (!initialized || running || !config.enabled) {
+        return;
+    }
+
+    running = true;
+    serialPrintf("[UDP] ✓ Sending to %s:%u\n", target.toString().c_str(), config.port);
+}
+
+void UDPOutput::stop() {
+    if (!running) {
+        return;
+    }
+
+    batch.flush();
+    running = false;
+    udp.close();
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Envoi
+// ═══════════════════════════════════════════════════════════════
+
+void UDPOutput::broadcast(const char* data) {
+    if (data) broadcast(data, strlen(data));
+}
+
+void UDPOutput::broadcast(const char* data, size_t len) {
+    if (!running || len == 0) {
+        return;
+    }
+    batch.add(data, len, millis());
+}
+
+void UDPOutput::flush() {
+    if (running) batch.poll(millis());
+}
+
+uint32_t UDPOutput::msUntilFlush() const {
+    return running ? batch.msUntilDue(millis()) : UDP_MAX_DELAY_MS;
+}
+
+void UDPOutput::onDatagram(const char* data, size_t len, void* ctx) {
+    static_cast<UDPOutput*>(ctx)->send(data, len);
+}
+
+void UDPOutput::send(const char* data, size_t len) {
+    // Out of the interface clients are on: the soft-AP in AP mode
+    tcpip_adapter_if_t iface = WiFi.getMode() == WIFI_AP ? TCPIP_ADAPTER_IF_AP : TCPIP_ADAPTER_IF_STA;
+    size_t sent = udp.writeTo((const uint8_t*)data, len, target, config.port, iface);
+    if (sent == len) {
+        bytesSent += len;
+    } else {
+        sendErrors++;
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Metrics
+// ═══════════════════════════════════════════════════════════════
+
+namespace {
+
+int64_t readUdpDatagrams(const void* ctx) {
+    return static_cast<const UDPOutput*>(ctx)->getDatagramsSent();
+}
+
+int64_t readUdpSentences(const void* ctx) {
+    return static_cast<const UDPOutput*>(ctx)->getSentencesSent();
+}
+
+} // namespace
+
+void UDPOutput::registerMetrics(MetricsRegistry& reg) {
+    reg.addCounter("espnav_udp_datagrams", "UDP datagrams sent", readUdpDatagrams, this);
+    reg.addCounter("espnav_udp_sentences", "Sentences sent over UDP", readUdpSentences, this);
+    reg.addCounter("espnav_udp_bytes", "Bytes sent over UDP", &bytesSent);
+    reg.addCounter("espnav_udp_send_errors", "UDP datagrams lwIP refused (no route, no buffer)", &sendErrors);
+}
@@ -11,13 +11,26 @@
 #include "config_manager.h"
 #include "wifi_manager.h"
 #include "uart_handler.h"
+#include "nmea_merge.h"
+#include "sentence_pool.h"
+#include "index_ring.h"
+#include "pipeline_stats.h"
+#include "metrics.h"
 #include "tcp_server.h"
+#include "udp_output.h"
+#include "nmea_router.h"
 #include "nmea_parser.h"
 #include "polar.h"
 #include "functions.h"
 #include "log_manager.h"
+#include "json_writer.h"
+#include "boat_poll.h"
+#include "http_range.h"
 
 #include <ArduinoJson.h>
+#include <atomic>
+#include <memory>
+#include <time.h>
 #include <Update.h>
 #include <esp_ota_ops.h>
 #include <esp_partition.h>
@@ -25,20 +38,83 @@
 // External variables from main.cpp for monitoring
 extern volatile uint32_t g_nmeaQueueOverflows;
 extern volatile uint32_t g_nmeaQueueFullEvents;
-extern QueueHandle_t nmeaQueue;
+extern IndexRing<NMEA_QUEUE_SIZE> nmeaQueue;
+extern SentencePool sentencePool;
+extern PipelineStats pipelineStats;
+extern NMEAMerger nmeaMerger;
+extern UDPOutput udpOutput;
+extern NMEARouter nmeaRouter;
+extern MetricsRegistry metrics;
+
+// ── Streamed JSON responses ───────────────────────────────────────────────────
+//
+// The documents that grow with the data (AIS targets, SD files) or are
+// large anyway are not built as a JsonDocument and a String: a JsonProducer
+// writes them part by part into a JsonStream, which fills the chunked
+// response buffer as AsyncTCP asks for it.  The producer's cursor lives in
+// a JsonResponse owned by the response callback and is freed with it, so
+// a request costs a fixed ~600 bytes however long the document.
+
+namespace {
+
+struct JsonResponse {
+    JsonStream stream;
+
+    JsonResponse(JsonProducer fn, void* ctx) : stream(fn, ctx) {}
+    virtual ~JsonResponse() {}
+};
+
+AsyncWebServerResponse* beginJsonStream(AsyncWebServerRequest* request, JsonResponse* body) {
+    std::shared_ptr<JsonResponse> owner(body);
+    return request->beginChunkedResponse(
+        "application/json",
+        [owner](uint8_t* buf, size_t maxLen, size_t index) -> size_t {
+            size_t n = owner->stream.read(buf, maxLen);
+            if (n == 0 && owner->stream.failed()) {
+                serialPrintf("[Web] ❌ JSON part over %u bytes, response cut short\n", JSON_STREAM_PART_MAX);
+            }
+            return n;
+        });
+}
+
+void sendJsonStream(AsyncWebServerRequest* request, JsonResponse* body) {
+    request->send(beginJsonStream(request, body));
+}
+
+// Sections each boat data endpoint reads, by WebServer::BoatEndpoint
+const uint32_t kBoatEndpointMask[] = {
+    BOAT_MASK(BOAT_SECTION_GPS) | BOAT_MASK(BOAT_SECTION_SPEED) |
+    BOAT_MASK(BOAT_SECTION_HEADING) | BOAT_MASK(BOAT_SECTION_DEPTH),   // navigation
+    BOAT_MASK(BOAT_SECTION_WIND),                                      // wind
+    BOAT_MASK(BOAT_SECTION_AIS),                                       // ais
+    BOAT_MASK_ALL,                                                     // state
+    BOAT_MASK(BOAT_SECTION_PERFORMANCE)                                // performance
+};
+
+// What each cached body is built from, by WebServer::CachedResponse
+const uint32_t kCachedSources[] = {
+    CACHE_MASK(CACHE_SOURCE_LITTLEFS),                                 // storage info
+    CACHE_MASK(CACHE_SOURCE_LITTLEFS),                                 // storage files
+    CACHE_MASK(CACHE_SOURCE_LITTLEFS) | CACHE_MASK(CACHE_SOURCE_POLAR), // polar status
+    CACHE_MASK(CACHE_SOURCE_SD)                                        // SD status
+};
+
+} // namespace
 
 // ── Constructor ───────────────────────────────────────────────────────────────
 
 WebServer::WebServer(ConfigManager* cm, WiFiManager* wm, TCPServer* tcp, UARTHandler* uart,
                      NMEAParser* nmea, BoatState* bs, BLEManager* ble,
                      SeatalkManager* stMgr, LogManager* logManager, SDManager* sdMgr)
-    : configManager(cm), wifiManager(wm), tcpServer(tcp), uartHandler(uart),
+    : configManager(cm), wifiManager(wm), tcpServer(tcp), uartPorts(uart),
       nmeaParser(nmea), boatState(bs), bleManager(ble),
       seatalkManager(stMgr), logManager(logManager), sdManager(sdMgr), running(false),
       otaInProgress(false), otaSuccess(false),
       otaExpectedSize(0), otaBytesWritten(0) {
     server = new AsyncWebServer(WEB_SERVER_PORT);
-    wsNMEA = new AsyncWebSocket("/ws/nmea");
+    wsNMEA = new WSStream("/ws/nmea");
+    wsState = new WSState("/ws/state", bs);
+    boatPoll = new BoatPoll(bs, sendBoatData, this);
 }
 
 // ── init ──────────────────────────────────────────────────────────────────────
@@ -52,12 +128,12 @@ void WebServer::init() {
     if (boatState) boatState->setDampingTau(tau);
     serialPrintf("[Web] Performance damping tau: %.1f s\n", tau);
 
-    wsNMEA->onEvent([this](AsyncWebSocket* server, AsyncWebSocketClient* client,
-                           AwsEventType type, void* arg, uint8_t* data, size_t len) {
-        this->handleWebSocketEvent(server, client, type, arg, data, len);
-    });
-
-    server->addHandler(wsNMEA);
+    wsNMEA->init();
+    server->addHandler(wsNMEA->handler());
+    wsState->init();
+    server->addHandler(wsState->handler());
+    boatPoll->init();
+    if (sdManager) sdManager->setChangeListener(onSDChange, this);
     registerRoutes();
 }
 
@@ -124,10 +200,42 @@ void WebServer::registerRoutes() {
         }
     );
 
+    server->on("/api/config/udp", HTTP_GET, [this](AsyncWebServerRequest* request) {
+        this->handleGetUDPConfig(request);
+    });
+    server->on("/api/config/udp", HTTP_POST,
+        [](AsyncWebServerRequest* request) {},
+        NULL,
+        [this](AsyncWebServerRequest* request, uint8_t* data, size_t len,
+               size_t index, size_t total) {
+            this->handlePostUDPConfig(request, data, len);
+        }
+    );
+
+    server->on("/api/config/routes", HTTP_GET, [this](AsyncWebServerRequest* request) {
+        this->handleGetRoutes(request);
+    });
+    server->on("/api/config/routes", HTTP_POST,
+        [](AsyncWebServerRequest* request) {},
+        NULL,
+        [this](AsyncWebServerRequest* request, uint8_t* data, size_t len,
+               size_t index, size_t total) {
+            this->handlePostRoutes(request, data, len);
+        }
+    );
+
     server->on("/api/status", HTTP_GET, [this](AsyncWebServerRequest* request) {
         this->handleGetStatus(request);
     });
 
+    server->on("/api/metrics", HTTP_GET, [this](AsyncWebServerRequest* request) {
+        this->handleGetMetrics(request);
+    });
+
+    server->on("/metrics", HTTP_GET, [this](AsyncWebServerRequest* request) {
+        this->handleGetOpenMetrics(request);
+    });
+
     server->on("/api/restart", HTTP_POST, [this](AsyncWebServerRequest* request) {
         this->handleRestart(request);
     });
@@ -178,20 +286,21 @@ void WebServer::registerRoutes() {
     });
         
     // ── Boat Data ──────────────────────────────────────────────
+    // Conditional / long-poll through BoatPoll, which calls sendBoatData()
     server->on("/api/boat/navigation", HTTP_GET, [this](AsyncWebServerRequest* request) {
-        this->handleGetNavigation(request);
+        this->handleGetBoatData(request, BOAT_NAVIGATION);
     });
     server->on("/api/boat/wind", HTTP_GET, [this](AsyncWebServerRequest* request) {
-        this->handleGetWind(request);
+        this->handleGetBoatData(request, BOAT_WIND);
     });
     server->on("/api/boat/ais", HTTP_GET, [this](AsyncWebServerRequest* request) {
-        this->handleGetAIS(request);
+        this->handleGetBoatData(request, BOAT_AIS);
     });
     server->on("/api/boat/state", HTTP_GET, [this](AsyncWebServerRequest* request) {
-        this->handleGetBoatState(request);
+        this->handleGetBoatData(request, BOAT_STATE);
     });
     server->on("/api/boat/performance", HTTP_GET, [this](AsyncWebServerRequest* request) {
-        this->handleGetPerformance(request);
+        this->handleGetBoatData(request, BOAT_PERFORMANCE);
     });
     server->on("/api/performance/config", HTTP_GET, [this](AsyncWebServerRequest* request) {
         this->handleGetPerformanceConfig(request);
@@ -334,39 +443,51 @@ void WebServer::registerRoutes() {
 
 // ── WebSocket ─────────────────────────────────────────────────────────────────
 
-void WebServer::handleWebSocketEvent(AsyncWebSocket* server, AsyncWebSocketClient* client,
-                                      AwsEventType type, void* arg, uint8_t* data, size_t len) {
-    switch (type) {
-        case WS_EVT_CONNECT:
-            serialPrintf("[WebSocket] Client #%u connected from %s\n",
-                          client->id(), client->remoteIP().toString().c_str());
-            break;
-        case WS_EVT_DISCONNECT:
-            serialPrintf("[WebSocket] Client #%u disconnected\n", client->id());
-            break;
-        default:
-            break;
-    }
+void WebServer::broadcastNMEA(const char* sentence, size_t len) {
+    if (running) wsNMEA->broadcast(sentence, len);
 }
 
-void WebServer::broadcastNMEA(const char* sentence) {
-    if (!wsNMEA || !running) return;
+void WebServer::flushNMEA() {
+    if (running) wsNMEA->flush();
+}
 
-    static uint32_t lastCleanup = 0;
-    uint32_t now = millis();
-    if (now - lastCleanup >= 5000) {
-        wsNMEA->cleanupClients();
-        lastCleanup = now;
-    }
+uint32_t WebServer::msUntilFlushNMEA() {
+    return wsNMEA->msUntilFlush();
+}
 
-    if (wsNMEA->count() == 0) return;
+void WebServer::pollState() {
+    if (!running) return;
+    wsState->poll();
+    boatPoll->poll();
+}
+
+void WebServer::registerMetrics(MetricsRegistry& reg) {
+    wsNMEA->registerMetrics(reg);
+    wsState->registerMetrics(reg);
+    boatPoll->registerMetrics(reg);
+    responseCache.registerMetrics(reg);
+}
+
+// ── Response cache ────────────────────────────────────────────────────────────
+
+bool WebServer::sendCached(AsyncWebServerRequest* request, CachedResponse key, uint32_t& stamp) {
+    const char* body = responseCache.get(key, millis());
+    if (body) {
+        request->send(200, "application/json", body);
+        return true;
+    }
+    stamp = responseCache.stamp(kCachedSources[key]);
+    return false;
+}
 
-    static uint32_t lastSend = 0;
-    static const uint32_t minInterval = 1000 / WS_MAX_RATE_HZ;
-    if (now - lastSend < minInterval) return;
-    lastSend = now;
+void WebServer::sendAndCache(AsyncWebServerRequest* request, CachedResponse key, uint32_t stamp,
+                             const String& body) {
+    responseCache.put(key, kCachedSources[key], stamp, millis(), body.c_str(), body.length());
+    request->send(200, "application/json", body);
+}
 
-    wsNMEA->textAll(sentence);
+void WebServer::onSDChange(void* ctx) {
+    static_cast<WebServer*>(ctx)->responseCache.invalidate(CACHE_MASK(CACHE_SOURCE_SD));
 }
 
 // ── OTA Handlers ─────────────────────────────────────────────────────────────
@@ -498,6 +619,9 @@ void WebServer::handleOTAUploadComplete(AsyncWebServerRequest* request) {
 // ── LittleFS Storage Handlers ─────────────────────────────────────────────────
 
 void WebServer::handleGetStorageInfo(AsyncWebServerRequest* request) {
+    uint32_t stamp;
+    if (sendCached(request, CACHED_STORAGE_INFO, stamp)) return;
+
     JsonDocument doc;
 
     size_t total = LittleFS.totalBytes();
@@ -510,10 +634,13 @@ void WebServer::handleGetStorageInfo(AsyncWebServerRequest* request) {
 
     String response;
     serializeJson(doc, response);
-    request->send(200, "application/json", response);
+    sendAndCache(request, CACHED_STORAGE_INFO, stamp, response);
 }
 
 void WebServer::handleListFiles(AsyncWebServerRequest* request) {
+    uint32_t stamp;
+    if (sendCached(request, CACHED_STORAGE_FILES, stamp)) return;
+
     JsonDocument doc;
     JsonArray files = doc["files"].to<JsonArray>();
 
@@ -540,7 +667,7 @@ void WebServer::handleListFiles(AsyncWebServerRequest* request) {
 
     String response;
     serializeJson(doc, response);
-    request->send(200, "application/json", response);
+    sendAndCache(request, CACHED_STORAGE_FILES, stamp, response);
 }
 
 void WebServer::handleDeleteFile(AsyncWebServerRequest* request) {
@@ -563,6 +690,7 @@ void WebServer::handleDeleteFile(AsyncWebServerRequest* request) {
     }
 
     if (LittleFS.remove(path)) {
+        responseCache.invalidate(CACHE_MASK(CACHE_SOURCE_LITTLEFS));
         serialPrintf("[Storage] Deleted: %s\n", path.c_str());
         request->send(200, "application/json",
                       "{\"success\":true,\"message\":\"File deleted\"}");
@@ -576,6 +704,7 @@ void WebServer::handleFormatStorage(AsyncWebServerRequest* request) {
     serialPrintf("[Storage] Formatting LittleFS...\n");
 
     bool ok = LittleFS.format();
+    responseCache.invalidate(CACHE_MASK(CACHE_SOURCE_LITTLEFS));
 
     if (ok) {
         LittleFS.begin(false, "/littlefs", 10, "littlefs");
@@ -616,6 +745,10 @@ void WebServer::handleGetSDStatus(AsyncWebServerRequest* request) {
         return;
     }
 
+    // statfs counts free clusters over SPI, shared with the logger
+    uint32_t stamp;
+    if (sendCached(request, CACHED_SD_STATUS, stamp)) return;
+
     SDStorageInfo info = sdManager->getStorageInfo();
 
     doc["enabled"]      = true;
@@ -631,38 +764,131 @@ void WebServer::handleGetSDStatus(AsyncWebServerRequest* request) {
 
     String response;
     serializeJson(doc, response);
-    request->send(200, "application/json", response);
+    sendAndCache(request, CACHED_SD_STATUS, stamp, response);
 }
 
+namespace {
+
+/** GET /api/sd/files: one file per part, read from the card as the response goes out. */
+struct SDListResponse : JsonResponse {
+    SDManager*  sd;
+    SDDirCursor cursor;
+    char        dir[128];
+    uint32_t    count;
+
+    explicit SDListResponse(SDManager* sdMgr) : JsonResponse(write, this), sd(sdMgr), count(0) {
+        dir[0] = '\0';
+    }
+    ~SDListResponse() { sd->closeDir(cursor); }
+
+    static bool write(JsonWriter& w, uint32_t part, void* ctx) {
+        SDListResponse& r = *static_cast<SDListResponse*>(ctx);
+        if (part == 0) {
+            w.beginObject();
+            w.add("dir", (const char*)r.dir);
+            w.beginArray("files");
+            return true;
+        }
+
+        SDFileInfo f;
+        if (r.sd->nextEntry(r.cursor, f)) {
+            w.beginObject();
+            w.add("path", f.path.c_str());
+            w.add("size", f.size);
+            w.add("isDir", f.isDir);
+            w.endObject();
+            r.count++;
+            return true;
+        }
+
+        // Known only once the walk is over, hence after the files
+        w.endArray();
+        w.add("count", r.count);
+        w.endObject();
+        return false;
+    }
+};
+
+} // namespace
+
 void WebServer::handleListSDFiles(AsyncWebServerRequest* request) {
     if (!sdManager || !sdManager->isMounted()) {
         sdNotAvailable(request);
         return;
     }
 
-    const char* dir = "/";
-    if (request->hasParam("dir")) {
-        dir = request->getParam("dir")->value().c_str();
-    }
+    SDListResponse* body = new SDListResponse(sdManager);
+    strlcpy(body->dir, request->hasParam("dir") ? request->getParam("dir")->value().c_str() : "/",
+            sizeof(body->dir));
 
-    std::vector<SDFileInfo> files = sdManager->listFiles(dir, 4);
+    // An unreadable directory lists as empty, as before
+    sdManager->openDir(body->cursor, body->dir, SD_LIST_MAX_DEPTH);
+    sendJsonStream(request, body);
+}
 
-    JsonDocument doc;
-    doc["dir"]   = dir;
-    doc["count"] = files.size();
-    JsonArray arr = doc["files"].to<JsonArray>();
+namespace {
 
-    for (const auto& f : files) {
-        JsonObject obj = arr.add<JsonObject>();
-        obj["path"]  = f.path;
-        obj["size"]  = f.size;
-        obj["isDir"] = f.isDir;
+/**
+ * GET /api/sd/download body: the card is read in SD_DOWNLOAD_BUFFER blocks
+ * (multi-block SPI transfers) and handed out as TCP asks for it, in pieces
+ * of at most one MSS.  Owned by the response filler; closes the file when
+ * the response is done or the client goes away.
+ */
+struct SDDownload {
+    static std::atomic<uint8_t> active;
+
+    File     file;
+    uint8_t* buf;
+    size_t   cap;
+    size_t   fill;      ///< Bytes in buf
+    size_t   pos;       ///< Next byte of buf to send
+    uint64_t left;      ///< Bytes of the range not yet read from the card
+
+    SDDownload() : buf(nullptr), cap(0), fill(0), pos(0), left(0) {
+        active.fetch_add(1, std::memory_order_relaxed);
+    }
+    ~SDDownload() {
+        file.close();
+        free(buf);
+        active.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    bool begin(File& f, uint64_t first, uint64_t length) {
+        file = f;
+        left = length;
+#ifdef BOARD_HAS_PSRAM
+        cap = SD_DOWNLOAD_BUFFER;
+        buf = (uint8_t*)ps_malloc(cap);
+#endif
+        if (!buf) {
+            cap = SD_DOWNLOAD_BUFFER_INTERNAL;
+            buf = (uint8_t*)malloc(cap);
+        }
+        return buf && (first == 0 || file.seek(first));
     }
 
-    String response;
-    serializeJson(doc, response);
-    request->send(200, "application/json", response);
-}
+    size_t read(uint8_t* out, size_t maxLen) {
+        if (pos == fill) {
+            size_t want = left < cap ? (size_t)left : cap;
+            int    got  = want ? file.read(buf, want) : 0;
+            if (got <= 0) {
+                // Truncated or card pulled: the client sees a short body
+                return 0;
+            }
+            fill  = (size_t)got;
+            pos   = 0;
+            left -= (uint64_t)got;
+        }
+        size_t n = fill - pos < maxLen ? fill - pos : maxLen;
+        memcpy(out, buf + pos, n);
+        pos += n;
+        return n;
+    }
+};
+
+std::atomic<uint8_t> SDDownload::active(0);
+
+} // namespace
 
 void WebServer::handleDownloadSDFile(AsyncWebServerRequest* request) {
     if (!sdManager || !sdManager->isMounted()) {
@@ -689,6 +915,22 @@ void WebServer::handleDownloadSDFile(AsyncWebServerRequest* request) {
         return;
     }
 
+    // ?gzip=1: the pre-compressed sibling <path>.gz if there is one
+    bool gzip = false;
+    if (request->hasParam("gzip") && request->getParam("gzip")->value() == "1" &&
+        sdManager->exists((path + ".gz").c_str())) {
+        path += ".gz";
+        gzip  = true;
+    }
+
+    if (SDDownload::active.load(std::memory_order_relaxed) >= SD_DOWNLOAD_MAX_ACTIVE) {
+        AsyncWebServerResponse* response =
+            request->beginResponse(503, "application/json", "{\"error\":\"Too many downloads\"}");
+        response->addHeader("Retry-After", "5");
+        request->send(response);
+        return;
+    }
+
     File f = sdManager->openForRead(path.c_str());
     if (!f || f.isDirectory()) {
         request->send(400, "application/json", "{\"error\":\"Not a file\"}");
@@ -704,19 +946,81 @@ void WebServer::handleDownloadSDFile(AsyncWebServerRequest* request) {
     else if (ext == "nmea") mime = "text/plain";
     else if (ext == "json") mime = "application/json";
     else if (ext == "log")  mime = "text/plain";
+    else if (ext == "gz")   mime = "application/gzip";
 
     // Extract filename for Content-Disposition
     String filename = path.substring(path.lastIndexOf('/') + 1);
 
-    AsyncWebServerResponse* response =
-        request->beginResponse(SD, path, mime);
+    // Validators: a log still being appended to changes size, so its tag moves with it
+    uint64_t size  = f.size();
+    time_t   mtime = f.getLastWrite();
+    char etag[40];
+    snprintf(etag, sizeof(etag), "\"%llx-%lx\"", (unsigned long long)size, (unsigned long)mtime);
+    char lastModified[32] = "";
+    if (mtime > 946684800) {   // Written with the clock set (FAT stores 1980 otherwise)
+        struct tm tm;
+        gmtime_r(&mtime, &tm);
+        strftime(lastModified, sizeof(lastModified), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+    }
+
+    // Range, unless If-Range names another version of the file
+    uint64_t first = 0, last = size ? size - 1 : 0;
+    HttpRangeResult range = HTTP_RANGE_NONE;
+    if (request->hasHeader("Range")) {
+        String ifRange = request->hasHeader("If-Range") ? request->header("If-Range") : String();
+        if (ifRange.isEmpty() ||
+            httpIfRangeMatches(ifRange.c_str(), etag, lastModified[0] ? lastModified : nullptr)) {
+            range = parseHttpRange(request->header("Range").c_str(), size, first, last);
+        }
+    }
+
+    char contentRange[64];
+    if (range == HTTP_RANGE_UNSATISFIABLE) {
+        f.close();
+        snprintf(contentRange, sizeof(contentRange), "bytes */%llu", (unsigned long long)size);
+        AsyncWebServerResponse* response = request->beginResponse(416);
+        response->addHeader("Content-Range", contentRange);
+        response->addHeader("Accept-Ranges", "bytes");
+        request->send(response);
+        return;
+    }
+
+    uint64_t length = size ? last - first + 1 : 0;
+    std::shared_ptr<SDDownload> download(new SDDownload());
+    if (!download->begin(f, first, length)) {
+        request->send(500, "application/json", "{\"error\":\"Cannot read file\"}");
+        return;
+    }
+
+    AsyncWebServerResponse* response = request->beginResponse(
+        mime, (size_t)length,
+        [download](uint8_t* buf, size_t maxLen, size_t index) -> size_t {
+            return download->read(buf, maxLen);
+        });
+    if (range == HTTP_RANGE_OK) {
+        response->setCode(206);
+        snprintf(contentRange, sizeof(contentRange), "bytes %llu-%llu/%llu",
+                 (unsigned long long)first, (unsigned long long)last, (unsigned long long)size);
+        response->addHeader("Content-Range", contentRange);
+    }
+    response->addHeader("Accept-Ranges", "bytes");
+    response->addHeader("ETag", etag);
+    if (lastModified[0]) {
+        response->addHeader("Last-Modified", lastModified);
+    }
     response->addHeader("Content-Disposition",
                         String("attachment; filename=\"") + filename + "\"");
     response->addHeader("Cache-Control", "no-cache");
     request->send(response);
 
-    serialPrintf("[SD] Download: %s (%u B)\n", path.c_str(), (uint32_t)f.size());
-    f.close();
+    if (range == HTTP_RANGE_OK) {
+        serialPrintf("[SD] Download: %s bytes %llu-%llu/%llu%s\n", path.c_str(),
+                     (unsigned long long)first, (unsigned long long)last, (unsigned long long)size,
+                     gzip ? " (gz)" : "");
+    } else {
+        serialPrintf("[SD] Download: %s (%llu B)%s\n", path.c_str(), (unsigned long long)size,
+                     gzip ? " (gz)" : "");
+    }
 }
 
 void WebServer::handleDeleteSDFile(AsyncWebServerRequest* request) {
@@ -871,11 +1175,29 @@ void WebServer::handlePostWiFiConfig(AsyncWebServerRequest* request, uint8_t* da
                   "{\"success\":true,\"message\":\"WiFi config saved. Restart to apply.\"}");
 }
 
+// Serial config endpoints address one input port via ?port=N (default 0)
+static bool serialPortParam(AsyncWebServerRequest* request, uint8_t& port) {
+    port = 0;
+    if (!request->hasParam("port")) return true;
+    long n = request->getParam("port")->value().toInt();
+    if (n < 0 || n >= NMEA_PORT_COUNT) return false;
+    port = (uint8_t)n;
+    return true;
+}
+
 void WebServer::handleGetSerialConfig(AsyncWebServerRequest* request) {
+    uint8_t port;
+    if (!serialPortParam(request, port)) {
+        request->send(400, "application/json", "{\"error\":\"Invalid port\"}");
+        return;
+    }
+
     UARTConfig config;
-    configManager->getSerialConfig(config);
+    configManager->getSerialConfig(config, port);
 
     JsonDocument doc;
+    doc["port"]     = port;
+    doc["enabled"]  = config.enabled;
     doc["baudRate"] = config.baudRate;
     doc["dataBits"] = config.dataBits;
     doc["parity"]   = config.parity;
@@ -887,6 +1209,12 @@ void WebServer::handleGetSerialConfig(AsyncWebServerRequest* request) {
 }
 
 void WebServer::handlePostSerialConfig(AsyncWebServerRequest* request, uint8_t* data, size_t len) {
+    uint8_t port;
+    if (!serialPortParam(request, port)) {
+        request->send(400, "application/json", "{\"error\":\"Invalid port\"}");
+        return;
+    }
+
     JsonDocument doc;
     DeserializationError error = deserializeJson(doc, (char*)data, len);
     if (error) {
@@ -894,112 +1222,297 @@ void WebServer::handlePostSerialConfig(AsyncWebServerRequest* request, uint8_t*
         return;
     }
 
+    // Start from the stored values so a partial update keeps the rest
     UARTConfig config;
-    config.baudRate = doc["baudRate"] | 38400;
-    config.dataBits = doc["dataBits"] | 8;
-    config.parity   = doc["parity"]   | 0;
-    config.stopBits = doc["stopBits"] | 1;
-
-    configManager->setSerialConfig(config);
+    configManager->getSerialConfig(config, port);
+    config.baudRate = doc["baudRate"] | config.baudRate;
+    config.dataBits = doc["dataBits"] | config.dataBits;
+    config.parity   = doc["parity"]   | config.parity;
+    config.stopBits = doc["stopBits"] | config.stopBits;
+    config.enabled  = doc["enabled"]  | config.enabled;
+
+    configManager->setSerialConfig(config, port);
     request->send(200, "application/json",
                   "{\"success\":true,\"message\":\"Serial config saved. Restart to apply.\"}");
 }
 
-void WebServer::handleGetStatus(AsyncWebServerRequest* request) {
-    JsonDocument doc;
-    GPSData     gps     = boatState->getGPS();
-
-    doc["version"] = VERSION;
-    doc["uptime"]  = millis() / 1000;
-    
-    doc["datetime"]  = gps.datetime.getTimestamp();
-
-    JsonObject heap  = doc["heap"].to<JsonObject>();
-    heap["free"]     = ESP.getFreeHeap();
-    heap["total"]    = ESP.getHeapSize();
-    heap["min_free"] = ESP.getMinFreeHeap();
-
-    JsonObject wifi = doc["wifi"].to<JsonObject>();
-    WiFiState   state   = wifiManager->getState();
-    wl_status_t wlStat  = WiFi.status();
-    const char* modeStr = "Unknown";
-    String ssid = "";
-    int8_t rssi = 0;
-    IPAddress ip(0, 0, 0, 0);
-    size_t clients = 0;
-
-    if (wlStat == WL_CONNECTED || state == WIFI_CONNECTED_STA) {
-        modeStr = "STA";
-        ssid    = WiFi.SSID();
-        rssi    = WiFi.RSSI();
-        ip      = WiFi.localIP();
-    } else if (WiFi.getMode() == WIFI_AP || state == WIFI_AP_MODE) {
-        modeStr = "AP";
-        ssid    = wifiManager->getSSID();
-        ip      = WiFi.softAPIP();
-        clients = WiFi.softAPgetStationNum();
-    } else {
-        switch (state) {
-            case WIFI_DISCONNECTED:  modeStr = "Disconnected";  break;
-            case WIFI_CONNECTING:    modeStr = "Connecting";    break;
-            case WIFI_RECONNECTING:  modeStr = "Reconnecting";  break;
-            default: break;
+/**
+ * Parts: header + WiFi, TCP/UDP, one per UART port (totals accumulated on
+ * the way), the UART totals + NMEA buffer, then BLE + SD.  The per-port
+ * list now comes before the "uart" totals it sums up.
+ */
+struct WebServer::StatusResponse : JsonResponse {
+    WebServer* web;
+    uint32_t   sentencesTotal;
+    uint32_t   framingTotal;
+    uint32_t   overflowTotal;
+    uint32_t   baud0;
+
+    explicit StatusResponse(WebServer* ws)
+        : JsonResponse(write, this), web(ws), sentencesTotal(0), framingTotal(0), overflowTotal(0), baud0(0) {}
+
+    static bool write(JsonWriter& w, uint32_t part, void* ctx);
+};
+
+bool WebServer::StatusResponse::write(JsonWriter& w, uint32_t part, void* ctx) {
+    StatusResponse& r  = *static_cast<StatusResponse*>(ctx);
+    WebServer&      ws = *r.web;
+
+    enum { PART_HEADER = 0, PART_LINKS, PART_PORTS, PART_BUFFERS = PART_PORTS + NMEA_PORT_COUNT, PART_DEVICES };
+
+    if (part == PART_HEADER) {
+        GPSData gps = ws.boatState->getGPS();
+        w.beginObject();
+        w.add("version", VERSION);
+        w.add("uptime", millis() / 1000);
+        w.add("datetime", (unsigned long long)gps.datetime.getTimestamp());
+
+        w.beginObject("heap");
+        w.add("free", ESP.getFreeHeap());
+        w.add("total", ESP.getHeapSize());
+        w.add("min_free", ESP.getMinFreeHeap());
+        w.endObject();
+
+        WiFiState   state   = ws.wifiManager->getState();
+        wl_status_t wlStat  = WiFi.status();
+        const char* modeStr = "Unknown";
+        String ssid = "";
+        int8_t rssi = 0;
+        IPAddress ip(0, 0, 0, 0);
+        size_t clients = 0;
+
+        if (wlStat == WL_CONNECTED || state == WIFI_CONNECTED_STA) {
+            modeStr = "STA";
+            ssid    = WiFi.SSID();
+            rssi    = WiFi.RSSI();
+            ip      = WiFi.localIP();
+        } else if (WiFi.getMode() == WIFI_AP || state == WIFI_AP_MODE) {
+            modeStr = "AP";
+            ssid    = ws.wifiManager->getSSID();
+            ip      = WiFi.softAPIP();
+            clients = WiFi.softAPgetStationNum();
+        } else {
+            switch (state) {
+                case WIFI_DISCONNECTED:  modeStr = "Disconnected";  break;
+                case WIFI_CONNECTING:    modeStr = "Connecting";    break;
+                case WIFI_RECONNECTING:  modeStr = "Reconnecting";  break;
+                default: break;
+            }
         }
-    }
 
-    wifi["mode"]    = modeStr;
-    wifi["ssid"]    = ssid;
-    wifi["rssi"]    = rssi;
-    wifi["ip"]      = ip.toString();
-    wifi["clients"] = clients;
-
-    JsonObject tcp = doc["tcp"].to<JsonObject>();
-    tcp["clients"] = tcpServer->getClientCount();
-    tcp["port"]    = TCP_PORT;
-
-    JsonObject uart = doc["uart"].to<JsonObject>();
-    uart["sentences_received"] = uartHandler->getSentencesReceived();
-    uart["errors"]             = nmeaParser->getInvalidSentences();
-    UARTConfig serialConfig;
-    configManager->getSerialConfig(serialConfig);
-    uart["baud"] = serialConfig.baudRate;
-
-    // ── NMEA buffer / queue status ────────────────────────────
-    JsonObject nmeaBuffer = doc["nmea_buffer"].to<JsonObject>();
-    nmeaBuffer["queue_size"]         = NMEA_QUEUE_SIZE;
-    nmeaBuffer["overflow_total"]     = g_nmeaQueueOverflows;
-    nmeaBuffer["full_events_recent"] = g_nmeaQueueFullEvents;
-    nmeaBuffer["has_overflow"]       = (g_nmeaQueueFullEvents > 0);
-
-    UBaseType_t queueWaiting = 0;
-    if (nmeaQueue != NULL) {
-        queueWaiting = uxQueueMessagesWaiting(nmeaQueue);
-    }
-    nmeaBuffer["queue_waiting"]  = (uint32_t)queueWaiting;
-    nmeaBuffer["queue_load_pct"] = (NMEA_QUEUE_SIZE > 0)
-        ? (uint8_t)((queueWaiting * 100) / NMEA_QUEUE_SIZE)
-        : 0;
-
-    JsonObject ble = doc["ble"].to<JsonObject>();
-    ble["enabled"]           = bleManager->isEnabled();
-    ble["advertising"]       = bleManager->isAdvertising();
-    ble["connected_devices"] = bleManager->getConnectedDevices();
-    ble["device_name"]       = bleManager->getConfig().device_name;
+        w.beginObject("wifi");
+        w.add("mode", modeStr);
+        w.add("ssid", ssid.c_str());
+        w.add("rssi", rssi);
+        w.add("ip", ip.toString().c_str());
+        w.add("clients", clients);
+        w.endObject();
+        return true;
+    }
+
+    if (part == PART_LINKS) {
+        w.beginObject("tcp");
+        w.add("clients", ws.tcpServer->getClientCount());
+        w.add("port", TCP_PORT);
+        w.endObject();
+
+        const UDPConfig& udpConfig = udpOutput.getConfig();
+        w.beginObject("udp");
+        w.add("enabled", udpOutput.isRunning());
+        w.add("mode", udpConfig.mode == 0 ? "broadcast" : "multicast");
+        w.add("port", udpConfig.port);
+        w.add("datagrams", udpOutput.getDatagramsSent());
+        w.add("sentences", udpOutput.getSentencesSent());
+        w.add("errors", udpOutput.getSendErrors());
+        w.endObject();
+
+        // "uart_ports" breaks the "uart" totals below down per input
+        w.beginArray("uart_ports");
+        return true;
+    }
+
+    if (part < PART_BUFFERS) {
+        uint8_t p = (uint8_t)(part - PART_PORTS);
+        const UARTHandler& h = ws.uartPorts[p];
+        UARTConfig portConfig;
+        ws.configManager->getSerialConfig(portConfig, p);
+
+        w.beginObject();
+        w.add("port", p);
+        w.add("enabled", portConfig.enabled);
+        w.add("running", h.isRunning());
+        w.add("baud", portConfig.baudRate);
+        w.add("sentences_received", h.getSentencesReceived());
+        w.add("framing_errors", h.getErrors());
+        w.add("overflows", h.getOverflows());
+        w.add("merged", nmeaMerger.merged(p));
+        w.add("dropped", nmeaMerger.dropped(p));
+        w.endObject();
+
+        r.sentencesTotal += h.getSentencesReceived();
+        r.framingTotal   += h.getErrors();
+        r.overflowTotal  += h.getOverflows();
+        if (p == 0) r.baud0 = portConfig.baudRate;
+        return true;
+    }
+
+    if (part == PART_BUFFERS) {
+        w.endArray();
+
+        // Totals across ports (baud of port 0), as the dashboard reads them
+        w.beginObject("uart");
+        w.add("baud", r.baud0);
+        w.add("sentences_received", r.sentencesTotal);
+        w.add("errors", ws.nmeaParser->getInvalidSentences());
+        w.add("framing_errors", r.framingTotal);
+        w.add("overflows", r.overflowTotal);
+        w.endObject();
+
+        // ── NMEA buffer / queue status ────────────────────────────
+        uint32_t queueWaiting = nmeaQueue.size();
+        w.beginObject("nmea_buffer");
+        w.add("queue_size", NMEA_QUEUE_SIZE);
+        w.add("overflow_total", g_nmeaQueueOverflows);
+        w.add("full_events_recent", g_nmeaQueueFullEvents);
+        w.add("has_overflow", g_nmeaQueueFullEvents > 0);
+        w.add("queue_waiting", queueWaiting);
+        w.add("queue_load_pct", (queueWaiting * 100) / NMEA_QUEUE_SIZE);
+        w.add("pool_size", sentencePool.capacity());
+        w.add("pool_free", sentencePool.available());
+        w.add("pool_low_water", sentencePool.lowWater());
+        w.add("pool_exhausted", sentencePool.exhausted());
+        w.endObject();
+        return true;
+    }
+
+    w.beginObject("ble");
+    w.add("enabled", ws.bleManager->isEnabled());
+    w.add("advertising", ws.bleManager->isAdvertising());
+    w.add("connected_devices", ws.bleManager->getConnectedDevices());
+    w.add("device_name", ws.bleManager->getConfig().device_name);
+    w.endObject();
 
     // ── SD card summary ───────────────────────────────────────
-    JsonObject sd = doc["sd"].to<JsonObject>();
-    if (sdManager) {
-        SDStorageInfo sdInfo = sdManager->getStorageInfo();
-        sd["enabled"]    = true;
-        sd["mounted"]    = sdInfo.mounted;
-        sd["card_type"]  = sdInfo.cardType;
-        sd["total_mb"]   = (uint32_t)(sdInfo.totalBytes / (1024ULL * 1024ULL));
-        sd["free_mb"]    = (uint32_t)(sdInfo.freeBytes  / (1024ULL * 1024ULL));
-        sd["used_pct"]   = sdInfo.usedPct;
+    w.beginObject("sd");
+    if (ws.sdManager) {
+        SDStorageInfo sdInfo = ws.sdManager->getStorageInfo();
+        w.add("enabled", true);
+        w.add("mounted", sdInfo.mounted);
+        w.add("card_type", sdInfo.cardType.c_str());
+        w.add("total_mb", (uint32_t)(sdInfo.totalBytes / (1024ULL * 1024ULL)));
+        w.add("free_mb", (uint32_t)(sdInfo.freeBytes  / (1024ULL * 1024ULL)));
+        w.add("used_pct", sdInfo.usedPct);
     } else {
-        sd["enabled"] = false;
-        sd["mounted"] = false;
+        w.add("enabled", false);
+        w.add("mounted", false);
     }
+    w.endObject();
+    w.endObject();
+    return false;
+}
+
+void WebServer::handleGetStatus(AsyncWebServerRequest* request) {
+    sendJsonStream(request, new StatusResponse(this));
+}
+
+// ── OpenMetrics exposition ────────────────────────────────────────────────────
+//
+// GET /metrics
+//   Every value in the MetricsRegistry as OpenMetrics text, for Prometheus.
+//   Streamed as a chunked response: each chunk is rendered straight into the
+//   TCP send buffer from the cursor, so the scrape allocates no document.
+
+void WebServer::handleGetOpenMetrics(AsyncWebServerRequest* request) {
+    MetricsCursor cursor;
+    AsyncWebServerResponse* response = request->beginChunkedResponse(
+        "application/openmetrics-text; version=1.0.0; charset=utf-8",
+        [cursor](uint8_t* buf, size_t maxLen, size_t index) mutable -> size_t {
+            return metrics.render(cursor, (char*)buf, maxLen);
+        });
+    response->addHeader("Cache-Control", "no-cache");
+    request->send(response);
+}
+
+// ── Pipeline metrics ──────────────────────────────────────────────────────────
+//
+// GET /api/metrics[?buckets=1][&reset=1]
+//   stages  — latency per pipeline stage in µs (count, mean, p50/p90/p99/p999, max);
+//             with buckets=1 also the non-empty histogram buckets as [upper_us, count]
+//   queues  — current depth, high-water mark and capacity
+//   drops   — sentences lost, by reason (including UART-level errors)
+//   reset=1 clears histograms and high-water marks after reporting
+
+void WebServer::handleGetMetrics(AsyncWebServerRequest* request) {
+    const bool withBuckets = request->hasParam("buckets");
+
+    JsonDocument doc;
+    doc["uptime_ms"] = millis();
+
+    JsonObject stages = doc["stages"].to<JsonObject>();
+    for (uint8_t i = 0; i < STAGE_COUNT; i++) {
+        const LatencyHistogram& h = pipelineStats.stage((PipelineStage)i);
+        JsonObject o = stages[PipelineStats::stageName((PipelineStage)i)].to<JsonObject>();
+        o["count"]   = h.count();
+        o["mean_us"] = h.mean();
+        o["p50_us"]  = h.percentile(500);
+        o["p90_us"]  = h.percentile(900);
+        o["p99_us"]  = h.percentile(990);
+        o["p999_us"] = h.percentile(999);
+        o["max_us"]  = h.max();
+        if (withBuckets) {
+            JsonArray buckets = o["buckets"].to<JsonArray>();
+            for (uint16_t b = 0; b < LATENCY_BUCKETS; b++) {
+                uint32_t n = h.bucketCount(b);
+                if (!n) continue;
+                JsonArray pair = buckets.add<JsonArray>();
+                pair.add(LatencyHistogram::bucketUpper(b));
+                pair.add(n);
+            }
+        }
+    }
+
+    JsonObject queues = doc["queues"].to<JsonObject>();
+    for (uint8_t p = 0; p < NMEA_PORT_COUNT; p++) {
+        char name[16];
+        snprintf(name, sizeof(name), "merge_port%u", p);
+        PipelineQueue q = (PipelineQueue)(QUEUE_MERGE0 + p);
+        JsonObject o = queues[name].to<JsonObject>();
+        o["depth"]      = nmeaMerger.pending(p);
+        o["high_water"] = pipelineStats.highWater(q);
+        o["capacity"]   = NMEA_MERGE_DEPTH;
+    }
+    JsonObject tq = queues["merge_tcp"].to<JsonObject>();
+    tq["depth"]      = nmeaMerger.pending(NMEA_SOURCE_TCP);
+    tq["high_water"] = pipelineStats.highWater((PipelineQueue)(QUEUE_MERGE0 + NMEA_SOURCE_TCP));
+    tq["capacity"]   = NMEA_MERGE_DEPTH;
+    JsonObject nq = queues["nmea"].to<JsonObject>();
+    nq["depth"]      = nmeaQueue.size();
+    nq["high_water"] = pipelineStats.highWater(QUEUE_NMEA);
+    nq["capacity"]   = NMEA_QUEUE_SIZE;
+    JsonObject lq = queues["log"].to<JsonObject>();
+    lq["depth"]      = pipelineStats.depth(QUEUE_LOG);
+    lq["high_water"] = pipelineStats.highWater(QUEUE_LOG);
+    lq["capacity"]   = LOG_QUEUE_SIZE;
+    JsonObject pq = queues["pool"].to<JsonObject>();
+    pq["depth"]      = sentencePool.capacity() - sentencePool.available();
+    pq["high_water"] = pipelineStats.highWater(QUEUE_POOL);
+    pq["capacity"]   = sentencePool.capacity();
+
+    JsonObject drops = doc["drops"].to<JsonObject>();
+    for (uint8_t r = 0; r < DROP_REASON_COUNT; r++) {
+        drops[PipelineStats::dropName((DropReason)r)] = pipelineStats.dropped((DropReason)r);
+    }
+    uint32_t uartErrors = 0, uartOverflows = 0;
+    for (uint8_t p = 0; p < NMEA_PORT_COUNT; p++) {
+        uartErrors    += uartPorts[p].getErrors();
+        uartOverflows += uartPorts[p].getOverflows();
+    }
+    drops["uart_framing"]  = uartErrors;
+    drops["uart_overflow"] = uartOverflows;
+    drops["ais_fragments"] = nmeaParser->getAISReassembly().dropped() +
+                             nmeaParser->getAISReassembly().expired();
+
+    if (request->hasParam("reset")) pipelineStats.reset();
 
     String response;
     serializeJson(doc, response);
@@ -1054,6 +1567,158 @@ void WebServer::handleGetWiFiScanResults(AsyncWebServerRequest* request) {
     request->send(200, "application/json", response);
 }
 
+// ── UDP output configuration ──────────────────────────────────────────────────
+
+void WebServer::handleGetUDPConfig(AsyncWebServerRequest* request) {
+    UDPConfig config;
+    configManager->getUDPConfig(config);
+
+    JsonDocument doc;
+    doc["enabled"]      = config.enabled;
+    doc["mode"]         = config.mode == 0 ? "broadcast" : "multicast";
+    doc["port"]         = config.port;
+    doc["group"]        = config.group;
+    doc["max_datagram"] = config.maxDatagram;
+    doc["max_delay_ms"] = config.maxDelayMs;
+    doc["running"]      = udpOutput.isRunning();
+
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+}
+
+void WebServer::handlePostUDPConfig(AsyncWebServerRequest* request, uint8_t* data, size_t len) {
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, (char*)data, len);
+    if (error) {
+        request->send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
+        return;
+    }
+
+    // Start from the stored values so a partial update keeps the rest
+    UDPConfig config;
+    configManager->getUDPConfig(config);
+    config.enabled = doc["enabled"] | config.enabled;
+
+    const char* mode = doc["mode"] | (config.mode == 0 ? "broadcast" : "multicast");
+    if (strcmp(mode, "broadcast") == 0) {
+        config.mode = 0;
+    } else if (strcmp(mode, "multicast") == 0) {
+        config.mode = 1;
+    } else {
+        request->send(400, "application/json",
+                      "{\"error\":\"mode must be broadcast or multicast\"}");
+        return;
+    }
+
+    uint32_t port   = doc["port"]         | (uint32_t)config.port;
+    uint32_t size   = doc["max_datagram"] | (uint32_t)config.maxDatagram;
+    uint32_t waitMs = doc["max_delay_ms"] | (uint32_t)config.maxDelayMs;
+    if (port == 0 || port > 65535) {
+        request->send(400, "application/json", "{\"error\":\"Invalid port\"}");
+        return;
+    }
+    if (size < UDP_MIN_DATAGRAM || size > DATAGRAM_MAX) {
+        request->send(400, "application/json",
+                      "{\"error\":\"max_datagram must be 128..1472 bytes\"}");
+        return;
+    }
+    if (waitMs < UDP_MIN_DELAY_MS || waitMs > UDP_MAX_DELAY_MS) {
+        request->send(400, "application/json",
+                      "{\"error\":\"max_delay_ms must be 10..1000\"}");
+        return;
+    }
+    config.port        = (uint16_t)port;
+    config.maxDatagram = (uint16_t)size;
+    config.maxDelayMs  = (uint16_t)waitMs;
+
+    const char* group = doc["group"] | (const char*)config.group;
+    IPAddress groupIP;
+    if (!groupIP.fromString(group) || groupIP[0] < 224 || groupIP[0] > 239) {
+        request->send(400, "application/json",
+                      "{\"error\":\"group must be a multicast address (224.0.0.0 - 239.255.255.255)\"}");
+        return;
+    }
+    strncpy(config.group, groupIP.toString().c_str(), sizeof(config.group) - 1);
+    config.group[sizeof(config.group) - 1] = '\0';
+
+    configManager->setUDPConfig(config);
+    request->send(200, "application/json",
+                  "{\"success\":true,\"message\":\"UDP config saved. Restart to apply.\"}");
+}
+
+// ── Routing ───────────────────────────────────────────────────────────────────
+
+void WebServer::handleGetRoutes(AsyncWebServerRequest* request) {
+    JsonDocument doc;
+    JsonObject routes = doc["routes"].to<JsonObject>();
+    JsonObject echoes = doc["echoes"].to<JsonObject>();
+    for (uint8_t s = 0; s < NMEA_SOURCE_MAX; s++) {
+        const char* name = NMEARouter::sourceName(s);
+        JsonArray outputs = routes[name].to<JsonArray>();
+        uint8_t mask = nmeaRouter.routes(s);
+        for (uint8_t o = 0; o < ROUTE_OUTPUT_COUNT; o++) {
+            if (mask & (1u << o)) outputs.add(NMEARouter::outputName(o));
+        }
+        echoes[name] = nmeaRouter.looped(s);
+    }
+
+    String response;
+    serializeJson(doc, response);
+    request->send(200, "application/json", response);
+}
+
+void WebServer::handlePostRoutes(AsyncWebServerRequest* request, uint8_t* data, size_t len) {
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, (char*)data, len);
+    if (error) {
+        request->send(400, "application/json", "{\"error\":\"Invalid JSON\"}");
+        return;
+    }
+
+    // Sources left out keep their current routes
+    RouteConfig config;
+    for (uint8_t s = 0; s < NMEA_SOURCE_MAX; s++) {
+        config.outputs[s] = nmeaRouter.routes(s);
+    }
+
+    JsonObject routes = doc["routes"];
+    for (JsonPair p : routes) {
+        uint8_t source = NMEA_SOURCE_MAX;
+        for (uint8_t s = 0; s < NMEA_SOURCE_MAX; s++) {
+            if (strcmp(p.key().c_str(), NMEARouter::sourceName(s)) == 0) source = s;
+        }
+        if (source == NMEA_SOURCE_MAX || !p.value().is<JsonArray>()) {
+            request->send(400, "application/json",
+                          "{\"error\":\"routes maps uart0..uart2 or tcp to a list of outputs\"}");
+            return;
+        }
+
+        uint8_t mask = 0;
+        for (JsonVariant v : p.value().as<JsonArray>()) {
+            const char* name = v | "";
+            uint8_t o = 0;
+            while (o < ROUTE_OUTPUT_COUNT && strcmp(name, NMEARouter::outputName(o)) != 0) o++;
+            if (o == ROUTE_OUTPUT_COUNT) {
+                request->send(400, "application/json",
+                              "{\"error\":\"outputs are uart0, uart1, uart2, tcp, udp or ws\"}");
+                return;
+            }
+            mask |= (uint8_t)(1u << o);
+        }
+        config.outputs[source] = mask;
+    }
+
+    // Applies at once; the router clears a UART's own TX, so save what it kept
+    for (uint8_t s = 0; s < NMEA_SOURCE_MAX; s++) {
+        nmeaRouter.setRoutes(s, config.outputs[s]);
+        config.outputs[s] = nmeaRouter.routes(s);
+    }
+    configManager->setRouteConfig(config);
+    request->send(200, "application/json",
+                  "{\"success\":true,\"message\":\"Routes saved and applied.\"}");
+}
+
 // ── BLE Configuration ─────────────────────────────────────────────────────────
 
 void WebServer::handleGetBLEConfig(AsyncWebServerRequest* request) {
@@ -1117,6 +1782,9 @@ void WebServer::handlePostBLEConfig(AsyncWebServerRequest* request, uint8_t* dat
 // ── Polar handlers ────────────────────────────────────────────────────────────
 
 void WebServer::handleGetPolarStatus(AsyncWebServerRequest* request) {
+    uint32_t stamp;
+    if (sendCached(request, CACHED_POLAR_STATUS, stamp)) return;
+
     JsonDocument doc;
     bool loaded      = boatState->polar.isLoaded();
     doc["loaded"]    = loaded;
@@ -1131,7 +1799,7 @@ void WebServer::handleGetPolarStatus(AsyncWebServerRequest* request) {
 
     String response;
     serializeJson(doc, response);
-    request->send(200, "application/json", response);
+    sendAndCache(request, CACHED_POLAR_STATUS, stamp, response);
 }
 
 void WebServer::handleUploadPolar(AsyncWebServerRequest* request,
@@ -1146,6 +1814,7 @@ void WebServer::handleUploadPolar(AsyncWebServerRequest* request,
             LittleFS.remove(POLAR_FILE_PATH);
         }
         uploadFile = LittleFS.open(POLAR_FILE_PATH, "w");
+        responseCache.invalidate(CACHE_MASK(CACHE_SOURCE_LITTLEFS));
         if (!uploadFile) {
             serialPrintf("[Web] ✗ Failed to open polar file for writing\n");
             return;
@@ -1162,6 +1831,7 @@ void WebServer::handleUploadPolar(AsyncWebServerRequest* request,
             serialPrintf("[Web] Polar upload complete: %u bytes\n", index + len);
         }
         bool ok = boatState->polar.loadFromFile(POLAR_FILE_PATH);
+        responseCache.invalidate(CACHE_MASK(CACHE_SOURCE_LITTLEFS) | CACHE_MASK(CACHE_SOURCE_POLAR));
         if (ok) {
             boatState->updatePerformance();
         }
@@ -1208,12 +1878,27 @@ void WebServer::handlePostAutopilotCommand(AsyncWebServerRequest* request,
 
 // ── Boat data handlers ────────────────────────────────────────────────────────
 
-void WebServer::handleGetNavigation(AsyncWebServerRequest* request) {
+void WebServer::handleGetBoatData(AsyncWebServerRequest* request, BoatEndpoint endpoint) {
     if (!boatState) {
         request->send(500, "application/json", "{\"error\":\"BoatState not available\"}");
         return;
     }
+    boatPoll->handle(request, endpoint, kBoatEndpointMask[endpoint]);
+}
+
+void WebServer::sendBoatData(AsyncWebServerRequest* request, uint8_t id, uint32_t stamp, void* ctx) {
+    WebServer* self = static_cast<WebServer*>(ctx);
+    switch (id) {
+        case BOAT_NAVIGATION:  self->handleGetNavigation(request, stamp);  break;
+        case BOAT_WIND:        self->handleGetWind(request, stamp);        break;
+        case BOAT_AIS:         self->handleGetAIS(request, stamp);         break;
+        case BOAT_STATE:       self->handleGetBoatState(request, stamp);   break;
+        case BOAT_PERFORMANCE: self->handleGetPerformance(request, stamp); break;
+        default:               request->send(404);                         break;
+    }
+}
 
+void WebServer::handleGetNavigation(AsyncWebServerRequest* request, uint32_t stamp) {
     JsonDocument doc;
     GPSData     gps     = boatState->getGPS();
     SpeedData   speed   = boatState->getSpeed();
@@ -1222,8 +1907,8 @@ void WebServer::handleGetNavigation(AsyncWebServerRequest* request) {
 
     JsonObject position = doc["position"].to<JsonObject>();
     if (gps.position.lat.valid && !gps.position.lat.isStale()) {
-        position["latitude"]  = gps.position.lat.value;
-        position["longitude"] = gps.position.lon.value;
+        position["latitude"]  = gps.position.latitude();
+        position["longitude"] = gps.position.longitude();
         position["age"]       = (millis() - gps.position.lat.timestamp) / 1000.0;
     } else {
         position["latitude"]  = nullptr;
@@ -1259,17 +1944,14 @@ void WebServer::handleGetNavigation(AsyncWebServerRequest* request) {
     if (speed.total.valid && !speed.total.isStale())  { doc["total"]["value"] = speed.total.value; doc["total"]["unit"] = speed.total.unit; }
     else                                              { doc["total"]["value"] = nullptr;            doc["total"]["unit"] = "nm"; }
 
-    String response;
-    serializeJson(doc, response);
-    request->send(200, "application/json", response);
+    String body;
+    serializeJson(doc, body);
+    AsyncWebServerResponse* response = request->beginResponse(200, "application/json", body);
+    boatPoll->tag(response, stamp);
+    request->send(response);
 }
 
-void WebServer::handleGetWind(AsyncWebServerRequest* request) {
-    if (!boatState) {
-        request->send(500, "application/json", "{\"error\":\"BoatState not available\"}");
-        return;
-    }
-
+void WebServer::handleGetWind(AsyncWebServerRequest* request, uint32_t stamp) {
     JsonDocument doc;
     WindData wind = boatState->getWind();
 
@@ -1291,67 +1973,110 @@ void WebServer::handleGetWind(AsyncWebServerRequest* request) {
     addWind("twa", wind.twa, "deg");
     addWind("twd", wind.twd, "deg");
 
-    String response;
-    serializeJson(doc, response);
-    request->send(200, "application/json", response);
+    String body;
+    serializeJson(doc, body);
+    AsyncWebServerResponse* response = request->beginResponse(200, "application/json", body);
+    boatPoll->tag(response, stamp);
+    request->send(response);
 }
 
-void WebServer::handleGetAIS(AsyncWebServerRequest* request) {
-    if (!boatState) {
-        request->send(500, "application/json", "{\"error\":\"BoatState not available\"}");
-        return;
-    }
+namespace {
+
+/** GET /api/boat/ais: counters first, then one target per part straight from the table. */
+struct AISResponse : JsonResponse {
+    BoatState*  state;
+    NMEAParser* parser;
+    AISList     targets;
+
+    AISResponse(BoatState* bs, NMEAParser* nmea) : JsonResponse(write, this), state(bs), parser(nmea) {}
+
+    static bool write(JsonWriter& w, uint32_t part, void* ctx) {
+        AISResponse& r = *static_cast<AISResponse*>(ctx);
+        if (part == 0) {
+            r.state->listAISTargets(r.targets);
+            w.beginObject();
+            w.add("target_count", r.targets.count);
+            w.add("capacity", r.state->getAISCapacity());
+            w.add("evicted", r.state->getAISEvictions());
+            w.add("rejected", r.state->getAISRejected());
+
+            // Multi-sentence reassembly: fragments lost to malformed input,
+            // slot pressure or timeouts
+            if (r.parser) {
+                const AISReassembler& ra = r.parser->getAISReassembly();
+                w.beginObject("reassembly");
+                w.add("fragments", ra.fragments());
+                w.add("completed", ra.completed());
+                w.add("dropped", ra.dropped());
+                w.add("expired", ra.expired());
+                w.add("in_flight", ra.inFlight());
+                w.add("loss_rate", ra.fragments()
+                                   ? (float)(ra.dropped() + ra.expired()) / (float)ra.fragments() : 0.0f);
+                w.endObject();
+            }
+            w.beginArray("targets");
+            return true;
+        }
 
-    JsonDocument doc;
-    AISData ais = boatState->getAIS();
-    doc["target_count"] = ais.targetCount;
-    JsonArray targets = doc["targets"].to<JsonArray>();
+        AISTarget t;
+        if (!r.state->nextAISTarget(r.targets, t)) {
+            w.endArray();
+            w.endObject();
+            return false;
+        }
 
-    for (int i = 0; i < ais.targetCount; i++) {
-        AISTarget& t      = ais.targets[i];
         unsigned long age = (millis() - t.timestamp) / 1000;
-        if (age > DATA_TIMEOUT_AIS / 1000) continue;
-
-        JsonObject obj = targets.add<JsonObject>();
-        obj["mmsi"] = t.mmsi;
-        obj["name"] = t.name;
-        JsonObject pos = obj["position"].to<JsonObject>();
-        pos["latitude"]  = t.lat;
-        pos["longitude"] = t.lon;
-        obj["cog"]     = t.cog;
-        obj["sog"]     = t.sog;
-        obj["heading"] = t.heading;
-        JsonObject prox = obj["proximity"].to<JsonObject>();
-        prox["distance"]      = t.distance;
-        prox["distance_unit"] = "nm";
-        prox["bearing"]       = t.bearing;
-        prox["bearing_unit"]  = "deg";
-        prox["cpa"]           = t.cpa;
-        prox["cpa_unit"]      = "nm";
-        prox["tcpa"]          = t.tcpa;
-        prox["tcpa_unit"]     = "min";
-        obj["age"] = age;
-    }
-
-    String response;
-    serializeJson(doc, response);
-    request->send(200, "application/json", response);
+        w.beginObject();
+        w.add("mmsi", t.mmsi);
+        w.add("name", (const char*)t.name);
+        w.add("callsign", (const char*)t.callsign);
+        w.add("ship_type", t.shipType);
+        w.add("msg_type", t.msgType);
+        w.beginObject("position");
+        w.add("latitude", t.lat);
+        w.add("longitude", t.lon);
+        w.endObject();
+        w.add("cog", t.cog);
+        w.add("sog", t.sog);
+        w.add("heading", t.heading);
+        w.beginObject("proximity");
+        w.add("distance", t.distance);
+        w.add("distance_unit", "nm");
+        w.add("bearing", t.bearing);
+        w.add("bearing_unit", "deg");
+        w.add("cpa", t.cpa);
+        w.add("cpa_unit", "nm");
+        w.add("tcpa", t.tcpa);
+        w.add("tcpa_unit", "min");
+        w.endObject();
+        w.add("age", age);
+        w.endObject();
+        return true;
+    }
+};
+
+/** GET /api/boat/state: BoatState::writeJSON() does the parts. */
+struct BoatStateResponse : JsonResponse {
+    BoatState::JsonContext doc;
+
+    explicit BoatStateResponse(BoatState* bs) : JsonResponse(BoatState::writeJSON, &doc), doc(bs) {}
+};
+
+} // namespace
+
+void WebServer::handleGetAIS(AsyncWebServerRequest* request, uint32_t stamp) {
+    AsyncWebServerResponse* response = beginJsonStream(request, new AISResponse(boatState, nmeaParser));
+    boatPoll->tag(response, stamp);
+    request->send(response);
 }
 
-void WebServer::handleGetBoatState(AsyncWebServerRequest* request) {
-    if (!boatState) {
-        request->send(500, "application/json", "{\"error\":\"BoatState not available\"}");
-        return;
-    }
-    request->send(200, "application/json", boatState->toJSON());
+void WebServer::handleGetBoatState(AsyncWebServerRequest* request, uint32_t stamp) {
+    AsyncWebServerResponse* response = beginJsonStream(request, new BoatStateResponse(boatState));
+    boatPoll->tag(response, stamp);
+    request->send(response);
 }
 
-void WebServer::handleGetPerformance(AsyncWebServerRequest* request) {
-    if (!boatState) {
-        request->send(500, "application/json", "{\"error\":\"BoatState not available\"}");
-        return;
-    }
-
+void WebServer::handleGetPerformance(AsyncWebServerRequest* request, uint32_t stamp) {
     PerformanceData perf = boatState->getPerformance();
     JsonDocument doc;
 
@@ -1377,9 +2102,11 @@ void WebServer::handleGetPerformance(AsyncWebServerRequest* request) {
 
     doc["polar_loaded"] = boatState->polar.isLoaded();
 
-    String response;
-    serializeJson(doc, response);
-    request->send(200, "application/json", response);
+    String body;
+    serializeJson(doc, body);
+    AsyncWebServerResponse* response = request->beginResponse(200, "application/json", body);
+    boatPoll->tag(response, stamp);
+    request->send(response);
 }
 
 // GET /api/performance/config
@@ -0,0 +1,136 @@
+#include "ws_state.h"
+#include "functions.h"
+#include "metrics.h"
+
+WSState::WSState(const char* url, BoatState* state)
+    : socket(url), boatState(state), clients(url), initialized(false),
+      lastPush(0), lastCapture(0), lastCleanup(0), joined(false),
+      keyframesSent(0), deltasSent(0), bytesSent(0), skipped(0) {
+    for (int s = 0; s < BOAT_SECTION_COUNT; s++) {
+        generations[s] = 0;
+    }
+}
+
+bool WSState::init() {
+    if (initialized) {
+        return true;
+    }
+
+    if (!clients.init()) {
+        serialPrintf("[WebSocket] ❌ Failed to create state mutex!\n");
+        return false;
+    }
+
+    socket.onEvent([this](AsyncWebSocket* server, AsyncWebSocketClient* client,
+                          AwsEventType type, void* arg, uint8_t* data, size_t len) {
+        this->onEvent(client, type);
+    });
+
+    initialized = true;
+    serialPrintf("[WebSocket] %s: %u clients, %u fields, delta every ≥ %u ms, keyframe every %u ms\n",
+                 socket.url(), WS_STATE_MAX_CLIENTS, STATE_FIELD_COUNT, WS_STATE_PUSH_MS, WS_STATE_KEYFRAME_MS);
+    return true;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Clients
+// ═══════════════════════════════════════════════════════════════
+
+void WSState::onEvent(AsyncWebSocketClient* client, AwsEventType type) {
+    if (!initialized || !client) {
+        return;
+    }
+
+    if (type == WS_EVT_CONNECT) {
+        clients.connect(client, [this](Slot& s) {
+            s.encoder.reset();
+            joined = true;
+        });
+    } else if (type == WS_EVT_DISCONNECT) {
+        clients.disconnect(client, [client](Slot& s) {
+            serialPrintf("[WebSocket] State client #%u disconnected: %u keyframes, %u deltas\n",
+                         client->id(), s.encoder.getKeyframes(), s.encoder.getDeltas());
+        });
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Push: one snapshot, one delta frame per client
+// ═══════════════════════════════════════════════════════════════
+
+bool WSState::sectionsChanged() {
+    static const BoatSection kShown[] = {
+        BOAT_SECTION_GPS, BOAT_SECTION_SPEED, BOAT_SECTION_HEADING, BOAT_SECTION_DEPTH,
+        BOAT_SECTION_WIND, BOAT_SECTION_ENVIRONMENT, BOAT_SECTION_PERFORMANCE
+    };
+    bool changed = false;
+    for (size_t i = 0; i < sizeof(kShown) / sizeof(kShown[0]); i++) {
+        uint32_t g = boatState->getGeneration(kShown[i]);
+        if (g != generations[kShown[i]]) {
+            generations[kShown[i]] = g;
+            changed = true;
+        }
+    }
+    return changed;
+}
+
+void WSState::poll() {
+    if (!initialized) {
+        return;
+    }
+
+    uint32_t now = millis();
+    if (now - lastCleanup >= 5000) {
+        socket.cleanupClients(WS_STATE_MAX_CLIENTS);
+        lastCleanup = now;
+    }
+    if (clients.count() == 0 || now - lastPush < WS_STATE_PUSH_MS) {
+        return;
+    }
+    lastPush = now;
+
+    // Outside the mutex: only the processor task touches the snapshot
+    bool changed = sectionsChanged();
+    if (changed || joined || now - lastCapture >= WS_STATE_SWEEP_MS) {
+        joined = false;
+        snapshot.capture(*boatState);
+        lastCapture = now;
+    }
+
+    clients.lock();
+    for (size_t i = 0; i < WS_STATE_MAX_CLIENTS; i++) {
+        Slot& s = clients[i];
+        if (!s.client) {
+            continue;
+        }
+        // Not encoded, so the next delta still covers what this push carried
+        if (s.client->queueIsFull()) {
+            skipped++;
+            continue;
+        }
+        size_t len = s.encoder.encode(snapshot, now, frame);
+        if (len == 0) {
+            continue;
+        }
+        s.client->binary(frame, len);
+        bytesSent += len;
+        if (frame[0] & STATE_FRAME_KEY) {
+            keyframesSent++;
+        } else {
+            deltasSent++;
+        }
+    }
+    clients.unlock();
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Metrics
+// ═══════════════════════════════════════════════════════════════
+
+void WSState::registerMetrics(MetricsRegistry& reg) {
+    clients.registerGauge(reg, "espnav_ws_state_clients", "Clients connected to /ws/state");
+    reg.addCounter("espnav_ws_state_frames", "Binary frames sent to /ws/state clients", &keyframesSent, "kind=\"key\"");
+    reg.addCounter("espnav_ws_state_frames", "Binary frames sent to /ws/state clients", &deltasSent, "kind=\"delta\"");
+    reg.addCounter("espnav_ws_state_bytes", "Bytes of binary frames sent to /ws/state clients", &bytesSent);
+    reg.addCounter("espnav_ws_state_skipped", "/ws/state pushes skipped for a full client send queue", &skipped);
+}
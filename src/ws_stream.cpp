@@ -0,0 +1,228 @@
+#include "ws_stream.h"
+#include "functions.h"
+#include "metrics.h"
+
+WSStream::WSStream(const char* url)
+    : socket(url), clients(url), initialized(false), lastCleanup(0),
+      framesSent(0), sentencesSent(0), sentencesDropped(0), evictions(0) {
+    for (size_t i = 0; i < WS_MAX_CLIENTS; i++) {
+        clients[i].sentences = 0;
+        clients[i].dropped   = 0;
+        clients[i].frames    = 0;
+    }
+}
+
+bool WSStream::init() {
+    if (initialized) {
+        return true;
+    }
+
+    if (!clients.init()) {
+        serialPrintf("[WebSocket] ❌ Failed to create mutex!\n");
+        return false;
+    }
+
+    // Rings are allocated once for every slot, not per connection
+    for (size_t i = 0; i < WS_MAX_CLIENTS; i++) {
+        if (!clients[i].ring.begin(WS_CLIENT_BUFFER)) {
+            serialPrintf("[WebSocket] ❌ Cannot allocate ring %u (%u bytes)\n", i, WS_CLIENT_BUFFER);
+            return false;
+        }
+    }
+
+    socket.onEvent([this](AsyncWebSocket* server, AsyncWebSocketClient* client,
+                          AwsEventType type, void* arg, uint8_t* data, size_t len) {
+        this->onEvent(client, type);
+    });
+
+    initialized = true;
+    serialPrintf("[WebSocket] %s: %u clients × %u B rings, frames every ≤ %u ms\n",
+                 socket.url(), WS_MAX_CLIENTS, WS_CLIENT_BUFFER, WS_BATCH_MS);
+    return true;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Clients
+// ═══════════════════════════════════════════════════════════════
+
+void WSStream::onEvent(AsyncWebSocketClient* client, AwsEventType type) {
+    if (!initialized || !client) {
+        return;
+    }
+
+    if (type == WS_EVT_CONNECT) {
+        clients.connect(client, [](Slot& s) {
+            s.sentences = 0;
+            s.dropped   = 0;
+            s.frames    = 0;
+            s.ring.clear();
+        });
+    } else if (type == WS_EVT_DISCONNECT) {
+        clients.disconnect(client, [client](Slot& s) {
+            serialPrintf("[WebSocket] Client #%u disconnected: %u sentences in %u frames, %u dropped\n",
+                         client->id(), s.sentences, s.frames, s.dropped);
+            s.ring.clear();
+        });
+    }
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Batching: ring → one text frame
+// ═══════════════════════════════════════════════════════════════
+
+bool WSStream::sendFrame(Slot& s, uint32_t now) {
+    if (s.ring.pending() == 0) {
+        return false;
+    }
+
+    // Nothing more for a client still working through its queue: its ring
+    // absorbs the backlog, then drops, then evicts.  Marked refused, so
+    // msUntilFlush() retries it once per WS_BATCH_MS instead of spinning.
+    AsyncWebSocketMessageBuffer* frame = s.client->queueIsFull() ? NULL : socket.makeBuffer(s.ring.pending());
+    if (!frame) {
+        s.ring.sinkRefused(now);
+        return false;
+    }
+
+    // At most two pieces when the ring wraps
+    uint8_t* out = frame->get();
+    size_t   len = 0;
+    const char* data;
+    size_t n;
+    while ((n = s.ring.peek(data)) > 0) {
+        memcpy(out + len, data, n);
+        s.ring.consume(n);
+        len += n;
+    }
+
+    s.client->text(frame);
+    s.frames++;
+    framesSent++;
+    return true;
+}
+
+AsyncWebSocketClient* WSStream::evictIfStalled(Slot& s, uint32_t now) {
+    uint32_t stalled = s.ring.overflowingFor(now);
+    if (!s.client || stalled < WS_CLIENT_STALL_MS) {
+        return NULL;
+    }
+
+    AsyncWebSocketClient* client = s.client;
+    serialPrintf("[WebSocket] Disconnecting #%u: ring full for %u ms (%u sentences dropped)\n",
+                 client->id(), stalled, s.dropped);
+    s.ring.clear();
+    clients.release(s);
+    evictions++;
+    return client;
+}
+
+void WSStream::broadcast(const char* data, size_t len) {
+    if (!initialized || !data || len == 0 || clients.count() == 0) {
+        return;
+    }
+
+    AsyncWebSocketClient* victims[WS_MAX_CLIENTS];
+    size_t victimCount = 0;
+    uint32_t now = millis();
+
+    clients.lock();
+    for (size_t i = 0; i < WS_MAX_CLIENTS; i++) {
+        Slot& s = clients[i];
+        if (!s.client) {
+            continue;
+        }
+
+        if (s.ring.appendLine(data, len, now)) {
+            s.sentences++;
+            sentencesSent++;
+        } else {
+            s.dropped++;
+            sentencesDropped++;
+            AsyncWebSocketClient* victim = evictIfStalled(s, now);
+            if (victim) {
+                victims[victimCount++] = victim;
+                continue;
+            }
+        }
+
+        if (s.ring.due(now, WS_BATCH_BYTES, WS_BATCH_MS)) {
+            sendFrame(s, now);
+        }
+    }
+    clients.unlock();
+
+    for (size_t i = 0; i < victimCount; i++) {
+        victims[i]->close();
+    }
+}
+
+void WSStream::flush() {
+    if (!initialized) {
+        return;
+    }
+
+    uint32_t now = millis();
+    if (now - lastCleanup >= 5000) {
+        socket.cleanupClients(WS_MAX_CLIENTS);
+        lastCleanup = now;
+    }
+    if (clients.count() == 0) {
+        return;
+    }
+
+    AsyncWebSocketClient* victims[WS_MAX_CLIENTS];
+    size_t victimCount = 0;
+
+    clients.lock();
+    for (size_t i = 0; i < WS_MAX_CLIENTS; i++) {
+        Slot& s = clients[i];
+        if (!s.client) {
+            continue;
+        }
+        AsyncWebSocketClient* victim = evictIfStalled(s, now);
+        if (victim) {
+            victims[victimCount++] = victim;
+        } else if (s.ring.due(now, WS_BATCH_BYTES, WS_BATCH_MS)) {
+            sendFrame(s, now);
+        }
+    }
+    clients.unlock();
+
+    for (size_t i = 0; i < victimCount; i++) {
+        victims[i]->close();
+    }
+}
+
+uint32_t WSStream::msUntilFlush() {
+    uint32_t wait = WS_BATCH_MS;
+    if (!initialized || clients.count() == 0) {
+        return wait;
+    }
+
+    uint32_t now = millis();
+    clients.lock();
+    for (size_t i = 0; i < WS_MAX_CLIENTS; i++) {
+        const Slot& s = clients[i];
+        if (!s.client || s.ring.pending() == 0) {
+            continue;
+        }
+        uint32_t left = s.ring.msUntilDue(now, WS_BATCH_MS);
+        if (left < wait) {
+            wait = left;
+        }
+    }
+    clients.unlock();
+    return wait;
+}
+
+// ═══════════════════════════════════════════════════════════════
+// Metrics
+// ═══════════════════════════════════════════════════════════════
+
+void WSStream::registerMetrics(MetricsRegistry& reg) {
+    clients.registerGauge(reg, "espnav_ws_clients", "Clients connected to the /ws/nmea monitor");
+    reg.addCounter("espnav_ws_frames", "Text frames sent to /ws/nmea clients", &framesSent);
+    reg.addCounter("espnav_ws_sentences", "Sentences queued for /ws/nmea clients", &sentencesSent);
+    reg.addCounter("espnav_ws_dropped", "Sentences dropped on a full /ws/nmea client ring", &sentencesDropped);
+    reg.addCounter("espnav_ws_evictions", "/ws/nmea clients disconnected for a stalled ring", &evictions);
+}
@@ -1,61 +1,53 @@
 import { useState, useEffect } from 'react';
 import { api } from '../../services/api';
+import { useBoatState } from '../../hooks/useBoatState';
 
 export function Instruments() {
-  const [navData, setNavData]         = useState(null);
-  const [windData, setWindData]       = useState(null);
-  const [aisData, setAisData]         = useState(null);
-  const [perfData, setPerfData]       = useState(null);
-  const [polarStatus, setPolarStatus] = useState(null);
-  const [loading, setLoading]         = useState(true);
-  const [autoRefresh, setAutoRefresh] = useState(true);
-  const [error, setError]             = useState(null);
+  // Navigation, wind and performance are pushed over /ws/state
+  const { navData, windData, perfData, polarStatus, isConnected } = useBoatState();
+
+  // AIS targets are not in the binary frames: long-polled, so a change
+  // shows up at once and an idle table costs one request every 20 s
+  const [aisData, setAisData] = useState(null);
+  const [error, setError]     = useState(null);
 
   useEffect(() => {
-    loadData();
-
-    const interval = setInterval(() => {
-      if (autoRefresh) loadData();
-    }, 2000);
-
-    return () => clearInterval(interval);
-  }, [autoRefresh]);
-
-  const loadData = async () => {
-    try {
-      const [nav, wind, ais, perf, polar] = await Promise.all([
-        api.getBoatNavigation(),
-        api.getBoatWind(),
-        api.getBoatAIS(),
-        api.getPerformance(),
-        api.getPolarStatus(),
-      ]);
-
-      setNavData(nav);
-      setWindData(wind);
-      setAisData(ais);
-      setPerfData(perf);
-      setPolarStatus(polar);
-      setLoading(false);
-      setError(null);
-    } catch (err) {
-      console.error('Failed to load instrument data:', err);
-      setError('Failed to load data');
-      setLoading(false);
-    }
-  };
+    const controller = new AbortController();
+
+    const watchAIS = async () => {
+      let since;
+      while (!controller.signal.aborted) {
+        try {
+          const data = await api.getBoatAIS(since, 20000, controller.signal);
+          if (data) {
+            setAisData(data);
+            since = data.generation;
+          }
+          setError(null);
+        } catch (err) {
+          if (controller.signal.aborted) return;
+          console.error('Failed to load AIS targets:', err);
+          setError('Failed to load AIS targets');
+          await new Promise(resolve => setTimeout(resolve, 5000));
+        }
+      }
+    };
+
+    watchAIS();
+    return () => controller.abort();
+  }, []);
 
   // ── Formatting helpers ──────────────────────────────────────
 
+  // The firmware sends stale values as "no value": anything present is fresh
   const formatValue = (dataPoint) => {
     if (!dataPoint || !dataPoint.valid || dataPoint.value === null || dataPoint.value === undefined) {
       return { value: '--', stale: true };
     }
-    const isStale = dataPoint.timestamp && (Date.now() - dataPoint.timestamp > 10000);
     return {
       value: typeof dataPoint.value === 'number' ? dataPoint.value.toFixed(1) : dataPoint.value,
       unit: dataPoint.unit || '',
-      stale: isStale,
+      stale: false,
     };
   };
 
@@ -82,7 +74,7 @@ export function Instruments() {
   };
 
   /**
-   * Performance value from the /api/boat/performance response.
+   * Performance value from the /ws/state fields.
    * Returns { value, unit, stale } or { value: '--', stale: true }.
    */
   const formatPerf = (field) => {
@@ -118,22 +110,15 @@ export function Instruments() {
     return perfData.vmg.value >= 0 ? '▲ upwind' : '▼ downwind';
   };
 
-  if (loading) return <div className="page">Loading instruments…</div>;
-
   return (
     <div className="page">
 
       {/* ── Header ── */}
       <div style={{ display: 'flex', justifyContent: 'space-between', alignItems: 'center', marginBottom: 20 }}>
         <h2>⚓ Marine Instruments</h2>
-        <label>
-          <input
-            type="checkbox"
-            checked={autoRefresh}
-            onChange={(e) => setAutoRefresh(e.target.checked)}
-          />
-          {' '}Auto-refresh (2 s)
-        </label>
+        <span style={{ color: isConnected ? '#27ae60' : '#e74c3c' }}>
+          {isConnected ? '● Live' : '○ Reconnecting…'}
+        </span>
       </div>
 
       {error && <div className="message error" style={{ marginBottom: 20 }}>{error}</div>}
@@ -0,0 +1,84 @@
+import { useState, useEffect } from 'react';
+import { WebSocketService, applyStateFrame } from '../services/websocket';
+
+/** DataPoint-like object the instrument cards render: null → invalid. */
+const dp = (value, unit = '') => ({
+  value: value ?? null,
+  unit,
+  valid: value !== null && value !== undefined,
+});
+
+/**
+ * Live instrument values from /ws/state.
+ *
+ * The socket pushes only the fields that changed (at most 5 frames a
+ * second) plus a periodic keyframe, so there is nothing to poll.  Returns
+ * the same nav / wind / perf shapes the REST helpers used to build.
+ */
+export function useBoatState() {
+  const [state, setState] = useState({});
+  const [isConnected, setIsConnected] = useState(false);
+
+  useEffect(() => {
+    const ws = new WebSocketService('/ws/state', { binary: true });
+
+    const handleEvent = (type, data) => {
+      switch (type) {
+        case 'connected':
+          setIsConnected(true);
+          break;
+        case 'disconnected':
+          setIsConnected(false);
+          setState({});   // The next connection starts with a keyframe
+          break;
+        case 'message':
+          if (data instanceof ArrayBuffer) setState(prev => applyStateFrame(data, prev));
+          break;
+        default:
+          break;
+      }
+    };
+
+    ws.addListener(handleEvent);
+    ws.connect();
+    return () => ws.disconnect();
+  }, []);
+
+  const navData = {
+    gps: {
+      position: { lat: dp(state.lat, 'deg'), lon: dp(state.lon, 'deg') },
+      sog:        dp(state.sog, 'kn'),
+      cog:        dp(state.cog, 'deg'),
+      satellites: dp(state.satellites),
+      hdop:       dp(state.hdop),
+    },
+    heading: {
+      magnetic:     dp(state.heading_mag, 'deg'),
+      true_heading: dp(state.heading_true, 'deg'),
+    },
+    speed: {
+      stw:   dp(state.stw, 'kn'),
+      trip:  dp(state.trip, 'nm'),
+      total: dp(state.total, 'nm'),
+    },
+    depth: { below_transducer: dp(state.depth, 'm') },
+  };
+
+  const windData = {
+    aws: dp(state.aws, 'kn'),
+    awa: dp(state.awa, 'deg'),
+    tws: dp(state.tws, 'kn'),
+    twa: dp(state.twa, 'deg'),
+    twd: dp(state.twd, 'deg'),
+    environment: { water_temp: dp(state.water_temp, '°C') },
+  };
+
+  const perfData = {
+    vmg:       dp(state.vmg, 'kn'),
+    polar_pct: dp(state.polar_pct, '%'),
+  };
+
+  const polarStatus = state.polar_loaded === undefined ? null : { loaded: state.polar_loaded === 1 };
+
+  return { navData, windData, perfData, polarStatus, isConnected };
+}
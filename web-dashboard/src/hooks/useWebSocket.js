@@ -27,8 +27,10 @@ export function useWebSocket() {
         case 'message':
           // Read the ref — never causes the effect to re-run
           if (!isPausedRef.current) {
+            // One frame carries up to 100 ms of sentences, CR LF separated
+            const lines = data.split(/\r?\n/).filter(line => line.length > 0);
             setMessages(prev => {
-              const next = [...prev, data];
+              const next = [...prev, ...lines];
               return next.slice(-100); // Keep last 100 messages
             });
           }
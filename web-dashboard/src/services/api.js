@@ -277,12 +277,6 @@ export const api = {
     });
   },
 
-  async getPerformance() {
-    const response = await fetch(`${API_BASE}/boat/performance`);
-    if (!response.ok) throw new Error('Failed to get performance data');
-    return response.json();
-  },
-
   async getPerformanceConfig() {
     const response = await fetch(`${API_BASE}/performance/config`);
     if (!response.ok) throw new Error('Failed to get performance config');
@@ -354,32 +348,15 @@ export const api = {
     };
   },
 
-  async getBoatWind() {
-    const response = await fetch(`${API_BASE}/boat/wind`);
-    if (!response.ok) throw new Error('Failed to get wind data');
-    const data = await response.json();
-
-    const mapDP = (d, unit) => ({
-      value: d?.value ?? null,
-      unit:  d?.unit  || unit,
-      valid: d?.value !== null && d?.value !== undefined,
-      timestamp: d?.age ? Date.now() - (d.age * 1000) : Date.now()
-    });
-
-    return {
-      aws: mapDP(data.aws, 'kn'),
-      awa: mapDP(data.awa, 'deg'),
-      tws: mapDP(data.tws, 'kn'),
-      twa: mapDP(data.twa, 'deg'),
-      twd: mapDP(data.twd, 'deg'),
-      environment: {
-        water_temp: { value: null, valid: false, unit: '°C', timestamp: Date.now() }
-      }
-    };
-  },
-
-  async getBoatAIS() {
-    const response = await fetch(`${API_BASE}/boat/ais`);
+  /**
+   * AIS targets.  With `since` (the `generation` of the previous result)
+   * and `wait` in ms, the gateway holds the request until the targets
+   * change; resolves to null if they did not within `wait`.
+   */
+  async getBoatAIS(since, wait = 0, signal) {
+    const query = since === undefined ? '' : `?since=${since}&wait=${wait}`;
+    const response = await fetch(`${API_BASE}/boat/ais${query}`, { signal });
+    if (response.status === 304) return null;
     if (!response.ok) throw new Error('Failed to get AIS data');
     const data = await response.json();
 
@@ -398,6 +375,6 @@ export const api = {
       age:      t.age,
     }));
 
-    return { ...data, targets };
+    return { ...data, targets, generation: Number(response.headers.get('X-Generation')) };
   }
 };
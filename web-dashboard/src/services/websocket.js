@@ -1,5 +1,11 @@
 export class WebSocketService {
-  constructor() {
+  /**
+   * @param path   '/ws/nmea' (text frames of sentences) or '/ws/state' (binary instrument frames)
+   * @param binary Deliver binary frames as ArrayBuffer
+   */
+  constructor(path = '/ws/nmea', { binary = false } = {}) {
+    this.path = path;
+    this.binary = binary;
     this.ws = null;
     this.listeners = [];
     this.reconnectTimeout = null;
@@ -8,13 +14,14 @@ export class WebSocketService {
 
   connect() {
     const protocol = window.location.protocol === 'https:' ? 'wss:' : 'ws:';
-    const wsUrl = `${protocol}//${window.location.host}/ws/nmea`;
+    const wsUrl = `${protocol}//${window.location.host}${this.path}`;
 
     try {
       this.ws = new WebSocket(wsUrl);
+      if (this.binary) this.ws.binaryType = 'arraybuffer';
 
       this.ws.onopen = () => {
-        console.log('[WebSocket] Connected');
+        console.log(`[WebSocket] Connected to ${this.path}`);
         this.notifyListeners('connected', null);
       };
 
@@ -28,7 +35,7 @@ export class WebSocketService {
       };
 
       this.ws.onclose = () => {
-        console.log('[WebSocket] Disconnected');
+        console.log(`[WebSocket] Disconnected from ${this.path}`);
         this.notifyListeners('disconnected', null);
         
         if (this.shouldReconnect) {
@@ -69,3 +76,41 @@ export class WebSocketService {
     }
   }
 }
+
+// ── /ws/state frames ─────────────────────────────────────────────
+// Mirrors include/state_frame.h: field id → [key, divisor].  Ids are never
+// reused; fields added by newer firmware are ignored here.
+export const STATE_FIELDS = [
+  ['lat', 1e7], ['lon', 1e7],
+  ['sog', 100], ['cog', 10], ['satellites', 1], ['hdop', 100],
+  ['stw', 100], ['trip', 100], ['total', 10],
+  ['heading_mag', 10], ['heading_true', 10],
+  ['depth', 100],
+  ['aws', 100], ['awa', 10], ['tws', 100], ['twa', 10], ['twd', 10],
+  ['water_temp', 10],
+  ['vmg', 100], ['polar_pct', 10], ['polar_loaded', 1],
+];
+
+const STATE_FRAME_KEY = 0x01;
+const STATE_NO_VALUE  = -2147483648;
+
+/**
+ * Apply one binary frame to the previous state and return the new state.
+ * byte 0: keyframe flag, byte 1: entry count, then per entry a field id and
+ * an int32 LE fixed-point value (STATE_NO_VALUE → null: invalid or stale).
+ */
+export function applyStateFrame(buffer, prev) {
+  const view  = new DataView(buffer);
+  if (view.byteLength < 2) return prev;
+  const count = view.getUint8(1);
+  if (view.byteLength !== 2 + count * 5) return prev;
+
+  const next = (view.getUint8(0) & STATE_FRAME_KEY) ? {} : { ...prev };
+  for (let i = 0, off = 2; i < count; i++, off += 5) {
+    const field = STATE_FIELDS[view.getUint8(off)];
+    if (!field) continue;
+    const raw = view.getInt32(off + 1, true);
+    next[field[0]] = raw === STATE_NO_VALUE ? null : raw / field[1];
+  }
+  return next;
+}